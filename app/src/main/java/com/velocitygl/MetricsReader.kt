@@ -0,0 +1,122 @@
+package com.velocitygl
+
+import android.os.Build
+import java.lang.invoke.VarHandle
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Reader for the native shared metrics block
+ * Polls the page written once per frame by the render thread, using the
+ * block's sequence counter instead of JNI calls or locks.
+ */
+class MetricsReader internal constructor(buffer: ByteBuffer) {
+
+    private val block: ByteBuffer = buffer.duplicate().order(ByteOrder.LITTLE_ENDIAN)
+
+    /**
+     * Read a consistent snapshot, null if the block is inactive or keeps changing
+     */
+    fun read(): Metrics? {
+        repeat(MAX_RETRIES) {
+            if (block.getInt(OFFSET_MAGIC) != MAGIC) return null
+            if (block.getInt(OFFSET_VERSION) < VERSION) return null
+
+            val before = block.getInt(OFFSET_SEQUENCE)
+            if ((before and 1) != 0) return@repeat
+            acquireFence()
+
+            val metrics = Metrics(
+                frameIndex = block.getLong(16),
+                timestampNs = block.getLong(24),
+                textureMemory = block.getLong(32),
+                bufferMemory = block.getLong(40),
+                heapMemory = block.getLong(48),
+                shaderCacheSize = block.getLong(56),
+                fps = block.getFloat(64),
+                avgFps = block.getFloat(68),
+                frameTimeMs = block.getFloat(72),
+                cpuTimeMs = block.getFloat(76),
+                gpuTimeMs = block.getFloat(80),
+                frameTimeP50Ms = block.getFloat(84),
+                frameTimeP90Ms = block.getFloat(88),
+                frameTimeP99Ms = block.getFloat(92),
+                frameTimeP999Ms = block.getFloat(96),
+                onePercentLowFps = block.getFloat(100),
+                stutterCount = block.getInt(104),
+                drawCalls = block.getInt(108),
+                drawCallsSaved = block.getInt(112),
+                triangles = block.getInt(116),
+                batchesCreated = block.getInt(120),
+                shaderCacheHits = block.getInt(124),
+                shaderCacheMisses = block.getInt(128),
+                resolutionScale = block.getFloat(132),
+                renderWidth = block.getInt(136),
+                renderHeight = block.getInt(140),
+                windowWidth = block.getInt(144),
+                windowHeight = block.getInt(148)
+            )
+
+            acquireFence()
+            if (block.getInt(OFFSET_SEQUENCE) == before) return metrics
+        }
+        return null
+    }
+
+    private fun acquireFence() {
+        if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.TIRAMISU) {
+            VarHandle.acquireFence()
+        } else {
+            // Monitor enter/exit orders the surrounding plain reads
+            synchronized(fenceLock) { }
+        }
+    }
+
+    companion object {
+        // Must match VELOCITY_METRICS_MAGIC / VELOCITY_METRICS_VERSION
+        private const val MAGIC = 0x4D474C56
+        private const val VERSION = 1
+
+        private const val OFFSET_MAGIC = 0
+        private const val OFFSET_VERSION = 4
+        private const val OFFSET_SEQUENCE = 12
+
+        private const val MAX_RETRIES = 8
+
+        private val fenceLock = Any()
+    }
+}
+
+/**
+ * Snapshot of the shared metrics block
+ */
+data class Metrics(
+    val frameIndex: Long,
+    val timestampNs: Long,
+    val textureMemory: Long,
+    val bufferMemory: Long,
+    val heapMemory: Long,
+    val shaderCacheSize: Long,
+    val fps: Float,
+    val avgFps: Float,
+    val frameTimeMs: Float,
+    val cpuTimeMs: Float,
+    val gpuTimeMs: Float,
+    val frameTimeP50Ms: Float,
+    val frameTimeP90Ms: Float,
+    val frameTimeP99Ms: Float,
+    val frameTimeP999Ms: Float,
+    val onePercentLowFps: Float,
+    val stutterCount: Int,
+    val drawCalls: Int,
+    val drawCallsSaved: Int,
+    val triangles: Int,
+    val batchesCreated: Int,
+    val shaderCacheHits: Int,
+    val shaderCacheMisses: Int,
+    val resolutionScale: Float,
+    val renderWidth: Int,
+    val renderHeight: Int,
+    val windowWidth: Int,
+    val windowHeight: Int
+)
@@ -2,6 +2,7 @@ package com.velocitygl
 
 import android.view.Surface
 import androidx.annotation.Keep
+import java.nio.ByteBuffer
 
 /**
  * VelocityGL - Main JNI interface
@@ -110,11 +111,102 @@ object VelocityGL {
     @JvmStatic
     external fun nativeGetGPUInfo(): String
 
+    /**
+     * Enable/disable the per-entry-point call profiler
+     */
+    @JvmStatic
+    external fun nativeSetCallProfiling(enabled: Boolean)
+
+    /**
+     * Dump call profiler table to a file (null = logcat)
+     */
+    @JvmStatic
+    external fun nativeDumpCallStats(path: String?): Boolean
+
+    /**
+     * Start timeline tracing (windowMs > 0 keeps a rolling window)
+     */
+    @JvmStatic
+    external fun nativeTraceStart(windowMs: Int)
+
+    /**
+     * Stop timeline tracing
+     */
+    @JvmStatic
+    external fun nativeTraceStop()
+
+    /**
+     * Write recorded timeline as Chrome trace JSON
+     */
+    @JvmStatic
+    external fun nativeTraceDump(path: String): Boolean
+
+    /**
+     * Capture the next N frames to a trace file
+     */
+    @JvmStatic
+    external fun nativeTraceCaptureFrames(path: String, frames: Int)
+
+    /**
+     * Set hitch threshold for the flight recorder (0 = off)
+     */
+    @JvmStatic
+    external fun nativeSetHitchThreshold(thresholdMs: Float)
+
+    /**
+     * Summarize a hitch dump file
+     */
+    @JvmStatic
+    external fun nativeSummarizeHitch(path: String): String?
+
+    /**
+     * Get direct buffer over the shared metrics block
+     */
+    @JvmStatic
+    external fun nativeGetMetricsBuffer(): ByteBuffer?
+
+    /**
+     * Get memfd backing the metrics block (-1 if none)
+     */
+    @JvmStatic
+    external fun nativeGetMetricsFd(): Int
+
+    /**
+     * Enable/disable frame pacing
+     */
+    @JvmStatic
+    external fun nativeSetFramePacing(enabled: Boolean)
+
+    /**
+     * Set display refresh rate used for pacing
+     */
+    @JvmStatic
+    external fun nativeSetDisplayRefreshRate(hz: Float)
+
+    /**
+     * Enable/disable latency mode
+     */
+    @JvmStatic
+    external fun nativeSetLatencyMode(enabled: Boolean, maxFramesInFlight: Int)
+
+    /**
+     * Mark the start of UI rendering for this frame
+     */
+    @JvmStatic
+    external fun nativeBeginUI()
+
+    /**
+     * Set native UI mode (0 = off, 1 = marker, 2 = auto)
+     */
+    @JvmStatic
+    external fun nativeSetNativeUI(mode: Int)
+
     // ========================================================================
     // Kotlin wrapper methods
     // ========================================================================
 
     private var initialized = false
+    private var metricsReader: MetricsReader? = null
 
     /**
      * Initialize VelocityGL
@@ -138,6 +230,7 @@ object VelocityGL {
      */
     fun shutdown() {
         if (initialized) {
+            metricsReader = null
             nativeShutdown()
             initialized = false
         }
@@ -274,6 +367,136 @@ object VelocityGL {
         }
     }
 
+    /**
+     * Enable/disable call profiling
+     */
+    fun setCallProfiling(enabled: Boolean) {
+        if (initialized) {
+            nativeSetCallProfiling(enabled)
+        }
+    }
+
+    /**
+     * Dump call profile (null path writes to logcat)
+     */
+    fun dumpCallStats(path: String? = null): Boolean {
+        return if (initialized) nativeDumpCallStats(path) else false
+    }
+
+    /**
+     * Start timeline tracing (0 = keep everything until stopped)
+     */
+    fun startTrace(windowMs: Int = 0) {
+        if (initialized) {
+            nativeTraceStart(windowMs)
+        }
+    }
+
+    /**
+     * Stop timeline tracing
+     */
+    fun stopTrace() {
+        if (initialized) {
+            nativeTraceStop()
+        }
+    }
+
+    /**
+     * Write recorded timeline (open in ui.perfetto.dev or chrome://tracing)
+     */
+    fun dumpTrace(path: String): Boolean {
+        return if (initialized) nativeTraceDump(path) else false
+    }
+
+    /**
+     * Capture the next N frames to a trace file
+     */
+    fun captureTraceFrames(path: String, frames: Int) {
+        if (initialized) {
+            nativeTraceCaptureFrames(path, frames)
+        }
+    }
+
+    /**
+     * Set frame time that triggers a hitch dump (0 disables the recorder)
+     */
+    fun setHitchThreshold(thresholdMs: Float) {
+        if (initialized) {
+            nativeSetHitchThreshold(thresholdMs.coerceAtLeast(0f))
+        }
+    }
+
+    /**
+     * Summarize a hitch dump (hitch_NN.vfr in the cache dir)
+     */
+    fun summarizeHitch(path: String): String? {
+        return if (initialized) nativeSummarizeHitch(path) else null
+    }
+
+    /**
+     * Get shared metrics reader (one JNI call on first use, none afterwards)
+     */
+    fun getMetricsReader(): MetricsReader? {
+        if (!initialized) return null
+        
+        metricsReader?.let { return it }
+        
+        val buffer = nativeGetMetricsBuffer() ?: return null
+        return MetricsReader(buffer).also { metricsReader = it }
+    }
+
+    /**
+     * Get memfd of the metrics block for local tools (-1 if unavailable)
+     */
+    fun getMetricsFd(): Int {
+        return if (initialized) nativeGetMetricsFd() else -1
+    }
+
+    /**
+     * Enable/disable frame pacing
+     */
+    fun setFramePacing(enabled: Boolean) {
+        if (initialized) {
+            nativeSetFramePacing(enabled)
+        }
+    }
+
+    /**
+     * Report the display refresh rate (e.g. Display.getRefreshRate()) for pacing
+     */
+    fun setDisplayRefreshRate(hz: Float) {
+        if (initialized) {
+            nativeSetDisplayRefreshRate(hz)
+        }
+    }
+
+    /**
+     * Enable/disable latency mode, bounding frames the CPU may queue ahead (1-3)
+     */
+    fun setLatencyMode(enabled: Boolean, maxFramesInFlight: Int = 1) {
+        if (initialized) {
+            nativeSetLatencyMode(enabled, maxFramesInFlight)
+        }
+    }
+
+    /**
+     * Mark the start of UI rendering: the scene is upscaled and the UI drawn at native resolution
+     */
+    fun beginUI() {
+        if (initialized) {
+            nativeBeginUI()
+        }
+    }
+
+    /**
+     * Set how the start of UI rendering is found (0 = off, 1 = marker, 2 = auto)
+     */
+    fun setNativeUI(mode: Int) {
+        if (initialized) {
+            nativeSetNativeUI(mode)
+        }
+    }
+
     /**
      * Check if initialized
      */
@@ -309,7 +532,17 @@ enum class QualityPreset {
  */
 data class RendererStats(
     val fps: Float,
+    val avgFps: Float,
     val frameTimeMs: Float,
+    val gpuTimeMs: Float,
+    val frameTimeP50Ms: Float,
+    val frameTimeP90Ms: Float,
+    val frameTimeP99Ms: Float,
+    val frameTimeP999Ms: Float,
+    val onePercentLowFps: Float,
+    val stutterCount: Int,
+    val pacedFps: Float,
+    val latencyMs: Float,
     val drawCalls: Int,
     val triangles: Int,
     val textureMemoryMB: Float,
@@ -325,7 +558,17 @@ data class RendererStats(
             val map = parseSimpleJson(json)
             return RendererStats(
                 fps = (map["fps"] as? Number)?.toFloat() ?: 0f,
+                avgFps = (map["avgFps"] as? Number)?.toFloat() ?: 0f,
                 frameTimeMs = (map["frameTimeMs"] as? Number)?.toFloat() ?: 0f,
+                gpuTimeMs = (map["gpuTimeMs"] as? Number)?.toFloat() ?: 0f,
+                frameTimeP50Ms = (map["frameTimeP50Ms"] as? Number)?.toFloat() ?: 0f,
+                frameTimeP90Ms = (map["frameTimeP90Ms"] as? Number)?.toFloat() ?: 0f,
+                frameTimeP99Ms = (map["frameTimeP99Ms"] as? Number)?.toFloat() ?: 0f,
+                frameTimeP999Ms = (map["frameTimeP999Ms"] as? Number)?.toFloat() ?: 0f,
+                onePercentLowFps = (map["onePercentLowFps"] as? Number)?.toFloat() ?: 0f,
+                stutterCount = (map["stutterCount"] as? Number)?.toInt() ?: 0,
+                pacedFps = (map["pacedFps"] as? Number)?.toFloat() ?: 0f,
+                latencyMs = (map["latencyMs"] as? Number)?.toFloat() ?: 0f,
                 drawCalls = (map["drawCalls"] as? Number)?.toInt() ?: 0,
                 triangles = (map["triangles"] as? Number)?.toInt() ?: 0,
                 textureMemoryMB = (map["textureMemoryMB"] as? Number)?.toFloat() ?: 0f,
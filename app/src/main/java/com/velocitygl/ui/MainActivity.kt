@@ -210,12 +210,13 @@ class MainActivity : AppCompatActivity() {
         statsUpdateJob = lifecycleScope.launch {
             while (isActive) {
                 if (VelocityGL.isInitialized()) {
-                    VelocityGL.getStats()?.let { stats ->
-                        binding.textFps.text = String.format("%.1f FPS", stats.fps)
-                        binding.textFrameTime.text = String.format("%.2f ms", stats.frameTimeMs)
-                        binding.textDrawCalls.text = "${stats.drawCalls} calls"
-                        binding.textTriangles.text = "${stats.triangles / 1000}K tris"
-                        binding.textCurrentScale.text = "${(stats.resolutionScale * 100).toInt()}%"
+                    // Shared metrics block: no JNI call per poll
+                    VelocityGL.getMetricsReader()?.read()?.let { metrics ->
+                        binding.textFps.text = String.format("%.1f FPS", metrics.fps)
+                        binding.textFrameTime.text = String.format("%.2f ms", metrics.frameTimeMs)
+                        binding.textDrawCalls.text = "${metrics.drawCalls} calls"
+                        binding.textTriangles.text = "${metrics.triangles / 1000}K tris"
+                        binding.textCurrentScale.text = "${(metrics.resolutionScale * 100).toInt()}%"
                     }
                 }
                 delay(500)
@@ -81,6 +81,30 @@ typedef enum VelocityShaderCacheMode {
     VELOCITY_CACHE_AGGRESSIVE        // Pre-compile common shaders
 } VelocityShaderCacheMode;
 
+/**
+ * Native-resolution UI over a scaled 3D frame
+ */
+typedef enum VelocityNativeUIMode {
+    VELOCITY_NATIVE_UI_OFF = 0,      // Whole frame at the render scale
+    VELOCITY_NATIVE_UI_MARKER,       // UI starts at velocityBeginUI()
+    VELOCITY_NATIVE_UI_AUTO          // Marker, or detected from draw state
+} VelocityNativeUIMode;
+
+/**
+ * Handling of frames identical to the previous ones
+ */
+typedef enum VelocityIdlePolicy {
+    VELOCITY_IDLE_OFF = 0,           // Upscale and present every frame
+    VELOCITY_IDLE_REPRESENT,         // Re-present the last image without redrawing it
+    VELOCITY_IDLE_SKIP               // Skip the present, run the loop at idleFPS
+} VelocityIdlePolicy;
+
+/**
+ * Delivery of an asynchronous readback on the render thread; pixels is
+ * NULL if the read failed and only valid during the call
+ */
+typedef void (*VelocityReadbackCallback)(uint32_t handle, const void* pixels, size_t size, void* userData);
+
 /**
  * Main configuration
  */
@@ -98,7 +122,16 @@ typedef struct VelocityConfig {
     bool enableDynamicResolution;
     float minResolutionScale;        // e.g., 0.5 for 50%
     float maxResolutionScale;        // e.g., 1.0 for 100%
-    int targetFPS;                   // Target for dynamic scaling
+    int targetFPS;                   // Target for dynamic scaling and frame pacing
+    VelocityNativeUIMode nativeUI;   // Draw UI at native resolution over the scaled scene
+    
+    // Frame pacing
+    bool enableFramePacing;          // Hold presents to a steady vsync cadence
+    bool enableLatencyMode;          // Bound how far the CPU runs ahead of the GPU
+    int maxFramesInFlight;           // Latency mode: 1 (lowest latency) - 3
+    bool enablePartialPresent;       // Present only changed window regions (swap with damage)
+    VelocityIdlePolicy idlePolicy;   // What to do with identical frames
+    int idleFPS;                     // Loop rate while presents are skipped
     
     // Draw call optimization
     bool enableDrawBatching;
@@ -110,11 +143,20 @@ typedef struct VelocityConfig {
     bool enableAsyncTextureLoad;
     int texturePoolSize;             // MB
     int maxTextureSize;              // Max dimension
+    bool enableStoragePooling;       // Recycle deleted render target storage of the same shape
     
     // Buffer optimization
     bool enableBufferPooling;
     int bufferPoolSize;              // MB
     bool enablePersistentMapping;
+    bool enableNamePooling;          // Pre-generate object names, delete behind frame fences
+    bool enableAsyncReadback;        // glReadPixels returns the last completed read of the region
+    bool enableVaoCache;             // Map re-specified attribute setups to cached VAOs
+    bool enableVertexPacking;        // Repack static float normals, colors and UVs into compact formats
+    
+    // Render passes
+    bool enableAutoInvalidate;       // Discard attachments whose contents are dead at pass end
+    bool enableRenderPassMerging;    // Defer framebuffer binds, drop empty passes, merge clears
     
     // GPU specific
     bool enableGPUSpecificTweaks;
@@ -123,6 +165,7 @@ typedef struct VelocityConfig {
     // Debug
     bool enableDebugOutput;
     bool enableProfiling;
+    float hitchThresholdMs;          // Frames slower than this dump the flight recorder (0 = off)
     const char* logPath;
     
 } VelocityConfig;
@@ -138,15 +181,39 @@ typedef struct VelocityStats {
     float gpuTimeMs;
     float cpuTimeMs;
     
+    // Frame time distribution (frame-to-frame interval over the stats window)
+    float frameTimeP50Ms;
+    float frameTimeP90Ms;
+    float frameTimeP99Ms;
+    float frameTimeP999Ms;
+    float onePercentLowFPS;          // FPS over the slowest 1% of frames
+    uint32_t stutterCount;           // Frames over 2x the median since reset
+    float pacedFPS;                  // Frame pacer cadence (0 = unpaced)
+    float latencyMs;                 // Estimated input-to-present latency
+    float presentedArea;             // Window share presented as damage last frame (1 = full)
+    uint32_t identicalFrames;        // Frames re-presented or skipped as unchanged
+    float readbackStallMs;           // CPU time in synchronous glReadPixels last frame
+    float syncStallMs;               // CPU time blocked on the GPU last frame, all causes
+    
     // Draw calls
     uint32_t drawCalls;
     uint32_t drawCallsSaved;         // Saved by batching
     uint32_t triangles;
+    uint32_t attribCallsSaved;       // Vertex attribute setup calls replaced by cached VAOs last frame
+    uint32_t attribsStripped;        // Enabled attribute arrays left out of draws that don't read them
+    
+    // Render passes (last frame)
+    uint32_t renderPasses;           // Draw framebuffer changes made by the app
+    uint32_t renderPassesExecuted;   // ... after dropping empty and merging repeated passes
     
     // Memory
     size_t textureMemory;
     size_t bufferMemory;
     size_t shaderCacheSize;
+    size_t storagePooled;            // Released render target storage held for reuse
+    uint32_t storageRecycled;        // Allocations served from released storage
+    uint32_t deferredDeletes;        // Deleted objects awaiting their frame fence
+    size_t vertexBytesSaved;         // Static vertex data drawn from smaller packed copies
     
     // Shader cache
     uint32_t shaderCacheHits;
@@ -159,6 +226,106 @@ typedef struct VelocityStats {
     
 } VelocityStats;
 
+/**
+ * Per-entry-point call statistics (call profiler)
+ */
+typedef struct VelocityCallStats {
+    const char* name;                // GL entry point, e.g. "glDrawElements"
+    uint64_t callsPerFrame;          // Calls during the last frame
+    uint64_t totalCalls;             // Calls since the last reset
+    uint64_t sampledCalls;           // Calls that were timed
+    float wrapperTimeNs;             // Average time spent in the wrapper
+    float driverTimeNs;              // Average time spent in the driver
+    float frameTimeMs;               // Estimated CPU time in the last frame
+} VelocityCallStats;
+
+/**
+ * GPU time per render pass (last resolved frame)
+ */
+typedef struct VelocityGpuPassStats {
+    const char* name;                // "framebuffer", "default_framebuffer", "scaler_upscale", ...
+    uint32_t framebuffer;            // Draw framebuffer of the pass
+    float gpuTimeMs;
+} VelocityGpuPassStats;
+
+/**
+ * Blocking CPU-GPU waits of one cause
+ */
+typedef struct VelocitySyncStallStats {
+    const char* name;                // "throttle", "stream", "finish", "app_sync", ...
+    uint32_t waitsPerFrame;
+    float frameMs;                   // Blocked during the last frame
+    uint64_t totalWaits;
+    float totalMs;
+    float maxMs;                     // Longest single wait
+} VelocitySyncStallStats;
+
+/**
+ * Upscaler quality/cost at one render scale, FSR against bilinear
+ */
+typedef struct VelocityUpscaleBenchmark {
+    float scale;                     // Render scale actually used
+    float fsrPsnrDb;                 // Against a native-resolution test pattern
+    float fsrMs;                     // Upscale pass time (EASU + RCAS)
+    float bilinearPsnrDb;
+    float bilinearMs;
+} VelocityUpscaleBenchmark;
+
+/**
+ * Shared-memory metrics (updated once per frame by the render thread)
+ * Little-endian, fixed layout; fields are only ever appended and the
+ * version bumped. Offsets are relative to the start of VelocityMetricsBlock.
+ */
+#define VELOCITY_METRICS_MAGIC   0x4D474C56  // "VLGM"
+#define VELOCITY_METRICS_VERSION 1
+
+typedef struct VelocityMetrics {
+    uint64_t frameIndex;             // 16
+    uint64_t timestampNs;            // 24: CLOCK_MONOTONIC at publish
+    uint64_t textureMemory;          // 32
+    uint64_t bufferMemory;           // 40
+    uint64_t heapMemory;             // 48
+    uint64_t shaderCacheSize;        // 56
+    
+    // Frame timing
+    float fps;                       // 64
+    float avgFps;                    // 68
+    float frameTimeMs;               // 72
+    float cpuTimeMs;                 // 76
+    float gpuTimeMs;                 // 80
+    float frameTimeP50Ms;            // 84
+    float frameTimeP90Ms;            // 88
+    float frameTimeP99Ms;            // 92
+    float frameTimeP999Ms;           // 96
+    float onePercentLowFps;          // 100
+    uint32_t stutterCount;           // 104
+    
+    // Draw calls
+    uint32_t drawCalls;              // 108
+    uint32_t drawCallsSaved;         // 112
+    uint32_t triangles;              // 116
+    uint32_t batchesCreated;         // 120
+    
+    // Shader cache
+    uint32_t shaderCacheHits;        // 124
+    uint32_t shaderCacheMisses;      // 128
+    
+    // Resolution
+    float resolutionScale;           // 132
+    int32_t renderWidth;             // 136
+    int32_t renderHeight;            // 140
+    int32_t windowWidth;             // 144
+    int32_t windowHeight;            // 148
+} VelocityMetrics;
+
+typedef struct VelocityMetricsBlock {
+    uint32_t magic;                  // 0: VELOCITY_METRICS_MAGIC
+    uint32_t version;                // 4: VELOCITY_METRICS_VERSION
+    uint32_t size;                   // 8: sizeof(VelocityMetricsBlock)
+    uint32_t sequence;               // 12: odd while a write is in progress
+    VelocityMetrics metrics;         // 16
+} VelocityMetricsBlock;
+
 /**
  * GPU capabilities
  */
@@ -285,6 +452,76 @@ VELOCITY_API void velocityBeginFrame(void);
  */
 VELOCITY_API void velocityEndFrame(void);
 
+/**
+ * Enable/disable the per-entry-point call profiler
+ */
+VELOCITY_API void velocitySetCallProfiling(bool enabled);
+
+/**
+ * Get call statistics sorted by CPU time, returns number of entries written
+ */
+VELOCITY_API int velocityGetCallStats(VelocityCallStats* stats, int maxEntries);
+
+/**
+ * Dump the call statistics table to a file (NULL writes to the log)
+ */
+VELOCITY_API bool velocityDumpCallStats(const char* path);
+
+/**
+ * Get GPU time per pass of the last resolved frame, returns number of entries written
+ */
+VELOCITY_API int velocityGetGpuPassStats(VelocityGpuPassStats* stats, int maxEntries);
+
+/**
+ * Get blocking waits per cause, returns number of entries written
+ */
+VELOCITY_API int velocityGetSyncStallStats(VelocitySyncStallStats* stats, int maxEntries);
+
+/**
+ * Start recording a CPU/GPU timeline (windowMs > 0 keeps only the last window)
+ */
+VELOCITY_API void velocityTraceStart(uint32_t windowMs);
+
+/**
+ * Stop recording the timeline
+ */
+VELOCITY_API void velocityTraceStop(void);
+
+/**
+ * Write the recorded timeline as Chrome Trace Event JSON
+ */
+VELOCITY_API bool velocityTraceDump(const char* path);
+
+/**
+ * Record the next N frames and write them to path
+ */
+VELOCITY_API void velocityTraceCaptureFrames(const char* path, int frames);
+
+/**
+ * Set the frame time that triggers a flight recorder dump (0 disables it)
+ */
+VELOCITY_API void velocitySetHitchThreshold(float thresholdMs);
+
+/**
+ * Summarize a flight recorder dump into out, likely cause first
+ */
+VELOCITY_API bool velocitySummarizeHitch(const char* path, char* out, size_t outSize);
+
+/**
+ * Get the shared metrics block (read with the sequence protocol), NULL if unavailable
+ */
+VELOCITY_API const VelocityMetricsBlock* velocityGetMetricsBlock(void);
+
+/**
+ * Get the memfd backing the metrics block for local tools, -1 if none
+ */
+VELOCITY_API int velocityGetMetricsFd(void);
+
+/**
+ * Read a consistent copy of the shared metrics
+ */
+VELOCITY_API bool velocityReadMetrics(VelocityMetrics* out);
+
 // ============================================================================
 // Shader Cache Control
 // ============================================================================
@@ -328,6 +565,70 @@ VELOCITY_API float velocityGetResolutionScale(void);
  */
 VELOCITY_API void velocitySetDynamicResolution(bool enabled);
 
+/**
+ * Compare FSR and bilinear upscaling at a render scale (stalls the GPU)
+ */
+VELOCITY_API bool velocityBenchmarkUpscaler(float scale, VelocityUpscaleBenchmark* result);
+
+/**
+ * Mark the start of UI rendering: the scene is upscaled at the next draw
+ * into the default framebuffer, the rest of the frame draws at native resolution
+ */
+VELOCITY_API void velocityBeginUI(void);
+
+/**
+ * Set how the start of UI rendering is found
+ */
+VELOCITY_API void velocitySetNativeUI(VelocityNativeUIMode mode);
+
+// ============================================================================
+// Frame Pacing
+// ============================================================================
+
+/**
+ * Enable/disable frame pacing
+ */
+VELOCITY_API void velocitySetFramePacing(bool enabled);
+
+/**
+ * Set the display refresh rate used for pacing (Hz)
+ */
+VELOCITY_API void velocitySetDisplayRefreshRate(float hz);
+
+/**
+ * Enable/disable latency mode with frames in flight (1-3)
+ */
+VELOCITY_API void velocitySetLatencyMode(bool enabled, int maxFramesInFlight);
+
+/**
+ * Set what happens to frames identical to the previous ones
+ */
+VELOCITY_API void velocitySetIdlePolicy(VelocityIdlePolicy policy, int idleFPS);
+
+// ============================================================================
+// Pixel Readback
+// ============================================================================
+
+/**
+ * Read a region of the bound read framebuffer without waiting for the GPU;
+ * the tightly packed result arrives through the callback, or through
+ * velocityPollReadback when it is NULL. Returns 0 if the read can't be queued
+ */
+VELOCITY_API uint32_t velocityReadPixelsAsync(int x, int y, int width, int height,
+                                              uint32_t format, uint32_t type,
+                                              VelocityReadbackCallback callback, void* userData);
+
+/**
+ * Copy out a polled readback: 1 done, 0 pending, -1 unknown or failed
+ */
+VELOCITY_API int velocityPollReadback(uint32_t handle, void* pixels, size_t size);
+
+/**
+ * Serve glReadPixels into client memory from reads completed a frame or
+ * more earlier (for readers that poll every frame, like map renderers)
+ */
+VELOCITY_API void velocitySetAsyncReadback(bool enabled);
+
 // ============================================================================
 // Memory Management
 // ============================================================================
@@ -6,6 +6,7 @@
 #include "../utils/log.h"
 #include "../utils/memory.h"
 #include "../core/gl_wrapper.h"
+#include "../profile/flight_recorder.h"
 
 #include <string.h>
 #include <pthread.h>
@@ -135,13 +136,6 @@ void bufferManagerShutdown(void) {
     }
     glDeleteBuffers(1, &g_bufMgr->streamBuffer);
     
-    // Delete sync objects
-    for (int i = 0; i < 3; i++) {
-        if (g_bufMgr->streamFences[i]) {
-            glDeleteSync(g_bufMgr->streamFences[i]);
-        }
-    }
-    
     // Destroy all pools
     for (int i = 0; i < g_bufMgr->poolCount; i++) {
         if (g_bufMgr->pools[i].bufferId) {
@@ -461,17 +455,12 @@ void bufferStreamBeginFrame(void) {
     // Wait for fence from 2 frames ago (triple buffering)
     int fenceIndex = (g_bufMgr->currentFrame + 1) % 3;
     
-    if (g_bufMgr->streamFences[fenceIndex]) {
-        GLenum result = glClientWaitSync(g_bufMgr->streamFences[fenceIndex], 
-                                          GL_SYNC_FLUSH_COMMANDS_BIT, 
-                                          1000000000);  // 1 second timeout
-        
-        if (result == GL_TIMEOUT_EXPIRED) {
+    if (g_bufMgr->streamPoints[fenceIndex]) {
+        if (!fenceTimelineWait(g_bufMgr->streamPoints[fenceIndex], FENCE_WAIT_STREAM,
+                               1000000000)) {  // 1 second timeout
             velocityLogWarn("Stream buffer fence timeout");
         }
-        
-        glDeleteSync(g_bufMgr->streamFences[fenceIndex]);
-        g_bufMgr->streamFences[fenceIndex] = NULL;
+        g_bufMgr->streamPoints[fenceIndex] = 0;
     }
     
     // Reset offset for this frame's portion
@@ -482,8 +471,8 @@ void bufferStreamBeginFrame(void) {
 void bufferStreamEndFrame(void) {
     if (!g_bufMgr) return;
     
-    // Insert fence
-    g_bufMgr->streamFences[g_bufMgr->currentFrame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    // Mark the frame's region on the timeline
+    g_bufMgr->streamPoints[g_bufMgr->currentFrame] = fenceTimelineSubmit();
     
     // Advance frame
     g_bufMgr->currentFrame = (g_bufMgr->currentFrame + 1) % 3;
@@ -500,6 +489,7 @@ size_t bufferStreamAlloc(size_t size, const void* data, GLuint* outBuffer) {
     // Check if we have space in current frame's region
     if (g_bufMgr->streamOffset + alignedSize > frameEnd) {
         velocityLogWarn("Stream buffer overflow for frame");
+        FLIGHT_EVENT(FLIGHT_EVENT_STREAM_OVERFLOW, size);
         return 0;
     }
     
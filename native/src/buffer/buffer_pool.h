@@ -11,6 +11,8 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#include "../optimize/fence_timeline.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -113,7 +115,7 @@ typedef struct BufferManagerContext {
     size_t streamBufferSize;
     size_t streamOffset;
     void* streamMappedPtr;
-    GLsync streamFences[3];  // Triple buffering
+    FencePoint streamPoints[3];  // Triple buffering
     int currentFrame;
     
     // Statistics
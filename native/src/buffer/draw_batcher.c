@@ -3,13 +3,18 @@
  */
 
 #include "draw_batcher.h"
+#include "vao_cache.h"
 #include "../utils/log.h"
 #include "../utils/memory.h"
 #include "../core/gl_wrapper.h"
+#include "../profile/trace.h"
+#include "../profile/flight_recorder.h"
 
 #include <string.h>
 #include <stdlib.h>
 
+bool glExtensionSupported(const char* extension);
+
 // ============================================================================
 // Global State
 // ============================================================================
@@ -28,6 +33,8 @@ static uint64_t hashBatchKey(const BatchKey* key) {
     hash *= 1099511628211ULL;
     hash ^= key->vao;
     hash *= 1099511628211ULL;
+    hash ^= key->elementBuffer;
+    hash *= 1099511628211ULL;
     hash ^= key->texture0;
     hash *= 1099511628211ULL;
     hash ^= key->texture1;
@@ -39,9 +46,15 @@ static uint64_t hashBatchKey(const BatchKey* key) {
     return hash;
 }
 
+static inline bool isIndexed(DrawCommandType type) {
+    return type == DRAW_CMD_ELEMENTS || type == DRAW_CMD_ELEMENTS_INSTANCED ||
+           type == DRAW_CMD_MULTI_DRAW_ELEMENTS;
+}
+
 static bool batchKeysEqual(const BatchKey* a, const BatchKey* b) {
     return a->program == b->program &&
            a->vao == b->vao &&
+           a->elementBuffer == b->elementBuffer &&
            a->texture0 == b->texture0 &&
            a->texture1 == b->texture1 &&
            a->mode == b->mode &&
@@ -71,13 +84,18 @@ bool drawBatcherInit(int maxCommands) {
     g_batcher->maxCommands = maxCommands;
     g_batcher->commands = (DrawCommand*)velocityCalloc(maxCommands, sizeof(DrawCommand));
     
-    g_batcher->maxBatches = maxCommands / 4;  // Rough estimate
-    g_batcher->batches = (BatchedDraw*)velocityCalloc(g_batcher->maxBatches, sizeof(BatchedDraw));
+    int maxChunks = (maxCommands + BATCH_CHUNK_SIZE - 1) / BATCH_CHUNK_SIZE;
+    g_batcher->scratchOrder = (uint32_t*)velocityCalloc(maxCommands, sizeof(uint32_t));
+    g_batcher->scratchFresh = (uint32_t*)velocityCalloc(maxCommands, sizeof(uint32_t));
+    g_batcher->chunkChanged = (bool*)velocityCalloc(maxChunks, sizeof(bool));
     
-    if (!g_batcher->commands || !g_batcher->batches) {
+    if (!g_batcher->commands || !g_batcher->scratchOrder || !g_batcher->scratchFresh ||
+        !g_batcher->chunkChanged) {
         velocityLogError("Failed to allocate batcher buffers");
         velocityFree(g_batcher->commands);
-        velocityFree(g_batcher->batches);
+        velocityFree(g_batcher->scratchOrder);
+        velocityFree(g_batcher->scratchFresh);
+        velocityFree(g_batcher->chunkChanged);
         velocityFree(g_batcher);
         g_batcher = NULL;
         return false;
@@ -93,12 +111,21 @@ bool drawBatcherInit(int maxCommands) {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_batcher->indexBuffer);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, INDEX_BUFFER_SIZE, NULL, GL_STREAM_DRAW);
     
-    // Create indirect command buffer
+    // Create indirect command buffer: a range per retained layout, zeroed
+    // so it always matches the layouts' mirrors
     glGenBuffers(1, &g_batcher->indirectBuffer);
     glBindBuffer(GL_DRAW_INDIRECT_BUFFER, g_batcher->indirectBuffer);
-    glBufferData(GL_DRAW_INDIRECT_BUFFER, 
-                 maxCommands * sizeof(DrawElementsIndirectCommand), 
-                 NULL, GL_STREAM_DRAW);
+    size_t indirectSize = (size_t)BATCH_RETAINED_FLUSHES * maxCommands * sizeof(IndirectCommand);
+    void* zeros = velocityCalloc(1, indirectSize);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, indirectSize, zeros, GL_DYNAMIC_DRAW);
+    velocityFree(zeros);
+    
+    if (glExtensionSupported("GL_EXT_multi_draw_indirect")) {
+        g_batcher->multiDrawArraysIndirect =
+            (MultiDrawArraysIndirectProc)eglGetProcAddress("glMultiDrawArraysIndirectEXT");
+        g_batcher->multiDrawElementsIndirect =
+            (MultiDrawElementsIndirectProc)eglGetProcAddress("glMultiDrawElementsIndirectEXT");
+    }
     
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
@@ -123,13 +150,18 @@ void drawBatcherShutdown(void) {
     glDeleteBuffers(1, &g_batcher->indexBuffer);
     glDeleteBuffers(1, &g_batcher->indirectBuffer);
     
-    for (int i = 0; i < g_batcher->batchCount; i++) {
-        velocityFree(g_batcher->batches[i].arrayCommands);
-        velocityFree(g_batcher->batches[i].elementCommands);
+    for (int i = 0; i < BATCH_RETAINED_FLUSHES; i++) {
+        BatchLayout* layout = &g_batcher->layouts[i];
+        velocityFree(layout->chunkHashes);
+        velocityFree(layout->order);
+        velocityFree(layout->batches);
+        velocityFree(layout->indirect);
     }
     
     velocityFree(g_batcher->commands);
-    velocityFree(g_batcher->batches);
+    velocityFree(g_batcher->scratchOrder);
+    velocityFree(g_batcher->scratchFresh);
+    velocityFree(g_batcher->chunkChanged);
     velocityFree(g_batcher);
     g_batcher = NULL;
 }
@@ -142,7 +174,7 @@ void drawBatcherBeginFrame(void) {
     if (!g_batcher) return;
     
     g_batcher->commandCount = 0;
-    g_batcher->batchCount = 0;
+    g_batcher->flushIndex = 0;
     g_batcher->vertexOffset = 0;
     g_batcher->indexOffset = 0;
     g_batcher->indirectOffset = 0;
@@ -163,15 +195,26 @@ void drawBatcherSetKey(const BatchKey* key) {
     }
 }
 
+void drawBatcherSetVertexArray(GLuint vao) {
+    g_currentKey.vao = vao;
+}
+
 void drawBatcherSubmit(const DrawCommand* cmd) {
     if (!g_batcher || !cmd) return;
     
     if (g_batcher->commandCount >= g_batcher->maxCommands) {
         velocityLogWarn("Draw batcher command overflow, flushing");
+        FLIGHT_EVENT(FLIGHT_EVENT_BATCH_OVERFLOW, g_batcher->commandCount);
         drawBatcherFlush();
     }
     
-    memcpy(&g_batcher->commands[g_batcher->commandCount], cmd, sizeof(DrawCommand));
+    DrawCommand* queued = &g_batcher->commands[g_batcher->commandCount];
+    memcpy(queued, cmd, sizeof(DrawCommand));
+    
+    // Indices are read at flush, from whatever the VAO had bound here
+    queued->key.elementBuffer = isIndexed(cmd->type) && g_wrapperCtx
+                                    ? g_wrapperCtx->state.buffers.elementBuffer : 0;
+    queued->keyHash = hashBatchKey(&queued->key);
     g_batcher->commandCount++;
     g_batcher->drawCallsSubmitted++;
 }
@@ -243,55 +286,271 @@ void drawBatcherDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type,
 // Batch Building
 // ============================================================================
 
-static int compareBatchKeys(const void* a, const void* b) {
-    const DrawCommand* cmdA = (const DrawCommand*)a;
-    const DrawCommand* cmdB = (const DrawCommand*)b;
-    
-    uint64_t hashA = hashBatchKey(&cmdA->key);
-    uint64_t hashB = hashBatchKey(&cmdB->key);
+static int compareOrder(const void* a, const void* b) {
+    uint32_t indexA = *(const uint32_t*)a;
+    uint32_t indexB = *(const uint32_t*)b;
+    const DrawCommand* cmdA = &g_batcher->commands[indexA];
+    const DrawCommand* cmdB = &g_batcher->commands[indexB];
     
-    if (hashA < hashB) return -1;
-    if (hashA > hashB) return 1;
+    // Ties keep submission order, so equal keys sort the same every frame
+    if (cmdA->keyHash != cmdB->keyHash) return cmdA->keyHash < cmdB->keyHash ? -1 : 1;
+    if (cmdA->type != cmdB->type) return cmdA->type < cmdB->type ? -1 : 1;
+    if (indexA != indexB) return indexA < indexB ? -1 : 1;
     return 0;
 }
 
-static void buildBatches(void) {
-    if (!g_batcher || g_batcher->commandCount == 0) return;
+static uint64_t hashChunk(int chunk) {
+    int start = chunk * BATCH_CHUNK_SIZE;
+    int end = start + BATCH_CHUNK_SIZE;
+    if (end > g_batcher->commandCount) end = g_batcher->commandCount;
+    
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = start; i < end; i++) {
+        hash ^= g_batcher->commands[i].keyHash;
+        hash *= 1099511628211ULL;
+        hash ^= g_batcher->commands[i].type;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static BatchLayout* acquireLayout(void) {
+    int slot = g_batcher->flushIndex;
+    if (slot >= BATCH_RETAINED_FLUSHES) slot = BATCH_RETAINED_FLUSHES - 1;
+    g_batcher->flushIndex++;
+    
+    BatchLayout* layout = &g_batcher->layouts[slot];
+    if (layout->order) return layout;
+    
+    int maxCommands = g_batcher->maxCommands;
+    int maxChunks = (maxCommands + BATCH_CHUNK_SIZE - 1) / BATCH_CHUNK_SIZE;
+    layout->chunkHashes = (uint64_t*)velocityCalloc(maxChunks, sizeof(uint64_t));
+    layout->order = (uint32_t*)velocityCalloc(maxCommands, sizeof(uint32_t));
+    layout->batches = (BatchedDraw*)velocityCalloc(maxCommands, sizeof(BatchedDraw));
+    layout->indirect = (IndirectCommand*)velocityCalloc(maxCommands, sizeof(IndirectCommand));
+    layout->indirectBase = (size_t)slot * maxCommands * sizeof(IndirectCommand);
+    layout->commandCount = 0;
+    
+    if (!layout->chunkHashes || !layout->order || !layout->batches || !layout->indirect) {
+        velocityLogError("Failed to allocate batch layout");
+        velocityFree(layout->chunkHashes);
+        velocityFree(layout->order);
+        velocityFree(layout->batches);
+        velocityFree(layout->indirect);
+        memset(layout, 0, sizeof(BatchLayout));
+        return NULL;
+    }
+    return layout;
+}
+
+/**
+ * Sort the flush into the layout's order, reusing last frame's order for
+ * chunks whose keys didn't change. Returns true if the order changed.
+ */
+static bool sortLayout(BatchLayout* layout) {
+    int count = g_batcher->commandCount;
+    uint32_t* order = layout->order;
+    
+    if (!g_batcher->enableBatching) {
+        for (int i = 0; i < count; i++) order[i] = (uint32_t)i;
+        layout->commandCount = 0;   // Nothing to compare against next frame
+        return true;
+    }
+    
+    int chunkCount = (count + BATCH_CHUNK_SIZE - 1) / BATCH_CHUNK_SIZE;
+    bool comparable = layout->commandCount == count;
+    int changed = 0;
+    
+    for (int c = 0; c < chunkCount; c++) {
+        uint64_t hash = hashChunk(c);
+        bool chunkChanged = !comparable || layout->chunkHashes[c] != hash;
+        g_batcher->chunkChanged[c] = chunkChanged;
+        layout->chunkHashes[c] = hash;
+        if (chunkChanged) changed++;
+    }
+    layout->commandCount = count;
     
-    // Sort commands by batch key
-    if (g_batcher->enableBatching) {
-        qsort(g_batcher->commands, g_batcher->commandCount, 
-              sizeof(DrawCommand), compareBatchKeys);
+    if (changed == 0) return false;
+    
+    if (!comparable || changed * 2 > chunkCount) {
+        for (int i = 0; i < count; i++) order[i] = (uint32_t)i;
+        qsort(order, count, sizeof(uint32_t), compareOrder);
+        return true;
     }
     
-    g_batcher->batchCount = 0;
+    // Sort only the changed chunks' commands, then merge them into the
+    // retained order with the changed chunks' old entries dropped
+    uint32_t* fresh = g_batcher->scratchFresh;
+    int freshCount = 0;
+    for (int c = 0; c < chunkCount; c++) {
+        if (!g_batcher->chunkChanged[c]) continue;
+        int end = (c + 1) * BATCH_CHUNK_SIZE;
+        if (end > count) end = count;
+        for (int i = c * BATCH_CHUNK_SIZE; i < end; i++) fresh[freshCount++] = (uint32_t)i;
+    }
+    qsort(fresh, freshCount, sizeof(uint32_t), compareOrder);
+    
+    uint32_t* merged = g_batcher->scratchOrder;
+    int m = 0, f = 0;
+    for (int i = 0; i < count; i++) {
+        uint32_t index = order[i];
+        if (g_batcher->chunkChanged[index / BATCH_CHUNK_SIZE]) continue;
+        while (f < freshCount && compareOrder(&fresh[f], &index) < 0) {
+            merged[m++] = fresh[f++];
+        }
+        merged[m++] = index;
+    }
+    while (f < freshCount) merged[m++] = fresh[f++];
+    
+    g_batcher->scratchOrder = order;
+    layout->order = merged;
+    return true;
+}
+
+static void buildSegments(BatchLayout* layout) {
+    const uint32_t* order = layout->order;
+    int count = g_batcher->commandCount;
+    
+    layout->batchCount = 0;
     
     int i = 0;
-    while (i < g_batcher->commandCount) {
-        DrawCommand* cmd = &g_batcher->commands[i];
+    while (i < count) {
+        DrawCommand* cmd = &g_batcher->commands[order[i]];
         
         // Count consecutive commands with same key
         int batchSize = 1;
-        while (i + batchSize < g_batcher->commandCount &&
-               batchKeysEqual(&cmd->key, &g_batcher->commands[i + batchSize].key) &&
-               cmd->type == g_batcher->commands[i + batchSize].type) {
+        while (i + batchSize < count) {
+            const DrawCommand* next = &g_batcher->commands[order[i + batchSize]];
+            if (!batchKeysEqual(&cmd->key, &next->key) || cmd->type != next->type) break;
             batchSize++;
         }
         
-        // Create batch if worthwhile
-        if (g_batcher->batchCount < g_batcher->maxBatches) {
-            BatchedDraw* batch = &g_batcher->batches[g_batcher->batchCount];
-            batch->key = cmd->key;
-            batch->commandCount = batchSize;
-            batch->isElements = (cmd->type == DRAW_CMD_ELEMENTS || 
-                                 cmd->type == DRAW_CMD_ELEMENTS_INSTANCED);
+        BatchedDraw* batch = &layout->batches[layout->batchCount++];
+        batch->key = cmd->key;
+        batch->arrayCommands = NULL;
+        batch->elementCommands = NULL;
+        batch->firstCommand = i;
+        batch->commandCount = batchSize;
+        batch->isElements = (cmd->type == DRAW_CMD_ELEMENTS || 
+                             cmd->type == DRAW_CMD_ELEMENTS_INSTANCED);
+        
+        i += batchSize;
+    }
+}
+
+static void buildBatches(BatchLayout* layout) {
+    TRACE_SCOPE("batch_build");
+    
+    if (sortLayout(layout)) {
+        buildSegments(layout);
+    }
+    g_batcher->batchesCreated += layout->batchCount;
+}
+
+// ============================================================================
+// Indirect Commands
+// ============================================================================
+
+static GLsizei indexTypeSize(GLenum type) {
+    switch (type) {
+        case GL_UNSIGNED_BYTE:  return 1;
+        case GL_UNSIGNED_SHORT: return 2;
+        case GL_UNSIGNED_INT:   return 4;
+        default:                return 0;
+    }
+}
+
+static bool canDrawIndirect(const BatchLayout* layout, const BatchedDraw* batch) {
+    if (!g_batcher->enableBatching || batch->commandCount < g_batcher->minBatchSize) return false;
+    
+    // Indirect draws read attributes and indices from buffers of a bound VAO,
+    // the one the batch was recorded with; state at flush may be later
+    GLuint vao = batch->key.vao;
+    if (vao == 0 || vao == 0xFFFFFFFF) return false;
+    
+    const DrawCommand* first = &g_batcher->commands[layout->order[batch->firstCommand]];
+    if (first->type == DRAW_CMD_ARRAYS) {
+        if (!g_batcher->multiDrawArraysIndirect) return false;
+    } else if (first->type == DRAW_CMD_ELEMENTS) {
+        GLuint elements = batch->key.elementBuffer;
+        if (!g_batcher->multiDrawElementsIndirect || elements == 0 || elements == 0xFFFFFFFF) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+    
+    for (int i = 0; i < batch->commandCount; i++) {
+        const DrawCommand* cmd = &g_batcher->commands[layout->order[batch->firstCommand + i]];
+        if (!cmd->canBatch) return false;
+        if (first->type == DRAW_CMD_ELEMENTS) {
+            GLsizei typeSize = indexTypeSize(cmd->indexType);
+            if (cmd->indexType != first->indexType || typeSize == 0 ||
+                (uintptr_t)cmd->indices % typeSize != 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void fillIndirect(IndirectCommand* record, const DrawCommand* cmd) {
+    memset(record, 0, sizeof(IndirectCommand));
+    if (cmd->type == DRAW_CMD_ELEMENTS) {
+        record->elements.count = cmd->count;
+        record->elements.instanceCount = cmd->instanceCount;
+        record->elements.firstIndex = (GLuint)((uintptr_t)cmd->indices / indexTypeSize(cmd->indexType));
+    } else {
+        record->arrays.count = cmd->count;
+        record->arrays.instanceCount = cmd->instanceCount;
+        record->arrays.first = cmd->first;
+    }
+}
+
+/**
+ * Write this flush's indirect records into the layout's mirror and upload
+ * only the range that differs from what the buffer already holds
+ */
+static bool patchIndirect(BatchLayout* layout) {
+    int dirtyFirst = -1;
+    int dirtyLast = -1;
+    bool any = false;
+    
+    for (int b = 0; b < layout->batchCount; b++) {
+        BatchedDraw* batch = &layout->batches[b];
+        batch->arrayCommands = NULL;
+        batch->elementCommands = NULL;
+        
+        if (!canDrawIndirect(layout, batch)) continue;
+        any = true;
+        
+        for (int i = 0; i < batch->commandCount; i++) {
+            int position = batch->firstCommand + i;
+            IndirectCommand record;
+            fillIndirect(&record, &g_batcher->commands[layout->order[position]]);
             
-            g_batcher->batchCount++;
-            g_batcher->batchesCreated++;
+            if (memcmp(&record, &layout->indirect[position], sizeof(IndirectCommand)) != 0) {
+                layout->indirect[position] = record;
+                if (dirtyFirst < 0) dirtyFirst = position;
+                dirtyLast = position;
+            }
         }
         
-        i += batchSize;
+        if (batch->isElements) {
+            batch->elementCommands = &layout->indirect[batch->firstCommand].elements;
+        } else {
+            batch->arrayCommands = &layout->indirect[batch->firstCommand].arrays;
+        }
+    }
+    
+    if (dirtyFirst >= 0) {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, g_batcher->indirectBuffer);
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER,
+                        layout->indirectBase + (size_t)dirtyFirst * sizeof(IndirectCommand),
+                        (size_t)(dirtyLast - dirtyFirst + 1) * sizeof(IndirectCommand),
+                        &layout->indirect[dirtyFirst]);
     }
+    return any;
 }
 
 // ============================================================================
@@ -324,12 +583,28 @@ static void executeDirect(DrawCommand* cmd) {
     g_batcher->drawCallsExecuted++;
 }
 
-static void executeMultiDraw(int startIndex, int count, bool isElements) {
-    // For simplicity, execute as individual calls
-    // A full implementation would use glMultiDrawArrays/Elements
+static void executeIndirect(const BatchLayout* layout, const BatchedDraw* batch) {
+    const void* offset = (const void*)(layout->indirectBase +
+                                       (size_t)batch->firstCommand * sizeof(IndirectCommand));
+    
+    if (batch->isElements) {
+        const DrawCommand* first = &g_batcher->commands[layout->order[batch->firstCommand]];
+        g_batcher->multiDrawElementsIndirect(batch->key.mode, first->indexType, offset,
+                                             batch->commandCount, sizeof(IndirectCommand));
+    } else {
+        g_batcher->multiDrawArraysIndirect(batch->key.mode, offset,
+                                           batch->commandCount, sizeof(IndirectCommand));
+    }
+    
+    g_batcher->drawCallsExecuted++;
+    g_batcher->drawCallsSaved += batch->commandCount - 1;
+}
+
+static void executeMultiDraw(const uint32_t* order, int count, bool isElements) {
+    // Segments that can't be drawn indirectly go out as individual calls
     
     for (int i = 0; i < count; i++) {
-        executeDirect(&g_batcher->commands[startIndex + i]);
+        executeDirect(&g_batcher->commands[order[i]]);
     }
     
     // Record savings (we'd save more with actual multi-draw)
@@ -338,42 +613,114 @@ static void executeMultiDraw(int startIndex, int count, bool isElements) {
     }
 }
 
+// Driver bindings during a flush, 0xFFFFFFFF while unknown
+typedef struct ReplayBindings {
+    GLuint vao;
+    GLuint element;             // Index buffer of that VAO
+    bool elementsChanged;       // Some VAO's index buffer was rebound
+} ReplayBindings;
+
+/**
+ * Bind the vertex array and index buffer a draw was recorded with. A VAO
+ * can be pointed at another index buffer before the flush (the VAO cache
+ * shares them between app arrays), so indexed draws rebind theirs.
+ */
+static void bindRecorded(const BatchKey* key, bool indexed, ReplayBindings* bound) {
+    if (key->vao != bound->vao && (key->vao != 0 || bound->vao != 0xFFFFFFFF)) {
+        glBindVertexArray(key->vao);
+        bound->vao = key->vao;
+        bound->element = 0xFFFFFFFF;
+    }
+    if (!indexed || key->elementBuffer == 0xFFFFFFFF || key->elementBuffer == bound->element) {
+        return;
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, key->elementBuffer);
+    bound->element = key->elementBuffer;
+    bound->elementsChanged = true;
+}
+
+/**
+ * Give later draws the bindings of the last submitted one
+ */
+static void restoreBindings(const ReplayBindings* bound) {
+    if (bound->vao != 0xFFFFFFFF && bound->vao != g_currentKey.vao) {
+        glBindVertexArray(g_currentKey.vao);
+    }
+    if (!bound->elementsChanged) return;
+    
+    GLuint element = g_wrapperCtx ? g_wrapperCtx->state.buffers.elementBuffer : 0xFFFFFFFF;
+    if (element != 0xFFFFFFFF) glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, element);
+    vaoCacheElementBuffersChanged();
+}
+
 void drawBatcherFlush(void) {
     if (!g_batcher || g_batcher->commandCount == 0) return;
     
-    buildBatches();
+    TRACE_SCOPE("batch_flush");
+    TRACE_GPU_BEGIN("batch_flush");
+    
+    ReplayBindings bound = { 0xFFFFFFFF, 0xFFFFFFFF, false };
+    BatchLayout* layout = acquireLayout();
+    if (!layout) {
+        for (int i = 0; i < g_batcher->commandCount; i++) {
+            DrawCommand* cmd = &g_batcher->commands[i];
+            bindRecorded(&cmd->key, isIndexed(cmd->type), &bound);
+            executeDirect(cmd);
+        }
+        restoreBindings(&bound);
+        g_batcher->commandCount = 0;
+        TRACE_GPU_END();
+        return;
+    }
+    
+    buildBatches(layout);
+    
+    GLint previousIndirect = 0;
+    bool indirect = g_batcher->multiDrawArraysIndirect || g_batcher->multiDrawElementsIndirect;
+    if (indirect) {
+        glGetIntegerv(GL_DRAW_INDIRECT_BUFFER_BINDING, &previousIndirect);
+        indirect = patchIndirect(layout);
+        if (indirect) {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, g_batcher->indirectBuffer);
+        }
+    }
     
-    int cmdIndex = 0;
-    for (int b = 0; b < g_batcher->batchCount; b++) {
-        BatchedDraw* batch = &g_batcher->batches[b];
+    for (int b = 0; b < layout->batchCount; b++) {
+        BatchedDraw* batch = &layout->batches[b];
+        const uint32_t* order = &layout->order[batch->firstCommand];
         
         // Bind state for batch
         if (batch->key.program) {
             glUseProgram(batch->key.program);
         }
-        if (batch->key.vao) {
-            glBindVertexArray(batch->key.vao);
-        }
+        bindRecorded(&batch->key, batch->isElements, &bound);
         if (batch->key.texture0) {
             glActiveTexture(GL_TEXTURE0);
             glBindTexture(GL_TEXTURE_2D, batch->key.texture0);
         }
         
         // Execute batch
-        if (batch->commandCount >= g_batcher->minBatchSize && g_batcher->enableBatching) {
-            executeMultiDraw(cmdIndex, batch->commandCount, batch->isElements);
+        if (batch->arrayCommands || batch->elementCommands) {
+            executeIndirect(layout, batch);
+        } else if (batch->commandCount >= g_batcher->minBatchSize && g_batcher->enableBatching) {
+            executeMultiDraw(order, batch->commandCount, batch->isElements);
         } else {
             for (int i = 0; i < batch->commandCount; i++) {
-                executeDirect(&g_batcher->commands[cmdIndex + i]);
+                executeDirect(&g_batcher->commands[order[i]]);
             }
         }
-        
-        cmdIndex += batch->commandCount;
     }
     
+    if (indirect) {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, (GLuint)previousIndirect);
+    }
+    
+    restoreBindings(&bound);
+    
     // Reset for next flush
     g_batcher->commandCount = 0;
-    g_batcher->batchCount = 0;
+    
+    TRACE_GPU_END();
 }
 
 void drawBatcherEndFrame(void) {
@@ -427,52 +774,107 @@ void vertexFormatAddElement(VertexFormat* format, GLuint index, GLint size,
     format->elementCount++;
 }
 
+size_t vertexElementBytes(const VertexElement* elem) {
+    switch (elem->type) {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE:
+            return (size_t)elem->size;
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+        case GL_HALF_FLOAT:
+            return (size_t)elem->size * 2;
+        case GL_INT_2_10_10_10_REV:
+        case GL_UNSIGNED_INT_2_10_10_10_REV:
+            return 4;   // All components packed in one word
+        default:
+            return (size_t)elem->size * 4;
+    }
+}
+
+static inline uint64_t hashFold(uint64_t hash, uint64_t value) {
+    hash ^= value;
+    return hash * 1099511628211ULL;
+}
+
 void vertexFormatFinalize(VertexFormat* format) {
     if (!format) return;
     
-    // Calculate stride
-    size_t maxOffset = 0;
-    size_t lastSize = 0;
-    
+    // Interleaved stride reaches the end of the furthest element
+    size_t end = 0;
     for (int i = 0; i < format->elementCount; i++) {
-        if (format->elements[i].offset >= maxOffset) {
-            maxOffset = format->elements[i].offset;
-            lastSize = format->elements[i].size * 4;  // Assume 4 bytes per component
-        }
+        const VertexElement* elem = &format->elements[i];
+        size_t elemEnd = elem->offset + vertexElementBytes(elem);
+        if (elemEnd > end) end = elemEnd;
     }
+    format->stride = (GLsizei)end;
     
-    format->stride = maxOffset + lastSize;
-    
-    // Calculate hash
-    format->hash = 14695981039346656037ULL;
+    // Everything that changes how attributes are fetched goes into the hash
+    uint64_t hash = 14695981039346656037ULL;
+    hash = hashFold(hash, (uint64_t)format->stride);
     for (int i = 0; i < format->elementCount; i++) {
-        format->hash ^= format->elements[i].index;
-        format->hash *= 1099511628211ULL;
-        format->hash ^= format->elements[i].size;
-        format->hash *= 1099511628211ULL;
+        const VertexElement* elem = &format->elements[i];
+        hash = hashFold(hash, elem->index);
+        hash = hashFold(hash, (uint64_t)elem->size);
+        hash = hashFold(hash, elem->type);
+        hash = hashFold(hash, (uint64_t)elem->normalized | (uint64_t)elem->integer << 1);
+        hash = hashFold(hash, (uint64_t)elem->stride);
+        hash = hashFold(hash, elem->divisor);
+        hash = hashFold(hash, (uint64_t)elem->offset);
     }
+    format->hash = hash;
 }
 
 bool vertexFormatEquals(const VertexFormat* a, const VertexFormat* b) {
     if (!a || !b) return false;
-    return a->hash == b->hash && a->elementCount == b->elementCount;
+    if (a->hash != b->hash || a->elementCount != b->elementCount || a->stride != b->stride) {
+        return false;
+    }
+    
+    for (int i = 0; i < a->elementCount; i++) {
+        const VertexElement* x = &a->elements[i];
+        const VertexElement* y = &b->elements[i];
+        if (x->index != y->index || x->size != y->size || x->type != y->type ||
+            x->normalized != y->normalized || x->integer != y->integer ||
+            x->stride != y->stride || x->divisor != y->divisor || x->offset != y->offset) {
+            return false;
+        }
+    }
+    return true;
 }
 
-void vertexFormatApply(const VertexFormat* format, GLuint vao, GLuint vbo) {
+void vertexFormatApplyBindings(const VertexFormat* format, const GLuint* buffers) {
     if (!format) return;
     
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    
+    GLuint bound = 0xFFFFFFFF;
     for (int i = 0; i < format->elementCount; i++) {
         const VertexElement* elem = &format->elements[i];
+        GLsizei stride = elem->stride ? elem->stride : format->stride;
+        
+        if (buffers && buffers[i] != bound) {
+            glBindBuffer(GL_ARRAY_BUFFER, buffers[i]);
+            bound = buffers[i];
+        }
         
         glEnableVertexAttribArray(elem->index);
-        glVertexAttribPointer(elem->index, elem->size, elem->type,
-                              elem->normalized, format->stride, 
-                              (const void*)elem->offset);
+        if (elem->integer) {
+            glVertexAttribIPointer(elem->index, elem->size, elem->type, stride,
+                                   (const void*)elem->offset);
+        } else {
+            glVertexAttribPointer(elem->index, elem->size, elem->type,
+                                  elem->normalized, stride, (const void*)elem->offset);
+        }
+        if (elem->divisor) {
+            glVertexAttribDivisor(elem->index, elem->divisor);
+        }
     }
+}
+
+void vertexFormatApply(const VertexFormat* format, GLuint vao, GLuint vbo) {
+    if (!format) return;
     
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    vertexFormatApplyBindings(format, NULL);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 }
@@ -25,6 +25,8 @@ extern "C" {
 #define MAX_BATCH_INSTANCES     4096
 #define VERTEX_BUFFER_SIZE      (16 * 1024 * 1024)  // 16 MB
 #define INDEX_BUFFER_SIZE       (4 * 1024 * 1024)   // 4 MB
+#define BATCH_CHUNK_SIZE        64      // Submitted commands per change-detection chunk
+#define BATCH_RETAINED_FLUSHES  8       // Flushes per frame that keep their layout
 
 // ============================================================================
 // Types
@@ -63,7 +65,9 @@ typedef struct VertexElement {
     GLint size;             // Component count (1-4)
     GLenum type;            // GL_FLOAT, etc
     GLboolean normalized;
-    GLsizei stride;
+    GLboolean integer;      // Specified with glVertexAttribIPointer
+    GLsizei stride;         // 0: the format's stride
+    GLuint divisor;
     size_t offset;
 } VertexElement;
 
@@ -83,6 +87,7 @@ typedef struct VertexFormat {
 typedef struct BatchKey {
     GLuint program;
     GLuint vao;
+    GLuint elementBuffer;   // Index buffer bound when an indexed draw was submitted
     GLuint texture0;        // Main texture
     GLuint texture1;        // Additional textures
     PrimitiveMode mode;
@@ -107,6 +112,14 @@ typedef struct DrawElementsIndirectCommand {
     GLuint baseInstance;
 } DrawElementsIndirectCommand;
 
+/**
+ * Indirect buffer record (one stride for both command kinds)
+ */
+typedef union IndirectCommand {
+    DrawArraysIndirectCommand arrays;
+    DrawElementsIndirectCommand elements;
+} IndirectCommand;
+
 /**
  * Single draw command in batch
  */
@@ -128,6 +141,7 @@ typedef struct DrawCommand {
     
     // For batching
     BatchKey key;
+    uint64_t keyHash;       // Hash of key, taken at submit
     bool canBatch;
     
     // Vertex data (for dynamic batching)
@@ -142,12 +156,33 @@ typedef struct DrawCommand {
  */
 typedef struct BatchedDraw {
     BatchKey key;
-    DrawArraysIndirectCommand* arrayCommands;
-    DrawElementsIndirectCommand* elementCommands;
+    DrawArraysIndirectCommand* arrayCommands;       // Into the layout's indirect mirror,
+    DrawElementsIndirectCommand* elementCommands;   // NULL when drawn directly
+    int firstCommand;       // Position in the sorted order
     int commandCount;
     bool isElements;
 } BatchedDraw;
 
+typedef void (GL_APIENTRYP MultiDrawArraysIndirectProc)(GLenum mode, const void* indirect,
+                                                     GLsizei drawcount, GLsizei stride);
+typedef void (GL_APIENTRYP MultiDrawElementsIndirectProc)(GLenum mode, GLenum type, const void* indirect,
+                                                       GLsizei drawcount, GLsizei stride);
+
+/**
+ * Sorted layout of one flush, compared with the same flush next frame
+ */
+typedef struct BatchLayout {
+    int commandCount;
+    uint64_t* chunkHashes;          // Keys and types per BATCH_CHUNK_SIZE submitted commands
+    uint32_t* order;                // Submitted command indices sorted by key
+    
+    BatchedDraw* batches;
+    int batchCount;
+    
+    IndirectCommand* indirect;      // Mirror of the layout's indirect buffer range
+    size_t indirectBase;            // Byte offset of that range
+} BatchLayout;
+
 /**
  * Draw batcher context
  */
@@ -157,10 +192,14 @@ typedef struct DrawBatcherContext {
     int commandCount;
     int maxCommands;
     
-    // Batched results
-    BatchedDraw* batches;
-    int batchCount;
-    int maxBatches;
+    // Layouts retained across frames, one per flush
+    BatchLayout layouts[BATCH_RETAINED_FLUSHES];
+    int flushIndex;
+    
+    // Merge scratch
+    uint32_t* scratchOrder;
+    uint32_t* scratchFresh;
+    bool* chunkChanged;
     
     // Vertex/index buffers for dynamic batching
     GLuint vertexBuffer;
@@ -170,9 +209,11 @@ typedef struct DrawBatcherContext {
     void* vertexMapped;
     void* indexMapped;
     
-    // Indirect command buffer
+    // Indirect command buffer (GL_EXT_multi_draw_indirect)
     GLuint indirectBuffer;
     size_t indirectOffset;
+    MultiDrawArraysIndirectProc multiDrawArraysIndirect;
+    MultiDrawElementsIndirectProc multiDrawElementsIndirect;
     
     // Statistics
     uint32_t drawCallsSubmitted;
@@ -248,6 +289,11 @@ void drawBatcherFlush(void);
  */
 void drawBatcherSetKey(const BatchKey* key);
 
+/**
+ * Set the vertex array later draws are batched and replayed with
+ */
+void drawBatcherSetVertexArray(GLuint vao);
+
 /**
  * Enable/disable batching
  */
@@ -273,6 +319,11 @@ VertexFormat* vertexFormatCreate(void);
 void vertexFormatAddElement(VertexFormat* format, GLuint index, GLint size, 
                             GLenum type, GLboolean normalized, size_t offset);
 
+/**
+ * Bytes one element occupies in a vertex
+ */
+size_t vertexElementBytes(const VertexElement* elem);
+
 /**
  * Finalize vertex format
  */
@@ -288,6 +339,12 @@ bool vertexFormatEquals(const VertexFormat* a, const VertexFormat* b);
  */
 void vertexFormatApply(const VertexFormat* format, GLuint vao, GLuint vbo);
 
+/**
+ * Specify a format's attributes on the bound VAO, each element sourced from
+ * its own buffer (NULL: the bound array buffer); leaves the last buffer bound
+ */
+void vertexFormatApplyBindings(const VertexFormat* format, const GLuint* buffers);
+
 // ============================================================================
 // Statistics
 // ============================================================================
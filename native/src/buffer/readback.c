@@ -0,0 +1,583 @@
+/**
+ * Readback - Implementation
+ * Every read is taken as tightly packed RGBA8, which ES guarantees for
+ * normalized color buffers, so desktop formats like GL_BGRA come out of
+ * the conversion rather than the driver. Mapping and unmapping stay on
+ * the render thread; the worker only touches the mapped pointer between
+ * the two.
+ */
+
+#include "readback.h"
+#include "../core/gl_wrapper.h"
+#include "../optimize/fence_timeline.h"
+#include "../optimize/resolution_scaler.h"
+#include "../profile/trace.h"
+#include "../utils/log.h"
+#include "../utils/memory.h"
+#include "../utils/thread_pool.h"
+
+#include <string.h>
+
+#ifndef GL_BGRA_EXT
+#define GL_BGRA_EXT 0x80E1
+#endif
+#define GL_BGR_DESKTOP                  0x80E0
+#define GL_UNSIGNED_INT_8_8_8_8_REV     0x8367
+
+// ============================================================================
+// Types
+// ============================================================================
+
+typedef enum SlotState {
+    SLOT_FREE = 0,
+    SLOT_IN_FLIGHT,              // Waiting on the fence
+    SLOT_CONVERTING,             // Mapped, worker converting
+    SLOT_READY                   // Converted, awaiting delivery or poll
+} SlotState;
+
+typedef struct ReadbackSlot {
+    SlotState state;
+    uint32_t handle;
+    uint32_t frame;
+
+    GLuint pbo;
+    size_t pboSize;
+    FencePoint point;
+    const uint8_t* mapped;
+
+    // Request
+    GLsizei width;
+    GLsizei height;
+    GLenum format;
+    GLint alignment;
+    VelocityReadbackCallback callback;
+    void* userData;
+    int stream;                  // Async glReadPixels region, -1 for none
+
+    // Converted pixels
+    uint8_t* data;
+    size_t capacity;
+    size_t size;
+    volatile bool converted;
+    bool failed;                 // Reported as -1 to a poll, NULL to a callback
+} ReadbackSlot;
+
+typedef struct ReadbackStream {
+    bool active;
+    GLint x, y;
+    GLsizei width, height;
+    GLenum format, type;
+    GLint alignment;
+    uint32_t lastUsed;
+    int inFlight;
+
+    // Latest completed read
+    uint8_t* data;
+    size_t capacity;
+    size_t size;
+    bool valid;
+} ReadbackStream;
+
+typedef struct ReadbackContext {
+    bool initialized;
+    bool asyncMode;
+    ThreadPool* worker;
+
+    ReadbackSlot slots[READBACK_SLOTS];
+    ReadbackStream streams[READBACK_STREAMS];
+    uint32_t nextHandle;
+    uint32_t frame;
+
+    // Stats
+    uint32_t completed;
+    uint32_t dropped;
+    uint32_t streamHits;
+    uint32_t syncReads;
+    uint64_t frameSyncNs;
+    uint64_t lastSyncNs;
+    uint64_t totalSyncNs;
+} ReadbackContext;
+
+static ReadbackContext g_readback = {0};
+
+// ============================================================================
+// Conversion
+// ============================================================================
+
+/**
+ * Source channels of each output component, 0 if the format isn't handled
+ */
+static int channelMap(GLenum format, GLenum type, uint8_t channels[4]) {
+    static const uint8_t RGBA[4] = { 0, 1, 2, 3 };
+    static const uint8_t BGRA[4] = { 2, 1, 0, 3 };
+    static const uint8_t ALPHA[1] = { 3 };
+
+    int count = 0;
+    const uint8_t* map = RGBA;
+    switch (format) {
+        case GL_RGBA:           count = 4; break;
+        case GL_BGRA_EXT:       count = 4; map = BGRA; break;
+        case GL_RGB:            count = 3; break;
+        case GL_BGR_DESKTOP:    count = 3; map = BGRA; break;
+        case GL_RG:             count = 2; break;
+        case GL_RED:            count = 1; break;
+        case GL_ALPHA:          count = 1; map = ALPHA; break;
+        default:                return 0;
+    }
+
+    // 8_8_8_8_REV is the byte order of UNSIGNED_BYTE on little-endian
+    if (type == GL_UNSIGNED_INT_8_8_8_8_REV && count != 4) return 0;
+    if (type != GL_UNSIGNED_BYTE && type != GL_UNSIGNED_INT_8_8_8_8_REV) return 0;
+
+    memcpy(channels, map, count);
+    return count;
+}
+
+static size_t rowStride(GLsizei width, int components, GLint alignment) {
+    size_t row = (size_t)width * components;
+    if (alignment > 1) row = (row + alignment - 1) / alignment * alignment;
+    return row;
+}
+
+static void convertTask(void* arg) {
+    ReadbackSlot* slot = (ReadbackSlot*)arg;
+
+    uint8_t channels[4];
+    int components = channelMap(slot->format, GL_UNSIGNED_BYTE, channels);
+    size_t srcRow = (size_t)slot->width * 4;
+    size_t dstRow = rowStride(slot->width, components, slot->alignment);
+
+    if (slot->format == GL_RGBA && srcRow == dstRow) {
+        memcpy(slot->data, slot->mapped, srcRow * slot->height);
+    } else {
+        for (GLsizei y = 0; y < slot->height; y++) {
+            const uint8_t* src = slot->mapped + y * srcRow;
+            uint8_t* dst = slot->data + y * dstRow;
+            for (GLsizei x = 0; x < slot->width; x++, src += 4, dst += components) {
+                for (int c = 0; c < components; c++) dst[c] = src[channels[c]];
+            }
+        }
+    }
+
+    __atomic_store_n(&slot->converted, true, __ATOMIC_RELEASE);
+}
+
+// ============================================================================
+// Slots
+// ============================================================================
+
+static ReadbackSlot* freeSlot(void) {
+    for (int i = 0; i < READBACK_SLOTS; i++) {
+        if (g_readback.slots[i].state == SLOT_FREE) return &g_readback.slots[i];
+    }
+    return NULL;
+}
+
+static ReadbackSlot* findSlot(uint32_t handle) {
+    if (handle == 0) return NULL;
+    for (int i = 0; i < READBACK_SLOTS; i++) {
+        ReadbackSlot* slot = &g_readback.slots[i];
+        if (slot->state != SLOT_FREE && slot->handle == handle) return slot;
+    }
+    return NULL;
+}
+
+static void releaseSlot(ReadbackSlot* slot) {
+    if (slot->stream >= 0) g_readback.streams[slot->stream].inFlight--;
+    slot->state = SLOT_FREE;
+    slot->handle = 0;
+    slot->callback = NULL;
+    slot->userData = NULL;
+    slot->stream = -1;
+    slot->failed = false;
+}
+
+static bool reserve(uint8_t** data, size_t* capacity, size_t size) {
+    if (*capacity >= size) return true;
+
+    uint8_t* grown = (uint8_t*)velocityRealloc(*data, size);
+    if (!grown) return false;
+    *data = grown;
+    *capacity = size;
+    return true;
+}
+
+/**
+ * Read the bound read framebuffer into a slot's pack buffer behind a fence
+ */
+static bool issue(ReadbackSlot* slot, GLint x, GLint y, GLsizei width, GLsizei height) {
+    size_t bytes = (size_t)width * height * 4;
+
+    if (!slot->pbo) glGenBuffers(1, &slot->pbo);
+    if (!slot->pbo) return false;
+
+    GLint previous = 0, rowLength = 0, skipPixels = 0, skipRows = 0;
+    glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &previous);
+    glGetIntegerv(GL_PACK_ROW_LENGTH, &rowLength);
+    glGetIntegerv(GL_PACK_SKIP_PIXELS, &skipPixels);
+    glGetIntegerv(GL_PACK_SKIP_ROWS, &skipRows);
+    if (rowLength) glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    if (skipPixels) glPixelStorei(GL_PACK_SKIP_PIXELS, 0);
+    if (skipRows) glPixelStorei(GL_PACK_SKIP_ROWS, 0);
+
+    // Scaled framebuffers hold the window in a subrect
+    GLint rect[4] = { x, y, width, height };
+    GLuint framebuffer = g_wrapperCtx ? g_wrapperCtx->state.framebuffer.readFramebuffer : 0;
+    bool staged = resolutionScalerBeginRead(framebuffer, rect);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+    if (slot->pboSize < bytes) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)bytes, NULL, GL_STREAM_READ);
+        slot->pboSize = bytes;
+    }
+    glReadPixels(rect[0], rect[1], width, height, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    slot->point = fenceTimelineSubmit();
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, (GLuint)previous);
+    if (staged) resolutionScalerEndRead();
+
+    if (rowLength) glPixelStorei(GL_PACK_ROW_LENGTH, rowLength);
+    if (skipPixels) glPixelStorei(GL_PACK_SKIP_PIXELS, skipPixels);
+    if (skipRows) glPixelStorei(GL_PACK_SKIP_ROWS, skipRows);
+
+    slot->state = SLOT_IN_FLIGHT;
+    slot->frame = g_readback.frame;
+    slot->width = width;
+    slot->height = height;
+    if (++g_readback.nextHandle == 0) g_readback.nextHandle = 1;
+    slot->handle = g_readback.nextHandle;
+    return true;
+}
+
+/**
+ * Map a signaled read and hand it to the worker
+ */
+static bool startConversion(ReadbackSlot* slot) {
+    uint8_t channels[4];
+    int components = channelMap(slot->format, GL_UNSIGNED_BYTE, channels);
+    size_t size = rowStride(slot->width, components, slot->alignment) * slot->height;
+    if (!reserve(&slot->data, &slot->capacity, size)) return false;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+    slot->mapped = (const uint8_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+                                                    (GLsizeiptr)slot->width * slot->height * 4,
+                                                    GL_MAP_READ_BIT);
+    if (!slot->mapped) return false;
+
+    slot->size = size;
+    slot->converted = false;
+    slot->state = SLOT_CONVERTING;
+    threadPoolSubmit(g_readback.worker, convertTask, slot);
+    return true;
+}
+
+/**
+ * Hand a converted read to its stream; false if it waits for a callback or poll
+ */
+static bool finishStream(ReadbackSlot* slot) {
+    if (slot->stream < 0) return false;
+
+    // Swap buffers rather than copy; reads complete in order
+    ReadbackStream* stream = &g_readback.streams[slot->stream];
+    uint8_t* data = stream->data;
+    size_t capacity = stream->capacity;
+    stream->data = slot->data;
+    stream->capacity = slot->capacity;
+    stream->size = slot->size;
+    stream->valid = true;
+    slot->data = data;
+    slot->capacity = capacity;
+
+    g_readback.completed++;
+    releaseSlot(slot);
+    return true;
+}
+
+/**
+ * A read that can't be mapped; its owner still hears about it
+ */
+static void fail(ReadbackSlot* slot) {
+    g_readback.dropped++;
+    if (slot->stream >= 0) {
+        releaseSlot(slot);
+        return;
+    }
+    slot->failed = true;
+    slot->size = 0;
+    slot->state = SLOT_READY;
+    slot->frame = g_readback.frame;
+}
+
+// ============================================================================
+// Streams
+// ============================================================================
+
+static ReadbackStream* findStream(GLint x, GLint y, GLsizei width, GLsizei height,
+                                  GLenum format, GLenum type, GLint alignment) {
+    ReadbackStream* victim = NULL;
+    for (int i = 0; i < READBACK_STREAMS; i++) {
+        ReadbackStream* stream = &g_readback.streams[i];
+        if (stream->active && stream->x == x && stream->y == y &&
+            stream->width == width && stream->height == height &&
+            stream->format == format && stream->type == type && stream->alignment == alignment) {
+            return stream;
+        }
+
+        if (!stream->active) {
+            if (!victim || victim->active) victim = stream;
+            continue;
+        }
+
+        // Reads still in flight would land in the wrong region
+        if (stream->inFlight > 0) continue;
+        if (!victim || (victim->active && stream->lastUsed < victim->lastUsed)) victim = stream;
+    }
+    if (!victim) return NULL;
+
+    // The old region's buffer is kept for the new one
+    victim->active = true;
+    victim->x = x;
+    victim->y = y;
+    victim->width = width;
+    victim->height = height;
+    victim->format = format;
+    victim->type = type;
+    victim->alignment = alignment;
+    victim->inFlight = 0;
+    victim->valid = false;
+    return victim;
+}
+
+// ============================================================================
+// Readback API
+// ============================================================================
+
+bool readbackInit(bool asyncMode) {
+    memset(&g_readback, 0, sizeof(ReadbackContext));
+    for (int i = 0; i < READBACK_SLOTS; i++) g_readback.slots[i].stream = -1;
+
+    g_readback.worker = threadPoolCreate(1);
+    if (!g_readback.worker) {
+        velocityLogError("Failed to create readback worker");
+        return false;
+    }
+
+    g_readback.asyncMode = asyncMode;
+    g_readback.initialized = true;
+
+    velocityLogInfo("Readback initialized (async glReadPixels %s)", asyncMode ? "on" : "off");
+    return true;
+}
+
+void readbackShutdown(void) {
+    if (!g_readback.initialized) return;
+
+    // Drains conversions still running on mapped buffers
+    threadPoolDestroy(g_readback.worker);
+
+    for (int i = 0; i < READBACK_SLOTS; i++) {
+        ReadbackSlot* slot = &g_readback.slots[i];
+        if (slot->state == SLOT_CONVERTING) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        if (slot->pbo) glDeleteBuffers(1, &slot->pbo);
+        velocityFree(slot->data);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    for (int i = 0; i < READBACK_STREAMS; i++) {
+        velocityFree(g_readback.streams[i].data);
+    }
+
+    memset(&g_readback, 0, sizeof(ReadbackContext));
+}
+
+void readbackSetAsyncMode(bool enabled) {
+    g_readback.asyncMode = enabled;
+}
+
+uint32_t readbackRequest(GLint x, GLint y, GLsizei width, GLsizei height,
+                         GLenum format, GLenum type,
+                         VelocityReadbackCallback callback, void* userData) {
+    if (!g_readback.initialized || width <= 0 || height <= 0) return 0;
+
+    uint8_t channels[4];
+    if (!channelMap(format, type, channels)) return 0;
+
+    ReadbackSlot* slot = freeSlot();
+    if (!slot) {
+        g_readback.dropped++;
+        return 0;
+    }
+
+    TRACE_SCOPE("readback_issue");
+    slot->format = format;
+    slot->alignment = 1;
+    slot->callback = callback;
+    slot->userData = userData;
+    slot->stream = -1;
+    if (!issue(slot, x, y, width, height)) {
+        g_readback.dropped++;
+        return 0;
+    }
+    return slot->handle;
+}
+
+int readbackPoll(uint32_t handle, void* pixels, size_t size) {
+    ReadbackSlot* slot = findSlot(handle);
+    if (!slot || slot->callback) return -1;
+    if (slot->state != SLOT_READY) return 0;
+    if (slot->failed) {
+        releaseSlot(slot);
+        return -1;
+    }
+
+    if (pixels) memcpy(pixels, slot->data, size < slot->size ? size : slot->size);
+    g_readback.completed++;
+    releaseSlot(slot);
+    return 1;
+}
+
+bool readbackReadPixels(GLint x, GLint y, GLsizei width, GLsizei height,
+                        GLenum format, GLenum type, void* pixels) {
+    if (!g_readback.initialized || !g_readback.asyncMode || !pixels) return false;
+    if (width <= 0 || height <= 0) return false;
+
+    uint8_t channels[4];
+    if (!channelMap(format, type, channels)) return false;
+
+    // Reads into an app pack buffer are already asynchronous
+    GLint packBuffer = 0, rowLength = 0, skipPixels = 0, skipRows = 0, alignment = 4;
+    glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &packBuffer);
+    if (packBuffer) return false;
+    glGetIntegerv(GL_PACK_ROW_LENGTH, &rowLength);
+    glGetIntegerv(GL_PACK_SKIP_PIXELS, &skipPixels);
+    glGetIntegerv(GL_PACK_SKIP_ROWS, &skipRows);
+    if (rowLength || skipPixels || skipRows) return false;
+    glGetIntegerv(GL_PACK_ALIGNMENT, &alignment);
+
+    ReadbackStream* stream = findStream(x, y, width, height, format, type, alignment);
+    if (!stream) return false;
+    stream->lastUsed = g_readback.frame;
+
+    // Keep one read per frame queued for the region
+    ReadbackSlot* slot = stream->inFlight < 2 ? freeSlot() : NULL;
+    if (slot) {
+        TRACE_SCOPE("readback_issue");
+        slot->format = format;
+        slot->alignment = alignment;
+        slot->callback = NULL;
+        slot->userData = NULL;
+        slot->stream = (int)(stream - g_readback.streams);
+        if (issue(slot, x, y, width, height)) {
+            stream->inFlight++;
+        } else {
+            slot->stream = -1;
+        }
+    }
+
+    // The first read of a region has nothing to serve yet
+    if (!stream->valid) return false;
+
+    memcpy(pixels, stream->data, stream->size);
+    g_readback.streamHits++;
+    return true;
+}
+
+void readbackRecordSync(uint64_t elapsedNs) {
+    g_readback.syncReads++;
+    g_readback.frameSyncNs += elapsedNs;
+    g_readback.totalSyncNs += elapsedNs;
+    fenceTimelineRecordStall(FENCE_WAIT_READBACK, elapsedNs);
+}
+
+void readbackEndFrame(void) {
+    if (!g_readback.initialized) return;
+
+    g_readback.lastSyncNs = g_readback.frameSyncNs;
+    g_readback.frameSyncNs = 0;
+
+    GLint previous = -1;
+    bool deliver = false;
+
+    for (int i = 0; i < READBACK_SLOTS; i++) {
+        ReadbackSlot* slot = &g_readback.slots[i];
+
+        if (slot->state == SLOT_IN_FLIGHT) {
+            if (!fenceTimelineReached(slot->point)) continue;
+
+            if (previous < 0) glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &previous);
+            if (!startConversion(slot)) {
+                fail(slot);
+                if (slot->callback) deliver = true;
+            }
+            continue;
+        }
+
+        if (slot->state == SLOT_CONVERTING) {
+            if (!__atomic_load_n(&slot->converted, __ATOMIC_ACQUIRE)) continue;
+
+            if (previous < 0) glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &previous);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            slot->mapped = NULL;
+            slot->state = SLOT_READY;
+            slot->frame = g_readback.frame;
+            if (!finishStream(slot) && slot->callback) deliver = true;
+            continue;
+        }
+
+        // Results nobody polls for
+        if (slot->state == SLOT_READY && !slot->callback &&
+            g_readback.frame - slot->frame > READBACK_MAX_AGE) {
+            g_readback.dropped++;
+            releaseSlot(slot);
+        }
+    }
+
+    if (previous >= 0) glBindBuffer(GL_PIXEL_PACK_BUFFER, (GLuint)previous);
+
+    // Callbacks run last so they may queue new reads
+    for (int i = 0; deliver && i < READBACK_SLOTS; i++) {
+        ReadbackSlot* slot = &g_readback.slots[i];
+        if (slot->state != SLOT_READY || !slot->callback) continue;
+
+        // The slot's data stays untouched until a new read of it is mapped
+        VelocityReadbackCallback callback = slot->callback;
+        void* userData = slot->userData;
+        uint32_t handle = slot->handle;
+        const uint8_t* data = slot->failed ? NULL : slot->data;
+        size_t size = slot->size;
+        if (!slot->failed) g_readback.completed++;
+        releaseSlot(slot);
+        callback(handle, data, size, userData);
+    }
+
+    for (int i = 0; i < READBACK_STREAMS; i++) {
+        ReadbackStream* stream = &g_readback.streams[i];
+        if (!stream->active || stream->inFlight > 0) continue;
+        if (g_readback.frame - stream->lastUsed <= READBACK_STREAM_AGE) continue;
+
+        velocityFree(stream->data);
+        memset(stream, 0, sizeof(ReadbackStream));
+    }
+
+    g_readback.frame++;
+}
+
+void readbackGetStats(ReadbackStats* stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(ReadbackStats));
+
+    stats->asyncMode = g_readback.asyncMode;
+    for (int i = 0; i < READBACK_SLOTS; i++) {
+        SlotState state = g_readback.slots[i].state;
+        if (state == SLOT_IN_FLIGHT || state == SLOT_CONVERTING) stats->inFlight++;
+    }
+    stats->completed = g_readback.completed;
+    stats->dropped = g_readback.dropped;
+    stats->streamHits = g_readback.streamHits;
+    stats->syncReads = g_readback.syncReads;
+    stats->syncMs = g_readback.lastSyncNs / 1000000.0f;
+    stats->syncTotalMs = g_readback.totalSyncNs / 1000000.0f;
+}
@@ -0,0 +1,112 @@
+/**
+ * Readback - Asynchronous pixel readback through a ring of pack buffers
+ * Reads go into a pixel pack buffer with a fence behind them. Once the
+ * fence has signaled the buffer is mapped and a worker converts the
+ * RGBA8 pixels to the requested format; results are delivered on the
+ * render thread a frame or more later, through a callback or a polled
+ * handle. In async mode a glReadPixels into client memory is served the
+ * latest completed read of the same region instead of waiting for the GPU.
+ */
+
+#ifndef READBACK_H
+#define READBACK_H
+
+#include <GLES3/gl32.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "velocity_gl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define READBACK_SLOTS              8       // Reads in flight or awaiting pickup
+#define READBACK_STREAMS            4       // Regions served to glReadPixels in async mode
+#define READBACK_MAX_AGE            120     // Frames an unpolled result is kept
+#define READBACK_STREAM_AGE         60      // Frames an unused stream is kept
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * Readback statistics
+ */
+typedef struct ReadbackStats {
+    bool asyncMode;
+    uint32_t inFlight;           // Reads waiting on the GPU or the worker
+    uint32_t completed;          // Async reads delivered
+    uint32_t dropped;            // Async reads refused (ring full) or failed
+    uint32_t streamHits;         // glReadPixels served from a completed read
+    uint32_t syncReads;          // glReadPixels that read directly
+    float syncMs;                // CPU time in direct reads last frame
+    float syncTotalMs;
+} ReadbackStats;
+
+// ============================================================================
+// Readback API
+// ============================================================================
+
+/**
+ * Initialize readback (requires GL context)
+ */
+bool readbackInit(bool asyncMode);
+
+/**
+ * Wait for the worker and release buffers
+ */
+void readbackShutdown(void);
+
+/**
+ * Serve glReadPixels into client memory from completed reads
+ */
+void readbackSetAsyncMode(bool enabled);
+
+/**
+ * Queue a read of the bound read framebuffer, 0 if it can't be queued;
+ * results are tightly packed
+ */
+uint32_t readbackRequest(GLint x, GLint y, GLsizei width, GLsizei height,
+                         GLenum format, GLenum type,
+                         VelocityReadbackCallback callback, void* userData);
+
+/**
+ * Copy a polled result out: 1 done (handle released), 0 pending,
+ * -1 unknown handle or failed read
+ */
+int readbackPoll(uint32_t handle, void* pixels, size_t size);
+
+/**
+ * glReadPixels into client memory in async mode, false if the caller has
+ * to read directly
+ */
+bool readbackReadPixels(GLint x, GLint y, GLsizei width, GLsizei height,
+                        GLenum format, GLenum type, void* pixels);
+
+/**
+ * Account a direct read
+ */
+void readbackRecordSync(uint64_t elapsedNs);
+
+/**
+ * Map finished reads, collect conversions and deliver results (call
+ * once per frame)
+ */
+void readbackEndFrame(void);
+
+/**
+ * Get statistics
+ */
+void readbackGetStats(ReadbackStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // READBACK_H
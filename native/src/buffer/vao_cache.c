@@ -0,0 +1,1148 @@
+/**
+ * VAO Cache - Implementation
+ * App vertex array names stay real driver names but are never bound while
+ * shadowing; the driver only sees cached VAOs and, for client-side arrays,
+ * the default VAO. The element buffer is VAO state the app can change at
+ * any time, so it is not part of the key: each cached VAO remembers what
+ * it has bound and is corrected at draw time. Arrays the current program
+ * has no active input for are left out of the key, so the driver never
+ * fetches them. A frame that builds more VAOs than the cache can keep
+ * turns it into pure churn, so setups then go to the default VAO for a
+ * while, exactly as without the cache. Separate attribute formats
+ * (glVertexAttribFormat, glBindVertexBuffer) are not shadowed: an array set
+ * up that way is written back once and drawn from directly.
+ */
+
+#include "vao_cache.h"
+#include "vertex_packer.h"
+#include "../core/gl_wrapper.h"
+#include "../profile/trace.h"
+#include "../utils/log.h"
+#include "../utils/memory.h"
+
+#include <string.h>
+
+// ============================================================================
+// Types
+// ============================================================================
+
+#define BOUND_DEFAULT       -1           // Default VAO bound in the driver
+#define BOUND_OTHER         -2           // Some array the cache doesn't own
+#define BOUND_APP           -3           // A direct app array, boundApp
+#define UNKNOWN_BINDING     0xFFFFFFFFu
+#define ALL_INPUTS          0xFFFFFFFFu
+
+/**
+ * Attribute setup of one app vertex array
+ */
+typedef struct ShadowArray {
+    GLuint name;
+    struct ShadowArray* next;
+
+    VertexElement attribs[VAO_CACHE_MAX_ATTRIBS];   // Stride 0 resolved to packed
+    GLsizei strides[VAO_CACHE_MAX_ATTRIBS];         // As specified, for queries
+    GLuint buffers[VAO_CACHE_MAX_ATTRIBS];
+    uint32_t enabledMask;
+    uint32_t activeMask;         // Enabled and read by the program, last resolve
+    GLuint elementBuffer;
+
+    bool dirty;                  // Setup changed since the last resolve
+    bool client;                 // An enabled attribute reads client memory
+    bool direct;                 // Driver owns the setup, the array itself is bound
+    uint32_t version;            // Bumped on every change
+    int entry;                   // Cached VAO it resolved to, -1 none
+    uint32_t entryGeneration;
+} ShadowArray;
+
+/**
+ * Attribute locations a linked program reads
+ */
+typedef struct ProgramInputs {
+    GLuint program;
+    struct ProgramInputs* next;
+    uint32_t mask;
+    uint8_t semantics[VAO_CACHE_MAX_ATTRIBS];   // VertexSemantic per location
+} ProgramInputs;
+
+typedef struct CachedVao {
+    GLuint vao;                  // 0: free slot
+    uint64_t hash;
+    VertexFormat format;
+    GLuint buffers[VAO_CACHE_MAX_ATTRIBS];
+    GLuint elementBuffer;        // Bound in the VAO now
+    uint32_t generation;
+    uint32_t lastUsed;
+    int16_t next;
+} CachedVao;
+
+typedef struct VaoCacheContext {
+    bool initialized;
+    bool enabled;
+    bool capture;                // Arrays not seen generated predate shadowing
+    int maxAttribs;
+
+    // App arrays
+    ShadowArray* arrays[VAO_CACHE_ARRAY_BUCKETS];
+    uint32_t arrayCount;
+    ShadowArray* current;
+
+    // Program inputs
+    ProgramInputs* programs[VAO_CACHE_PROGRAM_BUCKETS];
+    const ProgramInputs* inputs; // Of the program drawn with last
+
+    // Cached VAOs
+    CachedVao entries[VAO_CACHE_SIZE];
+    int16_t buckets[VAO_CACHE_BUCKETS];
+    int entryCount;
+
+    // Driver binding
+    int bound;                   // Entry index, BOUND_DEFAULT, BOUND_OTHER or BOUND_APP
+    GLuint boundApp;
+    GLuint defaultElement;
+    const ShadowArray* defaultShadow;   // Last written to the default VAO
+    uint32_t defaultVersion;
+    uint32_t defaultMask;
+    GLuint defaultDivisors[VAO_CACHE_MAX_ATTRIBS];
+
+    uint32_t frame;
+    uint32_t frameMisses;
+    uint32_t bypassFrames;       // Left in bypass, 0: cache in use
+
+    // Stats
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t clientDraws;
+    uint32_t bypassDraws;
+    uint32_t frameAbsorbed;
+    uint32_t frameIssued;
+    uint32_t frameStripped;
+    uint32_t lastAbsorbed;
+    uint32_t lastIssued;
+    uint32_t lastStripped;
+} VaoCacheContext;
+
+static VaoCacheContext g_vao = {0};
+
+bool g_vaoCacheActive = false;
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static inline bool listed(GLuint name, GLsizei n, const GLuint* names) {
+    if (name == 0 || name == UNKNOWN_BINDING) return false;
+    for (GLsizei i = 0; i < n; i++) {
+        if (names[i] == name) return true;
+    }
+    return false;
+}
+
+static GLuint appArrayBuffer(void) {
+    GLuint tracked = g_wrapperCtx ? g_wrapperCtx->state.buffers.arrayBuffer : UNKNOWN_BINDING;
+    if (tracked != UNKNOWN_BINDING) return tracked;
+
+    GLint bound = 0;
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &bound);
+    return (GLuint)bound;
+}
+
+static void resetAttribs(ShadowArray* shadow) {
+    for (int i = 0; i < VAO_CACHE_MAX_ATTRIBS; i++) {
+        VertexElement* elem = &shadow->attribs[i];
+        memset(elem, 0, sizeof(VertexElement));
+        elem->index = (GLuint)i;
+        elem->size = 4;
+        elem->type = GL_FLOAT;
+        elem->stride = (GLsizei)vertexElementBytes(elem);
+        shadow->strides[i] = 0;
+        shadow->buffers[i] = 0;
+    }
+    shadow->enabledMask = 0;
+    shadow->elementBuffer = 0;
+}
+
+static inline void touch(ShadowArray* shadow) {
+    shadow->dirty = true;
+    shadow->version++;
+}
+
+static void bindApp(const ShadowArray* shadow) {
+    if (g_vao.bound == BOUND_APP && g_vao.boundApp == shadow->name) return;
+
+    glBindVertexArray(shadow->name);
+    g_vao.bound = BOUND_APP;
+    g_vao.boundApp = shadow->name;
+    g_vao.frameIssued++;
+}
+
+/**
+ * Let a call on a direct array through to the driver: queued draws still
+ * read the array as it was, and later flushes have to restore it
+ */
+static void toDriver(const ShadowArray* shadow) {
+    drawBatcherFlush();
+    bindApp(shadow);
+    drawBatcherSetVertexArray(shadow->name);
+}
+
+// ============================================================================
+// App Arrays
+// ============================================================================
+
+static inline uint32_t arrayBucket(GLuint name) {
+    return name & (VAO_CACHE_ARRAY_BUCKETS - 1);
+}
+
+static ShadowArray* findArray(GLuint name) {
+    for (ShadowArray* shadow = g_vao.arrays[arrayBucket(name)]; shadow; shadow = shadow->next) {
+        if (shadow->name == name) return shadow;
+    }
+    return NULL;
+}
+
+/**
+ * Read an array's setup back from the driver
+ */
+static void captureArray(ShadowArray* shadow) {
+    GLint previous = 0;
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previous);
+    glBindVertexArray(shadow->name);
+
+    for (int i = 0; i < g_vao.maxAttribs; i++) {
+        VertexElement* elem = &shadow->attribs[i];
+        GLint enabled = 0, size = 4, type = GL_FLOAT, normalized = 0, integer = 0;
+        GLint stride = 0, divisor = 0, buffer = 0;
+        void* pointer = NULL;
+
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_SIZE, &size);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_TYPE, &type);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_NORMALIZED, &normalized);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_INTEGER, &integer);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_STRIDE, &stride);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_DIVISOR, &divisor);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &buffer);
+        glGetVertexAttribPointerv(i, GL_VERTEX_ATTRIB_ARRAY_POINTER, &pointer);
+
+        elem->size = size;
+        elem->type = (GLenum)type;
+        elem->normalized = normalized ? GL_TRUE : GL_FALSE;
+        elem->integer = integer ? GL_TRUE : GL_FALSE;
+        elem->divisor = (GLuint)divisor;
+        elem->offset = (size_t)(uintptr_t)pointer;
+        elem->stride = stride ? stride : (GLsizei)vertexElementBytes(elem);
+        shadow->strides[i] = stride;
+        shadow->buffers[i] = (GLuint)buffer;
+        if (enabled) shadow->enabledMask |= 1u << i;
+    }
+
+    GLint element = 0;
+    glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &element);
+    shadow->elementBuffer = (GLuint)element;
+
+    glBindVertexArray((GLuint)previous);
+}
+
+static ShadowArray* createArray(GLuint name) {
+    ShadowArray* shadow = (ShadowArray*)velocityCalloc(1, sizeof(ShadowArray));
+    if (!shadow) return NULL;
+
+    shadow->name = name;
+    shadow->entry = -1;
+    shadow->dirty = true;
+    resetAttribs(shadow);
+
+    uint32_t bucket = arrayBucket(name);
+    shadow->next = g_vao.arrays[bucket];
+    g_vao.arrays[bucket] = shadow;
+    g_vao.arrayCount++;
+    return shadow;
+}
+
+/**
+ * Shadow of an app array, created on first sight
+ */
+static ShadowArray* arrayFor(GLuint name) {
+    ShadowArray* shadow = findArray(name);
+    if (shadow) return shadow;
+
+    shadow = createArray(name);
+    if (shadow && g_vao.capture) captureArray(shadow);
+    return shadow;
+}
+
+static void destroyArray(ShadowArray* shadow) {
+    ShadowArray** link = &g_vao.arrays[arrayBucket(shadow->name)];
+    while (*link && *link != shadow) link = &(*link)->next;
+    if (*link) *link = shadow->next;
+
+    if (g_vao.defaultShadow == shadow) g_vao.defaultShadow = NULL;
+    g_vao.arrayCount--;
+    velocityFree(shadow);
+}
+
+static void destroyArrays(void) {
+    for (int b = 0; b < VAO_CACHE_ARRAY_BUCKETS; b++) {
+        ShadowArray* shadow = g_vao.arrays[b];
+        while (shadow) {
+            ShadowArray* next = shadow->next;
+            velocityFree(shadow);
+            shadow = next;
+        }
+        g_vao.arrays[b] = NULL;
+    }
+    g_vao.arrayCount = 0;
+    g_vao.current = NULL;
+    g_vao.defaultShadow = NULL;
+}
+
+/**
+ * Write a shadow into its app array
+ */
+static void writeBack(const ShadowArray* shadow) {
+    glBindVertexArray(shadow->name);
+
+    GLuint bound = UNKNOWN_BINDING;
+    for (int i = 0; i < g_vao.maxAttribs; i++) {
+        const VertexElement* elem = &shadow->attribs[i];
+
+        if (shadow->buffers[i] != bound) {
+            glBindBuffer(GL_ARRAY_BUFFER, shadow->buffers[i]);
+            bound = shadow->buffers[i];
+        }
+        if (elem->integer) {
+            glVertexAttribIPointer(elem->index, elem->size, elem->type, shadow->strides[i],
+                                   (const void*)elem->offset);
+        } else {
+            glVertexAttribPointer(elem->index, elem->size, elem->type, elem->normalized,
+                                  shadow->strides[i], (const void*)elem->offset);
+        }
+        glVertexAttribDivisor(elem->index, elem->divisor);
+
+        if (shadow->enabledMask & (1u << i)) {
+            glEnableVertexAttribArray(elem->index);
+        } else {
+            glDisableVertexAttribArray(elem->index);
+        }
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, shadow->elementBuffer);
+}
+
+// ============================================================================
+// Program Inputs
+// ============================================================================
+
+static const ProgramInputs EVERY_INPUT = { .mask = ALL_INPUTS };
+
+static inline uint32_t programBucket(GLuint program) {
+    return program & (VAO_CACHE_PROGRAM_BUCKETS - 1);
+}
+
+/**
+ * Locations taken by an attribute of the given type
+ */
+static int inputSlots(GLenum type) {
+    switch (type) {
+        case GL_FLOAT_MAT2:
+        case GL_FLOAT_MAT2x3:
+        case GL_FLOAT_MAT2x4:
+            return 2;
+        case GL_FLOAT_MAT3:
+        case GL_FLOAT_MAT3x2:
+        case GL_FLOAT_MAT3x4:
+            return 3;
+        case GL_FLOAT_MAT4:
+        case GL_FLOAT_MAT4x2:
+        case GL_FLOAT_MAT4x3:
+            return 4;
+        default:
+            return 1;
+    }
+}
+
+/**
+ * Ask the driver which attributes survived linking; anything it can't
+ * answer for counts as read
+ */
+static ProgramInputs* reflectProgram(GLuint program) {
+    ProgramInputs* inputs = (ProgramInputs*)velocityCalloc(1, sizeof(ProgramInputs));
+    if (!inputs) return NULL;
+    inputs->program = program;
+    inputs->mask = ALL_INPUTS;
+
+    GLint linked = 0, count = 0, maxLength = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+
+    char name[256];
+    if (linked && maxLength <= (GLint)sizeof(name)) {
+        inputs->mask = 0;
+        for (GLint i = 0; i < count; i++) {
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveAttrib(program, (GLuint)i, sizeof(name), NULL, &size, &type, name);
+
+            // Built-ins like gl_VertexID have no location
+            GLint location = glGetAttribLocation(program, name);
+            if (location < 0) continue;
+
+            uint8_t semantic = (uint8_t)vertexPackerSemantic(name);
+            int slots = inputSlots(type) * (size > 0 ? size : 1);
+            for (int s = 0; s < slots && location + s < VAO_CACHE_MAX_ATTRIBS; s++) {
+                inputs->mask |= 1u << (location + s);
+                inputs->semantics[location + s] = semantic;
+            }
+        }
+    }
+
+    uint32_t bucket = programBucket(program);
+    inputs->next = g_vao.programs[bucket];
+    g_vao.programs[bucket] = inputs;
+    return inputs;
+}
+
+static const ProgramInputs* currentInputs(void) {
+    GLuint program = g_wrapperCtx ? g_wrapperCtx->state.currentProgram : 0;
+    if (program == 0 || program == UNKNOWN_BINDING) return &EVERY_INPUT;
+    if (g_vao.inputs && g_vao.inputs->program == program) return g_vao.inputs;
+
+    const ProgramInputs* inputs = NULL;
+    for (inputs = g_vao.programs[programBucket(program)]; inputs; inputs = inputs->next) {
+        if (inputs->program == program) break;
+    }
+    if (!inputs) inputs = reflectProgram(program);
+    if (!inputs) return &EVERY_INPUT;
+
+    g_vao.inputs = inputs;
+    return inputs;
+}
+
+static void destroyPrograms(void) {
+    for (int b = 0; b < VAO_CACHE_PROGRAM_BUCKETS; b++) {
+        ProgramInputs* inputs = g_vao.programs[b];
+        while (inputs) {
+            ProgramInputs* next = inputs->next;
+            velocityFree(inputs);
+            inputs = next;
+        }
+        g_vao.programs[b] = NULL;
+    }
+    g_vao.inputs = NULL;
+}
+
+// ============================================================================
+// Cached VAOs
+// ============================================================================
+
+static uint64_t keyHash(const VertexFormat* format, const GLuint* buffers) {
+    uint64_t hash = format->hash;
+    for (int i = 0; i < format->elementCount; i++) {
+        hash ^= buffers[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static void buildKey(const ShadowArray* shadow, VertexFormat* format, GLuint* buffers) {
+    format->elementCount = 0;
+    for (int i = 0; i < g_vao.maxAttribs; i++) {
+        if (!(shadow->activeMask & (1u << i))) continue;
+        format->elements[format->elementCount] = shadow->attribs[i];
+        buffers[format->elementCount] = shadow->buffers[i];
+        format->elementCount++;
+    }
+    vertexFormatFinalize(format);
+}
+
+static int findEntry(uint64_t hash, const VertexFormat* format, const GLuint* buffers) {
+    for (int i = g_vao.buckets[hash & (VAO_CACHE_BUCKETS - 1)]; i >= 0; i = g_vao.entries[i].next) {
+        const CachedVao* entry = &g_vao.entries[i];
+        if (entry->hash == hash && vertexFormatEquals(&entry->format, format) &&
+            memcmp(entry->buffers, buffers, format->elementCount * sizeof(GLuint)) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void evictEntry(int index) {
+    CachedVao* entry = &g_vao.entries[index];
+
+    int16_t* link = &g_vao.buckets[entry->hash & (VAO_CACHE_BUCKETS - 1)];
+    while (*link >= 0 && *link != index) link = &g_vao.entries[*link].next;
+    if (*link == index) *link = entry->next;
+
+    // Deleting the bound array reverts the driver to the default one
+    glDeleteVertexArrays(1, &entry->vao);
+    if (g_vao.bound == index) g_vao.bound = BOUND_DEFAULT;
+
+    entry->vao = 0;
+    entry->generation++;
+    g_vao.entryCount--;
+    g_vao.evictions++;
+}
+
+static void evictAll(void) {
+    for (int i = 0; i < VAO_CACHE_SIZE; i++) {
+        if (g_vao.entries[i].vao) evictEntry(i);
+    }
+}
+
+/**
+ * Free slot for a new VAO, evicting the least recently used one when full
+ */
+static int allocEntry(void) {
+    int oldest = -1;
+    for (int i = 0; i < VAO_CACHE_SIZE; i++) {
+        const CachedVao* entry = &g_vao.entries[i];
+        if (!entry->vao) return i;
+        if (oldest < 0 || (int32_t)(entry->lastUsed - g_vao.entries[oldest].lastUsed) < 0) {
+            oldest = i;
+        }
+    }
+
+    // Queued draws may still replay with it
+    drawBatcherFlush();
+    evictEntry(oldest);
+    return oldest;
+}
+
+static int buildEntry(uint64_t hash, const VertexFormat* format, const GLuint* buffers,
+                      GLuint elementBuffer) {
+    int index = allocEntry();
+    CachedVao* entry = &g_vao.entries[index];
+
+    glGenVertexArrays(1, &entry->vao);
+    if (!entry->vao) return -1;
+
+    entry->hash = hash;
+    memcpy(&entry->format, format, sizeof(VertexFormat));
+    memcpy(entry->buffers, buffers, format->elementCount * sizeof(GLuint));
+    entry->elementBuffer = elementBuffer;
+    entry->lastUsed = g_vao.frame;
+
+    int16_t* bucket = &g_vao.buckets[hash & (VAO_CACHE_BUCKETS - 1)];
+    entry->next = *bucket;
+    *bucket = (int16_t)index;
+    g_vao.entryCount++;
+
+    // Static buffers with a packed copy are read through it
+    VertexFormat applied;
+    GLuint appliedBuffers[VAO_CACHE_MAX_ATTRIBS];
+    memcpy(&applied, format, sizeof(VertexFormat));
+    memcpy(appliedBuffers, buffers, format->elementCount * sizeof(GLuint));
+    vertexPackerSubstitute(&applied, appliedBuffers);
+
+    glBindVertexArray(entry->vao);
+    g_vao.bound = index;
+    vertexFormatApplyBindings(&applied, appliedBuffers);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, appArrayBuffer());
+
+    g_vao.frameIssued += (uint32_t)format->elementCount * 3 + 4;
+    g_vao.misses++;
+    g_vao.frameMisses++;
+    return index;
+}
+
+/**
+ * Element buffer uploads go through the driver's bound VAO, so it has to
+ * carry the app array's element buffer between draws too
+ */
+static void syncElementBuffer(void) {
+    // A direct array has its own binding; binds must not reach one that isn't current
+    if (g_vao.current->direct) {
+        toDriver(g_vao.current);
+        return;
+    }
+    if (g_vao.bound == BOUND_APP) {
+        drawBatcherFlush();
+        glBindVertexArray(0);
+        g_vao.bound = BOUND_DEFAULT;
+        drawBatcherSetVertexArray(0);
+    }
+
+    GLuint wanted = g_vao.current->elementBuffer;
+    GLuint* bound = NULL;
+    if (g_vao.bound >= 0) {
+        bound = &g_vao.entries[g_vao.bound].elementBuffer;
+    } else if (g_vao.bound == BOUND_DEFAULT) {
+        bound = &g_vao.defaultElement;
+    }
+    if (bound && *bound == wanted) return;
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, wanted);
+    if (bound) *bound = wanted;
+    g_vao.frameIssued++;
+}
+
+// ============================================================================
+// Draw Resolution
+// ============================================================================
+
+/**
+ * Client-side arrays can't live in a VAO: write them to the default one
+ */
+static GLuint applyDefault(ShadowArray* shadow) {
+    if (g_vao.bound != BOUND_DEFAULT) {
+        glBindVertexArray(0);
+        g_vao.bound = BOUND_DEFAULT;
+        g_vao.frameIssued++;
+    }
+
+    if (g_vao.defaultShadow != shadow || g_vao.defaultVersion != shadow->version ||
+        g_vao.defaultMask != shadow->activeMask) {
+        GLuint bound = UNKNOWN_BINDING;
+        uint32_t touched = shadow->activeMask | g_vao.defaultMask;
+
+        for (int i = 0; i < g_vao.maxAttribs; i++) {
+            uint32_t bit = 1u << i;
+            if (!(touched & bit)) continue;
+
+            const VertexElement* elem = &shadow->attribs[i];
+            if (!(shadow->activeMask & bit)) {
+                glDisableVertexAttribArray(elem->index);
+                g_vao.frameIssued++;
+                continue;
+            }
+
+            if (shadow->buffers[i] != bound) {
+                glBindBuffer(GL_ARRAY_BUFFER, shadow->buffers[i]);
+                bound = shadow->buffers[i];
+                g_vao.frameIssued++;
+            }
+            if (!(g_vao.defaultMask & bit)) {
+                glEnableVertexAttribArray(elem->index);
+                g_vao.frameIssued++;
+            }
+            if (elem->integer) {
+                glVertexAttribIPointer(elem->index, elem->size, elem->type, elem->stride,
+                                       (const void*)elem->offset);
+            } else {
+                glVertexAttribPointer(elem->index, elem->size, elem->type, elem->normalized,
+                                      elem->stride, (const void*)elem->offset);
+            }
+            g_vao.frameIssued++;
+            if (g_vao.defaultDivisors[i] != elem->divisor) {
+                glVertexAttribDivisor(elem->index, elem->divisor);
+                g_vao.defaultDivisors[i] = elem->divisor;
+                g_vao.frameIssued++;
+            }
+        }
+        if (bound != UNKNOWN_BINDING) {
+            glBindBuffer(GL_ARRAY_BUFFER, appArrayBuffer());
+            g_vao.frameIssued++;
+        }
+
+        g_vao.defaultMask = shadow->activeMask;
+        g_vao.defaultShadow = shadow;
+        g_vao.defaultVersion = shadow->version;
+    }
+
+    if (g_vao.defaultElement != shadow->elementBuffer) {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, shadow->elementBuffer);
+        g_vao.defaultElement = shadow->elementBuffer;
+        g_vao.frameIssued++;
+    }
+    return 0;
+}
+
+void vaoCacheElementBuffersChanged(void) {
+    if (!g_vaoCacheActive) return;
+
+    for (int i = 0; i < VAO_CACHE_SIZE; i++) {
+        if (g_vao.entries[i].vao) g_vao.entries[i].elementBuffer = UNKNOWN_BINDING;
+    }
+    g_vao.defaultElement = UNKNOWN_BINDING;
+}
+
+GLuint vaoCacheResolve(void) {
+    if (!g_vaoCacheActive) return 0;
+
+    ShadowArray* shadow = g_vao.current;
+    if (shadow->direct) {
+        bindApp(shadow);
+        return shadow->name;
+    }
+
+    const ProgramInputs* inputs = currentInputs();
+    uint32_t unread = shadow->enabledMask & ~inputs->mask;
+    if (unread) g_vao.frameStripped += (uint32_t)__builtin_popcount(unread);
+
+    uint32_t active = shadow->enabledMask & inputs->mask;
+    if (shadow->dirty || shadow->activeMask != active) {
+        shadow->dirty = false;
+        shadow->entry = -1;
+        shadow->activeMask = active;
+        shadow->client = false;
+        for (int i = 0; i < g_vao.maxAttribs; i++) {
+            if ((active & (1u << i)) && shadow->buffers[i] == 0) {
+                shadow->client = true;
+                break;
+            }
+        }
+    }
+
+    if (shadow->client) {
+        g_vao.clientDraws++;
+        return applyDefault(shadow);
+    }
+
+    // Rebuilding VAOs every few draws costs more than specifying attributes
+    if (g_vao.bypassFrames == 0 && g_vao.frameMisses >= VAO_CACHE_THRASH_MISSES) {
+        velocityLogDebug("VAO cache thrashing (%u builds this frame), bypassing", g_vao.frameMisses);
+        g_vao.bypassFrames = VAO_CACHE_BYPASS_FRAMES;
+    }
+    if (g_vao.bypassFrames > 0) {
+        g_vao.bypassDraws++;
+        return applyDefault(shadow);
+    }
+
+    int index = shadow->entry;
+    if (index < 0 || g_vao.entries[index].generation != shadow->entryGeneration ||
+        !g_vao.entries[index].vao) {
+        TRACE_SCOPE("vao_resolve");
+
+        VertexFormat format;
+        GLuint buffers[VAO_CACHE_MAX_ATTRIBS];
+        buildKey(shadow, &format, buffers);
+        vertexPackerObserve(&format, buffers, inputs->semantics);
+
+        uint64_t hash = keyHash(&format, buffers);
+        index = findEntry(hash, &format, buffers);
+        if (index < 0) {
+            index = buildEntry(hash, &format, buffers, shadow->elementBuffer);
+            if (index < 0) {
+                velocityLogWarn("VAO cache: glGenVertexArrays failed");
+                g_vao.clientDraws++;
+                return applyDefault(shadow);
+            }
+        } else {
+            g_vao.hits++;
+        }
+
+        shadow->entry = index;
+        shadow->entryGeneration = g_vao.entries[index].generation;
+    } else {
+        g_vao.hits++;
+    }
+
+    CachedVao* entry = &g_vao.entries[index];
+    entry->lastUsed = g_vao.frame;
+
+    if (g_vao.bound != index) {
+        glBindVertexArray(entry->vao);
+        g_vao.bound = index;
+        g_vao.frameIssued++;
+    }
+    if (entry->elementBuffer != shadow->elementBuffer) {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, shadow->elementBuffer);
+        entry->elementBuffer = shadow->elementBuffer;
+        g_vao.frameIssued++;
+    }
+    return entry->vao;
+}
+
+// ============================================================================
+// VAO Cache API
+// ============================================================================
+
+static void start(bool capture) {
+    g_vao.capture = capture;
+
+    GLint bound = 0;
+    if (capture) glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &bound);
+    g_vao.bound = bound == 0 ? BOUND_DEFAULT : BOUND_OTHER;
+
+    // A default VAO the app already used is in an unknown state
+    g_vao.defaultElement = capture ? UNKNOWN_BINDING : 0;
+    g_vao.defaultMask = capture ? (1u << g_vao.maxAttribs) - 1 : 0;
+    for (int i = 0; i < VAO_CACHE_MAX_ATTRIBS; i++) {
+        g_vao.defaultDivisors[i] = capture ? UNKNOWN_BINDING : 0;
+    }
+    g_vao.defaultShadow = NULL;
+
+    GLuint app = g_wrapperCtx ? g_wrapperCtx->state.vertexArray : UNKNOWN_BINDING;
+    if (app == UNKNOWN_BINDING) app = (GLuint)bound;
+    g_vao.current = arrayFor(app);
+    if (!g_vao.current) return;
+
+    g_vaoCacheActive = true;
+}
+
+static void stop(bool writeBackArrays) {
+    drawBatcherFlush();
+    drawBatcherSetVertexArray(writeBackArrays && g_vao.current ? g_vao.current->name : 0);
+
+    if (writeBackArrays) {
+        for (int b = 0; b < VAO_CACHE_ARRAY_BUCKETS; b++) {
+            for (ShadowArray* shadow = g_vao.arrays[b]; shadow; shadow = shadow->next) {
+                if (!shadow->direct) writeBack(shadow);
+            }
+        }
+        glBindVertexArray(g_vao.current ? g_vao.current->name : 0);
+        glBindBuffer(GL_ARRAY_BUFFER, appArrayBuffer());
+    }
+
+    evictAll();
+    destroyArrays();
+    destroyPrograms();
+    g_vaoCacheActive = false;
+}
+
+void vaoCacheInit(bool enabled) {
+    if (g_vao.initialized) vaoCacheShutdown();
+
+    memset(&g_vao, 0, sizeof(VaoCacheContext));
+    memset(g_vao.buckets, 0xFF, sizeof(g_vao.buckets));
+
+    GLint maxAttribs = 0;
+    glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &maxAttribs);
+    g_vao.maxAttribs = maxAttribs < VAO_CACHE_MAX_ATTRIBS ? maxAttribs : VAO_CACHE_MAX_ATTRIBS;
+    if (g_vao.maxAttribs < 1) g_vao.maxAttribs = 1;
+
+    g_vao.initialized = true;
+    g_vao.enabled = enabled;
+
+    // Nothing has touched vertex arrays on a fresh context
+    if (enabled) start(false);
+
+    velocityLogInfo("VAO cache initialized (enabled: %d, attributes: %d)",
+                    enabled, g_vao.maxAttribs);
+}
+
+void vaoCacheShutdown(void) {
+    if (!g_vao.initialized) return;
+
+    if (g_vaoCacheActive) stop(false);
+
+    velocityLogInfo("VAO cache: %u hits, %u built, %u evicted",
+                    g_vao.hits, g_vao.misses, g_vao.evictions);
+    memset(&g_vao, 0, sizeof(VaoCacheContext));
+}
+
+void vaoCacheSetEnabled(bool enabled) {
+    if (!g_vao.initialized || g_vao.enabled == enabled) return;
+    g_vao.enabled = enabled;
+
+    if (enabled) {
+        start(true);
+    } else if (g_vaoCacheActive) {
+        stop(true);
+    }
+}
+
+void vaoCacheGenArrays(GLsizei n, const GLuint* arrays) {
+    if (!g_vaoCacheActive || !arrays) return;
+
+    for (GLsizei i = 0; i < n; i++) {
+        if (arrays[i] && !findArray(arrays[i])) createArray(arrays[i]);
+    }
+}
+
+bool vaoCacheDeleteArrays(GLsizei n, const GLuint* arrays) {
+    if (!g_vaoCacheActive || !arrays) return false;
+
+    bool wasBound = false;
+    for (GLsizei i = 0; i < n; i++) {
+        if (arrays[i] == 0) continue;
+
+        ShadowArray* shadow = findArray(arrays[i]);
+        if (!shadow) continue;
+
+        if (shadow == g_vao.current) {
+            g_vao.current = NULL;
+            wasBound = true;
+        }
+        if (g_vao.bound == BOUND_APP && g_vao.boundApp == shadow->name) {
+            g_vao.bound = BOUND_DEFAULT;
+        }
+        destroyArray(shadow);
+    }
+
+    // Deleting the bound array binds the default one
+    if (wasBound) {
+        g_vao.current = arrayFor(0);
+        syncElementBuffer();
+    }
+    return wasBound;
+}
+
+void vaoCacheBindArray(GLuint array) {
+    g_vao.frameAbsorbed++;
+
+    ShadowArray* shadow = arrayFor(array);
+    if (!shadow || shadow == g_vao.current) return;
+
+    g_vao.current = shadow;
+    syncElementBuffer();
+}
+
+GLuint vaoCacheElementBuffer(void) {
+    return g_vao.current ? g_vao.current->elementBuffer : 0;
+}
+
+void vaoCacheBindElementBuffer(GLuint buffer) {
+    if (!g_vaoCacheActive) return;
+
+    g_vao.current->elementBuffer = buffer;
+    if (g_vao.current->direct) {
+        toDriver(g_vao.current);
+        return;
+    }
+
+    // The driver applies it to whichever array is bound right now
+    if (g_vao.bound >= 0) {
+        g_vao.entries[g_vao.bound].elementBuffer = buffer;
+    } else if (g_vao.bound == BOUND_DEFAULT) {
+        g_vao.defaultElement = buffer;
+    }
+}
+
+bool vaoCacheEnableAttrib(GLuint index, bool enabled) {
+    if ((int)index >= g_vao.maxAttribs) return false;
+
+    ShadowArray* shadow = g_vao.current;
+    if (shadow->direct) {
+        toDriver(shadow);
+        return false;
+    }
+    g_vao.frameAbsorbed++;
+    uint32_t bit = 1u << index;
+    if (((shadow->enabledMask & bit) != 0) == enabled) return true;
+
+    shadow->enabledMask ^= bit;
+    touch(shadow);
+    return true;
+}
+
+bool vaoCacheAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized,
+                           GLboolean integer, GLsizei stride, const void* pointer) {
+    if ((int)index >= g_vao.maxAttribs) return false;
+
+    ShadowArray* shadow = g_vao.current;
+    if (shadow->direct) {
+        toDriver(shadow);
+        return false;
+    }
+    g_vao.frameAbsorbed++;
+    GLuint buffer = appArrayBuffer();
+    VertexElement elem = shadow->attribs[index];
+    elem.size = size;
+    elem.type = type;
+    elem.normalized = integer ? GL_FALSE : normalized;
+    elem.integer = integer;
+    elem.offset = (size_t)(uintptr_t)pointer;
+    elem.stride = stride ? stride : (GLsizei)vertexElementBytes(&elem);
+
+    // Re-specifying the same setup keeps the resolved VAO
+    const VertexElement* old = &shadow->attribs[index];
+    if (old->size == elem.size && old->type == elem.type && old->normalized == elem.normalized &&
+        old->integer == elem.integer && old->offset == elem.offset && old->stride == elem.stride &&
+        shadow->strides[index] == stride && shadow->buffers[index] == buffer) {
+        return true;
+    }
+
+    shadow->attribs[index] = elem;
+    shadow->strides[index] = stride;
+    shadow->buffers[index] = buffer;
+    touch(shadow);
+    return true;
+}
+
+bool vaoCacheAttribDivisor(GLuint index, GLuint divisor) {
+    if ((int)index >= g_vao.maxAttribs) return false;
+
+    ShadowArray* shadow = g_vao.current;
+    if (shadow->direct) {
+        toDriver(shadow);
+        return false;
+    }
+    g_vao.frameAbsorbed++;
+    if (shadow->attribs[index].divisor == divisor) return true;
+
+    shadow->attribs[index].divisor = divisor;
+    touch(shadow);
+    return true;
+}
+
+void vaoCacheSeparateFormat(void) {
+    if (!g_vaoCacheActive) return;
+
+    ShadowArray* shadow = g_vao.current;
+    if (shadow->direct) {
+        toDriver(shadow);
+        return;
+    }
+
+    // The default array is also where client-side arrays are applied
+    if (shadow->name == 0) {
+        velocityLogInfo("VAO cache: separate attribute formats on the default array, disabling");
+        g_vao.enabled = false;
+        stop(true);
+        return;
+    }
+
+    drawBatcherFlush();
+    writeBack(shadow);
+    glBindBuffer(GL_ARRAY_BUFFER, appArrayBuffer());
+    shadow->direct = true;
+    shadow->entry = -1;
+    if (g_vao.defaultShadow == shadow) g_vao.defaultShadow = NULL;
+
+    g_vao.bound = BOUND_APP;
+    g_vao.boundApp = shadow->name;
+    drawBatcherSetVertexArray(shadow->name);
+}
+
+bool vaoCacheGetAttrib(GLuint index, GLenum pname, GLint* value) {
+    if (!g_vaoCacheActive || (int)index >= g_vao.maxAttribs || !value) return false;
+
+    const ShadowArray* shadow = g_vao.current;
+    if (shadow->direct) {
+        bindApp(shadow);
+        drawBatcherSetVertexArray(shadow->name);
+        return false;
+    }
+    const VertexElement* elem = &shadow->attribs[index];
+    switch (pname) {
+        case GL_VERTEX_ATTRIB_ARRAY_ENABLED:
+            *value = (shadow->enabledMask >> index) & 1;
+            return true;
+        case GL_VERTEX_ATTRIB_ARRAY_SIZE:           *value = elem->size; return true;
+        case GL_VERTEX_ATTRIB_ARRAY_STRIDE:         *value = shadow->strides[index]; return true;
+        case GL_VERTEX_ATTRIB_ARRAY_TYPE:           *value = (GLint)elem->type; return true;
+        case GL_VERTEX_ATTRIB_ARRAY_NORMALIZED:     *value = elem->normalized; return true;
+        case GL_VERTEX_ATTRIB_ARRAY_INTEGER:        *value = elem->integer; return true;
+        case GL_VERTEX_ATTRIB_ARRAY_DIVISOR:        *value = (GLint)elem->divisor; return true;
+        case GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING: *value = (GLint)shadow->buffers[index]; return true;
+        default:
+            // Current attribute values are context state
+            return false;
+    }
+}
+
+bool vaoCacheGetAttribPointer(GLuint index, void** pointer) {
+    if (!g_vaoCacheActive || (int)index >= g_vao.maxAttribs || !pointer) return false;
+    if (g_vao.current->direct) {
+        bindApp(g_vao.current);
+        drawBatcherSetVertexArray(g_vao.current->name);
+        return false;
+    }
+
+    *pointer = (void*)(uintptr_t)g_vao.current->attribs[index].offset;
+    return true;
+}
+
+void vaoCacheForgetBuffers(GLsizei n, const GLuint* buffers) {
+    if (!g_vaoCacheActive || !buffers || n <= 0) return;
+
+    // Their names may come back from the driver for new buffers
+    for (int i = 0; i < VAO_CACHE_SIZE; i++) {
+        CachedVao* entry = &g_vao.entries[i];
+        if (!entry->vao) continue;
+
+        bool reads = false;
+        for (int e = 0; e < entry->format.elementCount && !reads; e++) {
+            reads = listed(entry->buffers[e], n, buffers);
+        }
+        if (reads) {
+            evictEntry(i);
+        } else if (listed(entry->elementBuffer, n, buffers)) {
+            entry->elementBuffer = UNKNOWN_BINDING;
+        }
+    }
+    if (listed(g_vao.defaultElement, n, buffers)) g_vao.defaultElement = UNKNOWN_BINDING;
+    if (g_vao.bound == BOUND_DEFAULT) g_vao.defaultShadow = NULL;
+
+    // The driver unbinds deleted buffers from the bound array only
+    ShadowArray* shadow = g_vao.current;
+    if (shadow->direct) toDriver(shadow);
+    for (int i = 0; i < g_vao.maxAttribs; i++) {
+        if (listed(shadow->buffers[i], n, buffers)) {
+            shadow->buffers[i] = 0;
+            touch(shadow);
+        }
+    }
+    if (listed(shadow->elementBuffer, n, buffers)) shadow->elementBuffer = 0;
+}
+
+void vaoCacheRefreshBuffer(GLuint buffer) {
+    if (!g_vaoCacheActive || buffer == 0) return;
+
+    bool flushed = false;
+    bool wasBound = false;
+    for (int i = 0; i < VAO_CACHE_SIZE; i++) {
+        CachedVao* entry = &g_vao.entries[i];
+        if (!entry->vao) continue;
+
+        bool reads = false;
+        for (int e = 0; e < entry->format.elementCount && !reads; e++) {
+            reads = entry->buffers[e] == buffer;
+        }
+        if (!reads) continue;
+
+        // Queued draws may still replay with it
+        if (!flushed) {
+            drawBatcherFlush();
+            flushed = true;
+        }
+        if (g_vao.bound == i) wasBound = true;
+        evictEntry(i);
+    }
+
+    // Element buffer writes now land in the default array
+    if (wasBound) syncElementBuffer();
+}
+
+void vaoCacheForgetProgram(GLuint program) {
+    if (!g_vaoCacheActive || program == 0) return;
+
+    ProgramInputs** link = &g_vao.programs[programBucket(program)];
+    while (*link && (*link)->program != program) link = &(*link)->next;
+    if (!*link) return;
+
+    ProgramInputs* inputs = *link;
+    *link = inputs->next;
+    if (g_vao.inputs == inputs) g_vao.inputs = NULL;
+    velocityFree(inputs);
+}
+
+void vaoCacheEndFrame(void) {
+    g_vao.lastAbsorbed = g_vao.frameAbsorbed;
+    g_vao.lastIssued = g_vao.frameIssued;
+    g_vao.lastStripped = g_vao.frameStripped;
+    g_vao.frameAbsorbed = 0;
+    g_vao.frameIssued = 0;
+    g_vao.frameStripped = 0;
+    g_vao.frameMisses = 0;
+    g_vao.frame++;
+    if (g_vao.bypassFrames > 0) g_vao.bypassFrames--;
+
+    if (!g_vaoCacheActive) return;
+
+    // Passes around the present bind their own arrays; start from a known one
+    glBindVertexArray(0);
+    g_vao.bound = BOUND_DEFAULT;
+    drawBatcherSetVertexArray(0);
+}
+
+void vaoCacheGetStats(VaoCacheStats* stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(VaoCacheStats));
+
+    stats->enabled = g_vaoCacheActive;
+    stats->arrays = g_vao.arrayCount;
+    stats->cached = (uint32_t)g_vao.entryCount;
+    stats->hits = g_vao.hits;
+    stats->misses = g_vao.misses;
+    stats->evictions = g_vao.evictions;
+    stats->clientDraws = g_vao.clientDraws;
+    stats->bypassDraws = g_vao.bypassDraws;
+    stats->bypassed = g_vao.bypassFrames > 0;
+    stats->callsAbsorbed = g_vao.lastAbsorbed;
+    stats->callsIssued = g_vao.lastIssued;
+    stats->attribsStripped = g_vao.lastStripped;
+}
@@ -0,0 +1,172 @@
+/**
+ * VAO Cache - Vertex arrays keyed by attribute format and buffer bindings
+ * Attribute setup calls are recorded against a shadow of the app's bound
+ * vertex array instead of reaching the driver. At draw time the shadow's
+ * enabled attributes form a VertexFormat which, together with the buffer
+ * each attribute reads from, keys a cached driver VAO; re-specifying the
+ * same setup every draw then costs one glBindVertexArray, or nothing when
+ * it is already bound. Attributes the current program doesn't read are
+ * left disabled.
+ */
+
+#ifndef VAO_CACHE_H
+#define VAO_CACHE_H
+
+#include <GLES3/gl32.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "draw_batcher.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define VAO_CACHE_MAX_ATTRIBS       16      // Attributes shadowed per array
+#define VAO_CACHE_SIZE              256     // Cached driver VAOs
+#define VAO_CACHE_BUCKETS           512     // Hash buckets (power of two)
+#define VAO_CACHE_ARRAY_BUCKETS     256     // App array buckets (power of two)
+#define VAO_CACHE_PROGRAM_BUCKETS   64      // Program input buckets (power of two)
+#define VAO_CACHE_THRASH_MISSES     64      // Builds in one frame that mean the cache is thrashing
+#define VAO_CACHE_BYPASS_FRAMES     300     // Frames setups go to the default VAO after that
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * VAO cache statistics
+ */
+typedef struct VaoCacheStats {
+    bool enabled;
+    uint32_t arrays;             // App vertex arrays shadowed
+    uint32_t cached;             // Driver VAOs in the cache
+    uint32_t hits;               // Draws served by a cached VAO
+    uint32_t misses;             // Setups that built a new VAO
+    uint32_t evictions;
+    uint32_t clientDraws;        // Draws with client-side arrays, applied directly
+    uint32_t bypassDraws;        // Draws applied directly while the cache was thrashing
+    bool bypassed;               // Too many distinct setups: cache not in use right now
+    uint32_t callsAbsorbed;      // Attribute calls recorded instead of issued, last frame
+    uint32_t callsIssued;        // Attribute calls issued to build or apply, last frame
+    uint32_t attribsStripped;    // Enabled arrays the program didn't read, over last frame's draws
+} VaoCacheStats;
+
+// Set while app vertex arrays are shadowed, read on the attribute hot path
+extern bool g_vaoCacheActive;
+
+// ============================================================================
+// VAO Cache API
+// ============================================================================
+
+/**
+ * Initialize the cache (requires GL context)
+ */
+void vaoCacheInit(bool enabled);
+
+/**
+ * Hand shadowed state back to the app's arrays and delete cached VAOs
+ */
+void vaoCacheShutdown(void);
+
+/**
+ * Start or stop shadowing; stopping writes every shadow into its app array
+ */
+void vaoCacheSetEnabled(bool enabled);
+
+/**
+ * Track names from glGenVertexArrays
+ */
+void vaoCacheGenArrays(GLsizei n, const GLuint* arrays);
+
+/**
+ * Forget deleted app arrays; true if the bound one was among them
+ */
+bool vaoCacheDeleteArrays(GLsizei n, const GLuint* arrays);
+
+/**
+ * Select the app array later attribute calls record into
+ */
+void vaoCacheBindArray(GLuint array);
+
+/**
+ * Element buffer of the bound app array
+ */
+GLuint vaoCacheElementBuffer(void);
+
+/**
+ * Record an element buffer bind (still issued to the driver by the caller)
+ */
+void vaoCacheBindElementBuffer(GLuint buffer);
+
+/**
+ * Record attribute setup of the bound app array, false if the driver
+ * has to handle the call (index out of range)
+ */
+bool vaoCacheEnableAttrib(GLuint index, bool enabled);
+bool vaoCacheAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized,
+                           GLboolean integer, GLsizei stride, const void* pointer);
+bool vaoCacheAttribDivisor(GLuint index, GLuint divisor);
+
+/**
+ * Bind the app array before a separate-format call (glVertexAttribFormat,
+ * glBindVertexBuffer, ...) goes to the driver; the array is written back
+ * and drawn from directly from then on
+ */
+void vaoCacheSeparateFormat(void);
+
+/**
+ * Answer glGetVertexAttrib* from the bound app array, false if not shadowed
+ */
+bool vaoCacheGetAttrib(GLuint index, GLenum pname, GLint* value);
+bool vaoCacheGetAttribPointer(GLuint index, void** pointer);
+
+/**
+ * Drop cached VAOs reading deleted buffers and unbind those buffers from
+ * the bound app array, as the driver would (call before the delete)
+ */
+void vaoCacheForgetBuffers(GLsizei n, const GLuint* buffers);
+
+/**
+ * Rebuild cached VAOs reading a buffer at their next draw
+ */
+void vaoCacheRefreshBuffer(GLuint buffer);
+
+/**
+ * Re-read a program's active attributes at its next draw (after a link,
+ * a binary load or a delete)
+ */
+void vaoCacheForgetProgram(GLuint program);
+
+/**
+ * Index buffers of VAOs were rebound behind the cache (batched draws
+ * replaying the ones they were recorded with)
+ */
+void vaoCacheElementBuffersChanged(void);
+
+/**
+ * Bind the VAO matching the bound app array's setup before a draw;
+ * returns it, 0 when client-side arrays were applied to the default VAO
+ */
+GLuint vaoCacheResolve(void);
+
+/**
+ * Leave the default VAO bound across the swap and roll frame counters
+ * (call once per frame)
+ */
+void vaoCacheEndFrame(void);
+
+/**
+ * Get statistics
+ */
+void vaoCacheGetStats(VaoCacheStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VAO_CACHE_H
@@ -0,0 +1,741 @@
+/**
+ * Vertex Packer - Implementation
+ * The app's buffer is never modified: the packed copy is a second buffer
+ * that only cached VAOs read, so queries, reads and any element the packer
+ * doesn't recognize keep working on the original. A buffer is described by
+ * the layout of the first setup that draws from it; setups that offset into
+ * it by whole vertices map onto the same packed copy.
+ */
+
+#include "vertex_packer.h"
+#include "vao_cache.h"
+#include "../core/gl_wrapper.h"
+#include "../profile/trace.h"
+#include "../utils/log.h"
+#include "../utils/memory.h"
+#include "../utils/thread_pool.h"
+
+#include <ctype.h>
+#include <string.h>
+
+// ============================================================================
+// Types
+// ============================================================================
+
+typedef enum PackState {
+    PACK_WAITING = 0,            // Source copy held, layout unknown
+    PACK_CONVERTING,             // Worker packing
+    PACK_READY                   // Packed copy uploaded
+} PackState;
+
+typedef struct PackElement {
+    // As specified, offset relative to the vertex
+    size_t offset;
+    GLint size;
+    GLenum type;
+    GLboolean normalized;
+    GLboolean integer;
+    uint8_t semantic;
+
+    // Packed
+    size_t packedOffset;
+    GLint packedSize;
+    GLenum packedType;
+    GLboolean packedNormalized;
+} PackElement;
+
+typedef struct PackedBuffer {
+    GLuint buffer;
+    struct PackedBuffer* next;
+    PackState state;
+    uint32_t frame;              // Uploaded
+
+    uint8_t* source;
+    size_t size;
+
+    // Layout
+    GLsizei stride;
+    size_t base;                 // Offset of vertex 0
+    PackElement elements[VAO_CACHE_MAX_ATTRIBS];
+    int elementCount;
+
+    // Result, written by the worker
+    uint8_t* packed;
+    size_t packedSize;
+    GLsizei packedStride;
+    volatile bool converted;
+
+    GLuint packedBuffer;
+} PackedBuffer;
+
+typedef struct VertexPackerContext {
+    bool initialized;
+    bool enabled;
+    ThreadPool* worker;
+
+    PackedBuffer* buckets[VERTEX_PACKER_BUCKETS];
+    PackedBuffer* retired;       // Forgotten while the worker had them
+    uint32_t count;
+    uint32_t frame;
+
+    // Stats
+    size_t sourceBytes;
+    size_t originalBytes;
+    size_t packedBytes;
+    uint32_t packed;
+    uint32_t rejected;
+} VertexPackerContext;
+
+static VertexPackerContext g_packer = {0};
+
+bool g_vertexPackerActive = false;
+
+// ============================================================================
+// Value Conversion
+// ============================================================================
+
+static inline float readFloat(const uint8_t* p) {
+    float value;
+    memcpy(&value, p, sizeof(float));
+    return value;
+}
+
+static uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    int32_t exponent = (int32_t)((bits >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+
+    if (exponent >= 31) return (uint16_t)(sign | 0x7C00u);
+    if (exponent <= 0) {
+        if (exponent < -10) return (uint16_t)sign;
+        mantissa |= 0x800000u;
+        uint32_t shift = (uint32_t)(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1u) half++;
+        return (uint16_t)(sign | half);
+    }
+
+    uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000u) half++;     // Carries into the exponent correctly
+    return (uint16_t)half;
+}
+
+static float halfToFloat(uint16_t half) {
+    uint32_t sign = (uint32_t)(half & 0x8000u) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x3FFu;
+
+    uint32_t bits;
+    if (exponent == 0) {
+        float value = (float)mantissa * (1.0f / 16777216.0f);
+        return sign ? -value : value;
+    } else if (exponent == 31) {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    }
+
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static inline float absf(float value) {
+    return value < 0.0f ? -value : value;
+}
+
+static inline int32_t snorm10(float value) {
+    if (value > 1.0f) value = 1.0f;
+    if (value < -1.0f) value = -1.0f;
+    value *= 511.0f;
+    return (int32_t)(value < 0.0f ? value - 0.5f : value + 0.5f);
+}
+
+static inline uint8_t unorm8(float value) {
+    if (value > 1.0f) value = 1.0f;
+    if (value < 0.0f) value = 0.0f;
+    return (uint8_t)(value * 255.0f + 0.5f);
+}
+
+static inline size_t align4(size_t bytes) {
+    return (bytes + 3) & ~(size_t)3;
+}
+
+// ============================================================================
+// Packing (worker)
+// ============================================================================
+
+/**
+ * Whether every value of a float element survives its compact format
+ */
+static bool fits(const PackedBuffer* rec, const PackElement* elem, uint32_t vertices) {
+    const uint8_t* p = rec->source + rec->base + elem->offset;
+    for (uint32_t v = 0; v < vertices; v++, p += rec->stride) {
+        for (int c = 0; c < elem->size; c++) {
+            float value = readFloat(p + c * sizeof(float));
+            switch (elem->semantic) {
+                case VERTEX_SEMANTIC_NORMAL:
+                    if (!(absf(value) <= 1.001f)) return false;
+                    break;
+                case VERTEX_SEMANTIC_COLOR:
+                    if (!(value >= 0.0f && value <= 1.0f)) return false;
+                    break;
+                case VERTEX_SEMANTIC_TEXCOORD:
+                    if (!(absf(halfToFloat(floatToHalf(value)) - value) <= VERTEX_PACKER_UV_TOLERANCE)) {
+                        return false;
+                    }
+                    break;
+                default:
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Pick each element's packed format; false if none gets smaller
+ */
+static bool chooseFormats(PackedBuffer* rec, uint32_t vertices) {
+    bool smaller = false;
+    size_t offset = 0;
+
+    for (int i = 0; i < rec->elementCount; i++) {
+        PackElement* elem = &rec->elements[i];
+        elem->packedSize = elem->size;
+        elem->packedType = elem->type;
+        elem->packedNormalized = elem->normalized;
+
+        bool candidate = elem->type == GL_FLOAT && !elem->integer &&
+                         elem->semantic != VERTEX_SEMANTIC_OTHER;
+        if (elem->semantic == VERTEX_SEMANTIC_NORMAL && elem->size != 3) candidate = false;
+        if (elem->semantic == VERTEX_SEMANTIC_COLOR && elem->size < 3) candidate = false;
+
+        if (candidate && fits(rec, elem, vertices)) {
+            switch (elem->semantic) {
+                case VERTEX_SEMANTIC_NORMAL:
+                    elem->packedSize = 4;
+                    elem->packedType = GL_INT_2_10_10_10_REV;
+                    elem->packedNormalized = GL_TRUE;
+                    break;
+                case VERTEX_SEMANTIC_COLOR:
+                    elem->packedSize = 4;
+                    elem->packedType = GL_UNSIGNED_BYTE;
+                    elem->packedNormalized = GL_TRUE;
+                    break;
+                default:
+                    elem->packedType = GL_HALF_FLOAT;
+                    break;
+            }
+            smaller = true;
+        }
+
+        VertexElement packed = { .size = elem->packedSize, .type = elem->packedType };
+        elem->packedOffset = offset;
+        offset += align4(vertexElementBytes(&packed));
+    }
+
+    rec->packedStride = (GLsizei)offset;
+    return smaller && rec->packedStride < rec->stride;
+}
+
+static void packElement(const PackElement* elem, const uint8_t* src, uint8_t* dst) {
+    if (elem->packedType == elem->type) {
+        VertexElement original = { .size = elem->size, .type = elem->type };
+        memcpy(dst, src, vertexElementBytes(&original));
+        return;
+    }
+
+    float values[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    for (int c = 0; c < elem->size; c++) values[c] = readFloat(src + c * sizeof(float));
+
+    switch (elem->packedType) {
+        case GL_INT_2_10_10_10_REV: {
+            // w of 1 reads as the 1.0 a three component array leaves there
+            uint32_t word = ((uint32_t)snorm10(values[0]) & 0x3FFu) |
+                            (((uint32_t)snorm10(values[1]) & 0x3FFu) << 10) |
+                            (((uint32_t)snorm10(values[2]) & 0x3FFu) << 20) |
+                            (1u << 30);
+            memcpy(dst, &word, sizeof(word));
+            break;
+        }
+        case GL_UNSIGNED_BYTE:
+            for (int c = 0; c < 4; c++) dst[c] = unorm8(values[c]);
+            break;
+        case GL_HALF_FLOAT:
+            for (int c = 0; c < elem->size; c++) {
+                uint16_t half = floatToHalf(values[c]);
+                memcpy(dst + c * sizeof(uint16_t), &half, sizeof(half));
+            }
+            break;
+    }
+}
+
+static void packTask(void* arg) {
+    PackedBuffer* rec = (PackedBuffer*)arg;
+
+    // Vertices the buffer holds in full from the layout's base
+    size_t end = 0;
+    for (int i = 0; i < rec->elementCount; i++) {
+        const PackElement* elem = &rec->elements[i];
+        VertexElement original = { .size = elem->size, .type = elem->type };
+        size_t elemEnd = elem->offset + vertexElementBytes(&original);
+        if (elemEnd > end) end = elemEnd;
+    }
+    uint32_t vertices = rec->size >= rec->base + end ?
+                        (uint32_t)((rec->size - rec->base - end) / rec->stride + 1) : 0;
+
+    if (vertices > 0 && chooseFormats(rec, vertices)) {
+        size_t packedSize = (size_t)vertices * rec->packedStride;
+        uint8_t* packed = (uint8_t*)velocityMalloc(packedSize);
+        if (packed) {
+            memset(packed, 0, packedSize);
+            for (uint32_t v = 0; v < vertices; v++) {
+                const uint8_t* src = rec->source + rec->base + (size_t)v * rec->stride;
+                uint8_t* dst = packed + (size_t)v * rec->packedStride;
+                for (int i = 0; i < rec->elementCount; i++) {
+                    const PackElement* elem = &rec->elements[i];
+                    packElement(elem, src + elem->offset, dst + elem->packedOffset);
+                }
+            }
+            rec->packed = packed;
+            rec->packedSize = packedSize;
+        }
+    }
+
+    __atomic_store_n(&rec->converted, true, __ATOMIC_RELEASE);
+}
+
+// ============================================================================
+// Tracked Buffers
+// ============================================================================
+
+static inline uint32_t bucketOf(GLuint buffer) {
+    return buffer & (VERTEX_PACKER_BUCKETS - 1);
+}
+
+static PackedBuffer* findBuffer(GLuint buffer) {
+    for (PackedBuffer* rec = g_packer.buckets[bucketOf(buffer)]; rec; rec = rec->next) {
+        if (rec->buffer == buffer) return rec;
+    }
+    return NULL;
+}
+
+static void releaseSource(PackedBuffer* rec) {
+    if (!rec->source) return;
+    g_packer.sourceBytes -= rec->size;
+    velocityFree(rec->source);
+    rec->source = NULL;
+}
+
+static void freeBuffer(PackedBuffer* rec) {
+    releaseSource(rec);
+    velocityFree(rec->packed);
+    velocityFree(rec);
+}
+
+/**
+ * Unlink a record; the worker may still be writing it, in which case it
+ * is freed once done
+ */
+static void dropBuffer(PackedBuffer* rec) {
+    PackedBuffer** link = &g_packer.buckets[bucketOf(rec->buffer)];
+    while (*link && *link != rec) link = &(*link)->next;
+    if (*link) *link = rec->next;
+    g_packer.count--;
+
+    if (rec->state == PACK_READY) {
+        // Cached VAOs still point at the packed copy
+        vaoCacheRefreshBuffer(rec->buffer);
+        glDeleteBuffers(1, &rec->packedBuffer);
+        g_packer.originalBytes -= rec->size;
+        g_packer.packedBytes -= rec->packedSize;
+        g_packer.packed--;
+        rec->packedSize = 0;
+    }
+
+    if (rec->state == PACK_CONVERTING) {
+        rec->next = g_packer.retired;
+        g_packer.retired = rec;
+        return;
+    }
+    freeBuffer(rec);
+}
+
+static void dropAll(void) {
+    for (int b = 0; b < VERTEX_PACKER_BUCKETS; b++) {
+        while (g_packer.buckets[b]) dropBuffer(g_packer.buckets[b]);
+    }
+}
+
+static void freeRetired(bool wait) {
+    PackedBuffer** link = &g_packer.retired;
+    while (*link) {
+        PackedBuffer* rec = *link;
+        if (!wait && !__atomic_load_n(&rec->converted, __ATOMIC_ACQUIRE)) {
+            link = &rec->next;
+            continue;
+        }
+        *link = rec->next;
+        freeBuffer(rec);
+    }
+}
+
+static GLuint boundBuffer(GLenum target) {
+    GLenum binding;
+    switch (target) {
+        case GL_ARRAY_BUFFER:
+            if (g_wrapperCtx && g_wrapperCtx->state.buffers.arrayBuffer != 0xFFFFFFFFu) {
+                return g_wrapperCtx->state.buffers.arrayBuffer;
+            }
+            binding = GL_ARRAY_BUFFER_BINDING;
+            break;
+        case GL_ELEMENT_ARRAY_BUFFER:        binding = GL_ELEMENT_ARRAY_BUFFER_BINDING; break;
+        case GL_COPY_WRITE_BUFFER:           binding = GL_COPY_WRITE_BUFFER_BINDING; break;
+        case GL_COPY_READ_BUFFER:            binding = GL_COPY_READ_BUFFER_BINDING; break;
+        case GL_PIXEL_PACK_BUFFER:           binding = GL_PIXEL_PACK_BUFFER_BINDING; break;
+        case GL_PIXEL_UNPACK_BUFFER:         binding = GL_PIXEL_UNPACK_BUFFER_BINDING; break;
+        case GL_UNIFORM_BUFFER:              binding = GL_UNIFORM_BUFFER_BINDING; break;
+        case GL_TRANSFORM_FEEDBACK_BUFFER:   binding = GL_TRANSFORM_FEEDBACK_BUFFER_BINDING; break;
+        case GL_SHADER_STORAGE_BUFFER:       binding = GL_SHADER_STORAGE_BUFFER_BINDING; break;
+        case GL_DRAW_INDIRECT_BUFFER:        binding = GL_DRAW_INDIRECT_BUFFER_BINDING; break;
+        case GL_DISPATCH_INDIRECT_BUFFER:    binding = GL_DISPATCH_INDIRECT_BUFFER_BINDING; break;
+        default: return 0;
+    }
+
+    GLint bound = 0;
+    glGetIntegerv(binding, &bound);
+    return (GLuint)bound;
+}
+
+// ============================================================================
+// Layout
+// ============================================================================
+
+/**
+ * Describe a waiting buffer from the elements of a setup that read it
+ */
+static bool learnLayout(PackedBuffer* rec, const VertexFormat* format, const GLuint* buffers,
+                        const uint8_t* semantics) {
+    GLsizei stride = 0;
+    size_t lowest = (size_t)-1;
+    for (int i = 0; i < format->elementCount; i++) {
+        if (buffers[i] != rec->buffer) continue;
+        const VertexElement* elem = &format->elements[i];
+        GLsizei elemStride = elem->stride ? elem->stride : format->stride;
+
+        // Separate streams in one buffer have no single vertex to repack
+        if (stride && elemStride != stride) return false;
+        stride = elemStride;
+        if (elem->offset < lowest) lowest = elem->offset;
+    }
+    if (stride <= 0) return false;
+
+    rec->stride = stride;
+    rec->base = lowest % (size_t)stride;
+    rec->elementCount = 0;
+
+    for (int i = 0; i < format->elementCount; i++) {
+        if (buffers[i] != rec->buffer) continue;
+        const VertexElement* elem = &format->elements[i];
+
+        size_t offset = (elem->offset - rec->base) % (size_t)stride;
+        if (offset + vertexElementBytes(elem) > (size_t)stride) return false;
+
+        bool duplicate = false;
+        for (int e = 0; e < rec->elementCount && !duplicate; e++) {
+            const PackElement* other = &rec->elements[e];
+            if (other->offset != offset) continue;
+
+            // Two readings of the same bytes have to agree on what they are
+            if (other->size != elem->size || other->type != elem->type ||
+                other->normalized != elem->normalized || other->integer != elem->integer) {
+                return false;
+            }
+            duplicate = true;
+        }
+        if (duplicate) continue;
+
+        PackElement* packed = &rec->elements[rec->elementCount++];
+        memset(packed, 0, sizeof(PackElement));
+        packed->offset = offset;
+        packed->size = elem->size;
+        packed->type = elem->type;
+        packed->normalized = elem->normalized;
+        packed->integer = elem->integer;
+        packed->semantic = semantics ? semantics[elem->index] : VERTEX_SEMANTIC_OTHER;
+    }
+    return true;
+}
+
+/**
+ * Whether a setup could gain from the layout at all
+ */
+static bool worthPacking(const PackedBuffer* rec) {
+    for (int i = 0; i < rec->elementCount; i++) {
+        const PackElement* elem = &rec->elements[i];
+        if (elem->type == GL_FLOAT && !elem->integer && elem->semantic != VERTEX_SEMANTIC_OTHER) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void upload(PackedBuffer* rec) {
+    glGenBuffers(1, &rec->packedBuffer);
+    if (!rec->packedBuffer) {
+        dropBuffer(rec);
+        return;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, rec->packedBuffer);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)rec->packedSize, rec->packed, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, boundBuffer(GL_ARRAY_BUFFER));
+
+    velocityFree(rec->packed);
+    rec->packed = NULL;
+    releaseSource(rec);
+
+    rec->state = PACK_READY;
+    g_packer.originalBytes += rec->size;
+    g_packer.packedBytes += rec->packedSize;
+    g_packer.packed++;
+
+    // VAOs built before now read the original
+    vaoCacheRefreshBuffer(rec->buffer);
+}
+
+// ============================================================================
+// Vertex Packer API
+// ============================================================================
+
+bool vertexPackerInit(bool enabled) {
+    if (g_packer.initialized) vertexPackerShutdown();
+
+    memset(&g_packer, 0, sizeof(VertexPackerContext));
+
+    g_packer.worker = threadPoolCreate(1);
+    if (!g_packer.worker) {
+        velocityLogError("Failed to create vertex packer worker");
+        return false;
+    }
+
+    g_packer.initialized = true;
+    g_packer.enabled = enabled;
+    g_vertexPackerActive = enabled;
+
+    velocityLogInfo("Vertex packer initialized (enabled: %d)", enabled);
+    return true;
+}
+
+void vertexPackerShutdown(void) {
+    if (!g_packer.initialized) return;
+
+    // Conversions finish before their records go
+    threadPoolDestroy(g_packer.worker);
+    g_vertexPackerActive = false;
+
+    velocityLogInfo("Vertex packer: %u buffers packed, %zu KB -> %zu KB",
+                    g_packer.packed, g_packer.originalBytes / 1024, g_packer.packedBytes / 1024);
+
+    for (int b = 0; b < VERTEX_PACKER_BUCKETS; b++) {
+        PackedBuffer* rec = g_packer.buckets[b];
+        while (rec) {
+            PackedBuffer* next = rec->next;
+            if (rec->packedBuffer) glDeleteBuffers(1, &rec->packedBuffer);
+            freeBuffer(rec);
+            rec = next;
+        }
+    }
+    freeRetired(true);
+    memset(&g_packer, 0, sizeof(VertexPackerContext));
+}
+
+void vertexPackerSetEnabled(bool enabled) {
+    if (!g_packer.initialized || g_packer.enabled == enabled) return;
+    g_packer.enabled = enabled;
+    g_vertexPackerActive = enabled;
+
+    if (!enabled) dropAll();
+}
+
+VertexSemantic vertexPackerSemantic(const char* name) {
+    if (!name) return VERTEX_SEMANTIC_OTHER;
+
+    char lower[64];
+    size_t length = 0;
+    for (; name[length] && length < sizeof(lower) - 1; length++) {
+        lower[length] = (char)tolower((unsigned char)name[length]);
+    }
+    lower[length] = '\0';
+
+    if (strstr(lower, "normal")) return VERTEX_SEMANTIC_NORMAL;
+    if (strstr(lower, "color") || strstr(lower, "colour")) return VERTEX_SEMANTIC_COLOR;
+    if (strstr(lower, "texcoord") || strstr(lower, "uv")) return VERTEX_SEMANTIC_TEXCOORD;
+    return VERTEX_SEMANTIC_OTHER;
+}
+
+void vertexPackerBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+    if (!g_vertexPackerActive) return;
+
+    GLuint buffer = target == GL_ARRAY_BUFFER || g_packer.count > 0 ? boundBuffer(target) : 0;
+    if (buffer == 0) return;
+
+    PackedBuffer* rec = findBuffer(buffer);
+    if (rec) dropBuffer(rec);
+
+    // Only cached VAOs ever read a packed copy
+    if (!g_vaoCacheActive || target != GL_ARRAY_BUFFER || usage != GL_STATIC_DRAW || !data ||
+        size < VERTEX_PACKER_MIN_BYTES || g_packer.count >= VERTEX_PACKER_MAX_BUFFERS ||
+        g_packer.sourceBytes + (size_t)size > VERTEX_PACKER_SOURCE_BUDGET) {
+        return;
+    }
+
+    rec = (PackedBuffer*)velocityCalloc(1, sizeof(PackedBuffer));
+    if (!rec) return;
+    rec->source = (uint8_t*)velocityMalloc((size_t)size);
+    if (!rec->source) {
+        velocityFree(rec);
+        return;
+    }
+
+    memcpy(rec->source, data, (size_t)size);
+    rec->buffer = buffer;
+    rec->size = (size_t)size;
+    rec->frame = g_packer.frame;
+    rec->state = PACK_WAITING;
+    g_packer.sourceBytes += rec->size;
+
+    uint32_t bucket = bucketOf(buffer);
+    rec->next = g_packer.buckets[bucket];
+    g_packer.buckets[bucket] = rec;
+    g_packer.count++;
+}
+
+void vertexPackerBufferWritten(GLenum target) {
+    if (!g_vertexPackerActive || g_packer.count == 0) return;
+
+    GLuint buffer = boundBuffer(target);
+    PackedBuffer* rec = buffer ? findBuffer(buffer) : NULL;
+    if (rec) dropBuffer(rec);
+}
+
+void vertexPackerForgetBuffers(GLsizei n, const GLuint* buffers) {
+    if (!g_vertexPackerActive || g_packer.count == 0 || !buffers) return;
+
+    for (GLsizei i = 0; i < n; i++) {
+        PackedBuffer* rec = buffers[i] ? findBuffer(buffers[i]) : NULL;
+        if (rec) dropBuffer(rec);
+    }
+}
+
+void vertexPackerObserve(const VertexFormat* format, const GLuint* buffers,
+                         const uint8_t* semantics) {
+    if (!g_vertexPackerActive || g_packer.count == 0 || !format || !buffers) return;
+
+    for (int i = 0; i < format->elementCount; i++) {
+        PackedBuffer* rec = buffers[i] ? findBuffer(buffers[i]) : NULL;
+        if (!rec || rec->state != PACK_WAITING) continue;
+
+        TRACE_SCOPE("vertex_pack_observe");
+
+        if (!learnLayout(rec, format, buffers, semantics) || !worthPacking(rec)) {
+            g_packer.rejected++;
+            dropBuffer(rec);
+            continue;
+        }
+
+        rec->converted = false;
+        rec->state = PACK_CONVERTING;
+        threadPoolSubmit(g_packer.worker, packTask, rec);
+    }
+}
+
+bool vertexPackerSubstitute(VertexFormat* format, GLuint* buffers) {
+    if (!g_vertexPackerActive || g_packer.packed == 0 || !format || !buffers) return false;
+
+    bool changed = false;
+    for (int i = 0; i < format->elementCount; i++) {
+        const PackedBuffer* rec = buffers[i] ? findBuffer(buffers[i]) : NULL;
+        if (!rec || rec->state != PACK_READY) continue;
+
+        VertexElement* elem = &format->elements[i];
+        GLsizei stride = elem->stride ? elem->stride : format->stride;
+        if (stride != rec->stride || elem->offset < rec->base) continue;
+
+        // Offsets a whole number of vertices in land on the same element
+        size_t offset = (elem->offset - rec->base) % (size_t)stride;
+        size_t vertex = (elem->offset - rec->base) / (size_t)stride;
+
+        for (int e = 0; e < rec->elementCount; e++) {
+            const PackElement* packed = &rec->elements[e];
+            if (packed->offset != offset || packed->size != elem->size ||
+                packed->type != elem->type || packed->normalized != elem->normalized ||
+                packed->integer != elem->integer) {
+                continue;
+            }
+
+            elem->size = packed->packedSize;
+            elem->type = packed->packedType;
+            elem->normalized = packed->packedNormalized;
+            elem->offset = packed->packedOffset + vertex * (size_t)rec->packedStride;
+            elem->stride = rec->packedStride;
+            buffers[i] = rec->packedBuffer;
+            changed = true;
+            break;
+        }
+    }
+    return changed;
+}
+
+void vertexPackerEndFrame(void) {
+    if (!g_packer.initialized) return;
+    g_packer.frame++;
+
+    freeRetired(false);
+    if (!g_vertexPackerActive || g_packer.count == 0) return;
+
+    size_t uploaded = 0;
+    for (int b = 0; b < VERTEX_PACKER_BUCKETS; b++) {
+        PackedBuffer* rec = g_packer.buckets[b];
+        while (rec) {
+            PackedBuffer* next = rec->next;
+
+            if (rec->state == PACK_CONVERTING) {
+                if (__atomic_load_n(&rec->converted, __ATOMIC_ACQUIRE) &&
+                    uploaded < VERTEX_PACKER_UPLOAD_BUDGET) {
+                    if (rec->packed) {
+                        uploaded += rec->packedSize;
+                        upload(rec);
+                    } else {
+                        // Values outside what the compact formats hold
+                        g_packer.rejected++;
+                        rec->state = PACK_WAITING;
+                        dropBuffer(rec);
+                    }
+                }
+            } else if (rec->state == PACK_WAITING &&
+                       g_packer.frame - rec->frame > VERTEX_PACKER_SOURCE_FRAMES) {
+                // Never drawn through a cached VAO
+                dropBuffer(rec);
+            }
+            rec = next;
+        }
+    }
+}
+
+void vertexPackerGetStats(VertexPackerStats* stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(VertexPackerStats));
+
+    stats->enabled = g_vertexPackerActive;
+    stats->tracked = g_packer.count - g_packer.packed;
+    stats->packed = g_packer.packed;
+    stats->rejected = g_packer.rejected;
+    stats->sourceBytes = g_packer.sourceBytes;
+    stats->originalBytes = g_packer.originalBytes;
+    stats->packedBytes = g_packer.packedBytes;
+}
@@ -0,0 +1,132 @@
+/**
+ * Vertex Packer - Compact attribute formats for static vertex buffers
+ * Static vertex data tends to arrive as 32-bit floats throughout. A copy of
+ * each static upload is kept until a draw shows how it is laid out and what
+ * the shader calls each attribute; a worker then repacks normals to snorm
+ * 10-10-10-2, colors to unorm8 and texture coordinates to half floats where
+ * the values survive it, and cached VAOs read the packed copy instead.
+ */
+
+#ifndef VERTEX_PACKER_H
+#define VERTEX_PACKER_H
+
+#include <GLES3/gl32.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "draw_batcher.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define VERTEX_PACKER_BUCKETS           256     // Tracked buffer buckets (power of two)
+#define VERTEX_PACKER_MAX_BUFFERS       1024    // Static buffers tracked at once
+#define VERTEX_PACKER_MIN_BYTES         4096    // Smaller uploads aren't worth a copy
+#define VERTEX_PACKER_SOURCE_BUDGET     (32 * 1024 * 1024)  // Copies awaiting a draw
+#define VERTEX_PACKER_SOURCE_FRAMES     600     // Frames a copy waits for its first draw
+#define VERTEX_PACKER_UPLOAD_BUDGET     (4 * 1024 * 1024)   // Packed bytes uploaded per frame
+#define VERTEX_PACKER_UV_TOLERANCE      (1.0f / 16384.0f)   // Half float error accepted
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * What the shader reads an attribute as, from its name
+ */
+typedef enum VertexSemantic {
+    VERTEX_SEMANTIC_OTHER = 0,       // Copied as specified
+    VERTEX_SEMANTIC_NORMAL,
+    VERTEX_SEMANTIC_COLOR,
+    VERTEX_SEMANTIC_TEXCOORD
+} VertexSemantic;
+
+/**
+ * Vertex packer statistics
+ */
+typedef struct VertexPackerStats {
+    bool enabled;
+    uint32_t tracked;                // Static buffers awaiting a draw or conversion
+    uint32_t packed;                 // Buffers read through a packed copy
+    uint32_t rejected;               // Layouts or values with nothing to compact
+    size_t sourceBytes;              // Copies held for conversion
+    size_t originalBytes;            // Size of the packed buffers as uploaded
+    size_t packedBytes;              // ... and of their packed copies
+} VertexPackerStats;
+
+// Set while static uploads are tracked, read on the buffer hot path
+extern bool g_vertexPackerActive;
+
+// ============================================================================
+// Vertex Packer API
+// ============================================================================
+
+/**
+ * Initialize the packer and its worker (requires GL context)
+ */
+bool vertexPackerInit(bool enabled);
+
+/**
+ * Wait for the worker and delete packed copies
+ */
+void vertexPackerShutdown(void);
+
+/**
+ * Start or stop packing; stopping returns every VAO to the original buffers
+ */
+void vertexPackerSetEnabled(bool enabled);
+
+/**
+ * Name a shader input for the packer, VERTEX_SEMANTIC_OTHER if unknown
+ */
+VertexSemantic vertexPackerSemantic(const char* name);
+
+/**
+ * Track a glBufferData; static data on GL_ARRAY_BUFFER is copied
+ */
+void vertexPackerBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
+
+/**
+ * Drop the packed copy of the buffer bound to target before a write
+ */
+void vertexPackerBufferWritten(GLenum target);
+
+/**
+ * Forget deleted buffers
+ */
+void vertexPackerForgetBuffers(GLsizei n, const GLuint* buffers);
+
+/**
+ * Learn the layout of tracked buffers from a new VAO setup; semantics are
+ * indexed by attribute
+ */
+void vertexPackerObserve(const VertexFormat* format, const GLuint* buffers,
+                         const uint8_t* semantics);
+
+/**
+ * Point elements of a VAO setup that read packed buffers at the packed
+ * copies; true if any changed
+ */
+bool vertexPackerSubstitute(VertexFormat* format, GLuint* buffers);
+
+/**
+ * Upload finished conversions and expire stale copies (call once per frame)
+ */
+void vertexPackerEndFrame(void);
+
+/**
+ * Get statistics
+ */
+void vertexPackerGetStats(VertexPackerStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VERTEX_PACKER_H
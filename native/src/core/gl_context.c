@@ -48,6 +48,21 @@ static const EGLint DEFAULT_CONFIG_ATTRIBS[] = {
     EGL_ALPHA_SIZE, 8,
     EGL_DEPTH_SIZE, 24,
     EGL_STENCIL_SIZE, 8,
+    EGL_SAMPLE_BUFFERS, 0,
+    EGL_NONE
+};
+
+// Depth and stencil sizes sort ascending, so 0 picks a config without them
+static const EGLint COLOR_ONLY_CONFIG_ATTRIBS[] = {
+    EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
+    EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT,
+    EGL_RED_SIZE, 8,
+    EGL_GREEN_SIZE, 8,
+    EGL_BLUE_SIZE, 8,
+    EGL_ALPHA_SIZE, 8,
+    EGL_DEPTH_SIZE, 0,
+    EGL_STENCIL_SIZE, 0,
+    EGL_SAMPLE_BUFFERS, 0,
     EGL_NONE
 };
 
@@ -67,13 +82,25 @@ void glContextLoadExtensions(void) {
 // Config Selection
 // ============================================================================
 
-EGLConfig glContextChooseConfig(EGLDisplay display, const EGLint* attribs) {
+EGLConfig glContextChooseConfig(EGLDisplay display, bool depthStencil) {
     EGLConfig config;
     EGLint numConfigs;
     
-    const EGLint* configAttribs = attribs ? attribs : DEFAULT_CONFIG_ATTRIBS;
+    // Every byte per pixel left off the window is bandwidth the compositor
+    // and tile writeback don't spend each frame
+    if (!depthStencil) {
+        if (eglChooseConfig(display, COLOR_ONLY_CONFIG_ATTRIBS, &config, 1, &numConfigs) &&
+            numConfigs > 0) {
+            EGLint depth = 0, stencil = 0;
+            eglGetConfigAttrib(display, config, EGL_DEPTH_SIZE, &depth);
+            eglGetConfigAttrib(display, config, EGL_STENCIL_SIZE, &stencil);
+            velocityLogInfo("Window config: color only (depth %d, stencil %d)", depth, stencil);
+            return config;
+        }
+        velocityLogWarn("No color-only EGL config, using depth/stencil");
+    }
     
-    if (!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) || numConfigs == 0) {
+    if (!eglChooseConfig(display, DEFAULT_CONFIG_ATTRIBS, &config, 1, &numConfigs) || numConfigs == 0) {
         velocityLogError("eglChooseConfig failed");
         return NULL;
     }
@@ -3,6 +3,7 @@
  */
 
 #include "gl_wrapper.h"
+#include "../optimize/fb_invalidate.h"
 #include "../utils/log.h"
 
 #include <string.h>
@@ -224,6 +225,7 @@ void glStateInvalidateTextures(void) {
         g_wrapperCtx->state.textureUnits[i].texture2D = 0xFFFFFFFF;
         g_wrapperCtx->state.textureUnits[i].texture3D = 0xFFFFFFFF;
         g_wrapperCtx->state.textureUnits[i].textureCube = 0xFFFFFFFF;
+        g_wrapperCtx->state.textureUnits[i].texture2DArray = 0xFFFFFFFF;
     }
 }
 
@@ -235,3 +237,136 @@ void glStateInvalidateBuffers(void) {
     g_wrapperCtx->state.buffers.uniformBuffer = 0xFFFFFFFF;
     g_wrapperCtx->state.vertexArray = 0xFFFFFFFF;
 }
+
+// ============================================================================
+// Object Deletion
+// ============================================================================
+
+#define UNKNOWN_BINDING 0xFFFFFFFFu
+
+static const GLenum UNIT_TARGETS[] = {
+    GL_TEXTURE_2D, GL_TEXTURE_3D, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_2D_ARRAY
+};
+
+static GLuint* unitBinding(GLTextureUnitState* unit, GLenum target) {
+    switch (target) {
+        case GL_TEXTURE_2D:         return &unit->texture2D;
+        case GL_TEXTURE_3D:         return &unit->texture3D;
+        case GL_TEXTURE_CUBE_MAP:   return &unit->textureCube;
+        case GL_TEXTURE_2D_ARRAY:   return &unit->texture2DArray;
+    }
+    return NULL;
+}
+
+static bool listed(GLuint name, GLsizei n, const GLuint* names) {
+    if (name == 0) return false;
+    for (GLsizei i = 0; i < n; i++) {
+        if (names[i] == name) return true;
+    }
+    return false;
+}
+
+bool glStateUnbindTextures(GLsizei n, const GLuint* textures) {
+    if (!g_wrapperCtx) return false;
+    
+    GLState* state = &g_wrapperCtx->state;
+    if (state->activeTextureUnit < 0 || state->activeTextureUnit >= MAX_TEXTURE_UNITS) return false;
+    
+    for (int u = 0; u < MAX_TEXTURE_UNITS; u++) {
+        for (int t = 0; t < 4; t++) {
+            if (*unitBinding(&state->textureUnits[u], UNIT_TARGETS[t]) == UNKNOWN_BINDING) return false;
+        }
+    }
+    
+    GLint active = state->activeTextureUnit;
+    GLint current = active;
+    for (int u = 0; u < MAX_TEXTURE_UNITS; u++) {
+        for (int t = 0; t < 4; t++) {
+            GLuint* tracked = unitBinding(&state->textureUnits[u], UNIT_TARGETS[t]);
+            if (!listed(*tracked, n, textures)) continue;
+            
+            if (u != current) {
+                glActiveTexture(GL_TEXTURE0 + u);
+                current = u;
+            }
+            glBindTexture(UNIT_TARGETS[t], 0);
+            *tracked = 0;
+        }
+    }
+    if (current != active) glActiveTexture(GL_TEXTURE0 + active);
+    return true;
+}
+
+void glStateUnbindBuffers(GLsizei n, const GLuint* buffers) {
+    static const GLenum TARGETS[][2] = {
+        { GL_ARRAY_BUFFER,              GL_ARRAY_BUFFER_BINDING },
+        { GL_ELEMENT_ARRAY_BUFFER,      GL_ELEMENT_ARRAY_BUFFER_BINDING },
+        { GL_UNIFORM_BUFFER,            GL_UNIFORM_BUFFER_BINDING },
+        { GL_PIXEL_PACK_BUFFER,         GL_PIXEL_PACK_BUFFER_BINDING },
+        { GL_PIXEL_UNPACK_BUFFER,       GL_PIXEL_UNPACK_BUFFER_BINDING },
+        { GL_COPY_READ_BUFFER,          GL_COPY_READ_BUFFER_BINDING },
+        { GL_COPY_WRITE_BUFFER,         GL_COPY_WRITE_BUFFER_BINDING },
+        { GL_SHADER_STORAGE_BUFFER,     GL_SHADER_STORAGE_BUFFER_BINDING },
+        { GL_DRAW_INDIRECT_BUFFER,      GL_DRAW_INDIRECT_BUFFER_BINDING },
+        { GL_DISPATCH_INDIRECT_BUFFER,  GL_DISPATCH_INDIRECT_BUFFER_BINDING },
+    };
+    
+    // Element array binding is VAO state, so always ask the driver
+    for (size_t i = 0; i < sizeof(TARGETS) / sizeof(TARGETS[0]); i++) {
+        GLint bound = 0;
+        glGetIntegerv(TARGETS[i][1], &bound);
+        if (!listed((GLuint)bound, n, buffers)) continue;
+        
+        glBindBuffer(TARGETS[i][0], 0);
+        if (!g_wrapperCtx) continue;
+        
+        GLBufferBindings* tracked = &g_wrapperCtx->state.buffers;
+        switch (TARGETS[i][0]) {
+            case GL_ARRAY_BUFFER:           tracked->arrayBuffer = 0; break;
+            case GL_ELEMENT_ARRAY_BUFFER:   tracked->elementBuffer = 0; break;
+            case GL_UNIFORM_BUFFER:         tracked->uniformBuffer = 0; break;
+        }
+    }
+}
+
+void glStateDetachObjects(GLsizei n, const GLuint* names, bool renderbuffer) {
+    if (!g_wrapperCtx) return;
+    
+    static GLint maxColorAttachments = 0;
+    if (maxColorAttachments == 0) {
+        glGetIntegerv(GL_MAX_COLOR_ATTACHMENTS, &maxColorAttachments);
+        if (maxColorAttachments < 1) maxColorAttachments = 1;
+        if (maxColorAttachments > 8) maxColorAttachments = 8;
+    }
+    
+    const GLFramebufferState* fb = &g_wrapperCtx->state.framebuffer;
+    const GLenum targets[2] = { GL_DRAW_FRAMEBUFFER, GL_READ_FRAMEBUFFER };
+    const GLuint bound[2] = { fb->drawFramebuffer, fb->readFramebuffer };
+    GLint wanted = renderbuffer ? GL_RENDERBUFFER : GL_TEXTURE;
+    
+    for (int t = 0; t < 2; t++) {
+        if (bound[t] == 0 || bound[t] == UNKNOWN_BINDING) continue;
+        if (t == 1 && bound[1] == bound[0]) continue;
+        
+        for (int a = 0; a < maxColorAttachments + 2; a++) {
+            GLenum attachment = a < maxColorAttachments ? GL_COLOR_ATTACHMENT0 + a :
+                                a == maxColorAttachments ? GL_DEPTH_ATTACHMENT :
+                                GL_STENCIL_ATTACHMENT;
+            
+            GLint type = GL_NONE, object = 0;
+            glGetFramebufferAttachmentParameteriv(targets[t], attachment,
+                                                  GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &type);
+            if (type != wanted) continue;
+            glGetFramebufferAttachmentParameteriv(targets[t], attachment,
+                                                  GL_FRAMEBUFFER_ATTACHMENT_OBJECT_NAME, &object);
+            if (!listed((GLuint)object, n, names)) continue;
+            
+            if (renderbuffer) {
+                glFramebufferRenderbuffer(targets[t], attachment, GL_RENDERBUFFER, 0);
+            } else {
+                glFramebufferTexture2D(targets[t], attachment, GL_TEXTURE_2D, 0, 0);
+            }
+            fbInvalidateAttach(bound[t], attachment, 0, renderbuffer);
+        }
+    }
+}
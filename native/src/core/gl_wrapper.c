@@ -7,6 +7,11 @@
 #include "../utils/memory.h"
 #include "../shader/shader_cache.h"
 #include "../gpu/gpu_detect.h"
+#include "../profile/trace.h"
+#include "../profile/frame_stats.h"
+#include "../profile/gpu_timer.h"
+#include "../optimize/frame_pacing.h"
+#include "../optimize/damage_tracker.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -54,7 +59,8 @@ static const GLState DEFAULT_STATE = {
         .dstAlpha = GL_ZERO,
         .modeRGB = GL_FUNC_ADD,
         .modeAlpha = GL_FUNC_ADD,
-        .color = {0.0f, 0.0f, 0.0f, 0.0f}
+        .color = {0.0f, 0.0f, 0.0f, 0.0f},
+        .colorMask = {true, true, true, true}
     },
     
     // Depth
@@ -232,6 +238,17 @@ void glWrapperShutdown(void) {
 // Context Management
 // ============================================================================
 
+static bool createWindowSurface(EGLConfig config) {
+    EGLDisplay display = g_wrapperCtx->eglDisplay;
+    EGLint depthSize = 0;
+    eglGetConfigAttrib(display, config, EGL_DEPTH_SIZE, &depthSize);
+    g_wrapperCtx->windowDepth = depthSize > 0;
+    
+    g_wrapperCtx->eglSurface = eglCreateWindowSurface(display, config, 
+                                                       (EGLNativeWindowType)g_wrapperCtx->nativeWindow, NULL);
+    return g_wrapperCtx->eglSurface != EGL_NO_SURFACE;
+}
+
 bool glWrapperCreateContext(void* nativeWindow, EGLDisplay display) {
     if (!g_wrapperCtx || !g_wrapperCtx->initialized) {
         velocityLogError("Wrapper not initialized");
@@ -246,30 +263,25 @@ bool glWrapperCreateContext(void* nativeWindow, EGLDisplay display) {
     g_wrapperCtx->nativeWindow = nativeWindow;
     g_wrapperCtx->eglDisplay = display;
     
-    // Choose EGL config
-    EGLint configAttribs[] = {
-        EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
-        EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT,
-        EGL_RED_SIZE, 8,
-        EGL_GREEN_SIZE, 8,
-        EGL_BLUE_SIZE, 8,
-        EGL_ALPHA_SIZE, 8,
-        EGL_DEPTH_SIZE, 24,
-        EGL_STENCIL_SIZE, 8,
-        EGL_SAMPLE_BUFFERS, 0,
-        EGL_NONE
-    };
-    
-    EGLint numConfigs;
-    if (!eglChooseConfig(display, configAttribs, &g_wrapperCtx->eglConfig, 1, &numConfigs) || numConfigs == 0) {
+    // Choose EGL configs. The context always takes depth/stencil so the
+    // window can get it back if the scaler never comes up.
+    g_wrapperCtx->eglConfig = glContextChooseConfig(display, true);
+    if (!g_wrapperCtx->eglConfig) {
         velocityLogError("Failed to choose EGL config");
         return false;
     }
     
+    // With the scaler on the scene renders into its target and the window
+    // only receives the upscale, plus declared UI when native UI is
+    // marker-driven. Heuristic UI splits can misfire mid-scene, so they
+    // keep a depth buffer to fall back on.
+    bool windowDepth = !g_wrapperCtx->config.enableDynamicResolution ||
+                       g_wrapperCtx->config.nativeUI == VELOCITY_NATIVE_UI_AUTO;
+    EGLConfig windowConfig = windowDepth ? g_wrapperCtx->eglConfig : glContextChooseConfig(display, false);
+    if (!windowConfig) windowConfig = g_wrapperCtx->eglConfig;
+    
     // Create window surface
-    g_wrapperCtx->eglSurface = eglCreateWindowSurface(display, g_wrapperCtx->eglConfig, 
-                                                       (EGLNativeWindowType)nativeWindow, NULL);
-    if (g_wrapperCtx->eglSurface == EGL_NO_SURFACE) {
+    if (!createWindowSurface(windowConfig)) {
         velocityLogError("Failed to create EGL surface");
         return false;
     }
@@ -304,7 +316,17 @@ bool glWrapperCreateContext(void* nativeWindow, EGLDisplay display) {
         return false;
     }
     
-    // Make current
+    // Make current. Drivers that won't pair a color-only window with the
+    // depth context get the depth window instead.
+    if (!glWrapperMakeCurrent() && windowConfig != g_wrapperCtx->eglConfig) {
+        velocityLogWarn("Color-only window rejected, using depth/stencil");
+        eglDestroySurface(display, g_wrapperCtx->eglSurface);
+        if (!createWindowSurface(g_wrapperCtx->eglConfig)) {
+            velocityLogError("Failed to create EGL surface");
+            eglDestroyContext(display, g_wrapperCtx->eglContext);
+            return false;
+        }
+    }
     if (!glWrapperMakeCurrent()) {
         velocityLogError("Failed to make context current");
         eglDestroyContext(display, g_wrapperCtx->eglContext);
@@ -357,6 +379,30 @@ void glWrapperDestroyContext(void) {
     g_wrapperCtx->contextCurrent = false;
 }
 
+bool glWrapperRequireWindowDepth(void) {
+    if (!g_wrapperCtx || !g_wrapperCtx->contextCurrent) return false;
+    if (g_wrapperCtx->windowDepth) return true;
+    
+    velocityLogWarn("Recreating window surface with depth/stencil");
+    
+    // A window holds one surface at a time; GL objects stay with the context
+    EGLDisplay display = g_wrapperCtx->eglDisplay;
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroySurface(display, g_wrapperCtx->eglSurface);
+    
+    if (!createWindowSurface(g_wrapperCtx->eglConfig)) {
+        velocityLogError("Failed to create EGL surface");
+        g_wrapperCtx->contextCurrent = false;
+        return false;
+    }
+    if (!glWrapperMakeCurrent()) {
+        velocityLogError("Failed to make context current");
+        g_wrapperCtx->contextCurrent = false;
+        return false;
+    }
+    return true;
+}
+
 bool glWrapperMakeCurrent(void) {
     if (!g_wrapperCtx) return false;
     
@@ -369,7 +415,10 @@ bool glWrapperMakeCurrent(void) {
 void glWrapperSwapBuffers(void) {
     if (!g_wrapperCtx || !g_wrapperCtx->contextCurrent) return;
     
-    eglSwapBuffers(g_wrapperCtx->eglDisplay, g_wrapperCtx->eglSurface);
+    TRACE_SCOPE("swap");
+    framePacingBeforeSwap(g_wrapperCtx->eglDisplay, g_wrapperCtx->eglSurface);
+    damageTrackerSwapBuffers(g_wrapperCtx->eglDisplay, g_wrapperCtx->eglSurface);
+    framePacingAfterSwap();
 }
 
 // ============================================================================
@@ -398,6 +447,8 @@ void glWrapperPopState(void) {
 void glWrapperApplyStateDelta(const GLState* newState) {
     if (!g_wrapperCtx || !newState) return;
     
+    TRACE_SCOPE("state_flush");
+    
     GLState* cur = &g_wrapperCtx->state;
     
     // Apply only changed blend state
@@ -479,6 +530,7 @@ void glWrapperRecordDrawCall(int vertices, int instances) {
 }
 
 static uint64_t frameStartTime = 0;
+static uint64_t lastFrameEndTime = 0;
 
 void glWrapperBeginFrame(void) {
     if (!g_wrapperCtx) return;
@@ -504,17 +556,52 @@ void glWrapperEndFrame(void) {
     
     float frameTimeMs = (frameEndTime - frameStartTime) / 1000000.0f;
     g_wrapperCtx->stats.frameTimeMs = frameTimeMs;
-    g_wrapperCtx->stats.currentFPS = 1000.0f / frameTimeMs;
+    g_wrapperCtx->stats.cpuTimeMs = frameTimeMs;
+    
+    // Pacing stats use the frame-to-frame interval, which includes the
+    // time spent outside begin/end (swap, vsync, app logic)
+    if (lastFrameEndTime != 0) {
+        float intervalMs = (frameEndTime - lastFrameEndTime) / 1000000.0f;
+        frameStatsRecord(intervalMs);
+        g_wrapperCtx->stats.currentFPS = intervalMs > 0.0f ? 1000.0f / intervalMs : 0.0f;
+    }
+    lastFrameEndTime = frameEndTime;
+    
+    // Average FPS is frames over time (1000 / mean frame time), never the
+    // mean of per-frame FPS values
+    FrameStatsSummary summary;
+    frameStatsGetSummary(&summary);
+    
+    VelocityStats* stats = &g_wrapperCtx->stats;
+    stats->avgFPS = summary.meanMs > 0.0f ? 1000.0f / summary.meanMs : 0.0f;
+    stats->frameTimeP50Ms = summary.p50Ms;
+    stats->frameTimeP90Ms = summary.p90Ms;
+    stats->frameTimeP99Ms = summary.p99Ms;
+    stats->frameTimeP999Ms = summary.p999Ms;
+    stats->onePercentLowFPS = summary.onePercentLowFPS;
+    stats->stutterCount = summary.totalStutters;
+    
+    // GPU time lags a few frames behind: results are read without stalling
+    GpuTimerStats gpu;
+    gpuTimerGetStats(&gpu);
+    stats->gpuTimeMs = gpu.frameTimeMs;
+}
+
+void glWrapperPublishStats(void) {
+    if (!g_wrapperCtx) return;
     
-    // Rolling average FPS
-    static float fpsHistory[60] = {0};
-    static int fpsIndex = 0;
-    fpsHistory[fpsIndex] = g_wrapperCtx->stats.currentFPS;
-    fpsIndex = (fpsIndex + 1) % 60;
+    seqlockPublish(&g_wrapperCtx->statsLock, &g_wrapperCtx->publishedStats,
+                   &g_wrapperCtx->stats, sizeof(VelocityStats));
+}
+
+void glWrapperReadStats(VelocityStats* out) {
+    if (!out) return;
     
-    float sum = 0;
-    for (int i = 0; i < 60; i++) {
-        sum += fpsHistory[i];
+    if (!g_wrapperCtx) {
+        memset(out, 0, sizeof(VelocityStats));
+        return;
     }
-    g_wrapperCtx->stats.avgFPS = sum / 60.0f;
+    
+    seqlockRead(&g_wrapperCtx->statsLock, out, &g_wrapperCtx->publishedStats,
+                sizeof(VelocityStats));
 }
@@ -14,6 +14,7 @@
 #include <stdint.h>
 
 #include "velocity_gl.h"
+#include "../utils/seqlock.h"
 
 // ============================================================================
 // Internal Macros
@@ -51,6 +52,7 @@ typedef struct GLBlendState {
     GLenum modeRGB;
     GLenum modeAlpha;
     float color[4];
+    bool colorMask[4];
 } GLBlendState;
 
 /**
@@ -209,14 +211,17 @@ typedef struct GLWrapperContext {
     VelocityConfig config;
     VelocityGPUCaps gpuCaps;
     
-    // Statistics
+    // Statistics (stats is render-thread private, readers use publishedStats)
     VelocityStats stats;
+    VelocityStats publishedStats;
+    SeqLock statsLock;
     
     // EGL handles
     EGLDisplay eglDisplay;
     EGLSurface eglSurface;
     EGLContext eglContext;
     EGLConfig eglConfig;
+    bool windowDepth;   // Window surface has depth/stencil
     
     // Native window
     void* nativeWindow;
@@ -251,11 +256,23 @@ void glWrapperShutdown(void);
  */
 bool glWrapperCreateContext(void* nativeWindow, EGLDisplay display);
 
+/**
+ * Choose a window config, without depth/stencil when nothing renders
+ * depth into the window
+ */
+EGLConfig glContextChooseConfig(EGLDisplay display, bool depthStencil);
+
 /**
  * Destroy EGL context
  */
 void glWrapperDestroyContext(void);
 
+/**
+ * Give the window surface depth/stencil if it was created without.
+ * Needed when no scaler target takes the scene.
+ */
+bool glWrapperRequireWindowDepth(void);
+
 /**
  * Make context current
  */
@@ -300,6 +317,22 @@ void glWrapperPopState(void);
  */
 void glWrapperApplyStateDelta(const GLState* newState);
 
+/**
+ * Unbind textures from every unit, false (nothing changed) if tracked
+ * bindings are unknown
+ */
+bool glStateUnbindTextures(GLsizei n, const GLuint* textures);
+
+/**
+ * Unbind buffers from the generic binding points
+ */
+void glStateUnbindBuffers(GLsizei n, const GLuint* buffers);
+
+/**
+ * Detach textures or renderbuffers from the bound framebuffers
+ */
+void glStateDetachObjects(GLsizei n, const GLuint* names, bool renderbuffer);
+
 // ============================================================================
 // Statistics
 // ============================================================================
@@ -319,4 +352,14 @@ void glWrapperBeginFrame(void);
  */
 void glWrapperEndFrame(void);
 
+/**
+ * Publish stats for other threads (render thread, once per frame)
+ */
+void glWrapperPublishStats(void);
+
+/**
+ * Read the last published stats snapshot (any thread)
+ */
+void glWrapperReadStats(VelocityStats* out);
+
 #endif // GL_WRAPPER_H
@@ -5,10 +5,29 @@
 #include "gl_functions.h"
 #include "../core/gl_wrapper.h"
 #include "../buffer/draw_batcher.h"
+#include "../buffer/readback.h"
+#include "../buffer/vao_cache.h"
+#include "../buffer/vertex_packer.h"
 #include "../shader/shader_cache.h"
 #include "../texture/texture_manager.h"
+#include "../texture/storage_pool.h"
+#include "../optimize/frame_throttle.h"
+#include "../optimize/fence_timeline.h"
+#include "../optimize/name_pool.h"
+#include "../optimize/resolution_scaler.h"
+#include "../optimize/rt_scaler.h"
+#include "../optimize/fb_invalidate.h"
+#include "../optimize/render_pass.h"
+#include "../optimize/damage_tracker.h"
+#include "../optimize/frame_idle.h"
+#include "../optimize/ui_split.h"
+#include "../profile/call_profiler.h"
+#include "../profile/trace.h"
+#include "../profile/gpu_timer.h"
+#include "../profile/flight_recorder.h"
 #include "../utils/log.h"
 
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -23,6 +42,11 @@ typedef struct GLFunctionEntry {
 
 // Forward declarations
 static void registerFunctions(void);
+static void beforeDraw(void);
+static void beforeUnbatchedDraw(void);
+static void flushPendingClear(void);
+static void flushPasses(void);
+static void issueClear(GLbitfield mask);
 
 static GLFunctionEntry* g_functionTable = NULL;
 static int g_functionCount = 0;
@@ -59,6 +83,17 @@ void glFunctionsShutdown(void) {
     }
 }
 
+static bool readsFramebuffer(const char* name) {
+    static const char* const PREFIXES[] = {
+        "glDraw", "glMultiDraw", "glClear", "glFramebuffer", "glReadnPixels",
+        "glBlitFramebuffer", "glInvalidate", "glDiscardFramebuffer"
+    };
+    for (size_t i = 0; i < sizeof(PREFIXES) / sizeof(PREFIXES[0]); i++) {
+        if (strncmp(name, PREFIXES[i], strlen(PREFIXES[i])) == 0) return true;
+    }
+    return false;
+}
+
 void* glFunctionsGetProc(const char* name) {
     if (!name) return NULL;
     
@@ -69,8 +104,46 @@ void* glFunctionsGetProc(const char* name) {
         }
     }
     
-    // Fall back to native
-    return (void*)eglGetProcAddress(name);
+    // Fall back to native. A call reading the bound framebuffer would miss
+    // deferred binds and clears, so deferral ends once one is handed out.
+    void* proc = (void*)eglGetProcAddress(name);
+    if (proc && readsFramebuffer(name)) {
+        velocityLogWarn("%s is not wrapped", name);
+        renderPassHold();
+    }
+    return proc;
+}
+
+// ============================================================================
+// Frame Fingerprint
+// ============================================================================
+
+// Fold an entry point's arguments into the identical-frame fingerprint
+#define IDLE_HASH(name, ...) do { \
+    const uint64_t idleArgs[] = { __VA_ARGS__ }; \
+    frameIdleHash(PROFILE_CALL_##name, idleArgs, sizeof(idleArgs)); \
+} while (0)
+
+#define IDLE_PTR(p) ((uint64_t)(uintptr_t)(p))
+
+static inline void idleHashArray(uint32_t call, const void* values, GLsizei count, size_t elementSize) {
+    if (values && count > 0) frameIdleHash(call, values, (size_t)count * elementSize);
+}
+
+// Uniform, attribute and clear values are part of the frame
+static inline void idleHashValues(uint32_t call, GLint key, GLsizei count,
+                                  const void* value, size_t elementSize) {
+    uint64_t args[2] = { (uint64_t)key, (uint64_t)count };
+    frameIdleHash(call, args, sizeof(args));
+    idleHashArray(call, value, count, elementSize);
+}
+
+// Client-side indices live in app memory the fingerprint can't follow
+static inline void idleCheckIndices(void) {
+    if (g_wrapperCtx && g_wrapperCtx->state.vertexArray == 0 &&
+        g_wrapperCtx->state.buffers.elementBuffer == 0) {
+        frameIdleChanged();
+    }
 }
 
 // ============================================================================
@@ -78,10 +151,13 @@ void* glFunctionsGetProc(const char* name) {
 // ============================================================================
 
 void vglDrawArrays(GLenum mode, GLint first, GLsizei count) {
+    PROFILE_CALL(DrawArrays);
+    IDLE_HASH(DrawArrays, mode, first, count);
+    beforeDraw();
     if (g_wrapperCtx && g_wrapperCtx->config.enableDrawBatching) {
         drawBatcherDrawArrays(mode, first, count);
     } else {
-        glDrawArrays(mode, first, count);
+        PROFILE_DRIVER(glDrawArrays(mode, first, count));
         if (g_wrapperCtx) {
             g_wrapperCtx->stats.drawCalls++;
             g_wrapperCtx->stats.triangles += count / 3;
@@ -90,10 +166,14 @@ void vglDrawArrays(GLenum mode, GLint first, GLsizei count) {
 }
 
 void vglDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) {
+    PROFILE_CALL(DrawElements);
+    IDLE_HASH(DrawElements, mode, count, type, IDLE_PTR(indices));
+    idleCheckIndices();
+    beforeDraw();
     if (g_wrapperCtx && g_wrapperCtx->config.enableDrawBatching) {
         drawBatcherDrawElements(mode, count, type, indices);
     } else {
-        glDrawElements(mode, count, type, indices);
+        PROFILE_DRIVER(glDrawElements(mode, count, type, indices));
         if (g_wrapperCtx) {
             g_wrapperCtx->stats.drawCalls++;
             g_wrapperCtx->stats.triangles += count / 3;
@@ -102,10 +182,13 @@ void vglDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indice
 }
 
 void vglDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount) {
+    PROFILE_CALL(DrawArraysInstanced);
+    IDLE_HASH(DrawArraysInstanced, mode, first, count, instancecount);
+    beforeDraw();
     if (g_wrapperCtx && g_wrapperCtx->config.enableDrawBatching) {
         drawBatcherDrawArraysInstanced(mode, first, count, instancecount);
     } else {
-        glDrawArraysInstanced(mode, first, count, instancecount);
+        PROFILE_DRIVER(glDrawArraysInstanced(mode, first, count, instancecount));
         if (g_wrapperCtx) {
             g_wrapperCtx->stats.drawCalls++;
             g_wrapperCtx->stats.triangles += (count / 3) * instancecount;
@@ -115,7 +198,11 @@ void vglDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei ins
 
 void vglDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, 
                                const void* indices, GLsizei instancecount) {
-    glDrawElementsInstanced(mode, count, type, indices, instancecount);
+    PROFILE_CALL(DrawElementsInstanced);
+    IDLE_HASH(DrawElementsInstanced, mode, count, type, IDLE_PTR(indices), instancecount);
+    idleCheckIndices();
+    beforeUnbatchedDraw();
+    PROFILE_DRIVER(glDrawElementsInstanced(mode, count, type, indices, instancecount));
     if (g_wrapperCtx) {
         g_wrapperCtx->stats.drawCalls++;
         g_wrapperCtx->stats.triangles += (count / 3) * instancecount;
@@ -123,9 +210,14 @@ void vglDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type,
 }
 
 void vglMultiDrawArrays(GLenum mode, const GLint* first, const GLsizei* count, GLsizei drawcount) {
+    PROFILE_CALL(MultiDrawArrays);
+    IDLE_HASH(MultiDrawArrays, mode, drawcount);
+    idleHashArray(PROFILE_CALL_MultiDrawArrays, first, drawcount, sizeof(GLint));
+    idleHashArray(PROFILE_CALL_MultiDrawArrays, count, drawcount, sizeof(GLsizei));
+    beforeUnbatchedDraw();
     // OpenGL ES doesn't have glMultiDrawArrays, emulate it
     for (GLsizei i = 0; i < drawcount; i++) {
-        glDrawArrays(mode, first[i], count[i]);
+        PROFILE_DRIVER(glDrawArrays(mode, first[i], count[i]));
     }
     if (g_wrapperCtx) {
         g_wrapperCtx->stats.drawCalls += drawcount;
@@ -134,9 +226,15 @@ void vglMultiDrawArrays(GLenum mode, const GLint* first, const GLsizei* count, G
 
 void vglMultiDrawElements(GLenum mode, const GLsizei* count, GLenum type, 
                            const void* const* indices, GLsizei drawcount) {
+    PROFILE_CALL(MultiDrawElements);
+    IDLE_HASH(MultiDrawElements, mode, type, drawcount);
+    idleHashArray(PROFILE_CALL_MultiDrawElements, count, drawcount, sizeof(GLsizei));
+    idleHashArray(PROFILE_CALL_MultiDrawElements, indices, drawcount, sizeof(const void*));
+    idleCheckIndices();
+    beforeUnbatchedDraw();
     // OpenGL ES doesn't have glMultiDrawElements, emulate it
     for (GLsizei i = 0; i < drawcount; i++) {
-        glDrawElements(mode, count[i], type, indices[i]);
+        PROFILE_DRIVER(glDrawElements(mode, count[i], type, indices[i]));
     }
     if (g_wrapperCtx) {
         g_wrapperCtx->stats.drawCalls += drawcount;
@@ -145,87 +243,185 @@ void vglMultiDrawElements(GLenum mode, const GLsizei* count, GLenum type,
 
 void vglDrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei count, 
                            GLenum type, const void* indices) {
+    PROFILE_CALL(DrawRangeElements);
+    IDLE_HASH(DrawRangeElements, mode, start, end, count, type, IDLE_PTR(indices));
+    idleCheckIndices();
+    beforeUnbatchedDraw();
     // OpenGL ES 3.0 has glDrawRangeElements
-    glDrawRangeElements(mode, start, end, count, type, indices);
+    PROFILE_DRIVER(glDrawRangeElements(mode, start, end, count, type, indices));
+    if (g_wrapperCtx) {
+        g_wrapperCtx->stats.drawCalls++;
+        g_wrapperCtx->stats.triangles += count / 3;
+    }
+}
+
+void vglDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices,
+                               GLint basevertex) {
+    PROFILE_CALL(DrawElementsBaseVertex);
+    IDLE_HASH(DrawElementsBaseVertex, mode, count, type, IDLE_PTR(indices), (uint64_t)basevertex);
+    idleCheckIndices();
+    beforeUnbatchedDraw();
+    PROFILE_DRIVER(glDrawElementsBaseVertex(mode, count, type, indices, basevertex));
+    if (g_wrapperCtx) {
+        g_wrapperCtx->stats.drawCalls++;
+        g_wrapperCtx->stats.triangles += count / 3;
+    }
+}
+
+void vglDrawRangeElementsBaseVertex(GLenum mode, GLuint start, GLuint end, GLsizei count,
+                                    GLenum type, const void* indices, GLint basevertex) {
+    PROFILE_CALL(DrawRangeElementsBaseVertex);
+    IDLE_HASH(DrawRangeElementsBaseVertex, mode, start, end, count, type, IDLE_PTR(indices),
+              (uint64_t)basevertex);
+    idleCheckIndices();
+    beforeUnbatchedDraw();
+    PROFILE_DRIVER(glDrawRangeElementsBaseVertex(mode, start, end, count, type, indices, basevertex));
     if (g_wrapperCtx) {
         g_wrapperCtx->stats.drawCalls++;
         g_wrapperCtx->stats.triangles += count / 3;
     }
 }
 
+void vglDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices,
+                                        GLsizei instancecount, GLint basevertex) {
+    PROFILE_CALL(DrawElementsInstancedBaseVertex);
+    IDLE_HASH(DrawElementsInstancedBaseVertex, mode, count, type, IDLE_PTR(indices),
+              instancecount, (uint64_t)basevertex);
+    idleCheckIndices();
+    beforeUnbatchedDraw();
+    PROFILE_DRIVER(glDrawElementsInstancedBaseVertex(mode, count, type, indices, instancecount,
+                                                     basevertex));
+    if (g_wrapperCtx) {
+        g_wrapperCtx->stats.drawCalls++;
+        g_wrapperCtx->stats.triangles += (count / 3) * instancecount;
+    }
+}
+
+// Commands read from a buffer the fingerprint can't follow
+void vglDrawArraysIndirect(GLenum mode, const void* indirect) {
+    PROFILE_CALL(DrawArraysIndirect);
+    frameIdleChanged();
+    beforeUnbatchedDraw();
+    PROFILE_DRIVER(glDrawArraysIndirect(mode, indirect));
+    if (g_wrapperCtx) {
+        g_wrapperCtx->stats.drawCalls++;
+    }
+}
+
+void vglDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect) {
+    PROFILE_CALL(DrawElementsIndirect);
+    frameIdleChanged();
+    beforeUnbatchedDraw();
+    PROFILE_DRIVER(glDrawElementsIndirect(mode, type, indirect));
+    if (g_wrapperCtx) {
+        g_wrapperCtx->stats.drawCalls++;
+    }
+}
+
 // ============================================================================
 // Shader Operations
 // ============================================================================
 
 GLuint vglCreateShader(GLenum type) {
-    return glCreateShader(type);
+    PROFILE_CALL(CreateShader);
+    GLuint result;
+    PROFILE_DRIVER(result = glCreateShader(type));
+    return result;
 }
 
 void vglShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length) {
+    PROFILE_CALL(ShaderSource);
     // Could translate GLSL here if needed
-    glShaderSource(shader, count, string, length);
+    PROFILE_DRIVER(glShaderSource(shader, count, string, length));
 }
 
 void vglCompileShader(GLuint shader) {
-    glCompileShader(shader);
+    PROFILE_CALL(CompileShader);
+    TRACE_SCOPE("shader_compile");
+    FLIGHT_SCOPE(FLIGHT_EVENT_SHADER_COMPILE, shader);
+    PROFILE_DRIVER(glCompileShader(shader));
     
     // Check for errors
     GLint success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    PROFILE_DRIVER(glGetShaderiv(shader, GL_COMPILE_STATUS, &success));
     if (!success) {
         char log[1024];
-        glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        PROFILE_DRIVER(glGetShaderInfoLog(shader, sizeof(log), NULL, log));
         velocityLogError("Shader compilation failed: %s", log);
     }
 }
 
 void vglDeleteShader(GLuint shader) {
-    glDeleteShader(shader);
+    PROFILE_CALL(DeleteShader);
+    PROFILE_DRIVER(glDeleteShader(shader));
 }
 
 GLuint vglCreateProgram(void) {
-    return glCreateProgram();
+    PROFILE_CALL(CreateProgram);
+    GLuint result;
+    PROFILE_DRIVER(result = glCreateProgram());
+    return result;
 }
 
 void vglAttachShader(GLuint program, GLuint shader) {
-    glAttachShader(program, shader);
+    PROFILE_CALL(AttachShader);
+    PROFILE_DRIVER(glAttachShader(program, shader));
 }
 
 void vglDetachShader(GLuint program, GLuint shader) {
-    glDetachShader(program, shader);
+    PROFILE_CALL(DetachShader);
+    PROFILE_DRIVER(glDetachShader(program, shader));
 }
 
 void vglLinkProgram(GLuint program) {
-    glLinkProgram(program);
+    PROFILE_CALL(LinkProgram);
+    TRACE_SCOPE("shader_link");
+    FLIGHT_SCOPE(FLIGHT_EVENT_SHADER_LINK, program);
+    frameIdleChanged();
+    PROFILE_DRIVER(glLinkProgram(program));
     
     GLint success;
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    PROFILE_DRIVER(glGetProgramiv(program, GL_LINK_STATUS, &success));
     if (!success) {
         char log[1024];
-        glGetProgramInfoLog(program, sizeof(log), NULL, log);
+        PROFILE_DRIVER(glGetProgramInfoLog(program, sizeof(log), NULL, log));
         velocityLogError("Program linking failed: %s", log);
     }
+    
+    // Active attributes may have changed
+    if (g_vaoCacheActive) vaoCacheForgetProgram(program);
 }
 
 void vglUseProgram(GLuint program) {
+    PROFILE_CALL(UseProgram);
+    FLIGHT_COUNT(FLIGHT_EVENT_STATE_CHANGE);
+    IDLE_HASH(UseProgram, program);
     // Track state
     if (g_wrapperCtx) {
         g_wrapperCtx->state.currentProgram = program;
     }
-    glUseProgram(program);
+    PROFILE_DRIVER(glUseProgram(program));
 }
 
 void vglDeleteProgram(GLuint program) {
-    glDeleteProgram(program);
+    PROFILE_CALL(DeleteProgram);
+    IDLE_HASH(DeleteProgram, program);
+    uiSplitForgetProgram(program);
+    if (g_vaoCacheActive) vaoCacheForgetProgram(program);
+    PROFILE_DRIVER(glDeleteProgram(program));
 }
 
 void vglGetProgramBinary(GLuint program, GLsizei bufSize, GLsizei* length, 
                           GLenum* binaryFormat, void* binary) {
-    glGetProgramBinary(program, bufSize, length, binaryFormat, binary);
+    PROFILE_CALL(GetProgramBinary);
+    PROFILE_DRIVER(glGetProgramBinary(program, bufSize, length, binaryFormat, binary));
 }
 
 void vglProgramBinary(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length) {
-    glProgramBinary(program, binaryFormat, binary, length);
+    PROFILE_CALL(ProgramBinary);
+    frameIdleChanged();
+    PROFILE_DRIVER(glProgramBinary(program, binaryFormat, binary, length));
+    if (g_vaoCacheActive) vaoCacheForgetProgram(program);
 }
 
 // ============================================================================
@@ -233,40 +429,288 @@ void vglProgramBinary(GLuint program, GLenum binaryFormat, const void* binary, G
 // ============================================================================
 
 void vglUniform1i(GLint location, GLint v0) {
-    glUniform1i(location, v0);
+    PROFILE_CALL(Uniform1i);
+    IDLE_HASH(Uniform1i, location, v0);
+    PROFILE_DRIVER(glUniform1i(location, v0));
 }
 
 void vglUniform1f(GLint location, GLfloat v0) {
-    glUniform1f(location, v0);
+    PROFILE_CALL(Uniform1f);
+    IDLE_HASH(Uniform1f, location, frameIdleBits(v0));
+    PROFILE_DRIVER(glUniform1f(location, v0));
 }
 
 void vglUniform2f(GLint location, GLfloat v0, GLfloat v1) {
-    glUniform2f(location, v0, v1);
+    PROFILE_CALL(Uniform2f);
+    IDLE_HASH(Uniform2f, location, frameIdleBits(v0), frameIdleBits(v1));
+    PROFILE_DRIVER(glUniform2f(location, v0, v1));
 }
 
 void vglUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2) {
-    glUniform3f(location, v0, v1, v2);
+    PROFILE_CALL(Uniform3f);
+    IDLE_HASH(Uniform3f, location, frameIdleBits(v0), frameIdleBits(v1), frameIdleBits(v2));
+    PROFILE_DRIVER(glUniform3f(location, v0, v1, v2));
 }
 
 void vglUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) {
-    glUniform4f(location, v0, v1, v2, v3);
+    PROFILE_CALL(Uniform4f);
+    IDLE_HASH(Uniform4f, location, frameIdleBits(v0), frameIdleBits(v1), frameIdleBits(v2), frameIdleBits(v3));
+    PROFILE_DRIVER(glUniform4f(location, v0, v1, v2, v3));
 }
 
 void vglUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
-    glUniformMatrix4fv(location, count, transpose, value);
+    PROFILE_CALL(UniformMatrix4fv);
+    idleHashValues(PROFILE_CALL_UniformMatrix4fv, location, count, value, 16 * sizeof(GLfloat));
+    IDLE_HASH(UniformMatrix4fv, transpose);
+    if (g_wrapperCtx) {
+        uiSplitNoteMatrix(g_wrapperCtx->state.currentProgram, value, count, transpose == GL_TRUE);
+    }
+    PROFILE_DRIVER(glUniformMatrix4fv(location, count, transpose, value));
+}
+
+void vglUniform2i(GLint location, GLint v0, GLint v1) {
+    PROFILE_CALL(Uniform2i);
+    IDLE_HASH(Uniform2i, location, v0, v1);
+    PROFILE_DRIVER(glUniform2i(location, v0, v1));
+}
+
+void vglUniform3i(GLint location, GLint v0, GLint v1, GLint v2) {
+    PROFILE_CALL(Uniform3i);
+    IDLE_HASH(Uniform3i, location, v0, v1, v2);
+    PROFILE_DRIVER(glUniform3i(location, v0, v1, v2));
+}
+
+void vglUniform4i(GLint location, GLint v0, GLint v1, GLint v2, GLint v3) {
+    PROFILE_CALL(Uniform4i);
+    IDLE_HASH(Uniform4i, location, v0, v1, v2, v3);
+    PROFILE_DRIVER(glUniform4i(location, v0, v1, v2, v3));
+}
+
+void vglUniform1iv(GLint location, GLsizei count, const GLint* value) {
+    PROFILE_CALL(Uniform1iv);
+    idleHashValues(PROFILE_CALL_Uniform1iv, location, count, value, 1 * sizeof(GLint));
+    PROFILE_DRIVER(glUniform1iv(location, count, value));
+}
+
+void vglUniform2iv(GLint location, GLsizei count, const GLint* value) {
+    PROFILE_CALL(Uniform2iv);
+    idleHashValues(PROFILE_CALL_Uniform2iv, location, count, value, 2 * sizeof(GLint));
+    PROFILE_DRIVER(glUniform2iv(location, count, value));
+}
+
+void vglUniform3iv(GLint location, GLsizei count, const GLint* value) {
+    PROFILE_CALL(Uniform3iv);
+    idleHashValues(PROFILE_CALL_Uniform3iv, location, count, value, 3 * sizeof(GLint));
+    PROFILE_DRIVER(glUniform3iv(location, count, value));
+}
+
+void vglUniform4iv(GLint location, GLsizei count, const GLint* value) {
+    PROFILE_CALL(Uniform4iv);
+    idleHashValues(PROFILE_CALL_Uniform4iv, location, count, value, 4 * sizeof(GLint));
+    PROFILE_DRIVER(glUniform4iv(location, count, value));
+}
+
+void vglUniform1fv(GLint location, GLsizei count, const GLfloat* value) {
+    PROFILE_CALL(Uniform1fv);
+    idleHashValues(PROFILE_CALL_Uniform1fv, location, count, value, 1 * sizeof(GLfloat));
+    PROFILE_DRIVER(glUniform1fv(location, count, value));
+}
+
+void vglUniform2fv(GLint location, GLsizei count, const GLfloat* value) {
+    PROFILE_CALL(Uniform2fv);
+    idleHashValues(PROFILE_CALL_Uniform2fv, location, count, value, 2 * sizeof(GLfloat));
+    PROFILE_DRIVER(glUniform2fv(location, count, value));
+}
+
+void vglUniform3fv(GLint location, GLsizei count, const GLfloat* value) {
+    PROFILE_CALL(Uniform3fv);
+    idleHashValues(PROFILE_CALL_Uniform3fv, location, count, value, 3 * sizeof(GLfloat));
+    PROFILE_DRIVER(glUniform3fv(location, count, value));
+}
+
+void vglUniform4fv(GLint location, GLsizei count, const GLfloat* value) {
+    PROFILE_CALL(Uniform4fv);
+    idleHashValues(PROFILE_CALL_Uniform4fv, location, count, value, 4 * sizeof(GLfloat));
+    PROFILE_DRIVER(glUniform4fv(location, count, value));
+}
+
+void vglUniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    PROFILE_CALL(UniformMatrix2fv);
+    idleHashValues(PROFILE_CALL_UniformMatrix2fv, location, count, value, 4 * sizeof(GLfloat));
+    IDLE_HASH(UniformMatrix2fv, transpose);
+    PROFILE_DRIVER(glUniformMatrix2fv(location, count, transpose, value));
+}
+
+void vglUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    PROFILE_CALL(UniformMatrix3fv);
+    idleHashValues(PROFILE_CALL_UniformMatrix3fv, location, count, value, 9 * sizeof(GLfloat));
+    IDLE_HASH(UniformMatrix3fv, transpose);
+    PROFILE_DRIVER(glUniformMatrix3fv(location, count, transpose, value));
+}
+
+void vglUniformMatrix2x3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    PROFILE_CALL(UniformMatrix2x3fv);
+    idleHashValues(PROFILE_CALL_UniformMatrix2x3fv, location, count, value, 6 * sizeof(GLfloat));
+    IDLE_HASH(UniformMatrix2x3fv, transpose);
+    PROFILE_DRIVER(glUniformMatrix2x3fv(location, count, transpose, value));
+}
+
+void vglUniformMatrix3x2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    PROFILE_CALL(UniformMatrix3x2fv);
+    idleHashValues(PROFILE_CALL_UniformMatrix3x2fv, location, count, value, 6 * sizeof(GLfloat));
+    IDLE_HASH(UniformMatrix3x2fv, transpose);
+    PROFILE_DRIVER(glUniformMatrix3x2fv(location, count, transpose, value));
+}
+
+void vglUniformMatrix2x4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    PROFILE_CALL(UniformMatrix2x4fv);
+    idleHashValues(PROFILE_CALL_UniformMatrix2x4fv, location, count, value, 8 * sizeof(GLfloat));
+    IDLE_HASH(UniformMatrix2x4fv, transpose);
+    PROFILE_DRIVER(glUniformMatrix2x4fv(location, count, transpose, value));
+}
+
+void vglUniformMatrix4x2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    PROFILE_CALL(UniformMatrix4x2fv);
+    idleHashValues(PROFILE_CALL_UniformMatrix4x2fv, location, count, value, 8 * sizeof(GLfloat));
+    IDLE_HASH(UniformMatrix4x2fv, transpose);
+    PROFILE_DRIVER(glUniformMatrix4x2fv(location, count, transpose, value));
+}
+
+void vglUniformMatrix3x4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    PROFILE_CALL(UniformMatrix3x4fv);
+    idleHashValues(PROFILE_CALL_UniformMatrix3x4fv, location, count, value, 12 * sizeof(GLfloat));
+    IDLE_HASH(UniformMatrix3x4fv, transpose);
+    PROFILE_DRIVER(glUniformMatrix3x4fv(location, count, transpose, value));
+}
+
+void vglUniformMatrix4x3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    PROFILE_CALL(UniformMatrix4x3fv);
+    idleHashValues(PROFILE_CALL_UniformMatrix4x3fv, location, count, value, 12 * sizeof(GLfloat));
+    IDLE_HASH(UniformMatrix4x3fv, transpose);
+    PROFILE_DRIVER(glUniformMatrix4x3fv(location, count, transpose, value));
+}
+
+void vglUniform1ui(GLint location, GLuint v0) {
+    PROFILE_CALL(Uniform1ui);
+    IDLE_HASH(Uniform1ui, location, v0);
+    PROFILE_DRIVER(glUniform1ui(location, v0));
+}
+
+void vglUniform2ui(GLint location, GLuint v0, GLuint v1) {
+    PROFILE_CALL(Uniform2ui);
+    IDLE_HASH(Uniform2ui, location, v0, v1);
+    PROFILE_DRIVER(glUniform2ui(location, v0, v1));
+}
+
+void vglUniform3ui(GLint location, GLuint v0, GLuint v1, GLuint v2) {
+    PROFILE_CALL(Uniform3ui);
+    IDLE_HASH(Uniform3ui, location, v0, v1, v2);
+    PROFILE_DRIVER(glUniform3ui(location, v0, v1, v2));
+}
+
+void vglUniform4ui(GLint location, GLuint v0, GLuint v1, GLuint v2, GLuint v3) {
+    PROFILE_CALL(Uniform4ui);
+    IDLE_HASH(Uniform4ui, location, v0, v1, v2, v3);
+    PROFILE_DRIVER(glUniform4ui(location, v0, v1, v2, v3));
+}
+
+void vglUniform1uiv(GLint location, GLsizei count, const GLuint* value) {
+    PROFILE_CALL(Uniform1uiv);
+    idleHashValues(PROFILE_CALL_Uniform1uiv, location, count, value, 1 * sizeof(GLuint));
+    PROFILE_DRIVER(glUniform1uiv(location, count, value));
+}
+
+void vglUniform2uiv(GLint location, GLsizei count, const GLuint* value) {
+    PROFILE_CALL(Uniform2uiv);
+    idleHashValues(PROFILE_CALL_Uniform2uiv, location, count, value, 2 * sizeof(GLuint));
+    PROFILE_DRIVER(glUniform2uiv(location, count, value));
+}
+
+void vglUniform3uiv(GLint location, GLsizei count, const GLuint* value) {
+    PROFILE_CALL(Uniform3uiv);
+    idleHashValues(PROFILE_CALL_Uniform3uiv, location, count, value, 3 * sizeof(GLuint));
+    PROFILE_DRIVER(glUniform3uiv(location, count, value));
+}
+
+void vglUniform4uiv(GLint location, GLsizei count, const GLuint* value) {
+    PROFILE_CALL(Uniform4uiv);
+    idleHashValues(PROFILE_CALL_Uniform4uiv, location, count, value, 4 * sizeof(GLuint));
+    PROFILE_DRIVER(glUniform4uiv(location, count, value));
+}
+
+// Separable programs: the program joins the key since it needn't be current
+
+void vglProgramUniform1i(GLuint program, GLint location, GLint v0) {
+    PROFILE_CALL(ProgramUniform1i);
+    IDLE_HASH(ProgramUniform1i, program, location, v0);
+    PROFILE_DRIVER(glProgramUniform1i(program, location, v0));
+}
+
+void vglProgramUniform1f(GLuint program, GLint location, GLfloat v0) {
+    PROFILE_CALL(ProgramUniform1f);
+    IDLE_HASH(ProgramUniform1f, program, location, frameIdleBits(v0));
+    PROFILE_DRIVER(glProgramUniform1f(program, location, v0));
+}
+
+void vglProgramUniform4fv(GLuint program, GLint location, GLsizei count, const GLfloat* value) {
+    PROFILE_CALL(ProgramUniform4fv);
+    idleHashValues(PROFILE_CALL_ProgramUniform4fv, location, count, value, 4 * sizeof(GLfloat));
+    IDLE_HASH(ProgramUniform4fv, program);
+    PROFILE_DRIVER(glProgramUniform4fv(program, location, count, value));
+}
+
+void vglProgramUniformMatrix4fv(GLuint program, GLint location, GLsizei count,
+                                GLboolean transpose, const GLfloat* value) {
+    PROFILE_CALL(ProgramUniformMatrix4fv);
+    idleHashValues(PROFILE_CALL_ProgramUniformMatrix4fv, location, count, value, 16 * sizeof(GLfloat));
+    IDLE_HASH(ProgramUniformMatrix4fv, program, transpose);
+    uiSplitNoteMatrix(program, value, count, transpose == GL_TRUE);
+    PROFILE_DRIVER(glProgramUniformMatrix4fv(program, location, count, transpose, value));
+}
+
+void vglBindProgramPipeline(GLuint pipeline) {
+    PROFILE_CALL(BindProgramPipeline);
+    IDLE_HASH(BindProgramPipeline, pipeline);
+    PROFILE_DRIVER(glBindProgramPipeline(pipeline));
+}
+
+void vglUseProgramStages(GLuint pipeline, GLbitfield stages, GLuint program) {
+    PROFILE_CALL(UseProgramStages);
+    IDLE_HASH(UseProgramStages, pipeline, stages, program);
+    PROFILE_DRIVER(glUseProgramStages(pipeline, stages, program));
+}
+
+void vglUniformBlockBinding(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding) {
+    PROFILE_CALL(UniformBlockBinding);
+    IDLE_HASH(UniformBlockBinding, program, uniformBlockIndex, uniformBlockBinding);
+    PROFILE_DRIVER(glUniformBlockBinding(program, uniformBlockIndex, uniformBlockBinding));
 }
 
 // ============================================================================
 // Textures
 // ============================================================================
 
+// Deleted names are translated on the stack, this many at a time
+#define DELETE_CHUNK 64
+
+void vglGenTextures(GLsizei n, GLuint* textures) {
+    PROFILE_CALL(GenTextures);
+    PROFILE_DRIVER(namePoolGen(NAME_TEXTURE, n, textures));
+}
+
 void vglBindTexture(GLenum target, GLuint texture) {
+    PROFILE_CALL(BindTexture);
+    FLIGHT_COUNT(FLIGHT_EVENT_STATE_CHANGE);
+    IDLE_HASH(BindTexture, target, texture);
+    texture = storagePoolTexture(texture);
+    namePoolBind(NAME_TEXTURE, texture);
     // Track state
     if (g_wrapperCtx) {
         int unit = g_wrapperCtx->state.activeTextureUnit;
         switch (target) {
             case GL_TEXTURE_2D:
                 g_wrapperCtx->state.textureUnits[unit].texture2D = texture;
+                fbInvalidateSample(texture);
                 break;
             case GL_TEXTURE_3D:
                 g_wrapperCtx->state.textureUnits[unit].texture3D = texture;
@@ -274,13 +718,20 @@ void vglBindTexture(GLenum target, GLuint texture) {
             case GL_TEXTURE_CUBE_MAP:
                 g_wrapperCtx->state.textureUnits[unit].textureCube = texture;
                 break;
+            case GL_TEXTURE_2D_ARRAY:
+                g_wrapperCtx->state.textureUnits[unit].texture2DArray = texture;
+                break;
         }
     }
-    glBindTexture(target, texture);
+    PROFILE_DRIVER(glBindTexture(target, texture));
 }
 
 void vglTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, 
                     GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels) {
+    PROFILE_CALL(TexImage2D);
+    TRACE_SCOPE("texture_upload");
+    FLIGHT_SCOPE(FLIGHT_EVENT_TEXTURE_UPLOAD, (uint64_t)width * height);
+    frameIdleChanged();
     // Translate unsupported formats
     GLenum esInternalFormat = internalformat;
     GLenum esFormat = format;
@@ -299,44 +750,273 @@ void vglTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei wid
             break;
     }
     
-    glTexImage2D(target, level, esInternalFormat, width, height, border, esFormat, type, pixels);
+    // Window-size render targets follow the resolution scale
+    bool scaled;
+    PROFILE_DRIVER(scaled = rtScalerTexImage2D(target, level, esInternalFormat, width, height,
+                                               esFormat, type, pixels));
+    if (scaled) {
+        storagePoolDropBound(target);
+        return;
+    }
+    
+    // Render target storage comes from released targets of the same shape
+    bool pooled;
+    PROFILE_DRIVER(pooled = storagePoolTexImage2D(target, level, esInternalFormat, width, height,
+                                                  esFormat, type, pixels));
+    if (pooled) return;
+    
+    PROFILE_DRIVER(glTexImage2D(target, level, esInternalFormat, width, height, border, esFormat, type, pixels));
+}
+
+void vglTexStorage2D(GLenum target, GLsizei levels, GLenum internalformat, 
+                      GLsizei width, GLsizei height) {
+    PROFILE_CALL(TexStorage2D);
+    frameIdleChanged();
+    bool handled;
+    PROFILE_DRIVER(handled = rtScalerTexStorage2D(target, levels, internalformat, width, height));
+    if (handled) {
+        storagePoolDropBound(target);
+        return;
+    }
+    PROFILE_DRIVER(handled = storagePoolTexStorage(target, levels, internalformat, width, height, 1));
+    if (handled) return;
+    PROFILE_DRIVER(glTexStorage2D(target, levels, internalformat, width, height));
+}
+
+void vglDeleteTextures(GLsizei n, const GLuint* textures) {
+    PROFILE_CALL(DeleteTextures);
+    idleHashArray(PROFILE_CALL_DeleteTextures, textures, n, sizeof(GLuint));
+    if (!textures) return;
+    flushPasses();
+    
+    // Recyclable storage is pooled instead; the rest is deleted by its real name
+    GLuint names[DELETE_CHUNK];
+    for (GLsizei i = 0; i < n; i += DELETE_CHUNK) {
+        GLsizei count = n - i < DELETE_CHUNK ? n - i : DELETE_CHUNK;
+        memcpy(names, textures + i, count * sizeof(GLuint));
+        PROFILE_DRIVER(count = storagePoolDeleteTextures(count, names));
+        rtScalerForgetTextures(count, names);
+        PROFILE_DRIVER(namePoolDelete(NAME_TEXTURE, count, names));
+    }
+}
+
+GLboolean vglIsTexture(GLuint texture) {
+    PROFILE_CALL(IsTexture);
+    texture = storagePoolTexture(texture);
+    if (namePoolIsPending(NAME_TEXTURE, texture)) return GL_FALSE;
+    GLboolean result;
+    PROFILE_DRIVER(result = glIsTexture(texture));
+    return result;
 }
 
 void vglTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, 
                        GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels) {
-    glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
+    PROFILE_CALL(TexSubImage2D);
+    flushPendingClear();
+    TRACE_SCOPE("texture_upload");
+    FLIGHT_SCOPE(FLIGHT_EVENT_TEXTURE_UPLOAD, (uint64_t)width * height);
+    frameIdleChanged();
+    PROFILE_DRIVER(glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels));
 }
 
 void vglTexImage3D(GLenum target, GLint level, GLint internalformat, GLsizei width, 
                     GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, 
                     const void* pixels) {
-    glTexImage3D(target, level, internalformat, width, height, depth, border, format, type, pixels);
+    PROFILE_CALL(TexImage3D);
+    TRACE_SCOPE("texture_upload");
+    FLIGHT_SCOPE(FLIGHT_EVENT_TEXTURE_UPLOAD, (uint64_t)width * height * depth);
+    frameIdleChanged();
+    PROFILE_DRIVER(glTexImage3D(target, level, internalformat, width, height, depth, border, format, type, pixels));
 }
 
 void vglGenerateMipmap(GLenum target) {
-    glGenerateMipmap(target);
+    PROFILE_CALL(GenerateMipmap);
+    IDLE_HASH(GenerateMipmap, target);
+    flushPendingClear();
+    storagePoolDropBound(target);
+    if (g_wrapperCtx && target == GL_TEXTURE_2D) {
+        // Reads level 0 of a render target
+        const GLState* state = &g_wrapperCtx->state;
+        if (state->activeTextureUnit >= 0 && state->activeTextureUnit < MAX_TEXTURE_UNITS) {
+            fbInvalidateSample(state->textureUnits[state->activeTextureUnit].texture2D);
+        }
+    }
+    PROFILE_DRIVER(glGenerateMipmap(target));
 }
 
 void vglActiveTexture(GLenum texture) {
+    PROFILE_CALL(ActiveTexture);
+    IDLE_HASH(ActiveTexture, texture);
     if (g_wrapperCtx) {
         g_wrapperCtx->state.activeTextureUnit = texture - GL_TEXTURE0;
     }
-    glActiveTexture(texture);
+    PROFILE_DRIVER(glActiveTexture(texture));
 }
 
 void vglTexParameteri(GLenum target, GLenum pname, GLint param) {
-    glTexParameteri(target, pname, param);
+    PROFILE_CALL(TexParameteri);
+    IDLE_HASH(TexParameteri, target, pname, (uint64_t)param);
+    PROFILE_DRIVER(glTexParameteri(target, pname, param));
 }
 
 void vglTexParameterf(GLenum target, GLenum pname, GLfloat param) {
-    glTexParameterf(target, pname, param);
+    PROFILE_CALL(TexParameterf);
+    IDLE_HASH(TexParameterf, target, pname, frameIdleBits(param));
+    PROFILE_DRIVER(glTexParameterf(target, pname, param));
+}
+
+// Border color takes four values, every other parameter one
+static inline GLsizei texParameterCount(GLenum pname) {
+    return pname == GL_TEXTURE_BORDER_COLOR ? 4 : 1;
+}
+
+void vglTexParameteriv(GLenum target, GLenum pname, const GLint* params) {
+    PROFILE_CALL(TexParameteriv);
+    IDLE_HASH(TexParameteriv, target);
+    idleHashValues(PROFILE_CALL_TexParameteriv, (GLint)pname, texParameterCount(pname), params, sizeof(GLint));
+    PROFILE_DRIVER(glTexParameteriv(target, pname, params));
+}
+
+void vglTexParameterfv(GLenum target, GLenum pname, const GLfloat* params) {
+    PROFILE_CALL(TexParameterfv);
+    IDLE_HASH(TexParameterfv, target);
+    idleHashValues(PROFILE_CALL_TexParameterfv, (GLint)pname, texParameterCount(pname), params, sizeof(GLfloat));
+    PROFILE_DRIVER(glTexParameterfv(target, pname, params));
+}
+
+void vglTexStorage3D(GLenum target, GLsizei levels, GLenum internalformat, 
+                      GLsizei width, GLsizei height, GLsizei depth) {
+    PROFILE_CALL(TexStorage3D);
+    frameIdleChanged();
+    bool pooled;
+    PROFILE_DRIVER(pooled = storagePoolTexStorage(target, levels, internalformat, width, height, depth));
+    if (pooled) return;
+    PROFILE_DRIVER(glTexStorage3D(target, levels, internalformat, width, height, depth));
+}
+
+void vglTexSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, 
+                       GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, 
+                       const void* pixels) {
+    PROFILE_CALL(TexSubImage3D);
+    flushPendingClear();
+    TRACE_SCOPE("texture_upload");
+    FLIGHT_SCOPE(FLIGHT_EVENT_TEXTURE_UPLOAD, (uint64_t)width * height * depth);
+    frameIdleChanged();
+    PROFILE_DRIVER(glTexSubImage3D(target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels));
+}
+
+void vglCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, 
+                              GLsizei height, GLint border, GLsizei imageSize, const void* data) {
+    PROFILE_CALL(CompressedTexImage2D);
+    TRACE_SCOPE("texture_upload");
+    FLIGHT_SCOPE(FLIGHT_EVENT_TEXTURE_UPLOAD, (uint64_t)width * height);
+    frameIdleChanged();
+    storagePoolDropBound(target);
+    PROFILE_DRIVER(glCompressedTexImage2D(target, level, internalformat, width, height, border, imageSize, data));
+}
+
+void vglCompressedTexImage3D(GLenum target, GLint level, GLenum internalformat, GLsizei width, 
+                              GLsizei height, GLsizei depth, GLint border, GLsizei imageSize, 
+                              const void* data) {
+    PROFILE_CALL(CompressedTexImage3D);
+    TRACE_SCOPE("texture_upload");
+    FLIGHT_SCOPE(FLIGHT_EVENT_TEXTURE_UPLOAD, (uint64_t)width * height * depth);
+    frameIdleChanged();
+    PROFILE_DRIVER(glCompressedTexImage3D(target, level, internalformat, width, height, depth, border, imageSize, data));
+}
+
+void vglCompressedTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, 
+                                 GLsizei width, GLsizei height, GLenum format, GLsizei imageSize, 
+                                 const void* data) {
+    PROFILE_CALL(CompressedTexSubImage2D);
+    flushPendingClear();
+    TRACE_SCOPE("texture_upload");
+    FLIGHT_SCOPE(FLIGHT_EVENT_TEXTURE_UPLOAD, (uint64_t)width * height);
+    frameIdleChanged();
+    PROFILE_DRIVER(glCompressedTexSubImage2D(target, level, xoffset, yoffset, width, height, format, imageSize, data));
+}
+
+void vglCompressedTexSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, 
+                                 GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, 
+                                 GLenum format, GLsizei imageSize, const void* data) {
+    PROFILE_CALL(CompressedTexSubImage3D);
+    flushPendingClear();
+    TRACE_SCOPE("texture_upload");
+    FLIGHT_SCOPE(FLIGHT_EVENT_TEXTURE_UPLOAD, (uint64_t)width * height * depth);
+    frameIdleChanged();
+    PROFILE_DRIVER(glCompressedTexSubImage3D(target, level, xoffset, yoffset, zoffset, width, height, depth, 
+                                             format, imageSize, data));
+}
+
+// ============================================================================
+// Samplers
+// ============================================================================
+
+void vglBindSampler(GLuint unit, GLuint sampler) {
+    PROFILE_CALL(BindSampler);
+    IDLE_HASH(BindSampler, unit, sampler);
+    PROFILE_DRIVER(glBindSampler(unit, sampler));
+}
+
+void vglSamplerParameteri(GLuint sampler, GLenum pname, GLint param) {
+    PROFILE_CALL(SamplerParameteri);
+    IDLE_HASH(SamplerParameteri, sampler, pname, (uint64_t)param);
+    PROFILE_DRIVER(glSamplerParameteri(sampler, pname, param));
+}
+
+void vglSamplerParameterf(GLuint sampler, GLenum pname, GLfloat param) {
+    PROFILE_CALL(SamplerParameterf);
+    IDLE_HASH(SamplerParameterf, sampler, pname, frameIdleBits(param));
+    PROFILE_DRIVER(glSamplerParameterf(sampler, pname, param));
+}
+
+void vglSamplerParameteriv(GLuint sampler, GLenum pname, const GLint* param) {
+    PROFILE_CALL(SamplerParameteriv);
+    IDLE_HASH(SamplerParameteriv, sampler);
+    idleHashValues(PROFILE_CALL_SamplerParameteriv, (GLint)pname, texParameterCount(pname), param, sizeof(GLint));
+    PROFILE_DRIVER(glSamplerParameteriv(sampler, pname, param));
+}
+
+void vglSamplerParameterfv(GLuint sampler, GLenum pname, const GLfloat* param) {
+    PROFILE_CALL(SamplerParameterfv);
+    IDLE_HASH(SamplerParameterfv, sampler);
+    idleHashValues(PROFILE_CALL_SamplerParameterfv, (GLint)pname, texParameterCount(pname), param, sizeof(GLfloat));
+    PROFILE_DRIVER(glSamplerParameterfv(sampler, pname, param));
 }
 
 // ============================================================================
 // Buffers
 // ============================================================================
 
+void vglGenBuffers(GLsizei n, GLuint* buffers) {
+    PROFILE_CALL(GenBuffers);
+    PROFILE_DRIVER(namePoolGen(NAME_BUFFER, n, buffers));
+}
+
+void vglDeleteBuffers(GLsizei n, const GLuint* buffers) {
+    PROFILE_CALL(DeleteBuffers);
+    idleHashArray(PROFILE_CALL_DeleteBuffers, buffers, n, sizeof(GLuint));
+    if (!buffers) return;
+    // Queued draws may still read them
+    drawBatcherFlush();
+    if (g_vertexPackerActive) vertexPackerForgetBuffers(n, buffers);
+    if (g_vaoCacheActive) vaoCacheForgetBuffers(n, buffers);
+    PROFILE_DRIVER(namePoolDelete(NAME_BUFFER, n, buffers));
+}
+
+GLboolean vglIsBuffer(GLuint buffer) {
+    PROFILE_CALL(IsBuffer);
+    if (namePoolIsPending(NAME_BUFFER, buffer)) return GL_FALSE;
+    GLboolean result;
+    PROFILE_DRIVER(result = glIsBuffer(buffer));
+    return result;
+}
+
 void vglBindBuffer(GLenum target, GLuint buffer) {
+    PROFILE_CALL(BindBuffer);
+    FLIGHT_COUNT(FLIGHT_EVENT_STATE_CHANGE);
+    IDLE_HASH(BindBuffer, target, buffer);
+    namePoolBind(NAME_BUFFER, buffer);
     // Track state
     if (g_wrapperCtx) {
         switch (target) {
@@ -345,37 +1025,72 @@ void vglBindBuffer(GLenum target, GLuint buffer) {
                 break;
             case GL_ELEMENT_ARRAY_BUFFER:
                 g_wrapperCtx->state.buffers.elementBuffer = buffer;
+                if (g_vaoCacheActive) vaoCacheBindElementBuffer(buffer);
                 break;
             case GL_UNIFORM_BUFFER:
                 g_wrapperCtx->state.buffers.uniformBuffer = buffer;
                 break;
         }
     }
-    glBindBuffer(target, buffer);
+    PROFILE_DRIVER(glBindBuffer(target, buffer));
 }
 
 void vglBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
-    glBufferData(target, size, data, usage);
+    PROFILE_CALL(BufferData);
+    IDLE_HASH(BufferData, target, (uint64_t)size, usage);
+    // No data leaves the contents to later writes
+    if (data) frameIdleHashUpload(PROFILE_CALL_BufferData, data, (size_t)size);
+    // Static vertex data is kept for repacking
+    if (g_vertexPackerActive) vertexPackerBufferData(target, size, data, usage);
+    PROFILE_DRIVER(glBufferData(target, size, data, usage));
 }
 
 void vglBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
-    glBufferSubData(target, offset, size, data);
+    PROFILE_CALL(BufferSubData);
+    IDLE_HASH(BufferSubData, target, (uint64_t)offset, (uint64_t)size);
+    frameIdleHashUpload(PROFILE_CALL_BufferSubData, data, (size_t)size);
+    if (g_vertexPackerActive) vertexPackerBufferWritten(target);
+    PROFILE_DRIVER(glBufferSubData(target, offset, size, data));
 }
 
 void* vglMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
-    return glMapBufferRange(target, offset, length, access);
+    PROFILE_CALL(MapBufferRange);
+    if (access & GL_MAP_WRITE_BIT) {
+        frameIdleChanged();
+        if (g_vertexPackerActive) vertexPackerBufferWritten(target);
+    }
+    void* result;
+    PROFILE_DRIVER(result = glMapBufferRange(target, offset, length, access));
+    return result;
 }
 
 GLboolean vglUnmapBuffer(GLenum target) {
-    return glUnmapBuffer(target);
+    PROFILE_CALL(UnmapBuffer);
+    GLboolean result;
+    PROFILE_DRIVER(result = glUnmapBuffer(target));
+    return result;
+}
+
+void vglCopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset,
+                          GLintptr writeOffset, GLsizeiptr size) {
+    PROFILE_CALL(CopyBufferSubData);
+    frameIdleChanged();
+    if (g_vertexPackerActive) vertexPackerBufferWritten(writeTarget);
+    PROFILE_DRIVER(glCopyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size));
 }
 
 void vglBindBufferBase(GLenum target, GLuint index, GLuint buffer) {
-    glBindBufferBase(target, index, buffer);
+    PROFILE_CALL(BindBufferBase);
+    IDLE_HASH(BindBufferBase, target, index, buffer);
+    namePoolBind(NAME_BUFFER, buffer);
+    PROFILE_DRIVER(glBindBufferBase(target, index, buffer));
 }
 
 void vglBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
-    glBindBufferRange(target, index, buffer, offset, size);
+    PROFILE_CALL(BindBufferRange);
+    IDLE_HASH(BindBufferRange, target, index, buffer, (uint64_t)offset, (uint64_t)size);
+    namePoolBind(NAME_BUFFER, buffer);
+    PROFILE_DRIVER(glBindBufferRange(target, index, buffer, offset, size));
 }
 
 // ============================================================================
@@ -383,42 +1098,401 @@ void vglBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr off
 // ============================================================================
 
 void vglBindVertexArray(GLuint array) {
+    PROFILE_CALL(BindVertexArray);
+    FLIGHT_COUNT(FLIGHT_EVENT_STATE_CHANGE);
+    IDLE_HASH(BindVertexArray, array);
     if (g_wrapperCtx) {
         g_wrapperCtx->state.vertexArray = array;
     }
-    glBindVertexArray(array);
+    
+    // The cache binds its own VAO at the next draw
+    if (g_vaoCacheActive) {
+        vaoCacheBindArray(array);
+        if (g_wrapperCtx) {
+            g_wrapperCtx->state.buffers.elementBuffer = vaoCacheElementBuffer();
+        }
+        return;
+    }
+    
+    // Queued draws keep the VAO they were recorded with
+    drawBatcherSetVertexArray(array);
+    if (g_wrapperCtx && array != 0) {
+        // Part of the VAO's state, not tracked per VAO
+        g_wrapperCtx->state.buffers.elementBuffer = 0xFFFFFFFF;
+    }
+    PROFILE_DRIVER(glBindVertexArray(array));
 }
 
 void vglGenVertexArrays(GLsizei n, GLuint* arrays) {
-    glGenVertexArrays(n, arrays);
+    PROFILE_CALL(GenVertexArrays);
+    PROFILE_DRIVER(glGenVertexArrays(n, arrays));
+    if (g_vaoCacheActive) vaoCacheGenArrays(n, arrays);
 }
 
 void vglDeleteVertexArrays(GLsizei n, const GLuint* arrays) {
-    glDeleteVertexArrays(n, arrays);
+    PROFILE_CALL(DeleteVertexArrays);
+    idleHashArray(PROFILE_CALL_DeleteVertexArrays, arrays, n, sizeof(GLuint));
+    if (g_vaoCacheActive) {
+        if (vaoCacheDeleteArrays(n, arrays) && g_wrapperCtx) {
+            g_wrapperCtx->state.vertexArray = 0;
+            g_wrapperCtx->state.buffers.elementBuffer = vaoCacheElementBuffer();
+        }
+    } else if (arrays && n > 0) {
+        // Queued draws bind the VAOs they were recorded with
+        drawBatcherFlush();
+        for (GLsizei i = 0; g_wrapperCtx && i < n; i++) {
+            if (arrays[i] != 0 && arrays[i] == g_wrapperCtx->state.vertexArray) {
+                g_wrapperCtx->state.vertexArray = 0;
+                drawBatcherSetVertexArray(0);
+            }
+        }
+    }
+    PROFILE_DRIVER(glDeleteVertexArrays(n, arrays));
 }
 
 void vglEnableVertexAttribArray(GLuint index) {
-    glEnableVertexAttribArray(index);
+    PROFILE_CALL(EnableVertexAttribArray);
+    IDLE_HASH(EnableVertexAttribArray, index);
+    if (g_vaoCacheActive && vaoCacheEnableAttrib(index, true)) return;
+    PROFILE_DRIVER(glEnableVertexAttribArray(index));
 }
 
 void vglDisableVertexAttribArray(GLuint index) {
-    glDisableVertexAttribArray(index);
+    PROFILE_CALL(DisableVertexAttribArray);
+    IDLE_HASH(DisableVertexAttribArray, index);
+    if (g_vaoCacheActive && vaoCacheEnableAttrib(index, false)) return;
+    PROFILE_DRIVER(glDisableVertexAttribArray(index));
 }
 
 void vglVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, 
                              GLsizei stride, const void* pointer) {
-    glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+    PROFILE_CALL(VertexAttribPointer);
+    IDLE_HASH(VertexAttribPointer, index, (uint64_t)size, type, normalized, (uint64_t)stride, IDLE_PTR(pointer));
+    // Client-side arrays live in app memory
+    if (g_wrapperCtx && g_wrapperCtx->state.buffers.arrayBuffer == 0 && pointer) frameIdleChanged();
+    if (g_vaoCacheActive &&
+        vaoCacheAttribPointer(index, size, type, normalized, GL_FALSE, stride, pointer)) {
+        return;
+    }
+    PROFILE_DRIVER(glVertexAttribPointer(index, size, type, normalized, stride, pointer));
 }
 
 void vglVertexAttribDivisor(GLuint index, GLuint divisor) {
-    glVertexAttribDivisor(index, divisor);
+    PROFILE_CALL(VertexAttribDivisor);
+    IDLE_HASH(VertexAttribDivisor, index, divisor);
+    if (g_vaoCacheActive && vaoCacheAttribDivisor(index, divisor)) return;
+    PROFILE_DRIVER(glVertexAttribDivisor(index, divisor));
+}
+
+// Separate attribute formats are set on the app's own array
+void vglVertexAttribFormat(GLuint attribindex, GLint size, GLenum type, GLboolean normalized,
+                           GLuint relativeoffset) {
+    PROFILE_CALL(VertexAttribFormat);
+    IDLE_HASH(VertexAttribFormat, attribindex, (uint64_t)size, type, normalized, relativeoffset);
+    if (g_vaoCacheActive) vaoCacheSeparateFormat();
+    PROFILE_DRIVER(glVertexAttribFormat(attribindex, size, type, normalized, relativeoffset));
+}
+
+void vglVertexAttribIFormat(GLuint attribindex, GLint size, GLenum type, GLuint relativeoffset) {
+    PROFILE_CALL(VertexAttribIFormat);
+    IDLE_HASH(VertexAttribIFormat, attribindex, (uint64_t)size, type, relativeoffset);
+    if (g_vaoCacheActive) vaoCacheSeparateFormat();
+    PROFILE_DRIVER(glVertexAttribIFormat(attribindex, size, type, relativeoffset));
+}
+
+void vglVertexAttribBinding(GLuint attribindex, GLuint bindingindex) {
+    PROFILE_CALL(VertexAttribBinding);
+    IDLE_HASH(VertexAttribBinding, attribindex, bindingindex);
+    if (g_vaoCacheActive) vaoCacheSeparateFormat();
+    PROFILE_DRIVER(glVertexAttribBinding(attribindex, bindingindex));
+}
+
+void vglBindVertexBuffer(GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride) {
+    PROFILE_CALL(BindVertexBuffer);
+    IDLE_HASH(BindVertexBuffer, bindingindex, buffer, (uint64_t)offset, (uint64_t)stride);
+    if (g_vaoCacheActive) vaoCacheSeparateFormat();
+    PROFILE_DRIVER(glBindVertexBuffer(bindingindex, buffer, offset, stride));
+}
+
+void vglVertexBindingDivisor(GLuint bindingindex, GLuint divisor) {
+    PROFILE_CALL(VertexBindingDivisor);
+    IDLE_HASH(VertexBindingDivisor, bindingindex, divisor);
+    if (g_vaoCacheActive) vaoCacheSeparateFormat();
+    PROFILE_DRIVER(glVertexBindingDivisor(bindingindex, divisor));
+}
+
+void vglVertexAttrib1f(GLuint index, GLfloat x) {
+    PROFILE_CALL(VertexAttrib1f);
+    IDLE_HASH(VertexAttrib1f, index, frameIdleBits(x));
+    PROFILE_DRIVER(glVertexAttrib1f(index, x));
+}
+
+void vglVertexAttrib2f(GLuint index, GLfloat x, GLfloat y) {
+    PROFILE_CALL(VertexAttrib2f);
+    IDLE_HASH(VertexAttrib2f, index, frameIdleBits(x), frameIdleBits(y));
+    PROFILE_DRIVER(glVertexAttrib2f(index, x, y));
+}
+
+void vglVertexAttrib3f(GLuint index, GLfloat x, GLfloat y, GLfloat z) {
+    PROFILE_CALL(VertexAttrib3f);
+    IDLE_HASH(VertexAttrib3f, index, frameIdleBits(x), frameIdleBits(y), frameIdleBits(z));
+    PROFILE_DRIVER(glVertexAttrib3f(index, x, y, z));
+}
+
+void vglVertexAttrib4f(GLuint index, GLfloat x, GLfloat y, GLfloat z, GLfloat w) {
+    PROFILE_CALL(VertexAttrib4f);
+    IDLE_HASH(VertexAttrib4f, index, frameIdleBits(x), frameIdleBits(y), frameIdleBits(z), frameIdleBits(w));
+    PROFILE_DRIVER(glVertexAttrib4f(index, x, y, z, w));
+}
+
+void vglVertexAttrib1fv(GLuint index, const GLfloat* v) {
+    PROFILE_CALL(VertexAttrib1fv);
+    idleHashValues(PROFILE_CALL_VertexAttrib1fv, (GLint)index, 1, v, 1 * sizeof(GLfloat));
+    PROFILE_DRIVER(glVertexAttrib1fv(index, v));
+}
+
+void vglVertexAttrib2fv(GLuint index, const GLfloat* v) {
+    PROFILE_CALL(VertexAttrib2fv);
+    idleHashValues(PROFILE_CALL_VertexAttrib2fv, (GLint)index, 1, v, 2 * sizeof(GLfloat));
+    PROFILE_DRIVER(glVertexAttrib2fv(index, v));
+}
+
+void vglVertexAttrib3fv(GLuint index, const GLfloat* v) {
+    PROFILE_CALL(VertexAttrib3fv);
+    idleHashValues(PROFILE_CALL_VertexAttrib3fv, (GLint)index, 1, v, 3 * sizeof(GLfloat));
+    PROFILE_DRIVER(glVertexAttrib3fv(index, v));
+}
+
+void vglVertexAttrib4fv(GLuint index, const GLfloat* v) {
+    PROFILE_CALL(VertexAttrib4fv);
+    idleHashValues(PROFILE_CALL_VertexAttrib4fv, (GLint)index, 1, v, 4 * sizeof(GLfloat));
+    PROFILE_DRIVER(glVertexAttrib4fv(index, v));
+}
+
+void vglVertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer) {
+    PROFILE_CALL(VertexAttribIPointer);
+    IDLE_HASH(VertexAttribIPointer, index, (uint64_t)size, type, (uint64_t)stride, IDLE_PTR(pointer));
+    if (g_wrapperCtx && g_wrapperCtx->state.buffers.arrayBuffer == 0 && pointer) frameIdleChanged();
+    if (g_vaoCacheActive &&
+        vaoCacheAttribPointer(index, size, type, GL_FALSE, GL_TRUE, stride, pointer)) {
+        return;
+    }
+    PROFILE_DRIVER(glVertexAttribIPointer(index, size, type, stride, pointer));
+}
+
+void vglGetVertexAttribiv(GLuint index, GLenum pname, GLint* params) {
+    PROFILE_CALL(GetVertexAttribiv);
+    if (g_vaoCacheActive && vaoCacheGetAttrib(index, pname, params)) return;
+    PROFILE_DRIVER(glGetVertexAttribiv(index, pname, params));
+}
+
+void vglGetVertexAttribPointerv(GLuint index, GLenum pname, void** pointer) {
+    PROFILE_CALL(GetVertexAttribPointerv);
+    if (g_vaoCacheActive && pname == GL_VERTEX_ATTRIB_ARRAY_POINTER &&
+        vaoCacheGetAttribPointer(index, pointer)) {
+        return;
+    }
+    PROFILE_DRIVER(glGetVertexAttribPointerv(index, pname, pointer));
+}
+
+void vglVertexAttribI4i(GLuint index, GLint x, GLint y, GLint z, GLint w) {
+    PROFILE_CALL(VertexAttribI4i);
+    IDLE_HASH(VertexAttribI4i, index, (uint64_t)x, (uint64_t)y, (uint64_t)z, (uint64_t)w);
+    PROFILE_DRIVER(glVertexAttribI4i(index, x, y, z, w));
+}
+
+void vglVertexAttribI4ui(GLuint index, GLuint x, GLuint y, GLuint z, GLuint w) {
+    PROFILE_CALL(VertexAttribI4ui);
+    IDLE_HASH(VertexAttribI4ui, index, (uint64_t)x, (uint64_t)y, (uint64_t)z, (uint64_t)w);
+    PROFILE_DRIVER(glVertexAttribI4ui(index, x, y, z, w));
 }
 
 // ============================================================================
 // Framebuffers
 // ============================================================================
 
+// With resolution scaling on, the default framebuffer is the scaler's
+// render target: binds of 0 are redirected to it and viewport/scissor
+// rects are mapped from window space into the current subrect
+static inline bool drawingScaled(void) {
+    return g_wrapperCtx && g_wrapperCtx->state.framebuffer.drawFramebuffer == 0 &&
+           resolutionScalerGetTargetFBO() != 0;
+}
+
+// App framebuffers built from window-size targets are scaled the same way
+static inline bool isScaledFramebuffer(GLuint framebuffer) {
+    return framebuffer == 0 ? resolutionScalerGetTargetFBO() != 0 : rtScalerIsScaled(framebuffer);
+}
+
+static inline bool mapsRects(void) {
+    return g_wrapperCtx && isScaledFramebuffer(g_wrapperCtx->state.framebuffer.drawFramebuffer);
+}
+
+// App targets change size in coarser steps than the default framebuffer
+static inline void mapRect(GLuint framebuffer, GLint rect[4]) {
+    if (framebuffer == 0) {
+        resolutionScalerMapRect(rect);
+    } else {
+        rtScalerMapRect(rect);
+    }
+}
+
+static void applyViewport(void) {
+    GLint rect[4];
+    memcpy(rect, g_wrapperCtx->state.rasterizer.viewport, sizeof(rect));
+    if (mapsRects()) mapRect(g_wrapperCtx->state.framebuffer.drawFramebuffer, rect);
+    glViewport(rect[0], rect[1], rect[2], rect[3]);
+}
+
+static void applyScissor(void) {
+    GLint rect[4];
+    memcpy(rect, g_wrapperCtx->state.rasterizer.scissor, sizeof(rect));
+    if (mapsRects()) mapRect(g_wrapperCtx->state.framebuffer.drawFramebuffer, rect);
+    glScissor(rect[0], rect[1], rect[2], rect[3]);
+}
+
+// Blit corners may be flipped: map the normalized rect and keep the orientation
+static void mapBlitRect(GLuint framebuffer, GLint* x0, GLint* y0, GLint* x1, GLint* y1) {
+    GLint rect[4] = {
+        *x0 < *x1 ? *x0 : *x1, *y0 < *y1 ? *y0 : *y1,
+        abs(*x1 - *x0), abs(*y1 - *y0)
+    };
+    mapRect(framebuffer, rect);
+    
+    bool flipX = *x1 < *x0, flipY = *y1 < *y0;
+    *x0 = flipX ? rect[0] + rect[2] : rect[0];
+    *x1 = flipX ? rect[0] : rect[0] + rect[2];
+    *y0 = flipY ? rect[1] + rect[3] : rect[1];
+    *y1 = flipY ? rect[1] : rect[1] + rect[3];
+}
+
+// Reads take a window-space rect; a scaled source is staged at window size
+static bool beginRead(GLint rect[4]) {
+    if (!g_wrapperCtx) return false;
+    return resolutionScalerBeginRead(g_wrapperCtx->state.framebuffer.readFramebuffer, rect);
+}
+
+// The default framebuffer's buffer names don't exist on the FBO standing
+// in for it
+static GLenum defaultBufferToAttachment(GLenum buffer) {
+    switch (buffer) {
+        case GL_BACK:
+        case GL_COLOR:      return GL_COLOR_ATTACHMENT0;
+        case GL_DEPTH:      return GL_DEPTH_ATTACHMENT;
+        case GL_STENCIL:    return GL_STENCIL_ATTACHMENT;
+        default:            return buffer;
+    }
+}
+
+// Translated copy of a buffer list aimed at a redirected default
+// framebuffer, the list itself otherwise
+static const GLenum* mapDefaultBuffers(GLuint framebuffer, GLsizei n, const GLenum* buffers,
+                                       GLenum* mapped, GLsizei capacity) {
+    if (framebuffer != 0 || !buffers || n > capacity || !isScaledFramebuffer(0)) return buffers;
+    for (GLsizei i = 0; i < n; i++) mapped[i] = defaultBufferToAttachment(buffers[i]);
+    return mapped;
+}
+
+// A draw into the default framebuffer may start the UI: resolve the scaled
+// scene there so the rest of the frame draws at native resolution
+static void checkUISplit(void) {
+    if (!g_wrapperCtx || g_wrapperCtx->state.framebuffer.drawFramebuffer != 0) return;
+    if (!resolutionScalerIsEnabled() || !uiSplitBeforeDraw()) return;
+    
+    // Queued scene draws belong before the resolve
+    drawBatcherFlush();
+    if (!resolutionScalerResolve()) return;
+    
+    // Binds of 0 now reach the backbuffer, rects are no longer mapped
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, g_wrapperCtx->state.framebuffer.readFramebuffer);
+    renderPassMarkBound();
+    applyViewport();
+    applyScissor();
+    gpuTimerBeginPass("native_ui", 0);
+}
+
+// Framebuffer binds and clears are deferred until something needs the
+// framebuffer: a deferred clear always targets the driver's binding
+static void flushPendingClear(void) {
+    GLbitfield mask = renderPassTakeClear();
+    if (mask) issueClear(mask);
+}
+
+static void flushPasses(void) {
+    renderPassFlush();
+    flushPendingClear();
+}
+
+// Window region a draw (viewport) or clear (whole window) writes, clipped
+// by the scissor, feeds partial presentation
+static void damageWindow(bool useViewport) {
+    if (!g_wrapperCtx || g_wrapperCtx->state.framebuffer.drawFramebuffer != 0) return;
+    
+    const GLBlendState* blend = &g_wrapperCtx->state.blend;
+    if (!blend->colorMask[0] && !blend->colorMask[1] && !blend->colorMask[2] && !blend->colorMask[3]) {
+        return;
+    }
+    
+    const GLRasterizerState* raster = &g_wrapperCtx->state.rasterizer;
+    GLint rect[4] = { 0, 0, g_wrapperCtx->windowWidth, g_wrapperCtx->windowHeight };
+    if (useViewport && raster->viewport[2] > 0 && raster->viewport[3] > 0) {
+        memcpy(rect, raster->viewport, sizeof(rect));
+    }
+    
+    if (raster->scissorEnabled) {
+        const GLint* s = raster->scissor;
+        if (s[2] < 0 || s[3] < 0) {
+            // Untracked scissor
+            damageTrackerAddFull();
+            return;
+        }
+        GLint x0 = rect[0] > s[0] ? rect[0] : s[0];
+        GLint y0 = rect[1] > s[1] ? rect[1] : s[1];
+        GLint x1 = rect[0] + rect[2] < s[0] + s[2] ? rect[0] + rect[2] : s[0] + s[2];
+        GLint y1 = rect[1] + rect[3] < s[1] + s[3] ? rect[1] + rect[3] : s[1] + s[3];
+        if (x1 <= x0 || y1 <= y0) return;
+        rect[0] = x0;
+        rect[1] = y0;
+        rect[2] = x1 - x0;
+        rect[3] = y1 - y0;
+    }
+    
+    damageTrackerAddRect(rect);
+}
+
+static void beforeDraw(void) {
+    damageWindow(true);
+    flushPasses();
+    fbInvalidateDraw();
+    checkUISplit();
+    
+    // Attribute setup recorded since the last draw selects the VAO
+    if (g_vaoCacheActive) {
+        drawBatcherSetVertexArray(vaoCacheResolve());
+    }
+}
+
+// Draws the batcher doesn't queue go after the ones it holds
+static void beforeUnbatchedDraw(void) {
+    beforeDraw();
+    drawBatcherFlush();
+}
+
+void glFunctionsFlushPasses(void) {
+    flushPasses();
+    renderPassInvalidate();
+}
+
 void vglBindFramebuffer(GLenum target, GLuint framebuffer) {
+    PROFILE_CALL(BindFramebuffer);
+    FLIGHT_COUNT(FLIGHT_EVENT_STATE_CHANGE);
+    IDLE_HASH(BindFramebuffer, target, framebuffer);
+    
+    // A deferred clear belongs to the framebuffer bound so far
+    flushPendingClear();
+    bool wasScaled = mapsRects();
+    
     if (g_wrapperCtx) {
         if (target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER) {
             g_wrapperCtx->state.framebuffer.drawFramebuffer = framebuffer;
@@ -427,39 +1501,376 @@ void vglBindFramebuffer(GLenum target, GLuint framebuffer) {
             g_wrapperCtx->state.framebuffer.readFramebuffer = framebuffer;
         }
     }
-    glBindFramebuffer(target, framebuffer);
+    
+    // Reaches the driver at the first draw or clear; 0 becomes the
+    // scaler's target there
+    PROFILE_DRIVER(renderPassBind(target, framebuffer));
+    
+    // Viewport and scissor are context state: remap when crossing between
+    // scaled targets and a real framebuffer
+    if (g_wrapperCtx && wasScaled != mapsRects()) {
+        applyViewport();
+        applyScissor();
+    }
 }
 
 void vglFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, 
                               GLuint texture, GLint level) {
-    glFramebufferTexture2D(target, attachment, textarget, texture, level);
+    PROFILE_CALL(FramebufferTexture2D);
+    IDLE_HASH(FramebufferTexture2D, target, attachment, textarget, texture, (uint64_t)level);
+    flushPasses();
+    texture = storagePoolTexture(texture);
+    if (g_wrapperCtx && textarget == GL_TEXTURE_2D) {
+        const GLFramebufferState* fb = &g_wrapperCtx->state.framebuffer;
+        GLuint framebuffer = target == GL_READ_FRAMEBUFFER ? fb->readFramebuffer : fb->drawFramebuffer;
+        rtScalerAttach(framebuffer, attachment, texture, false);
+        fbInvalidateAttach(framebuffer, attachment, texture, false);
+    }
+    PROFILE_DRIVER(glFramebufferTexture2D(target, attachment, textarget, texture, level));
+}
+
+void vglFramebufferTexture(GLenum target, GLenum attachment, GLuint texture, GLint level) {
+    PROFILE_CALL(FramebufferTexture);
+    IDLE_HASH(FramebufferTexture, target, attachment, texture, (uint64_t)level);
+    flushPasses();
+    texture = storagePoolTexture(texture);
+    if (g_wrapperCtx) {
+        // May be layered: neither scaled nor discarded, like glFramebufferTextureLayer
+        const GLFramebufferState* fb = &g_wrapperCtx->state.framebuffer;
+        GLuint framebuffer = target == GL_READ_FRAMEBUFFER ? fb->readFramebuffer : fb->drawFramebuffer;
+        rtScalerAttach(framebuffer, attachment, 0, false);
+        fbInvalidateAttach(framebuffer, attachment, 0, false);
+    }
+    PROFILE_DRIVER(glFramebufferTexture(target, attachment, texture, level));
+}
+
+void vglFramebufferParameteri(GLenum target, GLenum pname, GLint param) {
+    PROFILE_CALL(FramebufferParameteri);
+    IDLE_HASH(FramebufferParameteri, target, pname, (uint64_t)param);
+    flushPasses();
+    PROFILE_DRIVER(glFramebufferParameteri(target, pname, param));
 }
 
 void vglFramebufferRenderbuffer(GLenum target, GLenum attachment, 
                                  GLenum renderbuffertarget, GLuint renderbuffer) {
-    glFramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer);
+    PROFILE_CALL(FramebufferRenderbuffer);
+    IDLE_HASH(FramebufferRenderbuffer, target, attachment, renderbuffertarget, renderbuffer);
+    flushPasses();
+    renderbuffer = storagePoolRenderbuffer(renderbuffer);
+    if (g_wrapperCtx) {
+        const GLFramebufferState* fb = &g_wrapperCtx->state.framebuffer;
+        GLuint framebuffer = target == GL_READ_FRAMEBUFFER ? fb->readFramebuffer : fb->drawFramebuffer;
+        rtScalerAttach(framebuffer, attachment, renderbuffer, true);
+        fbInvalidateAttach(framebuffer, attachment, renderbuffer, true);
+    }
+    PROFILE_DRIVER(glFramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer));
+}
+
+void vglFramebufferTextureLayer(GLenum target, GLenum attachment, GLuint texture, 
+                                 GLint level, GLint layer) {
+    PROFILE_CALL(FramebufferTextureLayer);
+    IDLE_HASH(FramebufferTextureLayer, target, attachment, texture, (uint64_t)level, (uint64_t)layer);
+    flushPasses();
+    texture = storagePoolTexture(texture);
+    if (g_wrapperCtx) {
+        // Layers are neither scaled nor discarded: only drop what was learned
+        const GLFramebufferState* fb = &g_wrapperCtx->state.framebuffer;
+        GLuint framebuffer = target == GL_READ_FRAMEBUFFER ? fb->readFramebuffer : fb->drawFramebuffer;
+        rtScalerAttach(framebuffer, attachment, 0, false);
+        fbInvalidateAttach(framebuffer, attachment, 0, false);
+    }
+    PROFILE_DRIVER(glFramebufferTextureLayer(target, attachment, texture, level, layer));
+}
+
+void vglGetFramebufferAttachmentParameteriv(GLenum target, GLenum attachment, 
+                                             GLenum pname, GLint* params) {
+    PROFILE_CALL(GetFramebufferAttachmentParameteriv);
+    flushPasses();
+    PROFILE_DRIVER(glGetFramebufferAttachmentParameteriv(target, attachment, pname, params));
+    
+    // Report the app's name for recycled storage
+    if (pname == GL_FRAMEBUFFER_ATTACHMENT_OBJECT_NAME && params && *params) {
+        GLint type = GL_NONE;
+        PROFILE_DRIVER(glGetFramebufferAttachmentParameteriv(target, attachment,
+                                                             GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &type));
+        if (type == GL_TEXTURE) *params = (GLint)storagePoolAppTexture((GLuint)*params);
+        if (type == GL_RENDERBUFFER) *params = (GLint)storagePoolAppRenderbuffer((GLuint)*params);
+    }
+}
+
+void vglGenFramebuffers(GLsizei n, GLuint* framebuffers) {
+    PROFILE_CALL(GenFramebuffers);
+    PROFILE_DRIVER(glGenFramebuffers(n, framebuffers));
+}
+
+void vglDeleteFramebuffers(GLsizei n, const GLuint* framebuffers) {
+    PROFILE_CALL(DeleteFramebuffers);
+    idleHashArray(PROFILE_CALL_DeleteFramebuffers, framebuffers, n, sizeof(GLuint));
+    flushPasses();
+    bool wasScaled = mapsRects();
+    
+    rtScalerForgetFramebuffers(n, framebuffers);
+    fbInvalidateForgetFramebuffers(n, framebuffers);
+    renderPassForgetFramebuffers(n, framebuffers);
+    
+    // Deleting a bound framebuffer reverts the binding to 0
+    if (g_wrapperCtx && framebuffers) {
+        GLFramebufferState* fb = &g_wrapperCtx->state.framebuffer;
+        for (GLsizei i = 0; i < n; i++) {
+            if (framebuffers[i] == 0) continue;
+            if (fb->drawFramebuffer == framebuffers[i]) fb->drawFramebuffer = 0;
+            if (fb->readFramebuffer == framebuffers[i]) fb->readFramebuffer = 0;
+        }
+    }
+    PROFILE_DRIVER(glDeleteFramebuffers(n, framebuffers));
+    
+    if (g_wrapperCtx && wasScaled != mapsRects()) {
+        applyViewport();
+        applyScissor();
+    }
+}
+
+void vglRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height) {
+    PROFILE_CALL(RenderbufferStorage);
+    IDLE_HASH(RenderbufferStorage, target, internalformat, (uint64_t)width, (uint64_t)height);
+    bool handled;
+    PROFILE_DRIVER(handled = rtScalerRenderbufferStorage(0, internalformat, width, height));
+    if (handled) {
+        storagePoolDropBound(GL_RENDERBUFFER);
+        return;
+    }
+    PROFILE_DRIVER(handled = storagePoolRenderbufferStorage(0, internalformat, width, height));
+    if (handled) return;
+    PROFILE_DRIVER(glRenderbufferStorage(target, internalformat, width, height));
+}
+
+void vglRenderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum internalformat, 
+                                        GLsizei width, GLsizei height) {
+    PROFILE_CALL(RenderbufferStorageMultisample);
+    IDLE_HASH(RenderbufferStorageMultisample, target, (uint64_t)samples, internalformat,
+              (uint64_t)width, (uint64_t)height);
+    bool handled;
+    PROFILE_DRIVER(handled = rtScalerRenderbufferStorage(samples, internalformat, width, height));
+    if (handled) {
+        storagePoolDropBound(GL_RENDERBUFFER);
+        return;
+    }
+    PROFILE_DRIVER(handled = storagePoolRenderbufferStorage(samples, internalformat, width, height));
+    if (handled) return;
+    PROFILE_DRIVER(glRenderbufferStorageMultisample(target, samples, internalformat, width, height));
+}
+
+void vglGenRenderbuffers(GLsizei n, GLuint* renderbuffers) {
+    PROFILE_CALL(GenRenderbuffers);
+    PROFILE_DRIVER(namePoolGen(NAME_RENDERBUFFER, n, renderbuffers));
+}
+
+void vglDeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers) {
+    PROFILE_CALL(DeleteRenderbuffers);
+    idleHashArray(PROFILE_CALL_DeleteRenderbuffers, renderbuffers, n, sizeof(GLuint));
+    if (!renderbuffers) return;
+    flushPasses();
+    
+    GLuint names[DELETE_CHUNK];
+    for (GLsizei i = 0; i < n; i += DELETE_CHUNK) {
+        GLsizei count = n - i < DELETE_CHUNK ? n - i : DELETE_CHUNK;
+        memcpy(names, renderbuffers + i, count * sizeof(GLuint));
+        PROFILE_DRIVER(count = storagePoolDeleteRenderbuffers(count, names));
+        rtScalerForgetRenderbuffers(count, names);
+        PROFILE_DRIVER(namePoolDelete(NAME_RENDERBUFFER, count, names));
+    }
+}
+
+void vglBindRenderbuffer(GLenum target, GLuint renderbuffer) {
+    PROFILE_CALL(BindRenderbuffer);
+    IDLE_HASH(BindRenderbuffer, target, renderbuffer);
+    renderbuffer = storagePoolRenderbuffer(renderbuffer);
+    namePoolBind(NAME_RENDERBUFFER, renderbuffer);
+    PROFILE_DRIVER(glBindRenderbuffer(target, renderbuffer));
 }
 
 GLenum vglCheckFramebufferStatus(GLenum target) {
-    return glCheckFramebufferStatus(target);
+    PROFILE_CALL(CheckFramebufferStatus);
+    flushPasses();
+    GLenum result;
+    PROFILE_DRIVER(result = glCheckFramebufferStatus(target));
+    return result;
 }
 
 void vglDrawBuffers(GLsizei n, const GLenum* bufs) {
-    glDrawBuffers(n, bufs);
+    PROFILE_CALL(DrawBuffers);
+    idleHashArray(PROFILE_CALL_DrawBuffers, bufs, n, sizeof(GLenum));
+    flushPasses();
+    fbInvalidateDrawBuffers(n, bufs);
+    GLenum mapped[16];
+    GLuint framebuffer = g_wrapperCtx ? g_wrapperCtx->state.framebuffer.drawFramebuffer : 1;
+    PROFILE_DRIVER(glDrawBuffers(n, mapDefaultBuffers(framebuffer, n, bufs, mapped, 16)));
 }
 
 void vglReadBuffer(GLenum mode) {
-    glReadBuffer(mode);
+    PROFILE_CALL(ReadBuffer);
+    IDLE_HASH(ReadBuffer, mode);
+    flushPasses();
+    if (g_wrapperCtx && g_wrapperCtx->state.framebuffer.readFramebuffer == 0 && isScaledFramebuffer(0)) {
+        mode = defaultBufferToAttachment(mode);
+    }
+    PROFILE_DRIVER(glReadBuffer(mode));
 }
 
 void vglBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1,
                          GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1,
                          GLbitfield mask, GLenum filter) {
-    glBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+    PROFILE_CALL(BlitFramebuffer);
+    IDLE_HASH(BlitFramebuffer, (uint64_t)srcX0, (uint64_t)srcY0, (uint64_t)srcX1, (uint64_t)srcY1,
+              (uint64_t)dstX0, (uint64_t)dstY0, (uint64_t)dstX1, (uint64_t)dstY1, mask, filter);
+    flushPasses();
+    if (g_wrapperCtx) {
+        const GLFramebufferState* fb = &g_wrapperCtx->state.framebuffer;
+        if (fb->drawFramebuffer == 0 && (mask & GL_COLOR_BUFFER_BIT)) {
+            GLint rect[4] = {
+                dstX0 < dstX1 ? dstX0 : dstX1, dstY0 < dstY1 ? dstY0 : dstY1,
+                abs(dstX1 - dstX0), abs(dstY1 - dstY0)
+            };
+            damageTrackerAddRect(rect);
+        }
+        if (isScaledFramebuffer(fb->readFramebuffer)) {
+            mapBlitRect(fb->readFramebuffer, &srcX0, &srcY0, &srcX1, &srcY1);
+        }
+        if (isScaledFramebuffer(fb->drawFramebuffer)) {
+            mapBlitRect(fb->drawFramebuffer, &dstX0, &dstY0, &dstX1, &dstY1);
+        }
+        fbInvalidateRead(fb->readFramebuffer, mask);
+    }
+    PROFILE_DRIVER(glBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter));
+}
+
+// App framebuffer bound to an invalidate target, nonzero if unknown
+static GLuint boundFramebuffer(GLenum target) {
+    if (!g_wrapperCtx) return 1;
+    return target == GL_READ_FRAMEBUFFER ? g_wrapperCtx->state.framebuffer.readFramebuffer
+                                         : g_wrapperCtx->state.framebuffer.drawFramebuffer;
+}
+
+// Window color left undefined has to be presented as damaged
+static bool invalidatesWindowColor(GLenum target, GLsizei numAttachments, const GLenum* attachments) {
+    if (!g_wrapperCtx || !attachments) return false;
+    
+    GLuint framebuffer = boundFramebuffer(target);
+    if (framebuffer != 0) return false;
+    
+    for (GLsizei i = 0; i < numAttachments; i++) {
+        if (attachments[i] == GL_COLOR) return true;
+    }
+    return false;
 }
 
 void vglInvalidateFramebuffer(GLenum target, GLsizei numAttachments, const GLenum* attachments) {
-    glInvalidateFramebuffer(target, numAttachments, attachments);
+    PROFILE_CALL(InvalidateFramebuffer);
+    IDLE_HASH(InvalidateFramebuffer, target);
+    idleHashArray(PROFILE_CALL_InvalidateFramebuffer, attachments, numAttachments, sizeof(GLenum));
+    flushPasses();
+    if (invalidatesWindowColor(target, numAttachments, attachments)) damageTrackerAddFull();
+    GLenum mapped[8];
+    attachments = mapDefaultBuffers(boundFramebuffer(target), numAttachments, attachments, mapped, 8);
+    PROFILE_DRIVER(glInvalidateFramebuffer(target, numAttachments, attachments));
+}
+
+void vglInvalidateSubFramebuffer(GLenum target, GLsizei numAttachments, const GLenum* attachments, 
+                                  GLint x, GLint y, GLsizei width, GLsizei height) {
+    PROFILE_CALL(InvalidateSubFramebuffer);
+    IDLE_HASH(InvalidateSubFramebuffer, target, (uint64_t)x, (uint64_t)y, (uint64_t)width, (uint64_t)height);
+    idleHashArray(PROFILE_CALL_InvalidateSubFramebuffer, attachments, numAttachments, sizeof(GLenum));
+    flushPasses();
+    if (invalidatesWindowColor(target, numAttachments, attachments)) {
+        GLint rect[4] = { x, y, width, height };
+        damageTrackerAddRect(rect);
+    }
+    GLuint framebuffer = boundFramebuffer(target);
+    GLenum mapped[8];
+    attachments = mapDefaultBuffers(framebuffer, numAttachments, attachments, mapped, 8);
+    
+    // Left unmapped, the window-space rect would discard live pixels past the subrect
+    GLint rect[4] = { x, y, width, height };
+    if (g_wrapperCtx && isScaledFramebuffer(framebuffer)) mapRect(framebuffer, rect);
+    PROFILE_DRIVER(glInvalidateSubFramebuffer(target, numAttachments, attachments,
+                                              rect[0], rect[1], rect[2], rect[3]));
+}
+
+void vglReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, 
+                    GLenum format, GLenum type, void* pixels) {
+    PROFILE_CALL(ReadPixels);
+    flushPasses();
+    if (g_wrapperCtx) fbInvalidateRead(g_wrapperCtx->state.framebuffer.readFramebuffer, GL_COLOR_BUFFER_BIT);
+    
+    // Readers polling every frame get the last completed read of the region
+    bool served;
+    PROFILE_DRIVER(served = readbackReadPixels(x, y, width, height, format, type, pixels));
+    if (served) return;
+    
+    TRACE_SCOPE("readback_sync");
+    FLIGHT_SCOPE(FLIGHT_EVENT_FENCE_WAIT, (uint64_t)width * height);
+    GLint rect[4] = { x, y, width, height };
+    bool staged = beginRead(rect);
+    uint64_t start = callProfilerNowNs();
+    PROFILE_DRIVER(glReadPixels(rect[0], rect[1], width, height, format, type, pixels));
+    readbackRecordSync(callProfilerNowNs() - start);
+    if (staged) resolutionScalerEndRead();
+}
+
+void vglReadnPixels(GLint x, GLint y, GLsizei width, GLsizei height,
+                    GLenum format, GLenum type, GLsizei bufSize, void* data) {
+    PROFILE_CALL(ReadnPixels);
+    flushPasses();
+    if (g_wrapperCtx) fbInvalidateRead(g_wrapperCtx->state.framebuffer.readFramebuffer, GL_COLOR_BUFFER_BIT);
+    
+    TRACE_SCOPE("readback_sync");
+    FLIGHT_SCOPE(FLIGHT_EVENT_FENCE_WAIT, (uint64_t)width * height);
+    GLint rect[4] = { x, y, width, height };
+    bool staged = beginRead(rect);
+    uint64_t start = callProfilerNowNs();
+    PROFILE_DRIVER(glReadnPixels(rect[0], rect[1], width, height, format, type, bufSize, data));
+    readbackRecordSync(callProfilerNowNs() - start);
+    if (staged) resolutionScalerEndRead();
+}
+
+void vglCopyTexImage2D(GLenum target, GLint level, GLenum internalformat, 
+                        GLint x, GLint y, GLsizei width, GLsizei height, GLint border) {
+    PROFILE_CALL(CopyTexImage2D);
+    IDLE_HASH(CopyTexImage2D, target, (uint64_t)level, internalformat,
+              (uint64_t)x, (uint64_t)y, (uint64_t)width, (uint64_t)height);
+    flushPasses();
+    if (g_wrapperCtx) fbInvalidateRead(g_wrapperCtx->state.framebuffer.readFramebuffer, GL_COLOR_BUFFER_BIT);
+    storagePoolDropBound(target);
+    GLint rect[4] = { x, y, width, height };
+    bool staged = beginRead(rect);
+    PROFILE_DRIVER(glCopyTexImage2D(target, level, internalformat, rect[0], rect[1], width, height, border));
+    if (staged) resolutionScalerEndRead();
+}
+
+void vglCopyTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, 
+                           GLint x, GLint y, GLsizei width, GLsizei height) {
+    PROFILE_CALL(CopyTexSubImage2D);
+    IDLE_HASH(CopyTexSubImage2D, target, (uint64_t)level, (uint64_t)xoffset, (uint64_t)yoffset,
+              (uint64_t)x, (uint64_t)y, (uint64_t)width, (uint64_t)height);
+    flushPasses();
+    if (g_wrapperCtx) fbInvalidateRead(g_wrapperCtx->state.framebuffer.readFramebuffer, GL_COLOR_BUFFER_BIT);
+    GLint rect[4] = { x, y, width, height };
+    bool staged = beginRead(rect);
+    PROFILE_DRIVER(glCopyTexSubImage2D(target, level, xoffset, yoffset, rect[0], rect[1], width, height));
+    if (staged) resolutionScalerEndRead();
+}
+
+void vglCopyTexSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, 
+                           GLint x, GLint y, GLsizei width, GLsizei height) {
+    PROFILE_CALL(CopyTexSubImage3D);
+    IDLE_HASH(CopyTexSubImage3D, target, (uint64_t)level, (uint64_t)xoffset, (uint64_t)yoffset,
+              (uint64_t)zoffset, (uint64_t)x, (uint64_t)y, (uint64_t)width, (uint64_t)height);
+    flushPasses();
+    if (g_wrapperCtx) fbInvalidateRead(g_wrapperCtx->state.framebuffer.readFramebuffer, GL_COLOR_BUFFER_BIT);
+    GLint rect[4] = { x, y, width, height };
+    bool staged = beginRead(rect);
+    PROFILE_DRIVER(glCopyTexSubImage3D(target, level, xoffset, yoffset, zoffset, rect[0], rect[1], width, height));
+    if (staged) resolutionScalerEndRead();
 }
 
 // ============================================================================
@@ -467,6 +1878,10 @@ void vglInvalidateFramebuffer(GLenum target, GLsizei numAttachments, const GLenu
 // ============================================================================
 
 void vglEnable(GLenum cap) {
+    PROFILE_CALL(Enable);
+    FLIGHT_COUNT(FLIGHT_EVENT_STATE_CHANGE);
+    IDLE_HASH(Enable, cap);
+    flushPendingClear();
     // Track common states
     if (g_wrapperCtx) {
         switch (cap) {
@@ -482,12 +1897,19 @@ void vglEnable(GLenum cap) {
             case GL_SCISSOR_TEST:
                 g_wrapperCtx->state.rasterizer.scissorEnabled = true;
                 break;
+            case GL_STENCIL_TEST:
+                resolutionScalerRequireFormats(true, false);
+                break;
         }
     }
-    glEnable(cap);
+    PROFILE_DRIVER(glEnable(cap));
 }
 
 void vglDisable(GLenum cap) {
+    PROFILE_CALL(Disable);
+    FLIGHT_COUNT(FLIGHT_EVENT_STATE_CHANGE);
+    IDLE_HASH(Disable, cap);
+    flushPendingClear();
     if (g_wrapperCtx) {
         switch (cap) {
             case GL_BLEND:
@@ -504,11 +1926,19 @@ void vglDisable(GLenum cap) {
                 break;
         }
     }
-    glDisable(cap);
+    PROFILE_DRIVER(glDisable(cap));
 }
 
 GLboolean vglIsEnabled(GLenum cap) {
-    return glIsEnabled(cap);
+    PROFILE_CALL(IsEnabled);
+    GLboolean result;
+    PROFILE_DRIVER(result = glIsEnabled(cap));
+    return result;
+}
+
+static inline bool usesDstAlpha(GLenum factor) {
+    return factor == GL_DST_ALPHA || factor == GL_ONE_MINUS_DST_ALPHA ||
+           factor == GL_SRC_ALPHA_SATURATE;
 }
 
 void vglBlendFunc(GLenum sfactor, GLenum dfactor) {
@@ -517,13 +1947,20 @@ void vglBlendFunc(GLenum sfactor, GLenum dfactor) {
 
 void vglBlendFuncSeparate(GLenum sfactorRGB, GLenum dfactorRGB, 
                            GLenum sfactorAlpha, GLenum dfactorAlpha) {
+    PROFILE_CALL(BlendFuncSeparate);
+    FLIGHT_COUNT(FLIGHT_EVENT_STATE_CHANGE);
+    IDLE_HASH(BlendFuncSeparate, sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha);
     if (g_wrapperCtx) {
         g_wrapperCtx->state.blend.srcRGB = sfactorRGB;
         g_wrapperCtx->state.blend.dstRGB = dfactorRGB;
         g_wrapperCtx->state.blend.srcAlpha = sfactorAlpha;
         g_wrapperCtx->state.blend.dstAlpha = dfactorAlpha;
     }
-    glBlendFuncSeparate(sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha);
+    if (usesDstAlpha(sfactorRGB) || usesDstAlpha(dfactorRGB) ||
+        usesDstAlpha(sfactorAlpha) || usesDstAlpha(dfactorAlpha)) {
+        resolutionScalerRequireFormats(false, true);
+    }
+    PROFILE_DRIVER(glBlendFuncSeparate(sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha));
 }
 
 void vglBlendEquation(GLenum mode) {
@@ -531,84 +1968,141 @@ void vglBlendEquation(GLenum mode) {
 }
 
 void vglBlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha) {
+    PROFILE_CALL(BlendEquationSeparate);
+    FLIGHT_COUNT(FLIGHT_EVENT_STATE_CHANGE);
+    IDLE_HASH(BlendEquationSeparate, modeRGB, modeAlpha);
     if (g_wrapperCtx) {
         g_wrapperCtx->state.blend.modeRGB = modeRGB;
         g_wrapperCtx->state.blend.modeAlpha = modeAlpha;
     }
-    glBlendEquationSeparate(modeRGB, modeAlpha);
+    PROFILE_DRIVER(glBlendEquationSeparate(modeRGB, modeAlpha));
 }
 
 void vglDepthFunc(GLenum func) {
+    PROFILE_CALL(DepthFunc);
+    FLIGHT_COUNT(FLIGHT_EVENT_STATE_CHANGE);
+    IDLE_HASH(DepthFunc, func);
     if (g_wrapperCtx) g_wrapperCtx->state.depth.func = func;
-    glDepthFunc(func);
+    PROFILE_DRIVER(glDepthFunc(func));
 }
 
 void vglDepthMask(GLboolean flag) {
+    PROFILE_CALL(DepthMask);
+    FLIGHT_COUNT(FLIGHT_EVENT_STATE_CHANGE);
+    IDLE_HASH(DepthMask, flag);
+    flushPendingClear();
     if (g_wrapperCtx) g_wrapperCtx->state.depth.writeEnabled = flag;
-    glDepthMask(flag);
+    PROFILE_DRIVER(glDepthMask(flag));
 }
 
 void vglDepthRangef(GLfloat n, GLfloat f) {
+    PROFILE_CALL(DepthRangef);
+    IDLE_HASH(DepthRangef, frameIdleBits(n), frameIdleBits(f));
     if (g_wrapperCtx) {
         g_wrapperCtx->state.depth.rangeNear = n;
         g_wrapperCtx->state.depth.rangeFar = f;
     }
-    glDepthRangef(n, f);
+    PROFILE_DRIVER(glDepthRangef(n, f));
 }
 
 void vglCullFace(GLenum mode) {
+    PROFILE_CALL(CullFace);
+    FLIGHT_COUNT(FLIGHT_EVENT_STATE_CHANGE);
+    IDLE_HASH(CullFace, mode);
     if (g_wrapperCtx) g_wrapperCtx->state.rasterizer.cullMode = mode;
-    glCullFace(mode);
+    PROFILE_DRIVER(glCullFace(mode));
 }
 
 void vglFrontFace(GLenum mode) {
+    PROFILE_CALL(FrontFace);
+    FLIGHT_COUNT(FLIGHT_EVENT_STATE_CHANGE);
+    IDLE_HASH(FrontFace, mode);
     if (g_wrapperCtx) g_wrapperCtx->state.rasterizer.frontFace = mode;
-    glFrontFace(mode);
+    PROFILE_DRIVER(glFrontFace(mode));
 }
 
 void vglPolygonOffset(GLfloat factor, GLfloat units) {
-    glPolygonOffset(factor, units);
+    PROFILE_CALL(PolygonOffset);
+    IDLE_HASH(PolygonOffset, frameIdleBits(factor), frameIdleBits(units));
+    PROFILE_DRIVER(glPolygonOffset(factor, units));
 }
 
 void vglLineWidth(GLfloat width) {
+    PROFILE_CALL(LineWidth);
+    IDLE_HASH(LineWidth, frameIdleBits(width));
     if (g_wrapperCtx) g_wrapperCtx->state.rasterizer.lineWidth = width;
-    glLineWidth(width);
+    PROFILE_DRIVER(glLineWidth(width));
 }
 
 void vglViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    PROFILE_CALL(Viewport);
+    IDLE_HASH(Viewport, (uint64_t)x, (uint64_t)y, (uint64_t)width, (uint64_t)height);
     if (g_wrapperCtx) {
         g_wrapperCtx->state.rasterizer.viewport[0] = x;
         g_wrapperCtx->state.rasterizer.viewport[1] = y;
         g_wrapperCtx->state.rasterizer.viewport[2] = width;
         g_wrapperCtx->state.rasterizer.viewport[3] = height;
+        
+        if (mapsRects()) {
+            PROFILE_DRIVER(applyViewport());
+            return;
+        }
     }
-    glViewport(x, y, width, height);
+    PROFILE_DRIVER(glViewport(x, y, width, height));
 }
 
 void vglScissor(GLint x, GLint y, GLsizei width, GLsizei height) {
+    PROFILE_CALL(Scissor);
+    IDLE_HASH(Scissor, (uint64_t)x, (uint64_t)y, (uint64_t)width, (uint64_t)height);
+    flushPendingClear();
     if (g_wrapperCtx) {
         g_wrapperCtx->state.rasterizer.scissor[0] = x;
         g_wrapperCtx->state.rasterizer.scissor[1] = y;
         g_wrapperCtx->state.rasterizer.scissor[2] = width;
         g_wrapperCtx->state.rasterizer.scissor[3] = height;
+        
+        if (mapsRects()) {
+            PROFILE_DRIVER(applyScissor());
+            return;
+        }
     }
-    glScissor(x, y, width, height);
+    PROFILE_DRIVER(glScissor(x, y, width, height));
 }
 
 void vglColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha) {
-    glColorMask(red, green, blue, alpha);
+    PROFILE_CALL(ColorMask);
+    IDLE_HASH(ColorMask, red, green, blue, alpha);
+    flushPendingClear();
+    if (g_wrapperCtx) {
+        g_wrapperCtx->state.blend.colorMask[0] = red;
+        g_wrapperCtx->state.blend.colorMask[1] = green;
+        g_wrapperCtx->state.blend.colorMask[2] = blue;
+        g_wrapperCtx->state.blend.colorMask[3] = alpha;
+    }
+    PROFILE_DRIVER(glColorMask(red, green, blue, alpha));
 }
 
 void vglStencilFunc(GLenum func, GLint ref, GLuint mask) {
-    glStencilFunc(func, ref, mask);
+    PROFILE_CALL(StencilFunc);
+    IDLE_HASH(StencilFunc, func, (uint64_t)ref, mask);
+    PROFILE_DRIVER(glStencilFunc(func, ref, mask));
 }
 
 void vglStencilOp(GLenum sfail, GLenum dpfail, GLenum dppass) {
-    glStencilOp(sfail, dpfail, dppass);
+    PROFILE_CALL(StencilOp);
+    IDLE_HASH(StencilOp, sfail, dpfail, dppass);
+    PROFILE_DRIVER(glStencilOp(sfail, dpfail, dppass));
 }
 
 void vglStencilMask(GLuint mask) {
-    glStencilMask(mask);
+    PROFILE_CALL(StencilMask);
+    IDLE_HASH(StencilMask, mask);
+    flushPendingClear();
+    if (g_wrapperCtx) {
+        g_wrapperCtx->state.stencilFront.writeMask = mask;
+        g_wrapperCtx->state.stencilBack.writeMask = mask;
+    }
+    PROFILE_DRIVER(glStencilMask(mask));
 }
 
 // ============================================================================
@@ -616,27 +2110,108 @@ void vglStencilMask(GLuint mask) {
 // ============================================================================
 
 void vglClear(GLbitfield mask) {
+    PROFILE_CALL(Clear);
+    IDLE_HASH(Clear, mask);
+    renderPassFlush();
+    fbInvalidateClear(mask);
+    
+    // Consecutive clears merge into one at the next draw
+    if (renderPassDeferClear(mask)) return;
+    issueClear(mask);
+}
+
+// Deferred clears are issued from other entry points, outside vglClear's
+// profiler scope
+static void issueClear(GLbitfield mask) {
+    renderPassNoteClearIssued();
+    if (mask & GL_COLOR_BUFFER_BIT) damageWindow(false);
+    
+    // Keep full-window clears inside the subrect instead of the whole
+    // max-size render target
+    if (drawingScaled() && !g_wrapperCtx->state.rasterizer.scissorEnabled) {
+        int width, height;
+        resolutionScalerGetRenderSize(&width, &height);
+        
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(0, 0, width, height);
+        glClear(mask);
+        glDisable(GL_SCISSOR_TEST);
+        applyScissor();
+        return;
+    }
+    
+    // After a UI split the backbuffer holds the upscaled scene: the UI
+    // draws over it, so a color clear would wipe the frame
+    if (g_wrapperCtx && g_wrapperCtx->state.framebuffer.drawFramebuffer == 0 &&
+        uiSplitIsActive() && resolutionScalerIsEnabled() && resolutionScalerGetTargetFBO() == 0) {
+        mask &= ~GL_COLOR_BUFFER_BIT;
+        if (!mask) return;
+    }
+    
     glClear(mask);
 }
 
 void vglClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+    PROFILE_CALL(ClearColor);
+    IDLE_HASH(ClearColor, frameIdleBits(red), frameIdleBits(green), frameIdleBits(blue), frameIdleBits(alpha));
+    flushPendingClear();
     if (g_wrapperCtx) {
         g_wrapperCtx->state.clearColor[0] = red;
         g_wrapperCtx->state.clearColor[1] = green;
         g_wrapperCtx->state.clearColor[2] = blue;
         g_wrapperCtx->state.clearColor[3] = alpha;
     }
-    glClearColor(red, green, blue, alpha);
+    PROFILE_DRIVER(glClearColor(red, green, blue, alpha));
 }
 
 void vglClearDepthf(GLfloat d) {
+    PROFILE_CALL(ClearDepthf);
+    IDLE_HASH(ClearDepthf, frameIdleBits(d));
+    flushPendingClear();
     if (g_wrapperCtx) g_wrapperCtx->state.clearDepth = d;
-    glClearDepthf(d);
+    PROFILE_DRIVER(glClearDepthf(d));
 }
 
 void vglClearStencil(GLint s) {
+    PROFILE_CALL(ClearStencil);
+    IDLE_HASH(ClearStencil, (uint64_t)s);
+    flushPendingClear();
     if (g_wrapperCtx) g_wrapperCtx->state.clearStencil = s;
-    glClearStencil(s);
+    PROFILE_DRIVER(glClearStencil(s));
+}
+
+void vglClearBufferfv(GLenum buffer, GLint drawbuffer, const GLfloat* value) {
+    PROFILE_CALL(ClearBufferfv);
+    idleHashValues(PROFILE_CALL_ClearBufferfv, (GLint)buffer, buffer == GL_COLOR ? 4 : 1, value, sizeof(GLfloat));
+    IDLE_HASH(ClearBufferfv, (uint64_t)drawbuffer);
+    flushPasses();
+    if (buffer == GL_COLOR) damageWindow(false);
+    PROFILE_DRIVER(glClearBufferfv(buffer, drawbuffer, value));
+}
+
+void vglClearBufferiv(GLenum buffer, GLint drawbuffer, const GLint* value) {
+    PROFILE_CALL(ClearBufferiv);
+    idleHashValues(PROFILE_CALL_ClearBufferiv, (GLint)buffer, buffer == GL_COLOR ? 4 : 1, value, sizeof(GLint));
+    IDLE_HASH(ClearBufferiv, (uint64_t)drawbuffer);
+    flushPasses();
+    if (buffer == GL_COLOR) damageWindow(false);
+    PROFILE_DRIVER(glClearBufferiv(buffer, drawbuffer, value));
+}
+
+void vglClearBufferuiv(GLenum buffer, GLint drawbuffer, const GLuint* value) {
+    PROFILE_CALL(ClearBufferuiv);
+    idleHashValues(PROFILE_CALL_ClearBufferuiv, (GLint)buffer, buffer == GL_COLOR ? 4 : 1, value, sizeof(GLuint));
+    IDLE_HASH(ClearBufferuiv, (uint64_t)drawbuffer);
+    flushPasses();
+    if (buffer == GL_COLOR) damageWindow(false);
+    PROFILE_DRIVER(glClearBufferuiv(buffer, drawbuffer, value));
+}
+
+void vglClearBufferfi(GLenum buffer, GLint drawbuffer, GLfloat depth, GLint stencil) {
+    PROFILE_CALL(ClearBufferfi);
+    IDLE_HASH(ClearBufferfi, buffer, (uint64_t)drawbuffer, frameIdleBits(depth), (uint64_t)stencil);
+    flushPasses();
+    PROFILE_DRIVER(glClearBufferfi(buffer, drawbuffer, depth, stencil));
 }
 
 // ============================================================================
@@ -644,6 +2219,7 @@ void vglClearStencil(GLint s) {
 // ============================================================================
 
 void vglGetIntegerv(GLenum pname, GLint* data) {
+    PROFILE_CALL(GetIntegerv);
     // Override some values to report GL 4.x
     switch (pname) {
         case GL_MAJOR_VERSION:
@@ -658,19 +2234,72 @@ void vglGetIntegerv(GLenum pname, GLint* data) {
                 return;
             }
             break;
+        // Report window-space state while rects are mapped
+        case GL_VIEWPORT:
+            if (mapsRects()) {
+                memcpy(data, g_wrapperCtx->state.rasterizer.viewport, 4 * sizeof(GLint));
+                return;
+            }
+            break;
+        case GL_SCISSOR_BOX:
+            if (mapsRects()) {
+                memcpy(data, g_wrapperCtx->state.rasterizer.scissor, 4 * sizeof(GLint));
+                return;
+            }
+            break;
+        case GL_DRAW_FRAMEBUFFER_BINDING:
+            if (g_wrapperCtx && (resolutionScalerGetTargetFBO() || renderPassIsEnabled())) {
+                *data = (GLint)g_wrapperCtx->state.framebuffer.drawFramebuffer;
+                return;
+            }
+            break;
+        case GL_READ_FRAMEBUFFER_BINDING:
+            if (g_wrapperCtx && (resolutionScalerGetTargetFBO() || renderPassIsEnabled())) {
+                *data = (GLint)g_wrapperCtx->state.framebuffer.readFramebuffer;
+                return;
+            }
+            break;
+        // App names of recycled storage
+        case GL_TEXTURE_BINDING_2D:
+        case GL_TEXTURE_BINDING_3D:
+        case GL_TEXTURE_BINDING_CUBE_MAP:
+        case GL_TEXTURE_BINDING_2D_ARRAY:
+            PROFILE_DRIVER(glGetIntegerv(pname, data));
+            *data = (GLint)storagePoolAppTexture((GLuint)*data);
+            return;
+        case GL_RENDERBUFFER_BINDING:
+            PROFILE_DRIVER(glGetIntegerv(pname, data));
+            *data = (GLint)storagePoolAppRenderbuffer((GLuint)*data);
+            return;
+        // The driver has a cached VAO bound, not the app's
+        case GL_VERTEX_ARRAY_BINDING:
+            if (g_vaoCacheActive && g_wrapperCtx) {
+                *data = (GLint)g_wrapperCtx->state.vertexArray;
+                return;
+            }
+            break;
+        case GL_ELEMENT_ARRAY_BUFFER_BINDING:
+            if (g_vaoCacheActive) {
+                *data = (GLint)vaoCacheElementBuffer();
+                return;
+            }
+            break;
     }
-    glGetIntegerv(pname, data);
+    PROFILE_DRIVER(glGetIntegerv(pname, data));
 }
 
 void vglGetFloatv(GLenum pname, GLfloat* data) {
-    glGetFloatv(pname, data);
+    PROFILE_CALL(GetFloatv);
+    PROFILE_DRIVER(glGetFloatv(pname, data));
 }
 
 void vglGetBooleanv(GLenum pname, GLboolean* data) {
-    glGetBooleanv(pname, data);
+    PROFILE_CALL(GetBooleanv);
+    PROFILE_DRIVER(glGetBooleanv(pname, data));
 }
 
 const GLubyte* vglGetString(GLenum name) {
+    PROFILE_CALL(GetString);
     // Override version string
     static char versionString[128];
     static char rendererString[256];
@@ -696,15 +2325,23 @@ const GLubyte* vglGetString(GLenum name) {
             break;
     }
     
-    return glGetString(name);
+    const GLubyte* result;
+    PROFILE_DRIVER(result = glGetString(name));
+    return result;
 }
 
 const GLubyte* vglGetStringi(GLenum name, GLuint index) {
-    return glGetStringi(name, index);
+    PROFILE_CALL(GetStringi);
+    const GLubyte* result;
+    PROFILE_DRIVER(result = glGetStringi(name, index));
+    return result;
 }
 
 GLenum vglGetError(void) {
-    return glGetError();
+    PROFILE_CALL(GetError);
+    GLenum result;
+    PROFILE_DRIVER(result = glGetError());
+    return result;
 }
 
 // ============================================================================
@@ -712,19 +2349,104 @@ GLenum vglGetError(void) {
 // ============================================================================
 
 GLsync vglFenceSync(GLenum condition, GLbitfield flags) {
-    return glFenceSync(condition, flags);
+    PROFILE_CALL(FenceSync);
+    flushPasses();
+    GLsync result;
+    PROFILE_DRIVER(result = glFenceSync(condition, flags));
+    return result;
 }
 
 void vglDeleteSync(GLsync sync) {
-    glDeleteSync(sync);
+    PROFILE_CALL(DeleteSync);
+    PROFILE_DRIVER(glDeleteSync(sync));
 }
 
 GLenum vglClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) {
-    return glClientWaitSync(sync, flags, timeout);
+    PROFILE_CALL(ClientWaitSync);
+    FLIGHT_SCOPE(FLIGHT_EVENT_FENCE_WAIT, timeout);
+    GLenum result;
+    if (timeout == 0) {
+        PROFILE_DRIVER(result = glClientWaitSync(sync, flags, timeout));
+        return result;
+    }
+    
+    uint64_t start = callProfilerNowNs();
+    PROFILE_DRIVER(result = glClientWaitSync(sync, flags, timeout));
+    fenceTimelineRecordStall(FENCE_WAIT_APP_SYNC, callProfilerNowNs() - start);
+    return result;
 }
 
 void vglWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) {
-    glWaitSync(sync, flags, timeout);
+    PROFILE_CALL(WaitSync);
+    PROFILE_DRIVER(glWaitSync(sync, flags, timeout));
+}
+
+void vglFinish(void) {
+    PROFILE_CALL(Finish);
+    flushPasses();
+    drawBatcherFlush();
+    
+    // Latency mode bounds the wait to the last frame fence
+    if (frameThrottleFinish()) return;
+    
+    uint64_t start = callProfilerNowNs();
+    PROFILE_DRIVER(glFinish());
+    fenceTimelineRecordStall(FENCE_WAIT_FINISH, callProfilerNowNs() - start);
+}
+
+void vglFlush(void) {
+    PROFILE_CALL(Flush);
+    flushPasses();
+    drawBatcherFlush();
+    PROFILE_DRIVER(glFlush());
+}
+
+// ============================================================================
+// Queries and Transform Feedback
+// ============================================================================
+
+// Draws recorded so far belong before the boundary, in the bound framebuffer
+
+void vglBeginQuery(GLenum target, GLuint id) {
+    PROFILE_CALL(BeginQuery);
+    flushPasses();
+    drawBatcherFlush();
+    PROFILE_DRIVER(glBeginQuery(target, id));
+}
+
+void vglEndQuery(GLenum target) {
+    PROFILE_CALL(EndQuery);
+    flushPasses();
+    drawBatcherFlush();
+    PROFILE_DRIVER(glEndQuery(target));
+}
+
+void vglBeginTransformFeedback(GLenum primitiveMode) {
+    PROFILE_CALL(BeginTransformFeedback);
+    flushPasses();
+    drawBatcherFlush();
+    PROFILE_DRIVER(glBeginTransformFeedback(primitiveMode));
+}
+
+void vglEndTransformFeedback(void) {
+    PROFILE_CALL(EndTransformFeedback);
+    flushPasses();
+    drawBatcherFlush();
+    PROFILE_DRIVER(glEndTransformFeedback());
+}
+
+void vglPauseTransformFeedback(void) {
+    PROFILE_CALL(PauseTransformFeedback);
+    flushPasses();
+    drawBatcherFlush();
+    PROFILE_DRIVER(glPauseTransformFeedback());
+}
+
+void vglResumeTransformFeedback(void) {
+    PROFILE_CALL(ResumeTransformFeedback);
+    flushPasses();
+    drawBatcherFlush();
+    PROFILE_DRIVER(glResumeTransformFeedback());
 }
 
 // ============================================================================
@@ -732,11 +2454,38 @@ void vglWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) {
 // ============================================================================
 
 void vglDispatchCompute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z) {
-    glDispatchCompute(num_groups_x, num_groups_y, num_groups_z);
+    PROFILE_CALL(DispatchCompute);
+    IDLE_HASH(DispatchCompute, num_groups_x, num_groups_y, num_groups_z);
+    flushPasses();
+    PROFILE_DRIVER(glDispatchCompute(num_groups_x, num_groups_y, num_groups_z));
 }
 
 void vglMemoryBarrier(GLbitfield barriers) {
-    glMemoryBarrier(barriers);
+    PROFILE_CALL(MemoryBarrier);
+    IDLE_HASH(MemoryBarrier, barriers);
+    PROFILE_DRIVER(glMemoryBarrier(barriers));
+}
+
+void vglBindImageTexture(GLuint unit, GLuint texture, GLint level, GLboolean layered,
+                         GLint layer, GLenum access, GLenum format) {
+    PROFILE_CALL(BindImageTexture);
+    IDLE_HASH(BindImageTexture, unit, texture, (uint64_t)level, layered, (uint64_t)layer, access, format);
+    PROFILE_DRIVER(glBindImageTexture(unit, storagePoolTexture(texture), level, layered, layer, access, format));
+}
+
+void vglCopyImageSubData(GLuint srcName, GLenum srcTarget, GLint srcLevel, GLint srcX, GLint srcY, GLint srcZ,
+                         GLuint dstName, GLenum dstTarget, GLint dstLevel, GLint dstX, GLint dstY, GLint dstZ,
+                         GLsizei srcWidth, GLsizei srcHeight, GLsizei srcDepth) {
+    PROFILE_CALL(CopyImageSubData);
+    IDLE_HASH(CopyImageSubData, srcName, srcTarget, (uint64_t)srcLevel, dstName, dstTarget, (uint64_t)dstLevel,
+              (uint64_t)srcX, (uint64_t)srcY, (uint64_t)srcZ, (uint64_t)dstX, (uint64_t)dstY, (uint64_t)dstZ,
+              (uint64_t)srcWidth, (uint64_t)srcHeight, (uint64_t)srcDepth);
+    flushPasses();
+    srcName = srcTarget == GL_RENDERBUFFER ? storagePoolRenderbuffer(srcName) : storagePoolTexture(srcName);
+    dstName = dstTarget == GL_RENDERBUFFER ? storagePoolRenderbuffer(dstName) : storagePoolTexture(dstName);
+    PROFILE_DRIVER(glCopyImageSubData(srcName, srcTarget, srcLevel, srcX, srcY, srcZ,
+                                      dstName, dstTarget, dstLevel, dstX, dstY, dstZ,
+                                      srcWidth, srcHeight, srcDepth));
 }
 
 // ============================================================================
@@ -752,6 +2501,19 @@ static void registerFunctions(void) {
     addFunction("glMultiDrawArrays", vglMultiDrawArrays);
     addFunction("glMultiDrawElements", vglMultiDrawElements);
     addFunction("glDrawRangeElements", vglDrawRangeElements);
+    addFunction("glDrawElementsBaseVertex", vglDrawElementsBaseVertex);
+    addFunction("glDrawRangeElementsBaseVertex", vglDrawRangeElementsBaseVertex);
+    addFunction("glDrawElementsInstancedBaseVertex", vglDrawElementsInstancedBaseVertex);
+    addFunction("glDrawArraysIndirect", vglDrawArraysIndirect);
+    addFunction("glDrawElementsIndirect", vglDrawElementsIndirect);
+    addFunction("glDrawElementsBaseVertexEXT", vglDrawElementsBaseVertex);
+    addFunction("glDrawElementsBaseVertexOES", vglDrawElementsBaseVertex);
+    addFunction("glDrawRangeElementsBaseVertexEXT", vglDrawRangeElementsBaseVertex);
+    addFunction("glDrawRangeElementsBaseVertexOES", vglDrawRangeElementsBaseVertex);
+    addFunction("glDrawElementsInstancedBaseVertexEXT", vglDrawElementsInstancedBaseVertex);
+    addFunction("glDrawElementsInstancedBaseVertexOES", vglDrawElementsInstancedBaseVertex);
+    addFunction("glDrawArraysInstancedEXT", vglDrawArraysInstanced);
+    addFunction("glDrawElementsInstancedEXT", vglDrawElementsInstanced);
     
     // Shaders
     addFunction("glCreateShader", vglCreateShader);
@@ -791,6 +2553,7 @@ static void registerFunctions(void) {
     addFunction("glBufferSubData", vglBufferSubData);
     addFunction("glMapBufferRange", vglMapBufferRange);
     addFunction("glUnmapBuffer", vglUnmapBuffer);
+    addFunction("glCopyBufferSubData", vglCopyBufferSubData);
     addFunction("glBindBufferBase", vglBindBufferBase);
     addFunction("glBindBufferRange", vglBindBufferRange);
     
@@ -802,16 +2565,30 @@ static void registerFunctions(void) {
     addFunction("glDisableVertexAttribArray", vglDisableVertexAttribArray);
     addFunction("glVertexAttribPointer", vglVertexAttribPointer);
     addFunction("glVertexAttribDivisor", vglVertexAttribDivisor);
+    addFunction("glVertexAttribFormat", vglVertexAttribFormat);
+    addFunction("glVertexAttribIFormat", vglVertexAttribIFormat);
+    addFunction("glVertexAttribBinding", vglVertexAttribBinding);
+    addFunction("glBindVertexBuffer", vglBindVertexBuffer);
+    addFunction("glVertexBindingDivisor", vglVertexBindingDivisor);
     
     // Framebuffers
     addFunction("glBindFramebuffer", vglBindFramebuffer);
     addFunction("glFramebufferTexture2D", vglFramebufferTexture2D);
     addFunction("glFramebufferRenderbuffer", vglFramebufferRenderbuffer);
+    addFunction("glFramebufferTextureLayer", vglFramebufferTextureLayer);
+    addFunction("glFramebufferTexture", vglFramebufferTexture);
+    addFunction("glFramebufferTextureEXT", vglFramebufferTexture);
+    addFunction("glFramebufferTextureOES", vglFramebufferTexture);
+    addFunction("glFramebufferParameteri", vglFramebufferParameteri);
+    addFunction("glGetFramebufferAttachmentParameteriv", vglGetFramebufferAttachmentParameteriv);
     addFunction("glCheckFramebufferStatus", vglCheckFramebufferStatus);
     addFunction("glDrawBuffers", vglDrawBuffers);
+    addFunction("glDrawBuffersEXT", vglDrawBuffers);
     addFunction("glReadBuffer", vglReadBuffer);
     addFunction("glBlitFramebuffer", vglBlitFramebuffer);
     addFunction("glInvalidateFramebuffer", vglInvalidateFramebuffer);
+    addFunction("glInvalidateSubFramebuffer", vglInvalidateSubFramebuffer);
+    addFunction("glDiscardFramebufferEXT", vglInvalidateFramebuffer);
     
     // State
     addFunction("glEnable", vglEnable);
@@ -840,6 +2617,10 @@ static void registerFunctions(void) {
     addFunction("glClearColor", vglClearColor);
     addFunction("glClearDepthf", vglClearDepthf);
     addFunction("glClearStencil", vglClearStencil);
+    addFunction("glClearBufferfv", vglClearBufferfv);
+    addFunction("glClearBufferiv", vglClearBufferiv);
+    addFunction("glClearBufferuiv", vglClearBufferuiv);
+    addFunction("glClearBufferfi", vglClearBufferfi);
     
     // Query
     addFunction("glGetIntegerv", vglGetIntegerv);
@@ -858,19 +2639,21 @@ static void registerFunctions(void) {
     // Compute
     addFunction("glDispatchCompute", vglDispatchCompute);
     addFunction("glMemoryBarrier", vglMemoryBarrier);
+    addFunction("glBindImageTexture", vglBindImageTexture);
+    addFunction("glCopyImageSubData", vglCopyImageSubData);
     
     // Additional Gen/Delete functions
-    addFunction("glGenTextures", glGenTextures);
-    addFunction("glDeleteTextures", glDeleteTextures);
-    addFunction("glGenBuffers", glGenBuffers);
-    addFunction("glDeleteBuffers", glDeleteBuffers);
-    addFunction("glGenFramebuffers", glGenFramebuffers);
-    addFunction("glDeleteFramebuffers", glDeleteFramebuffers);
-    addFunction("glGenRenderbuffers", glGenRenderbuffers);
-    addFunction("glDeleteRenderbuffers", glDeleteRenderbuffers);
-    addFunction("glBindRenderbuffer", glBindRenderbuffer);
-    addFunction("glRenderbufferStorage", glRenderbufferStorage);
-    addFunction("glRenderbufferStorageMultisample", glRenderbufferStorageMultisample);
+    addFunction("glGenTextures", vglGenTextures);
+    addFunction("glDeleteTextures", vglDeleteTextures);
+    addFunction("glGenBuffers", vglGenBuffers);
+    addFunction("glDeleteBuffers", vglDeleteBuffers);
+    addFunction("glGenFramebuffers", vglGenFramebuffers);
+    addFunction("glDeleteFramebuffers", vglDeleteFramebuffers);
+    addFunction("glGenRenderbuffers", vglGenRenderbuffers);
+    addFunction("glDeleteRenderbuffers", vglDeleteRenderbuffers);
+    addFunction("glBindRenderbuffer", vglBindRenderbuffer);
+    addFunction("glRenderbufferStorage", vglRenderbufferStorage);
+    addFunction("glRenderbufferStorageMultisample", vglRenderbufferStorageMultisample);
     
     // Shader queries
     addFunction("glGetShaderiv", glGetShaderiv);
@@ -882,55 +2665,65 @@ static void registerFunctions(void) {
     addFunction("glGetActiveUniform", glGetActiveUniform);
     addFunction("glGetActiveAttrib", glGetActiveAttrib);
     addFunction("glGetUniformBlockIndex", glGetUniformBlockIndex);
-    addFunction("glUniformBlockBinding", glUniformBlockBinding);
+    addFunction("glUniformBlockBinding", vglUniformBlockBinding);
     
     // More uniforms
-    addFunction("glUniform1iv", glUniform1iv);
-    addFunction("glUniform2i", glUniform2i);
-    addFunction("glUniform2iv", glUniform2iv);
-    addFunction("glUniform3i", glUniform3i);
-    addFunction("glUniform3iv", glUniform3iv);
-    addFunction("glUniform4i", glUniform4i);
-    addFunction("glUniform4iv", glUniform4iv);
-    addFunction("glUniform1fv", glUniform1fv);
-    addFunction("glUniform2fv", glUniform2fv);
-    addFunction("glUniform3fv", glUniform3fv);
-    addFunction("glUniform4fv", glUniform4fv);
-    addFunction("glUniformMatrix2fv", glUniformMatrix2fv);
-    addFunction("glUniformMatrix3fv", glUniformMatrix3fv);
-    addFunction("glUniformMatrix2x3fv", glUniformMatrix2x3fv);
-    addFunction("glUniformMatrix3x2fv", glUniformMatrix3x2fv);
-    addFunction("glUniformMatrix2x4fv", glUniformMatrix2x4fv);
-    addFunction("glUniformMatrix4x2fv", glUniformMatrix4x2fv);
-    addFunction("glUniformMatrix3x4fv", glUniformMatrix3x4fv);
-    addFunction("glUniformMatrix4x3fv", glUniformMatrix4x3fv);
+    addFunction("glUniform1iv", vglUniform1iv);
+    addFunction("glUniform2i", vglUniform2i);
+    addFunction("glUniform2iv", vglUniform2iv);
+    addFunction("glUniform3i", vglUniform3i);
+    addFunction("glUniform3iv", vglUniform3iv);
+    addFunction("glUniform4i", vglUniform4i);
+    addFunction("glUniform4iv", vglUniform4iv);
+    addFunction("glUniform1fv", vglUniform1fv);
+    addFunction("glUniform2fv", vglUniform2fv);
+    addFunction("glUniform3fv", vglUniform3fv);
+    addFunction("glUniform4fv", vglUniform4fv);
+    addFunction("glUniformMatrix2fv", vglUniformMatrix2fv);
+    addFunction("glUniformMatrix3fv", vglUniformMatrix3fv);
+    addFunction("glUniformMatrix2x3fv", vglUniformMatrix2x3fv);
+    addFunction("glUniformMatrix3x2fv", vglUniformMatrix3x2fv);
+    addFunction("glUniformMatrix2x4fv", vglUniformMatrix2x4fv);
+    addFunction("glUniformMatrix4x2fv", vglUniformMatrix4x2fv);
+    addFunction("glUniformMatrix3x4fv", vglUniformMatrix3x4fv);
+    addFunction("glUniformMatrix4x3fv", vglUniformMatrix4x3fv);
+    addFunction("glUniform1ui", vglUniform1ui);
+    addFunction("glUniform2ui", vglUniform2ui);
+    addFunction("glUniform3ui", vglUniform3ui);
+    addFunction("glUniform4ui", vglUniform4ui);
+    addFunction("glUniform1uiv", vglUniform1uiv);
+    addFunction("glUniform2uiv", vglUniform2uiv);
+    addFunction("glUniform3uiv", vglUniform3uiv);
+    addFunction("glUniform4uiv", vglUniform4uiv);
     
     // Vertex attributes
-    addFunction("glVertexAttrib1f", glVertexAttrib1f);
-    addFunction("glVertexAttrib2f", glVertexAttrib2f);
-    addFunction("glVertexAttrib3f", glVertexAttrib3f);
-    addFunction("glVertexAttrib4f", glVertexAttrib4f);
-    addFunction("glVertexAttrib1fv", glVertexAttrib1fv);
-    addFunction("glVertexAttrib2fv", glVertexAttrib2fv);
-    addFunction("glVertexAttrib3fv", glVertexAttrib3fv);
-    addFunction("glVertexAttrib4fv", glVertexAttrib4fv);
-    addFunction("glVertexAttribIPointer", glVertexAttribIPointer);
-    addFunction("glVertexAttribI4i", glVertexAttribI4i);
-    addFunction("glVertexAttribI4ui", glVertexAttribI4ui);
+    addFunction("glVertexAttrib1f", vglVertexAttrib1f);
+    addFunction("glVertexAttrib2f", vglVertexAttrib2f);
+    addFunction("glVertexAttrib3f", vglVertexAttrib3f);
+    addFunction("glVertexAttrib4f", vglVertexAttrib4f);
+    addFunction("glVertexAttrib1fv", vglVertexAttrib1fv);
+    addFunction("glVertexAttrib2fv", vglVertexAttrib2fv);
+    addFunction("glVertexAttrib3fv", vglVertexAttrib3fv);
+    addFunction("glVertexAttrib4fv", vglVertexAttrib4fv);
+    addFunction("glVertexAttribIPointer", vglVertexAttribIPointer);
+    addFunction("glGetVertexAttribiv", vglGetVertexAttribiv);
+    addFunction("glGetVertexAttribPointerv", vglGetVertexAttribPointerv);
+    addFunction("glVertexAttribI4i", vglVertexAttribI4i);
+    addFunction("glVertexAttribI4ui", vglVertexAttribI4ui);
     
     // Texture functions
-    addFunction("glTexStorage2D", glTexStorage2D);
-    addFunction("glTexStorage3D", glTexStorage3D);
-    addFunction("glTexSubImage3D", glTexSubImage3D);
-    addFunction("glCompressedTexImage2D", glCompressedTexImage2D);
-    addFunction("glCompressedTexImage3D", glCompressedTexImage3D);
-    addFunction("glCompressedTexSubImage2D", glCompressedTexSubImage2D);
-    addFunction("glCompressedTexSubImage3D", glCompressedTexSubImage3D);
-    addFunction("glCopyTexImage2D", glCopyTexImage2D);
-    addFunction("glCopyTexSubImage2D", glCopyTexSubImage2D);
-    addFunction("glCopyTexSubImage3D", glCopyTexSubImage3D);
-    addFunction("glTexParameteriv", glTexParameteriv);
-    addFunction("glTexParameterfv", glTexParameterfv);
+    addFunction("glTexStorage2D", vglTexStorage2D);
+    addFunction("glTexStorage3D", vglTexStorage3D);
+    addFunction("glTexSubImage3D", vglTexSubImage3D);
+    addFunction("glCompressedTexImage2D", vglCompressedTexImage2D);
+    addFunction("glCompressedTexImage3D", vglCompressedTexImage3D);
+    addFunction("glCompressedTexSubImage2D", vglCompressedTexSubImage2D);
+    addFunction("glCompressedTexSubImage3D", vglCompressedTexSubImage3D);
+    addFunction("glCopyTexImage2D", vglCopyTexImage2D);
+    addFunction("glCopyTexSubImage2D", vglCopyTexSubImage2D);
+    addFunction("glCopyTexSubImage3D", vglCopyTexSubImage3D);
+    addFunction("glTexParameteriv", vglTexParameteriv);
+    addFunction("glTexParameterfv", vglTexParameterfv);
     addFunction("glGetTexParameteriv", glGetTexParameteriv);
     addFunction("glGetTexParameterfv", glGetTexParameterfv);
     addFunction("glPixelStorei", glPixelStorei);
@@ -938,20 +2731,23 @@ static void registerFunctions(void) {
     // Sampler objects
     addFunction("glGenSamplers", glGenSamplers);
     addFunction("glDeleteSamplers", glDeleteSamplers);
-    addFunction("glBindSampler", glBindSampler);
-    addFunction("glSamplerParameteri", glSamplerParameteri);
-    addFunction("glSamplerParameterf", glSamplerParameterf);
-    addFunction("glSamplerParameteriv", glSamplerParameteriv);
-    addFunction("glSamplerParameterfv", glSamplerParameterfv);
+    addFunction("glBindSampler", vglBindSampler);
+    addFunction("glSamplerParameteri", vglSamplerParameteri);
+    addFunction("glSamplerParameterf", vglSamplerParameterf);
+    addFunction("glSamplerParameteriv", vglSamplerParameteriv);
+    addFunction("glSamplerParameterfv", vglSamplerParameterfv);
     
     // Read pixels
-    addFunction("glReadPixels", glReadPixels);
+    addFunction("glReadPixels", vglReadPixels);
+    addFunction("glReadnPixels", vglReadnPixels);
+    addFunction("glReadnPixelsEXT", vglReadnPixels);
+    addFunction("glReadnPixelsKHR", vglReadnPixels);
     
     // Queries
     addFunction("glGenQueries", glGenQueries);
     addFunction("glDeleteQueries", glDeleteQueries);
-    addFunction("glBeginQuery", glBeginQuery);
-    addFunction("glEndQuery", glEndQuery);
+    addFunction("glBeginQuery", vglBeginQuery);
+    addFunction("glEndQuery", vglEndQuery);
     addFunction("glGetQueryiv", glGetQueryiv);
     addFunction("glGetQueryObjectuiv", glGetQueryObjectuiv);
     
@@ -959,30 +2755,30 @@ static void registerFunctions(void) {
     addFunction("glGenTransformFeedbacks", glGenTransformFeedbacks);
     addFunction("glDeleteTransformFeedbacks", glDeleteTransformFeedbacks);
     addFunction("glBindTransformFeedback", glBindTransformFeedback);
-    addFunction("glBeginTransformFeedback", glBeginTransformFeedback);
-    addFunction("glEndTransformFeedback", glEndTransformFeedback);
-    addFunction("glPauseTransformFeedback", glPauseTransformFeedback);
-    addFunction("glResumeTransformFeedback", glResumeTransformFeedback);
+    addFunction("glBeginTransformFeedback", vglBeginTransformFeedback);
+    addFunction("glEndTransformFeedback", vglEndTransformFeedback);
+    addFunction("glPauseTransformFeedback", vglPauseTransformFeedback);
+    addFunction("glResumeTransformFeedback", vglResumeTransformFeedback);
     addFunction("glTransformFeedbackVaryings", glTransformFeedbackVaryings);
     addFunction("glGetTransformFeedbackVarying", glGetTransformFeedbackVarying);
     
     // Program pipeline (if supported)
     addFunction("glGenProgramPipelines", glGenProgramPipelines);
     addFunction("glDeleteProgramPipelines", glDeleteProgramPipelines);
-    addFunction("glBindProgramPipeline", glBindProgramPipeline);
-    addFunction("glUseProgramStages", glUseProgramStages);
+    addFunction("glBindProgramPipeline", vglBindProgramPipeline);
+    addFunction("glUseProgramStages", vglUseProgramStages);
     addFunction("glActiveShaderProgram", glActiveShaderProgram);
-    addFunction("glProgramUniform1i", glProgramUniform1i);
-    addFunction("glProgramUniform1f", glProgramUniform1f);
-    addFunction("glProgramUniform4fv", glProgramUniform4fv);
-    addFunction("glProgramUniformMatrix4fv", glProgramUniformMatrix4fv);
+    addFunction("glProgramUniform1i", vglProgramUniform1i);
+    addFunction("glProgramUniform1f", vglProgramUniform1f);
+    addFunction("glProgramUniform4fv", vglProgramUniform4fv);
+    addFunction("glProgramUniformMatrix4fv", vglProgramUniformMatrix4fv);
     
     // Misc
-    addFunction("glFlush", glFlush);
-    addFunction("glFinish", glFinish);
+    addFunction("glFlush", vglFlush);
+    addFunction("glFinish", vglFinish);
     addFunction("glHint", glHint);
-    addFunction("glIsTexture", glIsTexture);
-    addFunction("glIsBuffer", glIsBuffer);
+    addFunction("glIsTexture", vglIsTexture);
+    addFunction("glIsBuffer", vglIsBuffer);
     addFunction("glIsFramebuffer", glIsFramebuffer);
     addFunction("glIsProgram", glIsProgram);
     addFunction("glIsShader", glIsShader);
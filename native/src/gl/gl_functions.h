@@ -77,6 +77,11 @@ void vglDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const voi
 void vglMultiDrawArrays(GLenum mode, const GLint* first, const GLsizei* count, GLsizei drawcount);
 void vglMultiDrawElements(GLenum mode, const GLsizei* count, GLenum type, const void* const* indices, GLsizei drawcount);
 void vglDrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const void* indices);
+void vglDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint basevertex);
+void vglDrawRangeElementsBaseVertex(GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const void* indices, GLint basevertex);
+void vglDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex);
+void vglDrawArraysIndirect(GLenum mode, const void* indirect);
+void vglDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect);
 
 // Shader operations
 GLuint vglCreateShader(GLenum type);
@@ -99,23 +104,81 @@ void vglUniform2f(GLint location, GLfloat v0, GLfloat v1);
 void vglUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2);
 void vglUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3);
 void vglUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+void vglUniform2i(GLint location, GLint v0, GLint v1);
+void vglUniform3i(GLint location, GLint v0, GLint v1, GLint v2);
+void vglUniform4i(GLint location, GLint v0, GLint v1, GLint v2, GLint v3);
+void vglUniform1iv(GLint location, GLsizei count, const GLint* value);
+void vglUniform2iv(GLint location, GLsizei count, const GLint* value);
+void vglUniform3iv(GLint location, GLsizei count, const GLint* value);
+void vglUniform4iv(GLint location, GLsizei count, const GLint* value);
+void vglUniform1fv(GLint location, GLsizei count, const GLfloat* value);
+void vglUniform2fv(GLint location, GLsizei count, const GLfloat* value);
+void vglUniform3fv(GLint location, GLsizei count, const GLfloat* value);
+void vglUniform4fv(GLint location, GLsizei count, const GLfloat* value);
+void vglUniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+void vglUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+void vglUniformMatrix2x3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+void vglUniformMatrix3x2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+void vglUniformMatrix2x4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+void vglUniformMatrix4x2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+void vglUniformMatrix3x4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+void vglUniformMatrix4x3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+void vglUniform1ui(GLint location, GLuint v0);
+void vglUniform2ui(GLint location, GLuint v0, GLuint v1);
+void vglUniform3ui(GLint location, GLuint v0, GLuint v1, GLuint v2);
+void vglUniform4ui(GLint location, GLuint v0, GLuint v1, GLuint v2, GLuint v3);
+void vglUniform1uiv(GLint location, GLsizei count, const GLuint* value);
+void vglUniform2uiv(GLint location, GLsizei count, const GLuint* value);
+void vglUniform3uiv(GLint location, GLsizei count, const GLuint* value);
+void vglUniform4uiv(GLint location, GLsizei count, const GLuint* value);
+void vglProgramUniform1i(GLuint program, GLint location, GLint v0);
+void vglProgramUniform1f(GLuint program, GLint location, GLfloat v0);
+void vglProgramUniform4fv(GLuint program, GLint location, GLsizei count, const GLfloat* value);
+void vglProgramUniformMatrix4fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+void vglBindProgramPipeline(GLuint pipeline);
+void vglUseProgramStages(GLuint pipeline, GLbitfield stages, GLuint program);
+void vglUniformBlockBinding(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding);
 
 // Texture operations
+void vglGenTextures(GLsizei n, GLuint* textures);
 void vglBindTexture(GLenum target, GLuint texture);
 void vglTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels);
 void vglTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels);
 void vglTexImage3D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const void* pixels);
+void vglTexStorage2D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
+void vglDeleteTextures(GLsizei n, const GLuint* textures);
+GLboolean vglIsTexture(GLuint texture);
 void vglGenerateMipmap(GLenum target);
 void vglActiveTexture(GLenum texture);
 void vglTexParameteri(GLenum target, GLenum pname, GLint param);
 void vglTexParameterf(GLenum target, GLenum pname, GLfloat param);
+void vglTexParameteriv(GLenum target, GLenum pname, const GLint* params);
+void vglTexParameterfv(GLenum target, GLenum pname, const GLfloat* params);
+void vglTexStorage3D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth);
+void vglTexSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void* pixels);
+void vglCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void* data);
+void vglCompressedTexImage3D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLsizei imageSize, const void* data);
+void vglCompressedTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLsizei imageSize, const void* data);
+void vglCompressedTexSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLsizei imageSize, const void* data);
+
+// Sampler operations
+void vglBindSampler(GLuint unit, GLuint sampler);
+void vglSamplerParameteri(GLuint sampler, GLenum pname, GLint param);
+void vglSamplerParameterf(GLuint sampler, GLenum pname, GLfloat param);
+void vglSamplerParameteriv(GLuint sampler, GLenum pname, const GLint* param);
+void vglSamplerParameterfv(GLuint sampler, GLenum pname, const GLfloat* param);
 
 // Buffer operations
+void vglGenBuffers(GLsizei n, GLuint* buffers);
+void vglDeleteBuffers(GLsizei n, const GLuint* buffers);
+GLboolean vglIsBuffer(GLuint buffer);
 void vglBindBuffer(GLenum target, GLuint buffer);
 void vglBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
 void vglBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data);
 void* vglMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
 GLboolean vglUnmapBuffer(GLenum target);
+void vglCopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset,
+                          GLintptr writeOffset, GLsizeiptr size);
 void vglBindBufferBase(GLenum target, GLuint index, GLuint buffer);
 void vglBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
 
@@ -127,16 +190,51 @@ void vglEnableVertexAttribArray(GLuint index);
 void vglDisableVertexAttribArray(GLuint index);
 void vglVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer);
 void vglVertexAttribDivisor(GLuint index, GLuint divisor);
+void vglVertexAttribFormat(GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset);
+void vglVertexAttribIFormat(GLuint attribindex, GLint size, GLenum type, GLuint relativeoffset);
+void vglVertexAttribBinding(GLuint attribindex, GLuint bindingindex);
+void vglBindVertexBuffer(GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride);
+void vglVertexBindingDivisor(GLuint bindingindex, GLuint divisor);
+void vglVertexAttrib1f(GLuint index, GLfloat x);
+void vglVertexAttrib2f(GLuint index, GLfloat x, GLfloat y);
+void vglVertexAttrib3f(GLuint index, GLfloat x, GLfloat y, GLfloat z);
+void vglVertexAttrib4f(GLuint index, GLfloat x, GLfloat y, GLfloat z, GLfloat w);
+void vglVertexAttrib1fv(GLuint index, const GLfloat* v);
+void vglVertexAttrib2fv(GLuint index, const GLfloat* v);
+void vglVertexAttrib3fv(GLuint index, const GLfloat* v);
+void vglVertexAttrib4fv(GLuint index, const GLfloat* v);
+void vglVertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer);
+void vglGetVertexAttribiv(GLuint index, GLenum pname, GLint* params);
+void vglGetVertexAttribPointerv(GLuint index, GLenum pname, void** pointer);
+void vglVertexAttribI4i(GLuint index, GLint x, GLint y, GLint z, GLint w);
+void vglVertexAttribI4ui(GLuint index, GLuint x, GLuint y, GLuint z, GLuint w);
 
 // Framebuffer operations
 void vglBindFramebuffer(GLenum target, GLuint framebuffer);
 void vglFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
 void vglFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer);
+void vglFramebufferTextureLayer(GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer);
+void vglFramebufferTexture(GLenum target, GLenum attachment, GLuint texture, GLint level);
+void vglFramebufferParameteri(GLenum target, GLenum pname, GLint param);
+void vglGetFramebufferAttachmentParameteriv(GLenum target, GLenum attachment, GLenum pname, GLint* params);
+void vglGenFramebuffers(GLsizei n, GLuint* framebuffers);
+void vglDeleteFramebuffers(GLsizei n, const GLuint* framebuffers);
+void vglRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height);
+void vglRenderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height);
+void vglGenRenderbuffers(GLsizei n, GLuint* renderbuffers);
+void vglDeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers);
+void vglBindRenderbuffer(GLenum target, GLuint renderbuffer);
 GLenum vglCheckFramebufferStatus(GLenum target);
 void vglDrawBuffers(GLsizei n, const GLenum* bufs);
 void vglReadBuffer(GLenum mode);
 void vglBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter);
 void vglInvalidateFramebuffer(GLenum target, GLsizei numAttachments, const GLenum* attachments);
+void vglInvalidateSubFramebuffer(GLenum target, GLsizei numAttachments, const GLenum* attachments, GLint x, GLint y, GLsizei width, GLsizei height);
+void vglReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels);
+void vglReadnPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLsizei bufSize, void* data);
+void vglCopyTexImage2D(GLenum target, GLint level, GLenum internalformat, GLint x, GLint y, GLsizei width, GLsizei height, GLint border);
+void vglCopyTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint x, GLint y, GLsizei width, GLsizei height);
+void vglCopyTexSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLint x, GLint y, GLsizei width, GLsizei height);
 
 // State management
 void vglEnable(GLenum cap);
@@ -165,6 +263,10 @@ void vglClear(GLbitfield mask);
 void vglClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
 void vglClearDepthf(GLfloat d);
 void vglClearStencil(GLint s);
+void vglClearBufferfv(GLenum buffer, GLint drawbuffer, const GLfloat* value);
+void vglClearBufferiv(GLenum buffer, GLint drawbuffer, const GLint* value);
+void vglClearBufferuiv(GLenum buffer, GLint drawbuffer, const GLuint* value);
+void vglClearBufferfi(GLenum buffer, GLint drawbuffer, GLfloat depth, GLint stencil);
 
 // Query operations
 void vglGetIntegerv(GLenum pname, GLint* data);
@@ -179,10 +281,27 @@ GLsync vglFenceSync(GLenum condition, GLbitfield flags);
 void vglDeleteSync(GLsync sync);
 GLenum vglClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout);
 void vglWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout);
+void vglFinish(void);
+void vglFlush(void);
+
+// Queries and transform feedback
+void vglBeginQuery(GLenum target, GLuint id);
+void vglEndQuery(GLenum target);
+void vglBeginTransformFeedback(GLenum primitiveMode);
+void vglEndTransformFeedback(void);
+void vglPauseTransformFeedback(void);
+void vglResumeTransformFeedback(void);
 
 // Compute (if available)
 void vglDispatchCompute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
 void vglMemoryBarrier(GLbitfield barriers);
+void vglBindImageTexture(GLuint unit, GLuint texture, GLint level, GLboolean layered,
+                         GLint layer, GLenum access, GLenum format);
+
+// Copies between images
+void vglCopyImageSubData(GLuint srcName, GLenum srcTarget, GLint srcLevel, GLint srcX, GLint srcY, GLint srcZ,
+                         GLuint dstName, GLenum dstTarget, GLint dstLevel, GLint dstX, GLint dstY, GLint dstZ,
+                         GLsizei srcWidth, GLsizei srcHeight, GLsizei srcDepth);
 
 // ============================================================================
 // Function Registration
@@ -203,6 +322,12 @@ void glFunctionsShutdown(void);
  */
 void* glFunctionsGetProc(const char* name);
 
+/**
+ * Issue deferred framebuffer binds and clears (call before the wrapper
+ * binds framebuffers itself)
+ */
+void glFunctionsFlushPasses(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,329 @@
+/**
+ * Damage Tracker - Implementation
+ * Damage is kept as a few rects per frame. When a frame runs out of
+ * slots, the new rect merges into the one it grows the least. A back
+ * buffer of age N last held the frame N swaps ago, so it is missing the
+ * damage of the N - 1 frames since: that union is both what has to be
+ * redrawn and what differs from the previous present.
+ */
+
+#include "damage_tracker.h"
+#include "../core/gl_wrapper.h"
+#include "../utils/log.h"
+
+#include <EGL/eglext.h>
+#include <string.h>
+
+// ============================================================================
+// Types
+// ============================================================================
+
+typedef EGLBoolean (EGLAPIENTRYP SwapWithDamageProc)(EGLDisplay display, EGLSurface surface,
+                                                     const EGLint* rects, EGLint count);
+
+typedef struct DamageRect {
+    int x0, y0, x1, y1;          // Max exclusive
+} DamageRect;
+
+typedef struct DamageFrame {
+    DamageRect rects[DAMAGE_MAX_RECTS];
+    int count;
+    bool full;
+} DamageFrame;
+
+typedef struct DamageTrackerContext {
+    bool initialized;
+    bool enabled;
+
+    // EGL support
+    EGLDisplay probedDisplay;
+    SwapWithDamageProc swapWithDamage;
+    bool bufferAge;
+
+    DamageFrame current;
+    DamageFrame history[DAMAGE_HISTORY];   // Most recent first
+    int historyCount;
+
+    // Region presented by the coming swap
+    DamageFrame present;
+    bool presentReady;
+
+    int lastBufferAge;
+    float lastDamagedArea;
+    uint32_t partialFrames;
+    uint32_t fullFrames;
+} DamageTrackerContext;
+
+static DamageTrackerContext g_damage = {0};
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static void probeExtensions(EGLDisplay display) {
+    if (display == g_damage.probedDisplay) return;
+
+    g_damage.probedDisplay = display;
+    g_damage.swapWithDamage = NULL;
+    g_damage.bufferAge = false;
+
+    const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+    if (extensions) {
+        if (strstr(extensions, "EGL_KHR_swap_buffers_with_damage")) {
+            g_damage.swapWithDamage = (SwapWithDamageProc)eglGetProcAddress("eglSwapBuffersWithDamageKHR");
+        }
+        if (!g_damage.swapWithDamage && strstr(extensions, "EGL_EXT_swap_buffers_with_damage")) {
+            g_damage.swapWithDamage = (SwapWithDamageProc)eglGetProcAddress("eglSwapBuffersWithDamageEXT");
+        }
+        g_damage.bufferAge = strstr(extensions, "EGL_EXT_buffer_age") != NULL ||
+                             strstr(extensions, "EGL_KHR_partial_update") != NULL;
+    }
+
+    velocityLogInfo("Partial present: swap with damage %s, buffer age %s",
+                    g_damage.swapWithDamage ? "available" : "unavailable",
+                    g_damage.bufferAge ? "available" : "unavailable");
+}
+
+static inline int64_t rectArea(const DamageRect* r) {
+    return (int64_t)(r->x1 - r->x0) * (r->y1 - r->y0);
+}
+
+static inline DamageRect rectUnion(const DamageRect* a, const DamageRect* b) {
+    DamageRect u = {
+        a->x0 < b->x0 ? a->x0 : b->x0, a->y0 < b->y0 ? a->y0 : b->y0,
+        a->x1 > b->x1 ? a->x1 : b->x1, a->y1 > b->y1 ? a->y1 : b->y1
+    };
+    return u;
+}
+
+static inline bool rectContains(const DamageRect* outer, const DamageRect* inner) {
+    return inner->x0 >= outer->x0 && inner->y0 >= outer->y0 &&
+           inner->x1 <= outer->x1 && inner->y1 <= outer->y1;
+}
+
+static void frameAdd(DamageFrame* frame, DamageRect rect) {
+    if (frame->full || rect.x1 <= rect.x0 || rect.y1 <= rect.y0) return;
+
+    // Drop rects the new one covers, skip it if already covered
+    for (int i = 0; i < frame->count; i++) {
+        if (rectContains(&frame->rects[i], &rect)) return;
+        if (rectContains(&rect, &frame->rects[i])) {
+            frame->rects[i--] = frame->rects[--frame->count];
+        }
+    }
+
+    if (frame->count < DAMAGE_MAX_RECTS) {
+        frame->rects[frame->count++] = rect;
+        return;
+    }
+
+    int best = 0;
+    int64_t bestGrowth = INT64_MAX;
+    for (int i = 0; i < frame->count; i++) {
+        DamageRect u = rectUnion(&frame->rects[i], &rect);
+        int64_t growth = rectArea(&u) - rectArea(&frame->rects[i]);
+        if (growth < bestGrowth) {
+            bestGrowth = growth;
+            best = i;
+        }
+    }
+    frame->rects[best] = rectUnion(&frame->rects[best], &rect);
+}
+
+static void frameMerge(DamageFrame* dst, const DamageFrame* src) {
+    if (src->full) {
+        dst->full = true;
+        return;
+    }
+    for (int i = 0; i < src->count; i++) {
+        frameAdd(dst, src->rects[i]);
+    }
+}
+
+static bool frameBounds(const DamageFrame* frame, DamageRect* bounds) {
+    if (frame->full) return false;
+
+    if (frame->count == 0) {
+        memset(bounds, 0, sizeof(DamageRect));
+        return true;
+    }
+
+    *bounds = frame->rects[0];
+    for (int i = 1; i < frame->count; i++) {
+        *bounds = rectUnion(bounds, &frame->rects[i]);
+    }
+    return true;
+}
+
+// ============================================================================
+// Damage Tracker API
+// ============================================================================
+
+void damageTrackerInit(bool enabled) {
+    memset(&g_damage, 0, sizeof(DamageTrackerContext));
+    g_damage.initialized = true;
+    g_damage.enabled = enabled;
+
+    velocityLogInfo("Damage tracker initialized: %s", enabled ? "enabled" : "disabled");
+}
+
+void damageTrackerShutdown(void) {
+    memset(&g_damage, 0, sizeof(DamageTrackerContext));
+}
+
+void damageTrackerSetEnabled(bool enabled) {
+    if (enabled && !g_damage.enabled) {
+        // Frames presented meanwhile left no history
+        g_damage.historyCount = 0;
+        g_damage.current.full = true;
+    }
+    g_damage.enabled = enabled;
+}
+
+void damageTrackerAddRect(const GLint rect[4]) {
+    if (!g_damage.enabled || g_damage.current.full || !g_wrapperCtx) return;
+
+    int width = g_wrapperCtx->windowWidth;
+    int height = g_wrapperCtx->windowHeight;
+
+    DamageRect r = { rect[0], rect[1], rect[0] + rect[2], rect[1] + rect[3] };
+    if (r.x0 < 0) r.x0 = 0;
+    if (r.y0 < 0) r.y0 = 0;
+    if (r.x1 > width) r.x1 = width;
+    if (r.y1 > height) r.y1 = height;
+
+    frameAdd(&g_damage.current, r);
+}
+
+void damageTrackerAddFull(void) {
+    g_damage.current.full = true;
+}
+
+void damageTrackerDiscardFrame(void) {
+    memset(&g_damage.current, 0, sizeof(DamageFrame));
+}
+
+void damageTrackerEndFrame(EGLDisplay display, EGLSurface surface) {
+    if (!g_damage.initialized) return;
+
+    DamageFrame* present = &g_damage.present;
+    *present = g_damage.current;
+    g_damage.presentReady = true;
+
+    int age = 0;
+    if (g_damage.enabled && display != EGL_NO_DISPLAY && surface != EGL_NO_SURFACE) {
+        probeExtensions(display);
+        if (g_damage.bufferAge && !eglQuerySurface(display, surface, EGL_BUFFER_AGE_EXT, &age)) {
+            age = 0;
+        }
+    }
+    g_damage.lastBufferAge = age;
+
+    // Age 0 is a fresh or undefined buffer; older than the history is unknown
+    if (!g_damage.enabled || age <= 0 || age - 1 > g_damage.historyCount) {
+        present->full = true;
+    } else {
+        for (int i = 0; i < age - 1; i++) {
+            frameMerge(present, &g_damage.history[i]);
+        }
+    }
+
+    int width = g_wrapperCtx ? g_wrapperCtx->windowWidth : 0;
+    int height = g_wrapperCtx ? g_wrapperCtx->windowHeight : 0;
+    int64_t windowArea = (int64_t)width * height;
+    DamageRect bounds;
+    if (windowArea > 0 && frameBounds(present, &bounds) &&
+        rectArea(&bounds) >= windowArea * DAMAGE_FULL_RATIO) {
+        present->full = true;
+    }
+
+    // Shift this frame into the history
+    memmove(&g_damage.history[1], &g_damage.history[0],
+            (DAMAGE_HISTORY - 1) * sizeof(DamageFrame));
+    g_damage.history[0] = g_damage.current;
+    if (g_damage.historyCount < DAMAGE_HISTORY) g_damage.historyCount++;
+
+    memset(&g_damage.current, 0, sizeof(DamageFrame));
+}
+
+bool damageTrackerGetRepairBounds(GLint rect[4]) {
+    if (!g_damage.presentReady) return false;
+
+    DamageRect bounds;
+    if (!frameBounds(&g_damage.present, &bounds)) return false;
+
+    rect[0] = bounds.x0;
+    rect[1] = bounds.y0;
+    rect[2] = bounds.x1 - bounds.x0;
+    rect[3] = bounds.y1 - bounds.y0;
+    return true;
+}
+
+void damageTrackerSkipPresent(void) {
+    if (!g_damage.presentReady) return;
+    g_damage.presentReady = false;
+
+    // The back buffer stays put: its damage carries into the next frame
+    DamageFrame skipped = g_damage.history[0];
+    memmove(&g_damage.history[0], &g_damage.history[1],
+            (DAMAGE_HISTORY - 1) * sizeof(DamageFrame));
+    memset(&g_damage.history[DAMAGE_HISTORY - 1], 0, sizeof(DamageFrame));
+    if (g_damage.historyCount > 0) g_damage.historyCount--;
+
+    frameMerge(&skipped, &g_damage.current);
+    g_damage.current = skipped;
+}
+
+EGLBoolean damageTrackerSwapBuffers(EGLDisplay display, EGLSurface surface) {
+    bool partial = g_damage.presentReady && g_damage.enabled && !g_damage.present.full &&
+                   g_damage.swapWithDamage && display == g_damage.probedDisplay;
+    g_damage.presentReady = false;
+
+    if (!partial) {
+        if (g_damage.initialized) {
+            g_damage.lastDamagedArea = 1.0f;
+            g_damage.fullFrames++;
+        }
+        return eglSwapBuffers(display, surface);
+    }
+
+    EGLint rects[DAMAGE_MAX_RECTS * 4];
+    int64_t area = 0;
+    for (int i = 0; i < g_damage.present.count; i++) {
+        const DamageRect* r = &g_damage.present.rects[i];
+        rects[i * 4 + 0] = r->x0;
+        rects[i * 4 + 1] = r->y0;
+        rects[i * 4 + 2] = r->x1 - r->x0;
+        rects[i * 4 + 3] = r->y1 - r->y0;
+        area += rectArea(r);
+    }
+
+    int64_t windowArea = g_wrapperCtx ? (int64_t)g_wrapperCtx->windowWidth * g_wrapperCtx->windowHeight : 0;
+    g_damage.lastDamagedArea = windowArea > 0 ? (float)area / (float)windowArea : 1.0f;
+    if (g_damage.lastDamagedArea > 1.0f) g_damage.lastDamagedArea = 1.0f;
+    g_damage.partialFrames++;
+
+    // Zero rects would mean full damage: an unchanged frame reports one pixel
+    if (g_damage.present.count == 0) {
+        rects[0] = 0;
+        rects[1] = 0;
+        rects[2] = 1;
+        rects[3] = 1;
+        return g_damage.swapWithDamage(display, surface, rects, 1);
+    }
+
+    return g_damage.swapWithDamage(display, surface, rects, g_damage.present.count);
+}
+
+void damageTrackerGetStats(DamageTrackerStats* stats) {
+    if (!stats) return;
+
+    memset(stats, 0, sizeof(DamageTrackerStats));
+    stats->enabled = g_damage.enabled;
+    stats->swapWithDamage = g_damage.swapWithDamage != NULL;
+    stats->bufferAge = g_damage.bufferAge;
+    stats->lastBufferAge = g_damage.lastBufferAge;
+    stats->lastDamagedArea = g_damage.lastDamagedArea;
+    stats->partialFrames = g_damage.partialFrames;
+    stats->fullFrames = g_damage.fullFrames;
+}
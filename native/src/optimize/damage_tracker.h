@@ -0,0 +1,113 @@
+/**
+ * Damage Tracker - Partial presentation with swap-buffers-with-damage
+ * Collects the window regions each frame draws, clears and blits into,
+ * widens them by the frames the reused back buffer missed (buffer age),
+ * and presents through eglSwapBuffersWithDamageKHR/EXT so the compositor
+ * only recomposes what changed. The same region bounds the scaler's
+ * upscale pass. Frames with unknown buffer age or near-full damage
+ * present normally.
+ */
+
+#ifndef DAMAGE_TRACKER_H
+#define DAMAGE_TRACKER_H
+
+#include <EGL/egl.h>
+#include <GLES3/gl32.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define DAMAGE_MAX_RECTS        8       // Rects per frame before merging
+#define DAMAGE_HISTORY          4       // Past frames kept for buffer age
+#define DAMAGE_FULL_RATIO       0.85f   // Damaged share of the window treated as full
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * Presentation statistics
+ */
+typedef struct DamageTrackerStats {
+    bool enabled;
+    bool swapWithDamage;         // Extension available
+    bool bufferAge;              // EGL_EXT_buffer_age available
+    int lastBufferAge;
+    float lastDamagedArea;       // Share of the window presented as damage (1 = full)
+    uint32_t partialFrames;
+    uint32_t fullFrames;
+} DamageTrackerStats;
+
+// ============================================================================
+// Damage Tracker API
+// ============================================================================
+
+/**
+ * Initialize tracking
+ */
+void damageTrackerInit(bool enabled);
+
+/**
+ * Shutdown tracking
+ */
+void damageTrackerShutdown(void);
+
+/**
+ * Enable/disable partial presentation
+ */
+void damageTrackerSetEnabled(bool enabled);
+
+/**
+ * Add a window rect (x, y, w, h, bottom-left origin) to this frame's damage
+ */
+void damageTrackerAddRect(const GLint rect[4]);
+
+/**
+ * Damage the whole window this frame
+ */
+void damageTrackerAddFull(void);
+
+/**
+ * Drop this frame's damage (it redrew what is already presented)
+ */
+void damageTrackerDiscardFrame(void);
+
+/**
+ * Close this frame's damage and accumulate it over the buffer age (call
+ * before the upscale and swap)
+ */
+void damageTrackerEndFrame(EGLDisplay display, EGLSurface surface);
+
+/**
+ * Bounds of the region the back buffer needs redrawn (empty if none),
+ * false if all of it
+ */
+bool damageTrackerGetRepairBounds(GLint rect[4]);
+
+/**
+ * Present the frame with its damage
+ */
+EGLBoolean damageTrackerSwapBuffers(EGLDisplay display, EGLSurface surface);
+
+/**
+ * The closed frame won't be presented: keep the back buffer's history
+ */
+void damageTrackerSkipPresent(void);
+
+/**
+ * Get statistics
+ */
+void damageTrackerGetStats(DamageTrackerStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DAMAGE_TRACKER_H
@@ -0,0 +1,387 @@
+/**
+ * FB Invalidate - Implementation
+ */
+
+#include "fb_invalidate.h"
+#include "../core/gl_wrapper.h"
+#include "../buffer/draw_batcher.h"
+#include "../utils/log.h"
+
+#include <string.h>
+
+// ============================================================================
+// Types
+// ============================================================================
+
+#define DEPTH_BIT       (1u << 8)
+#define STENCIL_BIT     (1u << 9)
+#define COLOR_BITS      0xFFu
+
+typedef struct InvalidateFramebuffer {
+    GLuint framebuffer;
+    GLuint textures[FB_INVALIDATE_ATTACHMENTS];
+    uint8_t confidence[FB_INVALIDATE_ATTACHMENTS];
+
+    uint16_t attached;
+    uint16_t renderbuffers;
+    uint16_t drawBuffers;        // Color attachments glClear reaches
+    uint16_t sampled;            // Texture attachments bound for sampling since attach
+    uint16_t blocked;            // Discarded once and read after: never again
+
+    // Contents left by the last pass whose fate is not known yet
+    uint16_t pending;
+    uint16_t invalidated;        // ... of which were discarded
+
+    // Current pass
+    uint16_t cleared;            // Fully cleared before any draw
+    bool drawn;
+} InvalidateFramebuffer;
+
+typedef struct FBInvalidateContext {
+    bool initialized;
+    bool enabled;
+
+    InvalidateFramebuffer framebuffers[FB_INVALIDATE_MAX_FRAMEBUFFERS];
+    int framebufferCount;
+
+    GLuint currentFramebuffer;
+    int current;                 // Index of the bound draw framebuffer, -1 if untracked
+    uint32_t unsampled;          // Texture attachments not sampled yet
+
+    // Stats
+    uint32_t passes;
+    uint32_t invalidations;
+    uint32_t swapInvalidations;
+    uint32_t mispredictions;
+} FBInvalidateContext;
+
+static FBInvalidateContext g_inv = {0};
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static uint16_t attachmentBits(GLenum attachment) {
+    if (attachment >= GL_COLOR_ATTACHMENT0 && attachment < GL_COLOR_ATTACHMENT0 + 8) {
+        return (uint16_t)(1u << (attachment - GL_COLOR_ATTACHMENT0));
+    }
+    switch (attachment) {
+        case GL_DEPTH_ATTACHMENT:           return DEPTH_BIT;
+        case GL_STENCIL_ATTACHMENT:         return STENCIL_BIT;
+        case GL_DEPTH_STENCIL_ATTACHMENT:   return DEPTH_BIT | STENCIL_BIT;
+    }
+    return 0;
+}
+
+static uint16_t maskBits(const InvalidateFramebuffer* fb, GLbitfield mask, bool drawBuffersOnly) {
+    uint16_t bits = 0;
+    if (mask & GL_COLOR_BUFFER_BIT) bits |= drawBuffersOnly ? fb->drawBuffers : COLOR_BITS;
+    if (mask & GL_DEPTH_BUFFER_BIT) bits |= DEPTH_BIT;
+    if (mask & GL_STENCIL_BUFFER_BIT) bits |= STENCIL_BIT;
+    return bits & fb->attached;
+}
+
+static inline uint16_t textureBits(const InvalidateFramebuffer* fb) {
+    return fb->attached & ~fb->renderbuffers;
+}
+
+static int findFramebuffer(GLuint framebuffer) {
+    for (int i = 0; i < g_inv.framebufferCount; i++) {
+        if (g_inv.framebuffers[i].framebuffer == framebuffer) return i;
+    }
+    return -1;
+}
+
+static InvalidateFramebuffer* boundFramebuffer(void) {
+    return g_inv.current >= 0 ? &g_inv.framebuffers[g_inv.current] : NULL;
+}
+
+static int countBits(uint16_t bits) {
+    int count = 0;
+    for (; bits; bits &= bits - 1) count++;
+    return count;
+}
+
+static bool isBoundForSampling(GLuint texture) {
+    if (!g_wrapperCtx) return false;
+    for (int i = 0; i < MAX_TEXTURE_UNITS; i++) {
+        if (g_wrapperCtx->state.textureUnits[i].texture2D == texture) return true;
+    }
+    return false;
+}
+
+/**
+ * Contents of a previous pass were needed: stop trusting the attachments,
+ * and never discard again the ones that were discarded
+ */
+static void markUsed(InvalidateFramebuffer* fb, uint16_t used) {
+    used &= fb->pending;
+    if (!used) return;
+
+    uint16_t wrong = used & fb->invalidated;
+    if (wrong) {
+        if ((fb->blocked & wrong) == 0) {
+            velocityLogWarn("Framebuffer %u: discarded attachments 0x%x were read, disabling",
+                            fb->framebuffer, wrong);
+        }
+        fb->blocked |= wrong;
+        g_inv.mispredictions++;
+    }
+
+    for (int i = 0; i < FB_INVALIDATE_ATTACHMENTS; i++) {
+        if (used & (1u << i)) fb->confidence[i] = 0;
+    }
+    fb->pending &= ~used;
+    fb->invalidated &= ~used;
+}
+
+/**
+ * Contents of a previous pass were overwritten without being read
+ */
+static void markDead(InvalidateFramebuffer* fb, uint16_t dead) {
+    dead &= fb->pending;
+    for (int i = 0; i < FB_INVALIDATE_ATTACHMENTS; i++) {
+        if ((dead & (1u << i)) && fb->confidence[i] < 255) fb->confidence[i]++;
+    }
+    fb->pending &= ~dead;
+    fb->invalidated &= ~dead;
+}
+
+static void endPass(InvalidateFramebuffer* fb) {
+    // Nothing written: the previous pass's contents are still pending
+    if (!fb->drawn && !fb->cleared) return;
+
+    uint16_t discard = 0;
+    if (g_inv.enabled) {
+        uint16_t eligible = fb->attached & ~fb->blocked & (fb->renderbuffers | ~fb->sampled);
+        for (int i = 0; i < FB_INVALIDATE_ATTACHMENTS; i++) {
+            if ((eligible & (1u << i)) && fb->confidence[i] >= FB_INVALIDATE_CONFIDENCE) {
+                discard |= (uint16_t)(1u << i);
+            }
+        }
+    }
+
+    if (discard) {
+        GLenum attachments[FB_INVALIDATE_ATTACHMENTS];
+        GLsizei count = 0;
+        for (int i = 0; i < 8; i++) {
+            if (discard & (1u << i)) attachments[count++] = GL_COLOR_ATTACHMENT0 + i;
+        }
+        if (discard & DEPTH_BIT) attachments[count++] = GL_DEPTH_ATTACHMENT;
+        if (discard & STENCIL_BIT) attachments[count++] = GL_STENCIL_ATTACHMENT;
+
+        // Queued draws into this pass come first
+        drawBatcherFlush();
+        glInvalidateFramebuffer(GL_DRAW_FRAMEBUFFER, count, attachments);
+        g_inv.invalidations += (uint32_t)count;
+    }
+
+    fb->pending = fb->attached;
+    fb->invalidated = discard;
+}
+
+static void removeFramebuffer(int index) {
+    InvalidateFramebuffer* fb = &g_inv.framebuffers[index];
+    g_inv.unsampled -= (uint32_t)countBits(textureBits(fb) & ~fb->sampled);
+
+    int last = --g_inv.framebufferCount;
+    if (index != last) g_inv.framebuffers[index] = g_inv.framebuffers[last];
+
+    if (g_inv.current == index) {
+        g_inv.current = -1;
+    } else if (g_inv.current == last) {
+        g_inv.current = index;
+    }
+}
+
+// ============================================================================
+// FB Invalidate API
+// ============================================================================
+
+void fbInvalidateInit(bool enabled) {
+    memset(&g_inv, 0, sizeof(FBInvalidateContext));
+    g_inv.initialized = true;
+    g_inv.enabled = enabled;
+    g_inv.current = -1;
+
+    velocityLogInfo("Framebuffer invalidation initialized: %s", enabled ? "auto" : "off");
+}
+
+void fbInvalidateShutdown(void) {
+    memset(&g_inv, 0, sizeof(FBInvalidateContext));
+    g_inv.current = -1;
+}
+
+void fbInvalidateSetEnabled(bool enabled) {
+    g_inv.enabled = enabled;
+}
+
+void fbInvalidateBindDraw(GLuint framebuffer) {
+    if (!g_inv.initialized || framebuffer == g_inv.currentFramebuffer) return;
+
+    InvalidateFramebuffer* fb = boundFramebuffer();
+    if (fb) endPass(fb);
+
+    g_inv.currentFramebuffer = framebuffer;
+    g_inv.current = framebuffer ? findFramebuffer(framebuffer) : -1;
+
+    fb = boundFramebuffer();
+    if (fb) {
+        fb->cleared = 0;
+        fb->drawn = false;
+        g_inv.passes++;
+    }
+}
+
+void fbInvalidateAttach(GLuint framebuffer, GLenum attachment, GLuint name, bool renderbuffer) {
+    if (!g_inv.initialized || framebuffer == 0) return;
+
+    uint16_t bits = attachmentBits(attachment);
+    if (!bits) return;
+
+    int index = findFramebuffer(framebuffer);
+    if (index < 0) {
+        if (name == 0) return;
+        if (g_inv.framebufferCount >= FB_INVALIDATE_MAX_FRAMEBUFFERS) return;
+
+        index = g_inv.framebufferCount++;
+        InvalidateFramebuffer* fb = &g_inv.framebuffers[index];
+        memset(fb, 0, sizeof(InvalidateFramebuffer));
+        fb->framebuffer = framebuffer;
+        fb->drawBuffers = 1;     // COLOR_ATTACHMENT0 until glDrawBuffers
+        if (framebuffer == g_inv.currentFramebuffer) g_inv.current = index;
+    }
+
+    InvalidateFramebuffer* fb = &g_inv.framebuffers[index];
+    g_inv.unsampled -= (uint32_t)countBits(bits & textureBits(fb) & ~fb->sampled);
+
+    // A new attachment starts with nothing learned
+    fb->attached &= ~bits;
+    fb->renderbuffers &= ~bits;
+    fb->sampled &= ~bits;
+    fb->blocked &= ~bits;
+    fb->pending &= ~bits;
+    fb->invalidated &= ~bits;
+    for (int i = 0; i < FB_INVALIDATE_ATTACHMENTS; i++) {
+        if (bits & (1u << i)) {
+            fb->textures[i] = renderbuffer ? 0 : name;
+            fb->confidence[i] = 0;
+        }
+    }
+    if (name == 0) return;
+
+    fb->attached |= bits;
+    if (renderbuffer) {
+        fb->renderbuffers |= bits;
+    } else if (isBoundForSampling(name)) {
+        fb->sampled |= bits;
+    } else {
+        g_inv.unsampled += (uint32_t)countBits(bits);
+    }
+}
+
+void fbInvalidateDrawBuffers(GLsizei n, const GLenum* bufs) {
+    InvalidateFramebuffer* fb = boundFramebuffer();
+    if (!fb || !bufs) return;
+
+    fb->drawBuffers = 0;
+    for (GLsizei i = 0; i < n; i++) {
+        if (bufs[i] >= GL_COLOR_ATTACHMENT0 && bufs[i] < GL_COLOR_ATTACHMENT0 + 8) {
+            fb->drawBuffers |= (uint16_t)(1u << (bufs[i] - GL_COLOR_ATTACHMENT0));
+        }
+    }
+}
+
+void fbInvalidateClear(GLbitfield mask) {
+    InvalidateFramebuffer* fb = boundFramebuffer();
+    if (!fb || !g_wrapperCtx || fb->drawn) return;
+
+    // Only whole-attachment clears make the old contents dead
+    const GLState* state = &g_wrapperCtx->state;
+    if (state->rasterizer.scissorEnabled) return;
+
+    const bool* colorMask = state->blend.colorMask;
+    if (!(colorMask[0] && colorMask[1] && colorMask[2] && colorMask[3])) {
+        mask &= ~GL_COLOR_BUFFER_BIT;
+    }
+    if (!state->depth.writeEnabled) mask &= ~GL_DEPTH_BUFFER_BIT;
+    if ((state->stencilFront.writeMask & 0xFF) != 0xFF) mask &= ~GL_STENCIL_BUFFER_BIT;
+
+    uint16_t bits = maskBits(fb, mask, true);
+    markDead(fb, bits);
+    fb->cleared |= bits;
+}
+
+void fbInvalidateDraw(void) {
+    if (g_inv.current < 0) return;
+
+    InvalidateFramebuffer* fb = &g_inv.framebuffers[g_inv.current];
+    if (fb->pending) markUsed(fb, fb->pending & ~fb->cleared);
+    fb->drawn = true;
+}
+
+void fbInvalidateRead(GLuint framebuffer, GLbitfield mask) {
+    if (!g_inv.initialized || framebuffer == 0) return;
+
+    int index = findFramebuffer(framebuffer);
+    if (index < 0) return;
+
+    InvalidateFramebuffer* fb = &g_inv.framebuffers[index];
+    markUsed(fb, maskBits(fb, mask, false));
+}
+
+void fbInvalidateSample(GLuint texture) {
+    if (g_inv.unsampled == 0 || texture == 0) return;
+
+    for (int f = 0; f < g_inv.framebufferCount; f++) {
+        InvalidateFramebuffer* fb = &g_inv.framebuffers[f];
+        uint16_t candidates = textureBits(fb) & ~fb->sampled;
+
+        for (int i = 0; i < FB_INVALIDATE_ATTACHMENTS && candidates; i++) {
+            uint16_t bit = (uint16_t)(1u << i);
+            if (!(candidates & bit) || fb->textures[i] != texture) continue;
+
+            markUsed(fb, bit);
+            fb->sampled |= bit;
+            g_inv.unsampled--;
+        }
+    }
+}
+
+void fbInvalidateForgetFramebuffers(GLsizei n, const GLuint* framebuffers) {
+    if (!g_inv.initialized || !framebuffers) return;
+
+    for (GLsizei i = 0; i < n; i++) {
+        int index = findFramebuffer(framebuffers[i]);
+        if (index >= 0) removeFramebuffer(index);
+    }
+}
+
+void fbInvalidateBeforeSwap(void) {
+    if (!g_inv.initialized || !g_inv.enabled) return;
+
+    // Depth and stencil are undefined after swap anyway
+    static const GLenum ATTACHMENTS[] = { GL_DEPTH, GL_STENCIL };
+
+    GLint bound = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &bound);
+
+    drawBatcherFlush();
+    if (bound != 0) glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glInvalidateFramebuffer(GL_DRAW_FRAMEBUFFER, 2, ATTACHMENTS);
+    if (bound != 0) glBindFramebuffer(GL_DRAW_FRAMEBUFFER, (GLuint)bound);
+
+    g_inv.swapInvalidations++;
+}
+
+void fbInvalidateGetStats(FBInvalidateStats* stats) {
+    if (!stats) return;
+
+    memset(stats, 0, sizeof(FBInvalidateStats));
+    stats->enabled = g_inv.enabled;
+    stats->framebuffers = (uint32_t)g_inv.framebufferCount;
+    stats->passes = g_inv.passes;
+    stats->invalidations = g_inv.invalidations;
+    stats->swapInvalidations = g_inv.swapInvalidations;
+    stats->mispredictions = g_inv.mispredictions;
+}
@@ -0,0 +1,120 @@
+/**
+ * FB Invalidate - Automatic framebuffer invalidation for tile-based GPUs
+ * Tracks render passes on app framebuffers and learns which attachments
+ * are dead when a pass ends: fully cleared before anything reads them in
+ * the next pass, and never sampled, blitted or read back in between. Once
+ * an attachment has been dead for a few passes in a row it is discarded
+ * with glInvalidateFramebuffer when the app switches away, so tilers skip
+ * writing it back to memory. A wrong guess blocks the attachment for good.
+ * Default framebuffer depth/stencil is discarded before every swap.
+ */
+
+#ifndef FB_INVALIDATE_H
+#define FB_INVALIDATE_H
+
+#include <GLES3/gl32.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define FB_INVALIDATE_MAX_FRAMEBUFFERS  64
+#define FB_INVALIDATE_ATTACHMENTS       10      // 8 color, depth, stencil
+#define FB_INVALIDATE_CONFIDENCE        3       // Dead passes in a row before discarding
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * Invalidation statistics
+ */
+typedef struct FBInvalidateStats {
+    bool enabled;
+    uint32_t framebuffers;       // Tracked app framebuffers
+    uint32_t passes;             // Passes on tracked framebuffers
+    uint32_t invalidations;      // Attachments discarded at pass ends
+    uint32_t swapInvalidations;  // Default framebuffer discards before swap
+    uint32_t mispredictions;     // Discarded contents that were read after all
+} FBInvalidateStats;
+
+// ============================================================================
+// FB Invalidate API
+// ============================================================================
+
+/**
+ * Initialize tracking
+ */
+void fbInvalidateInit(bool enabled);
+
+/**
+ * Shutdown tracking
+ */
+void fbInvalidateShutdown(void);
+
+/**
+ * Enable/disable automatic invalidation
+ */
+void fbInvalidateSetEnabled(bool enabled);
+
+/**
+ * Note a draw framebuffer change (call before the bind reaches the driver)
+ */
+void fbInvalidateBindDraw(GLuint framebuffer);
+
+/**
+ * Note an attachment change on a framebuffer
+ */
+void fbInvalidateAttach(GLuint framebuffer, GLenum attachment, GLuint name, bool renderbuffer);
+
+/**
+ * Note glDrawBuffers on the bound draw framebuffer
+ */
+void fbInvalidateDrawBuffers(GLsizei n, const GLenum* bufs);
+
+/**
+ * Note a clear of the bound draw framebuffer
+ */
+void fbInvalidateClear(GLbitfield mask);
+
+/**
+ * Note a draw into the bound draw framebuffer
+ */
+void fbInvalidateDraw(void);
+
+/**
+ * Note a read (blit, readback, copy) from a framebuffer
+ */
+void fbInvalidateRead(GLuint framebuffer, GLbitfield mask);
+
+/**
+ * Note a texture bound for sampling
+ */
+void fbInvalidateSample(GLuint texture);
+
+/**
+ * Forget deleted framebuffers
+ */
+void fbInvalidateForgetFramebuffers(GLsizei n, const GLuint* framebuffers);
+
+/**
+ * Discard default framebuffer depth/stencil (call right before swap)
+ */
+void fbInvalidateBeforeSwap(void);
+
+/**
+ * Get statistics
+ */
+void fbInvalidateGetStats(FBInvalidateStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FB_INVALIDATE_H
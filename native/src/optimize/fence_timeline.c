@@ -0,0 +1,257 @@
+/**
+ * Fence Timeline - Implementation
+ * Fences signal in submission order on one context, so the ring is
+ * retired from the oldest end and the completed value only moves forward.
+ */
+
+#include "fence_timeline.h"
+#include "../profile/trace.h"
+#include "../profile/flight_recorder.h"
+#include "../utils/log.h"
+
+#include <GLES3/gl32.h>
+#include <string.h>
+#include <time.h>
+
+// ============================================================================
+// Types
+// ============================================================================
+
+typedef struct TimelineFence {
+    GLsync fence;
+    FencePoint point;
+} TimelineFence;
+
+typedef struct CauseTotals {
+    uint32_t frameWaits;
+    uint64_t frameNs;
+    uint32_t lastFrameWaits;
+    uint64_t lastFrameNs;
+    uint64_t totalWaits;
+    uint64_t totalNs;
+    uint64_t maxNs;
+} CauseTotals;
+
+typedef struct FenceTimelineContext {
+    bool initialized;
+
+    // Fences in flight, oldest at tail
+    TimelineFence ring[FENCE_TIMELINE_RING];
+    int tail;
+    int count;
+
+    FencePoint submitted;
+    FencePoint completed;
+
+    // Stalls
+    CauseTotals causes[FENCE_WAIT_CAUSE_COUNT];
+    FenceStall history[FENCE_STALL_HISTORY];
+    int historyHead;
+    int historyCount;
+    uint64_t frame;
+} FenceTimelineContext;
+
+static FenceTimelineContext g_timeline = {0};
+
+static const char* const CAUSE_NAMES[FENCE_WAIT_CAUSE_COUNT] = {
+    "throttle",
+    "stream",
+    "finish",
+    "app_sync",
+    "readback",
+    "overflow"
+};
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static inline uint64_t nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void popOldest(void) {
+    TimelineFence* oldest = &g_timeline.ring[g_timeline.tail];
+    glDeleteSync(oldest->fence);
+    oldest->fence = NULL;
+    if (oldest->point > g_timeline.completed) g_timeline.completed = oldest->point;
+
+    g_timeline.tail = (g_timeline.tail + 1) % FENCE_TIMELINE_RING;
+    g_timeline.count--;
+}
+
+/**
+ * Retire signaled fences from the oldest end without blocking
+ */
+static void poll(void) {
+    while (g_timeline.count > 0) {
+        GLenum result = glClientWaitSync(g_timeline.ring[g_timeline.tail].fence, 0, 0);
+        if (result == GL_TIMEOUT_EXPIRED) break;
+        popOldest();
+    }
+}
+
+/**
+ * Block on one fence of the ring, retiring it and everything older if reached
+ */
+static bool waitIndex(int offset, FenceWaitCause cause, uint64_t timeoutNs) {
+    TimelineFence* entry = &g_timeline.ring[(g_timeline.tail + offset) % FENCE_TIMELINE_RING];
+
+    TRACE_SCOPE("fence_wait");
+    FLIGHT_SCOPE(FLIGHT_EVENT_FENCE_WAIT, timeoutNs);
+
+    uint64_t start = nowNs();
+    GLenum result = glClientWaitSync(entry->fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeoutNs);
+    fenceTimelineRecordStall(cause, nowNs() - start);
+
+    if (result == GL_TIMEOUT_EXPIRED) return false;
+    if (result == GL_WAIT_FAILED) {
+        // The fence says nothing: only a drain proves the points reached
+        velocityLogWarn("Fence wait failed (%s), finishing instead", CAUSE_NAMES[cause]);
+        start = nowNs();
+        glFinish();
+        fenceTimelineRecordStall(cause, nowNs() - start);
+    }
+
+    for (int i = 0; i <= offset; i++) popOldest();
+    return true;
+}
+
+// ============================================================================
+// Fence Timeline API
+// ============================================================================
+
+void fenceTimelineInit(void) {
+    if (g_timeline.initialized) fenceTimelineShutdown();
+
+    memset(&g_timeline, 0, sizeof(FenceTimelineContext));
+    g_timeline.initialized = true;
+}
+
+void fenceTimelineShutdown(void) {
+    if (!g_timeline.initialized) return;
+
+    while (g_timeline.count > 0) popOldest();
+    memset(&g_timeline, 0, sizeof(FenceTimelineContext));
+}
+
+FencePoint fenceTimelineSubmit(void) {
+    if (!g_timeline.initialized) return 0;
+
+    // A GPU a whole ring behind: wait out the oldest point. Dropping it
+    // unsignaled would report its point as completed, so keep waiting.
+    if (g_timeline.count == FENCE_TIMELINE_RING) {
+        poll();
+        while (g_timeline.count == FENCE_TIMELINE_RING &&
+               !waitIndex(0, FENCE_WAIT_OVERFLOW, FENCE_OVERFLOW_TIMEOUT_NS)) {
+            velocityLogWarn("Fence timeline overflow wait timed out, still waiting");
+        }
+    }
+
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    if (!fence) {
+        // Without a fence only a full drain keeps the point honest
+        velocityLogWarn("Fence creation failed, finishing instead");
+        uint64_t start = nowNs();
+        glFinish();
+        fenceTimelineRecordStall(FENCE_WAIT_OVERFLOW, nowNs() - start);
+        while (g_timeline.count > 0) popOldest();
+        g_timeline.completed = ++g_timeline.submitted;
+        return g_timeline.submitted;
+    }
+
+    int index = (g_timeline.tail + g_timeline.count) % FENCE_TIMELINE_RING;
+    g_timeline.ring[index].fence = fence;
+    g_timeline.ring[index].point = ++g_timeline.submitted;
+    g_timeline.count++;
+    return g_timeline.submitted;
+}
+
+bool fenceTimelineReached(FencePoint point) {
+    if (!g_timeline.initialized || point <= g_timeline.completed) return true;
+
+    poll();
+    return point <= g_timeline.completed;
+}
+
+bool fenceTimelineWait(FencePoint point, FenceWaitCause cause, uint64_t timeoutNs) {
+    if (fenceTimelineReached(point)) return true;
+
+    // Points are consecutive, so the fence sits at a known offset
+    int offset = (int)(point - g_timeline.ring[g_timeline.tail].point);
+    if (offset < 0 || offset >= g_timeline.count) return true;
+    return waitIndex(offset, cause, timeoutNs);
+}
+
+void fenceTimelineRecordStall(FenceWaitCause cause, uint64_t durationNs) {
+    if (!g_timeline.initialized || cause >= FENCE_WAIT_CAUSE_COUNT) return;
+
+    CauseTotals* totals = &g_timeline.causes[cause];
+    totals->frameWaits++;
+    totals->frameNs += durationNs;
+    totals->totalWaits++;
+    totals->totalNs += durationNs;
+    if (durationNs > totals->maxNs) totals->maxNs = durationNs;
+
+    FenceStall* stall = &g_timeline.history[g_timeline.historyHead];
+    stall->cause = cause;
+    stall->durationNs = durationNs;
+    stall->frame = g_timeline.frame;
+    g_timeline.historyHead = (g_timeline.historyHead + 1) % FENCE_STALL_HISTORY;
+    if (g_timeline.historyCount < FENCE_STALL_HISTORY) g_timeline.historyCount++;
+
+    float ms = durationNs / 1000000.0f;
+    if (ms > FENCE_STALL_LOG_MS) {
+        velocityLogDebug("Sync stall: %s blocked %.2f ms", CAUSE_NAMES[cause], ms);
+    }
+}
+
+void fenceTimelineEndFrame(void) {
+    if (!g_timeline.initialized) return;
+
+    poll();
+
+    for (int i = 0; i < FENCE_WAIT_CAUSE_COUNT; i++) {
+        CauseTotals* totals = &g_timeline.causes[i];
+        totals->lastFrameWaits = totals->frameWaits;
+        totals->lastFrameNs = totals->frameNs;
+        totals->frameWaits = 0;
+        totals->frameNs = 0;
+    }
+    g_timeline.frame++;
+}
+
+int fenceTimelineGetStalls(FenceStall* out, int maxEntries) {
+    if (!out || maxEntries <= 0) return 0;
+
+    int count = g_timeline.historyCount < maxEntries ? g_timeline.historyCount : maxEntries;
+    for (int i = 0; i < count; i++) {
+        int index = (g_timeline.historyHead - 1 - i + FENCE_STALL_HISTORY) % FENCE_STALL_HISTORY;
+        out[i] = g_timeline.history[index];
+    }
+    return count;
+}
+
+void fenceTimelineGetStats(FenceTimelineStats* stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(FenceTimelineStats));
+
+    stats->submitted = g_timeline.submitted;
+    stats->completed = g_timeline.completed;
+    stats->inFlight = (uint32_t)g_timeline.count;
+
+    for (int i = 0; i < FENCE_WAIT_CAUSE_COUNT; i++) {
+        const CauseTotals* totals = &g_timeline.causes[i];
+        FenceStallStats* cause = &stats->causes[i];
+
+        cause->name = CAUSE_NAMES[i];
+        cause->frameWaits = totals->lastFrameWaits;
+        cause->frameMs = totals->lastFrameNs / 1000000.0f;
+        cause->totalWaits = totals->totalWaits;
+        cause->totalMs = totals->totalNs / 1000000.0f;
+        cause->maxMs = totals->maxNs / 1000000.0f;
+        stats->frameStallMs += cause->frameMs;
+    }
+}
@@ -0,0 +1,137 @@
+/**
+ * Fence Timeline - One numbered fence sequence for every CPU-GPU sync point
+ * Subsystems submit a point where they need to know the GPU is done and
+ * later ask whether it has been reached; completion is polled without
+ * blocking, in order, from a single ring of fences. Every blocking wait,
+ * on the timeline or elsewhere (glFinish, direct readbacks, app syncs),
+ * is recorded with its cause and duration.
+ */
+
+#ifndef FENCE_TIMELINE_H
+#define FENCE_TIMELINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define FENCE_TIMELINE_RING         64      // Points in flight
+#define FENCE_STALL_HISTORY         64      // Recent blocking waits kept
+#define FENCE_STALL_LOG_MS          8.0f    // Waits logged when longer
+#define FENCE_OVERFLOW_TIMEOUT_NS   1000000000ULL   // 1 s between overflow warnings
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * Point on the timeline; 0 is reached from the start
+ */
+typedef uint64_t FencePoint;
+
+/**
+ * What a blocking wait was for
+ */
+typedef enum FenceWaitCause {
+    FENCE_WAIT_THROTTLE = 0,         // Latency mode frame bound
+    FENCE_WAIT_STREAM,               // Stream buffer region reuse
+    FENCE_WAIT_FINISH,               // App glFinish
+    FENCE_WAIT_APP_SYNC,             // App glClientWaitSync
+    FENCE_WAIT_READBACK,             // Direct glReadPixels
+    FENCE_WAIT_OVERFLOW,             // Ring full, oldest point waited out
+    FENCE_WAIT_CAUSE_COUNT
+} FenceWaitCause;
+
+/**
+ * One recorded blocking wait
+ */
+typedef struct FenceStall {
+    FenceWaitCause cause;
+    uint64_t durationNs;
+    uint64_t frame;
+} FenceStall;
+
+/**
+ * Stall totals for one cause
+ */
+typedef struct FenceStallStats {
+    const char* name;
+    uint32_t frameWaits;             // Waits during the last frame
+    float frameMs;                   // Blocked during the last frame
+    uint64_t totalWaits;
+    float totalMs;
+    float maxMs;
+} FenceStallStats;
+
+/**
+ * Timeline statistics
+ */
+typedef struct FenceTimelineStats {
+    FencePoint submitted;            // Last point issued
+    FencePoint completed;            // Last point known reached
+    uint32_t inFlight;
+    float frameStallMs;              // All causes, last frame
+    FenceStallStats causes[FENCE_WAIT_CAUSE_COUNT];
+} FenceTimelineStats;
+
+// ============================================================================
+// Fence Timeline API
+// ============================================================================
+
+/**
+ * Initialize the timeline (requires GL context)
+ */
+void fenceTimelineInit(void);
+
+/**
+ * Delete fences still in flight
+ */
+void fenceTimelineShutdown(void);
+
+/**
+ * Fence everything submitted so far, returns its point
+ */
+FencePoint fenceTimelineSubmit(void);
+
+/**
+ * Check without blocking whether the GPU has passed a point
+ */
+bool fenceTimelineReached(FencePoint point);
+
+/**
+ * Block until a point is reached or the timeout expires, recording the
+ * wait; true if reached
+ */
+bool fenceTimelineWait(FencePoint point, FenceWaitCause cause, uint64_t timeoutNs);
+
+/**
+ * Record a blocking wait made outside the timeline
+ */
+void fenceTimelineRecordStall(FenceWaitCause cause, uint64_t durationNs);
+
+/**
+ * Poll completed points and roll the frame's stall totals (call once per frame)
+ */
+void fenceTimelineEndFrame(void);
+
+/**
+ * Copy the most recent blocking waits, newest first; returns the count
+ */
+int fenceTimelineGetStalls(FenceStall* out, int maxEntries);
+
+/**
+ * Get statistics
+ */
+void fenceTimelineGetStats(FenceTimelineStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FENCE_TIMELINE_H
@@ -0,0 +1,197 @@
+/**
+ * Frame Idle - Implementation
+ * The app's draws for an identical frame have already been submitted by
+ * the time the swap compares fingerprints; what an idle frame saves is
+ * everything after them: the upscale, the compositor's recomposition,
+ * and under the skip policy the present and the next frames' work.
+ */
+
+#include "frame_idle.h"
+#include "damage_tracker.h"
+#include "resolution_scaler.h"
+#include "../utils/hash.h"
+#include "../utils/log.h"
+
+#include <string.h>
+#include <time.h>
+
+// ============================================================================
+// Types
+// ============================================================================
+
+typedef struct FrameIdleContext {
+    bool initialized;
+    FrameIdlePolicy policy;
+    int idleFPS;
+
+    // Current frame
+    uint64_t hash;
+    bool changed;
+
+    uint64_t lastHash;
+    int matches;
+
+    uint64_t lastRefreshNs;
+    uint64_t lastWakeNs;
+
+    bool idle;
+    uint32_t identicalFrames;
+    uint32_t framesReused;
+    uint32_t presentsSkipped;
+    uint32_t refreshes;
+} FrameIdleContext;
+
+static FrameIdleContext g_idle = {0};
+
+static const char* POLICY_NAMES[] = { "off", "re-present", "skip present" };
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static inline uint64_t nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline bool detecting(void) {
+    return g_idle.initialized && g_idle.policy != FRAME_IDLE_OFF;
+}
+
+static void resetFrame(void) {
+    g_idle.hash = 0;
+    g_idle.changed = false;
+}
+
+// ============================================================================
+// Frame Idle API
+// ============================================================================
+
+void frameIdleInit(FrameIdlePolicy policy, int idleFPS) {
+    memset(&g_idle, 0, sizeof(FrameIdleContext));
+    g_idle.initialized = true;
+    frameIdleSetPolicy(policy, idleFPS);
+}
+
+void frameIdleShutdown(void) {
+    memset(&g_idle, 0, sizeof(FrameIdleContext));
+}
+
+void frameIdleSetPolicy(FrameIdlePolicy policy, int idleFPS) {
+    if (policy < FRAME_IDLE_OFF || policy > FRAME_IDLE_SKIP) policy = FRAME_IDLE_OFF;
+    if (idleFPS < 1) idleFPS = 1;
+
+    if (policy != g_idle.policy) {
+        // Fingerprints from before the change cover only part of a frame
+        g_idle.matches = 0;
+        g_idle.lastHash = 0;
+        g_idle.idle = false;
+        g_idle.changed = true;
+        velocityLogInfo("Identical frames: %s", POLICY_NAMES[policy]);
+    }
+    g_idle.policy = policy;
+    g_idle.idleFPS = idleFPS;
+}
+
+void frameIdleHash(uint32_t call, const void* data, size_t size) {
+    // A frame already known to differ needs no fingerprint
+    if (!detecting() || g_idle.changed) return;
+    g_idle.hash = hashCombine(g_idle.hash, hashMurmur3(data, size, call));
+}
+
+void frameIdleHashUpload(uint32_t call, const void* data, size_t size) {
+    if (!detecting() || g_idle.changed) return;
+
+    if (!data || size > FRAME_IDLE_MAX_HASH_BYTES) {
+        g_idle.changed = true;
+        return;
+    }
+    frameIdleHash(call, data, size);
+}
+
+void frameIdleChanged(void) {
+    g_idle.changed = true;
+}
+
+bool frameIdleEndFrame(void) {
+    if (!detecting()) {
+        g_idle.idle = false;
+        return true;
+    }
+
+    // The scale picks the region of the target the upscale reads
+    float scale = resolutionScalerGetScale();
+    g_idle.hash = hashCombine(g_idle.hash, hashMurmur3(&scale, sizeof(scale), 0));
+
+    bool identical = !g_idle.changed && g_idle.hash == g_idle.lastHash;
+    g_idle.lastHash = g_idle.hash;
+    resetFrame();
+
+    uint64_t now = nowNs();
+    if (!identical) {
+        g_idle.matches = 0;
+        g_idle.idle = false;
+        return true;
+    }
+
+    if (++g_idle.matches < FRAME_IDLE_MATCH_FRAMES) return true;
+
+    if (!g_idle.idle) {
+        g_idle.idle = true;
+        g_idle.lastRefreshNs = now;
+        g_idle.lastWakeNs = now;
+    }
+    g_idle.identicalFrames++;
+
+    // Entry points passed straight to the driver never reach the
+    // fingerprint: refresh the whole window now and then
+    if (now - g_idle.lastRefreshNs >= FRAME_IDLE_KEEPALIVE_MS * 1000000ULL) {
+        g_idle.lastRefreshNs = now;
+        g_idle.refreshes++;
+        damageTrackerAddFull();
+        return true;
+    }
+
+    damageTrackerDiscardFrame();
+
+    if (g_idle.policy == FRAME_IDLE_SKIP) {
+        g_idle.presentsSkipped++;
+        return false;
+    }
+
+    g_idle.framesReused++;
+    return true;
+}
+
+void frameIdleWait(void) {
+    if (!g_idle.initialized || g_idle.idleFPS <= 0) return;
+
+    uint64_t interval = 1000000000ULL / (uint64_t)g_idle.idleFPS;
+    uint64_t wake = g_idle.lastWakeNs + interval;
+    uint64_t now = nowNs();
+
+    if (wake > now) {
+        uint64_t sleepNs = wake - now;
+        struct timespec ts = {
+            .tv_sec = (time_t)(sleepNs / 1000000000ULL),
+            .tv_nsec = (long)(sleepNs % 1000000000ULL)
+        };
+        nanosleep(&ts, NULL);
+        g_idle.lastWakeNs = wake;
+    } else {
+        g_idle.lastWakeNs = now;
+    }
+}
+
+void frameIdleGetStats(FrameIdleStats* stats) {
+    if (!stats) return;
+
+    memset(stats, 0, sizeof(FrameIdleStats));
+    stats->policy = g_idle.policy;
+    stats->idle = g_idle.idle;
+    stats->identicalFrames = g_idle.identicalFrames;
+    stats->framesReused = g_idle.framesReused;
+    stats->presentsSkipped = g_idle.presentsSkipped;
+    stats->refreshes = g_idle.refreshes;
+}
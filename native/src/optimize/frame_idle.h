@@ -0,0 +1,120 @@
+/**
+ * Frame Idle - Identical-frame detection
+ * Every wrapped entry point folds its call and arguments (uniform values,
+ * buffer contents) into a running fingerprint; uploads that can't be
+ * hashed cheaply mark the frame changed. A frame whose fingerprint
+ * matches the previous frames, with no changed resources, draws exactly
+ * what is already on screen: its damage is dropped, so the scaler skips
+ * the upscale and the present repeats the last image, or under the skip
+ * policy the present is dropped and the loop slowed to the idle rate.
+ * A keepalive refresh covers entry points the wrapper doesn't intercept.
+ */
+
+#ifndef FRAME_IDLE_H
+#define FRAME_IDLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+// The first repeat of a stream can still start from different state
+#define FRAME_IDLE_MATCH_FRAMES     3           // Matching frames before going idle
+#define FRAME_IDLE_KEEPALIVE_MS     500         // Full refresh interval while idle
+#define FRAME_IDLE_MAX_HASH_BYTES   (256 * 1024) // Larger uploads count as changed
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * What happens to identical frames (matches VelocityIdlePolicy)
+ */
+typedef enum FrameIdlePolicy {
+    FRAME_IDLE_OFF = 0,
+    FRAME_IDLE_REPRESENT,        // Present without damage or upscale
+    FRAME_IDLE_SKIP              // Skip the present, throttle to the idle rate
+} FrameIdlePolicy;
+
+/**
+ * Idle statistics
+ */
+typedef struct FrameIdleStats {
+    FrameIdlePolicy policy;
+    bool idle;                   // Last frame was identical
+    uint32_t identicalFrames;
+    uint32_t framesReused;       // Presented without damage
+    uint32_t presentsSkipped;
+    uint32_t refreshes;          // Keepalive refreshes while idle
+} FrameIdleStats;
+
+// ============================================================================
+// Frame Idle API
+// ============================================================================
+
+/**
+ * Initialize detection
+ */
+void frameIdleInit(FrameIdlePolicy policy, int idleFPS);
+
+/**
+ * Shutdown detection
+ */
+void frameIdleShutdown(void);
+
+/**
+ * Change the policy and idle rate
+ */
+void frameIdleSetPolicy(FrameIdlePolicy policy, int idleFPS);
+
+/**
+ * Fold a call and its arguments into this frame's fingerprint
+ */
+void frameIdleHash(uint32_t call, const void* data, size_t size);
+
+/**
+ * Fold uploaded data into the fingerprint (NULL or too large: changed)
+ */
+void frameIdleHashUpload(uint32_t call, const void* data, size_t size);
+
+/**
+ * A resource changed in a way the fingerprint can't see
+ */
+void frameIdleChanged(void);
+
+/**
+ * Close this frame's fingerprint, false if the present should be skipped
+ * (call before the damage tracker closes the frame)
+ */
+bool frameIdleEndFrame(void);
+
+/**
+ * Hold the loop to the idle rate after a skipped present
+ */
+void frameIdleWait(void);
+
+/**
+ * Get statistics
+ */
+void frameIdleGetStats(FrameIdleStats* stats);
+
+/**
+ * Bit pattern of a float argument
+ */
+static inline uint64_t frameIdleBits(float value) {
+    union { float f; uint32_t u; } bits = { value };
+    return bits.u;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FRAME_IDLE_H
@@ -1,38 +1,342 @@
 /**
- * Frame Pacing - Stub implementation
+ * Frame Pacing - Implementation
+ * Each frame gets a present slot on the vsync grid, divider periods after
+ * the previous one. The pacer sleeps until shortly before the buffer has to
+ * be queued, spins the rest, then tags the buffer with the slot time. Swaps
+ * that block on buffer release land just after a vsync edge and keep the
+ * grid phase-locked to the display.
  */
 
-#include "../core/gl_wrapper.h"
+#include "frame_pacing.h"
 #include "../utils/log.h"
 
+#include <EGL/eglext.h>
+#include <string.h>
+#include <errno.h>
 #include <time.h>
 
 // ============================================================================
-// Frame Timing
+// Types
 // ============================================================================
 
-static uint64_t g_lastFrameTime = 0;
-static float g_targetFrameTime = 16.666f; // 60 FPS
+typedef struct FramePacingContext {
+    bool initialized;
+    bool enabled;
+    int targetFPS;
+
+    // Vsync grid
+    float refreshHz;
+    uint64_t periodNs;
+    uint64_t phaseNs;            // Timestamp of an observed vsync edge
+    bool phaseValid;
+
+    // Cadence ladder: refresh / divider
+    int divider;
+    int minDivider;              // Fastest cadence not above the target
+    int maxDivider;              // Slowest cadence allowed
+    int holdFrames;
+
+    // Schedule
+    uint64_t lastSlotNs;
+    uint64_t workStartNs;
+    uint64_t swapStartNs;
+
+    // Sleep accuracy
+    float oversleepNs;
+
+    // Work history (ms)
+    float workMs[PACING_HISTORY];
+    int historyIndex;
+    int historyCount;
+
+    // EGL_ANDROID_presentation_time
+    EGLDisplay probedDisplay;
+    PFNEGLPRESENTATIONTIMEANDROIDPROC presentationTime;
+
+    // Stats
+    float avgWorkMs;
+    float avgWaitMs;
+    uint32_t missedFrames;
+    uint32_t stepDowns;
+    uint32_t stepUps;
+} FramePacingContext;
+
+static FramePacingContext g_pacing = {0};
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static inline uint64_t nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline void cpuRelax(void) {
+#if defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#elif defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#endif
+}
+
+static void updateLadder(void) {
+    float refresh = g_pacing.refreshHz;
+    int target = g_pacing.targetFPS > 0 ? g_pacing.targetFPS : (int)(refresh + 0.5f);
+
+    // Fastest whole-vsync cadence that does not exceed the target
+    int minDivider = 1;
+    while (minDivider < PACING_MAX_VSYNC_DIVIDER && refresh / minDivider > target + 0.5f) {
+        minDivider++;
+    }
+
+    int maxDivider = minDivider;
+    while (maxDivider < PACING_MAX_VSYNC_DIVIDER && refresh / (maxDivider + 1) >= PACING_MIN_FPS) {
+        maxDivider++;
+    }
+
+    g_pacing.minDivider = minDivider;
+    g_pacing.maxDivider = maxDivider;
+    g_pacing.divider = minDivider;
+    g_pacing.holdFrames = PACING_HOLD_FRAMES;
+    g_pacing.historyCount = 0;
+    g_pacing.historyIndex = 0;
+}
+
+static uint64_t alignToVsync(uint64_t t) {
+    if (!g_pacing.phaseValid || t <= g_pacing.phaseNs) return t;
+
+    uint64_t periods = (t - g_pacing.phaseNs + g_pacing.periodNs - 1) / g_pacing.periodNs;
+    return g_pacing.phaseNs + periods * g_pacing.periodNs;
+}
+
+static void probePresentationTime(EGLDisplay display) {
+    if (display == g_pacing.probedDisplay) return;
+
+    g_pacing.probedDisplay = display;
+    g_pacing.presentationTime = NULL;
+
+    const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+    if (extensions && strstr(extensions, "EGL_ANDROID_presentation_time")) {
+        g_pacing.presentationTime = (PFNEGLPRESENTATIONTIMEANDROIDPROC)
+            eglGetProcAddress("eglPresentationTimeANDROID");
+    }
+
+    velocityLogInfo("Frame pacing: presentation time %s",
+                    g_pacing.presentationTime ? "available" : "unavailable");
+}
+
+/**
+ * Sleep until close to the deadline, then spin. The spin window follows the
+ * observed sleep overshoot so the wake-up lands on time without burning a
+ * whole frame of CPU.
+ */
+static uint64_t waitUntil(uint64_t deadline) {
+    uint64_t start = nowNs();
+    if (deadline <= start) return 0;
+
+    uint64_t spinNs = (uint64_t)(g_pacing.oversleepNs * 2.0f);
+    if (spinNs < PACING_SPIN_MIN_US * 1000ULL) spinNs = PACING_SPIN_MIN_US * 1000ULL;
+    if (spinNs > PACING_SPIN_MAX_US * 1000ULL) spinNs = PACING_SPIN_MAX_US * 1000ULL;
+
+    if (deadline - start > spinNs) {
+        uint64_t sleepUntil = deadline - spinNs;
+        struct timespec ts = {
+            .tv_sec = (time_t)(sleepUntil / 1000000000ULL),
+            .tv_nsec = (long)(sleepUntil % 1000000000ULL)
+        };
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+        }
+
+        uint64_t woke = nowNs();
+        float overshoot = woke > sleepUntil ? (float)(woke - sleepUntil) : 0.0f;
+        g_pacing.oversleepNs += (overshoot - g_pacing.oversleepNs) * 0.1f;
+    }
+
+    while (nowNs() < deadline) {
+        cpuRelax();
+    }
+
+    return nowNs() - start;
+}
+
+static void recordWork(float workMs) {
+    g_pacing.workMs[g_pacing.historyIndex] = workMs;
+    g_pacing.historyIndex = (g_pacing.historyIndex + 1) % PACING_HISTORY;
+    if (g_pacing.historyCount < PACING_HISTORY) g_pacing.historyCount++;
+
+    g_pacing.avgWorkMs += (workMs - g_pacing.avgWorkMs) * 0.05f;
+}
+
+/**
+ * Step the cadence down when a sustained share of frames misses the budget,
+ * and back up once the next faster budget has clear headroom.
+ */
+static void updateCadence(void) {
+    if (g_pacing.holdFrames > 0) {
+        g_pacing.holdFrames--;
+        return;
+    }
+    if (g_pacing.historyCount < PACING_HISTORY / 2) return;
+
+    float periodMs = g_pacing.periodNs / 1000000.0f;
+    float budgetMs = periodMs * g_pacing.divider;
+    float fasterBudgetMs = periodMs * (g_pacing.divider - 1);
+
+    // Misses are judged on the most recent half of the history
+    int recent = PACING_HISTORY / 2;
+    int misses = 0;
+    float worstMs = 0.0f;
+    for (int i = 0; i < g_pacing.historyCount; i++) {
+        int index = (g_pacing.historyIndex - 1 - i + PACING_HISTORY) % PACING_HISTORY;
+        float ms = g_pacing.workMs[index];
+        if (i < recent && ms > budgetMs) misses++;
+        if (ms > worstMs) worstMs = ms;
+    }
+
+    if (misses > recent * PACING_MISS_RATIO && g_pacing.divider < g_pacing.maxDivider) {
+        g_pacing.divider++;
+        g_pacing.stepDowns++;
+        g_pacing.holdFrames = PACING_HOLD_FRAMES;
+        velocityLogInfo("Frame pacing: stepping down to %.0f FPS (%d/%d frames over %.1f ms)",
+                        g_pacing.refreshHz / g_pacing.divider, misses, recent, budgetMs);
+    } else if (g_pacing.divider > g_pacing.minDivider &&
+               g_pacing.historyCount == PACING_HISTORY &&
+               worstMs < fasterBudgetMs * PACING_HEADROOM) {
+        g_pacing.divider--;
+        g_pacing.stepUps++;
+        g_pacing.holdFrames = PACING_HOLD_FRAMES;
+        velocityLogInfo("Frame pacing: stepping up to %.0f FPS (worst %.1f ms)",
+                        g_pacing.refreshHz / g_pacing.divider, worstMs);
+    }
+}
+
+// ============================================================================
+// Frame Pacing API
+// ============================================================================
+
+void framePacingInit(int targetFPS, bool enabled) {
+    memset(&g_pacing, 0, sizeof(FramePacingContext));
+
+    g_pacing.initialized = true;
+    g_pacing.enabled = enabled;
+    g_pacing.targetFPS = targetFPS;
+    g_pacing.probedDisplay = EGL_NO_DISPLAY;
+
+    framePacingSetRefreshRate(PACING_DEFAULT_REFRESH_HZ);
+
+    velocityLogInfo("Frame pacing initialized: %s, target %d FPS",
+                    enabled ? "enabled" : "disabled", targetFPS);
+}
+
+void framePacingShutdown(void) {
+    memset(&g_pacing, 0, sizeof(FramePacingContext));
+}
+
+void framePacingSetEnabled(bool enabled) {
+    if (g_pacing.enabled == enabled) return;
+
+    g_pacing.enabled = enabled;
+    g_pacing.lastSlotNs = 0;
+    updateLadder();
+}
+
+bool framePacingIsEnabled(void) {
+    return g_pacing.enabled;
+}
 
 void framePacingSetTargetFPS(int fps) {
-    if (fps > 0) {
-        g_targetFrameTime = 1000.0f / fps;
+    if (fps <= 0 || fps == g_pacing.targetFPS) return;
+
+    g_pacing.targetFPS = fps;
+    updateLadder();
+}
+
+void framePacingSetRefreshRate(float hz) {
+    if (hz < 1.0f) return;
+
+    g_pacing.refreshHz = hz;
+    g_pacing.periodNs = (uint64_t)(1000000000.0 / hz);
+    g_pacing.phaseValid = false;
+    g_pacing.lastSlotNs = 0;
+    updateLadder();
+}
+
+void framePacingBeforeSwap(EGLDisplay display, EGLSurface surface) {
+    if (!g_pacing.initialized) return;
+
+    uint64_t now = nowNs();
+    if (g_pacing.workStartNs != 0) {
+        recordWork((now - g_pacing.workStartNs) / 1000000.0f);
+    }
+
+    if (!g_pacing.enabled) {
+        g_pacing.swapStartNs = now;
+        return;
+    }
+
+    probePresentationTime(display);
+    updateCadence();
+
+    // Queue one vsync ahead of the slot so the compositor can latch it
+    uint64_t interval = g_pacing.periodNs * g_pacing.divider;
+    uint64_t lead = g_pacing.periodNs;
+    uint64_t slot = g_pacing.lastSlotNs + interval;
+
+    if (g_pacing.lastSlotNs == 0 || slot < now + lead) {
+        if (g_pacing.lastSlotNs != 0) g_pacing.missedFrames++;
+        slot = alignToVsync(now + lead);
+    }
+
+    uint64_t waitedNs = waitUntil(slot - lead);
+    g_pacing.avgWaitMs += (waitedNs / 1000000.0f - g_pacing.avgWaitMs) * 0.05f;
+
+    if (g_pacing.presentationTime) {
+        g_pacing.presentationTime(display, surface, (EGLnsecsANDROID)slot);
     }
+
+    g_pacing.lastSlotNs = slot;
+    g_pacing.swapStartNs = nowNs();
 }
 
-void framePacingBeginFrame(void) {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    g_lastFrameTime = ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+void framePacingAfterSwap(void) {
+    if (!g_pacing.initialized) return;
+
+    uint64_t now = nowNs();
+
+    // A swap that blocked returned right after a buffer was released on a
+    // vsync edge; nudge the grid phase towards it
+    if (g_pacing.swapStartNs != 0 && now - g_pacing.swapStartNs > g_pacing.periodNs / 4) {
+        if (!g_pacing.phaseValid) {
+            g_pacing.phaseNs = now;
+            g_pacing.phaseValid = true;
+        } else if (now > g_pacing.phaseNs) {
+            int64_t period = (int64_t)g_pacing.periodNs;
+            int64_t error = (int64_t)((now - g_pacing.phaseNs) % g_pacing.periodNs);
+            if (error > period / 2) error -= period;
+            g_pacing.phaseNs += error / 8;
+        }
+    }
+
+    g_pacing.workStartNs = now;
 }
 
-void framePacingEndFrame(void) {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    uint64_t currentTime = ts.tv_sec * 1000000000ULL + ts.tv_nsec;
-    
-    float frameTimeMs = (currentTime - g_lastFrameTime) / 1000000.0f;
-    
-    // Simple frame pacing - could add sleep here if frame is too fast
-    (void)frameTimeMs;
+void framePacingGetStats(FramePacingStats* stats) {
+    if (!stats) return;
+
+    memset(stats, 0, sizeof(FramePacingStats));
+    if (!g_pacing.initialized) return;
+
+    stats->refreshRateHz = g_pacing.refreshHz;
+    stats->targetFPS = (float)g_pacing.targetFPS;
+    stats->pacedFPS = g_pacing.enabled ? g_pacing.refreshHz / g_pacing.divider : 0.0f;
+    stats->vsyncDivider = g_pacing.divider;
+    stats->avgWorkMs = g_pacing.avgWorkMs;
+    stats->avgWaitMs = g_pacing.avgWaitMs;
+    stats->oversleepUs = g_pacing.oversleepNs / 1000.0f;
+    stats->missedFrames = g_pacing.missedFrames;
+    stats->stepDowns = g_pacing.stepDowns;
+    stats->stepUps = g_pacing.stepUps;
+    stats->presentationTime = g_pacing.presentationTime != NULL;
 }
@@ -0,0 +1,108 @@
+/**
+ * Frame Pacing - Steady present cadence at the target frame rate
+ * Holds frames to a whole number of vsync periods using a hybrid
+ * sleep-then-spin wait, asks the compositor for matching present times
+ * through EGL_ANDROID_presentation_time, and steps the cadence down when
+ * the frame budget is missed for a sustained period.
+ */
+
+#ifndef FRAME_PACING_H
+#define FRAME_PACING_H
+
+#include <EGL/egl.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define PACING_DEFAULT_REFRESH_HZ   60.0f
+#define PACING_MAX_VSYNC_DIVIDER    4       // Slowest cadence = refresh / 4
+#define PACING_MIN_FPS              20      // Never step below this rate
+#define PACING_SPIN_MIN_US          300     // Spin at least this long before a deadline
+#define PACING_SPIN_MAX_US          3000
+#define PACING_HISTORY              120     // Frames used for step decisions
+#define PACING_MISS_RATIO           0.15f   // Missed-budget ratio that steps down
+#define PACING_HEADROOM             0.75f   // Work / faster interval ratio that steps up
+#define PACING_HOLD_FRAMES          120     // Frames between two cadence changes
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * Pacer statistics
+ */
+typedef struct FramePacingStats {
+    float refreshRateHz;         // Display refresh used for phase locking
+    float targetFPS;             // Requested rate
+    float pacedFPS;              // Current cadence (refresh / divider)
+    int vsyncDivider;            // Vsync periods per frame
+    float avgWorkMs;             // Frame work between swaps, excluding waits
+    float avgWaitMs;             // Time the pacer held frames
+    float oversleepUs;           // Sleep overshoot estimate driving the spin margin
+    uint32_t missedFrames;       // Frames past their present slot since init
+    uint32_t stepDowns;
+    uint32_t stepUps;
+    bool presentationTime;       // EGL_ANDROID_presentation_time in use
+} FramePacingStats;
+
+// ============================================================================
+// Frame Pacing API
+// ============================================================================
+
+/**
+ * Initialize pacer
+ */
+void framePacingInit(int targetFPS, bool enabled);
+
+/**
+ * Shutdown pacer
+ */
+void framePacingShutdown(void);
+
+/**
+ * Enable/disable pacing
+ */
+void framePacingSetEnabled(bool enabled);
+
+/**
+ * Check if pacing is enabled
+ */
+bool framePacingIsEnabled(void);
+
+/**
+ * Set target frame rate (snapped to a whole vsync divider)
+ */
+void framePacingSetTargetFPS(int fps);
+
+/**
+ * Set display refresh rate in Hz
+ */
+void framePacingSetRefreshRate(float hz);
+
+/**
+ * Hold the frame until its present slot (call right before eglSwapBuffers)
+ */
+void framePacingBeforeSwap(EGLDisplay display, EGLSurface surface);
+
+/**
+ * Record swap completion for vsync phase tracking (call right after eglSwapBuffers)
+ */
+void framePacingAfterSwap(void);
+
+/**
+ * Get pacer statistics
+ */
+void framePacingGetStats(FramePacingStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FRAME_PACING_H
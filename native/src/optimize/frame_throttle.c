@@ -0,0 +1,213 @@
+/**
+ * Frame Throttle - Implementation
+ */
+
+#include "frame_throttle.h"
+#include "frame_pacing.h"
+#include "fence_timeline.h"
+#include "../profile/trace.h"
+#include "../utils/log.h"
+
+#include <GLES3/gl32.h>
+#include <string.h>
+#include <time.h>
+
+// ============================================================================
+// Types
+// ============================================================================
+
+typedef struct ThrottleFrame {
+    FencePoint point;
+    uint64_t startNs;            // When the CPU began building the frame
+} ThrottleFrame;
+
+typedef struct FrameThrottleContext {
+    bool initialized;
+    bool enabled;
+    int maxFrames;
+
+    // Pending frames, oldest at tail
+    ThrottleFrame frames[THROTTLE_RING_SIZE];
+    int tail;
+    int count;
+
+    uint64_t frameStartNs;
+
+    // Stats
+    float latencyMs;
+    float gpuCompleteMs;
+    float waitMs;
+    uint32_t finishesReplaced;
+} FrameThrottleContext;
+
+static FrameThrottleContext g_throttle = {0};
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static inline uint64_t nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline int clampFrames(int frames) {
+    if (frames < THROTTLE_MIN_FRAMES) return THROTTLE_MIN_FRAMES;
+    if (frames > THROTTLE_MAX_FRAMES) return THROTTLE_MAX_FRAMES;
+    return frames;
+}
+
+/**
+ * Retire the oldest frame. The completion time is exact after a blocking
+ * wait and an upper bound when the fence was already signaled.
+ */
+static void retireOldest(uint64_t completeNs) {
+    ThrottleFrame* frame = &g_throttle.frames[g_throttle.tail];
+
+    if (frame->startNs != 0 && completeNs > frame->startNs) {
+        // The compositor latches on the next vsync, scanout takes one more
+        FramePacingStats pacing;
+        framePacingGetStats(&pacing);
+        float refreshHz = pacing.refreshRateHz > 0.0f ? pacing.refreshRateHz : PACING_DEFAULT_REFRESH_HZ;
+
+        float completeMs = (completeNs - frame->startNs) / 1000000.0f;
+        float latencyMs = completeMs + 1000.0f / refreshHz;
+
+        g_throttle.gpuCompleteMs += (completeMs - g_throttle.gpuCompleteMs) * 0.1f;
+        g_throttle.latencyMs += (latencyMs - g_throttle.latencyMs) * 0.1f;
+    }
+
+    g_throttle.tail = (g_throttle.tail + 1) % THROTTLE_RING_SIZE;
+    g_throttle.count--;
+}
+
+static void waitOldest(FenceWaitCause cause) {
+    TRACE_SCOPE("throttle_wait");
+
+    // Stop tracking the frame on timeout rather than stall every following one
+    ThrottleFrame* frame = &g_throttle.frames[g_throttle.tail];
+    if (!fenceTimelineWait(frame->point, cause, THROTTLE_WAIT_TIMEOUT_NS)) {
+        velocityLogWarn("Frame throttle fence wait timed out");
+    }
+
+    retireOldest(nowNs());
+}
+
+static void retireSignaled(void) {
+    while (g_throttle.count > 0 && fenceTimelineReached(g_throttle.frames[g_throttle.tail].point)) {
+        retireOldest(nowNs());
+    }
+}
+
+static void releaseAll(void) {
+    g_throttle.tail = 0;
+    g_throttle.count = 0;
+}
+
+// ============================================================================
+// Frame Throttle API
+// ============================================================================
+
+void frameThrottleInit(int maxFramesInFlight, bool enabled) {
+    if (g_throttle.initialized) {
+        frameThrottleShutdown();
+    }
+
+    memset(&g_throttle, 0, sizeof(FrameThrottleContext));
+    g_throttle.initialized = true;
+    g_throttle.enabled = enabled;
+    g_throttle.maxFrames = clampFrames(maxFramesInFlight);
+    g_throttle.frameStartNs = nowNs();
+
+    velocityLogInfo("Frame throttle initialized: latency mode %s, %d frame(s) in flight",
+                    enabled ? "on" : "off", g_throttle.maxFrames);
+}
+
+void frameThrottleShutdown(void) {
+    if (!g_throttle.initialized) return;
+
+    releaseAll();
+    memset(&g_throttle, 0, sizeof(FrameThrottleContext));
+}
+
+void frameThrottleSetEnabled(bool enabled) {
+    if (g_throttle.enabled == enabled) return;
+
+    g_throttle.enabled = enabled;
+    velocityLogInfo("Latency mode %s", enabled ? "enabled" : "disabled");
+}
+
+bool frameThrottleIsEnabled(void) {
+    return g_throttle.enabled;
+}
+
+void frameThrottleSetMaxFrames(int frames) {
+    g_throttle.maxFrames = clampFrames(frames);
+}
+
+void frameThrottleBeforeSwap(void) {
+    if (!g_throttle.initialized) return;
+
+    // Apps that never let the GPU catch up would overflow the ring
+    if (g_throttle.count == THROTTLE_RING_SIZE) {
+        waitOldest(FENCE_WAIT_THROTTLE);
+    }
+
+    int index = (g_throttle.tail + g_throttle.count) % THROTTLE_RING_SIZE;
+    g_throttle.frames[index].point = fenceTimelineSubmit();
+    g_throttle.frames[index].startNs = g_throttle.frameStartNs;
+    g_throttle.count++;
+}
+
+void frameThrottleAfterSwap(void) {
+    if (!g_throttle.initialized) return;
+
+    retireSignaled();
+
+    uint64_t waitStart = nowNs();
+    uint64_t waitEnd = waitStart;
+
+    // N frames in flight: the frame from N-1 swaps ago must be done before
+    // the CPU starts sampling input for the next one
+    if (g_throttle.enabled) {
+        while (g_throttle.count >= g_throttle.maxFrames) {
+            waitOldest(FENCE_WAIT_THROTTLE);
+        }
+        waitEnd = nowNs();
+    }
+
+    g_throttle.waitMs += ((waitEnd - waitStart) / 1000000.0f - g_throttle.waitMs) * 0.1f;
+    g_throttle.frameStartNs = waitEnd;
+}
+
+bool frameThrottleFinish(void) {
+    if (!g_throttle.initialized || !g_throttle.enabled || g_throttle.count == 0) {
+        return false;
+    }
+
+    // Waits for the last presented frame only; work issued since then keeps
+    // running, which is what latency mode trades a full pipeline drain for
+    glFlush();
+    while (g_throttle.count > 0) {
+        waitOldest(FENCE_WAIT_FINISH);
+    }
+
+    g_throttle.finishesReplaced++;
+    return true;
+}
+
+void frameThrottleGetStats(FrameThrottleStats* stats) {
+    if (!stats) return;
+
+    memset(stats, 0, sizeof(FrameThrottleStats));
+    if (!g_throttle.initialized) return;
+
+    stats->enabled = g_throttle.enabled;
+    stats->maxFramesInFlight = g_throttle.maxFrames;
+    stats->framesInFlight = g_throttle.count;
+    stats->latencyMs = g_throttle.latencyMs;
+    stats->gpuCompleteMs = g_throttle.gpuCompleteMs;
+    stats->waitMs = g_throttle.waitMs;
+    stats->finishesReplaced = g_throttle.finishesReplaced;
+}
@@ -0,0 +1,98 @@
+/**
+ * Frame Throttle - Bounded frames in flight for low-latency mode
+ * Inserts a fence per frame at swap and, in latency mode, waits on the
+ * fence from N frames ago before the CPU starts the next frame. Fence
+ * completion times also drive the input-to-present latency estimate.
+ */
+
+#ifndef FRAME_THROTTLE_H
+#define FRAME_THROTTLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define THROTTLE_MIN_FRAMES         1       // CPU and GPU fully serialized
+#define THROTTLE_MAX_FRAMES         3
+#define THROTTLE_DEFAULT_FRAMES     2
+#define THROTTLE_RING_SIZE          8       // Fences tracked while unthrottled
+#define THROTTLE_WAIT_TIMEOUT_NS    100000000ULL    // 100 ms
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * Throttle statistics
+ */
+typedef struct FrameThrottleStats {
+    bool enabled;
+    int maxFramesInFlight;
+    int framesInFlight;          // Frames queued on the GPU after the last swap
+    float latencyMs;             // Frame start to expected present (EMA)
+    float gpuCompleteMs;         // Frame start to GPU completion (EMA)
+    float waitMs;                // Time the CPU was held per frame (EMA)
+    uint32_t finishesReplaced;   // App glFinish calls served by a frame fence
+} FrameThrottleStats;
+
+// ============================================================================
+// Frame Throttle API
+// ============================================================================
+
+/**
+ * Initialize throttle (requires GL context)
+ */
+void frameThrottleInit(int maxFramesInFlight, bool enabled);
+
+/**
+ * Shutdown throttle and release pending fences
+ */
+void frameThrottleShutdown(void);
+
+/**
+ * Enable/disable latency mode
+ */
+void frameThrottleSetEnabled(bool enabled);
+
+/**
+ * Check if latency mode is enabled
+ */
+bool frameThrottleIsEnabled(void);
+
+/**
+ * Set frames the CPU may run ahead of the GPU (1-3)
+ */
+void frameThrottleSetMaxFrames(int frames);
+
+/**
+ * Insert the frame fence (call right before swap)
+ */
+void frameThrottleBeforeSwap(void);
+
+/**
+ * Retire finished frames and hold the CPU in latency mode (call right after swap)
+ */
+void frameThrottleAfterSwap(void);
+
+/**
+ * Serve an app glFinish from the last frame fence, false if a real glFinish is needed
+ */
+bool frameThrottleFinish(void);
+
+/**
+ * Get throttle statistics
+ */
+void frameThrottleGetStats(FrameThrottleStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FRAME_THROTTLE_H
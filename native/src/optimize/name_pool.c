@@ -0,0 +1,439 @@
+/**
+ * Name Pool - Implementation
+ * Pooled names and pending deletions belong to the context the pool was
+ * initialized on; calls made with any other context current go straight
+ * to the driver. A deleted object is unbound from the texture units,
+ * generic buffer bindings and bound framebuffers before it is queued,
+ * which is what the driver's delete would have done to the context.
+ */
+
+#include "name_pool.h"
+#include "fence_timeline.h"
+#include "../core/gl_wrapper.h"
+#include "../profile/trace.h"
+#include "../utils/log.h"
+
+#include <EGL/egl.h>
+#include <string.h>
+
+// ============================================================================
+// Types
+// ============================================================================
+
+#define PENDING_SET_SIZE    (NAME_POOL_MAX_PENDING * 2)
+#define DELETE_BATCH        256
+
+typedef struct PendingName {
+    GLuint name;                 // 0: revived, skip
+    uint8_t kind;
+    uint32_t frame;
+} PendingName;
+
+typedef struct FrameFence {
+    FencePoint point;
+    uint32_t frame;              // Last frame whose deletions it covers
+} FrameFence;
+
+typedef struct NamePoolContext {
+    bool initialized;
+    bool enabled;
+    EGLContext context;
+
+    // Pre-generated names per kind
+    GLuint available[NAME_KIND_COUNT][NAME_POOL_SIZE];
+    int availableCount[NAME_KIND_COUNT];
+
+    // Deletions, oldest at head
+    PendingName queue[NAME_POOL_MAX_PENDING];
+    uint32_t head;
+    uint32_t count;
+
+    // Pending names keyed by kind and name
+    uint64_t set[PENDING_SET_SIZE];
+
+    // Fences over frames with deletions, oldest at tail
+    FrameFence fences[NAME_POOL_MAX_FRAMES];
+    int fenceTail;
+    int fenceCount;
+
+    uint32_t frame;
+    bool queuedThisFrame;
+
+    // Stats
+    uint32_t served;
+    uint32_t generated;
+    uint32_t deferred;
+    uint32_t deleted;
+    uint32_t deleteCalls;
+    uint32_t forced;
+} NamePoolContext;
+
+static NamePoolContext g_names = {0};
+
+uint32_t g_namePoolPending = 0;
+
+// ============================================================================
+// Driver Calls
+// ============================================================================
+
+static void driverGen(NameKind kind, GLsizei n, GLuint* names) {
+    switch (kind) {
+        case NAME_BUFFER:       glGenBuffers(n, names); break;
+        case NAME_TEXTURE:      glGenTextures(n, names); break;
+        case NAME_RENDERBUFFER: glGenRenderbuffers(n, names); break;
+        default: break;
+    }
+}
+
+static void driverDelete(NameKind kind, GLsizei n, const GLuint* names) {
+    if (n <= 0) return;
+
+    switch (kind) {
+        case NAME_BUFFER:       glDeleteBuffers(n, names); break;
+        case NAME_TEXTURE:      glDeleteTextures(n, names); break;
+        case NAME_RENDERBUFFER: glDeleteRenderbuffers(n, names); break;
+        default: break;
+    }
+}
+
+static inline bool usable(void) {
+    return g_names.initialized && g_names.enabled && eglGetCurrentContext() == g_names.context;
+}
+
+// ============================================================================
+// Pending Set
+// ============================================================================
+
+static inline uint64_t setKey(NameKind kind, GLuint name) {
+    return ((uint64_t)kind << 32) | name;
+}
+
+static inline uint32_t setIndex(uint64_t key) {
+    return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & (PENDING_SET_SIZE - 1);
+}
+
+static uint64_t* setFind(uint64_t key) {
+    for (uint32_t i = setIndex(key); ; i = (i + 1) & (PENDING_SET_SIZE - 1)) {
+        if (g_names.set[i] == key) return &g_names.set[i];
+        if (g_names.set[i] == 0) return NULL;
+    }
+}
+
+static void setInsert(uint64_t key) {
+    // The queue caps the count at half the table, so a free slot exists
+    uint32_t i = setIndex(key);
+    while (g_names.set[i] != 0 && g_names.set[i] != key) {
+        i = (i + 1) & (PENDING_SET_SIZE - 1);
+    }
+    g_names.set[i] = key;
+}
+
+static void setRemove(uint64_t key) {
+    uint64_t* slot = setFind(key);
+    if (!slot) return;
+
+    // Backward shift: pull later slots of the probe run into the hole
+    uint32_t hole = (uint32_t)(slot - g_names.set);
+    for (uint32_t i = (hole + 1) & (PENDING_SET_SIZE - 1); g_names.set[i] != 0;
+         i = (i + 1) & (PENDING_SET_SIZE - 1)) {
+        uint32_t home = setIndex(g_names.set[i]);
+        bool stays = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+        if (stays) continue;
+
+        g_names.set[hole] = g_names.set[i];
+        hole = i;
+    }
+    g_names.set[hole] = 0;
+}
+
+// ============================================================================
+// Deferred Deletion
+// ============================================================================
+
+/**
+ * Delete queued names up to and including a frame, one call per kind and batch
+ */
+static void retireThrough(uint32_t frame, bool forced) {
+    GLuint batch[NAME_KIND_COUNT][DELETE_BATCH];
+    GLsizei batchCount[NAME_KIND_COUNT] = {0};
+
+    while (g_names.count > 0) {
+        PendingName* pending = &g_names.queue[g_names.head];
+        if ((int32_t)(pending->frame - frame) > 0) break;
+
+        g_names.head = (g_names.head + 1) & (NAME_POOL_MAX_PENDING - 1);
+        g_names.count--;
+        if (pending->name == 0) continue;
+
+        NameKind kind = (NameKind)pending->kind;
+        setRemove(setKey(kind, pending->name));
+        g_namePoolPending--;
+
+        batch[kind][batchCount[kind]++] = pending->name;
+        if (batchCount[kind] == DELETE_BATCH) {
+            driverDelete(kind, DELETE_BATCH, batch[kind]);
+            g_names.deleteCalls++;
+            batchCount[kind] = 0;
+        }
+
+        if (forced) {
+            g_names.forced++;
+        } else {
+            g_names.deleted++;
+        }
+    }
+
+    for (int k = 0; k < NAME_KIND_COUNT; k++) {
+        if (batchCount[k] == 0) continue;
+        driverDelete((NameKind)k, batchCount[k], batch[k]);
+        g_names.deleteCalls++;
+    }
+}
+
+static void popFence(void) {
+    g_names.fenceTail = (g_names.fenceTail + 1) % NAME_POOL_MAX_FRAMES;
+    g_names.fenceCount--;
+}
+
+/**
+ * Close the frame's deletions with a fence
+ */
+static void fenceFrame(void) {
+    if (!g_names.queuedThisFrame) return;
+    g_names.queuedThisFrame = false;
+
+    // A GPU this far behind gets the oldest frame deleted without waiting
+    if (g_names.fenceCount == NAME_POOL_MAX_FRAMES) {
+        retireThrough(g_names.fences[g_names.fenceTail].frame, true);
+        popFence();
+    }
+
+    int index = (g_names.fenceTail + g_names.fenceCount) % NAME_POOL_MAX_FRAMES;
+    g_names.fences[index].point = fenceTimelineSubmit();
+    g_names.fences[index].frame = g_names.frame;
+    g_names.fenceCount++;
+}
+
+static void retireSignaled(void) {
+    while (g_names.fenceCount > 0) {
+        FrameFence* oldest = &g_names.fences[g_names.fenceTail];
+        if (!fenceTimelineReached(oldest->point)) break;
+
+        retireThrough(oldest->frame, false);
+        popFence();
+    }
+}
+
+static void refill(void) {
+    for (int k = 0; k < NAME_KIND_COUNT; k++) {
+        int count = g_names.availableCount[k];
+        if (count >= NAME_POOL_REFILL) continue;
+
+        driverGen((NameKind)k, NAME_POOL_SIZE - count, &g_names.available[k][count]);
+        g_names.availableCount[k] = NAME_POOL_SIZE;
+    }
+}
+
+static void releaseAvailable(void) {
+    for (int k = 0; k < NAME_KIND_COUNT; k++) {
+        driverDelete((NameKind)k, g_names.availableCount[k], g_names.available[k]);
+        g_names.availableCount[k] = 0;
+    }
+}
+
+/**
+ * Unbind objects about to be queued, false if their bindings can't be known
+ */
+static bool unbind(NameKind kind, GLsizei n, const GLuint* names) {
+    switch (kind) {
+        case NAME_BUFFER:
+            glStateUnbindBuffers(n, names);
+            return true;
+
+        case NAME_TEXTURE:
+            if (!glStateUnbindTextures(n, names)) return false;
+            glStateDetachObjects(n, names, false);
+            return true;
+
+        case NAME_RENDERBUFFER: {
+            GLint bound = 0;
+            glGetIntegerv(GL_RENDERBUFFER_BINDING, &bound);
+            for (GLsizei i = 0; i < n; i++) {
+                if (bound != 0 && names[i] == (GLuint)bound) {
+                    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+                    break;
+                }
+            }
+            glStateDetachObjects(n, names, true);
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+// ============================================================================
+// Name Pool API
+// ============================================================================
+
+void namePoolInit(bool enabled) {
+    memset(&g_names, 0, sizeof(NamePoolContext));
+    g_namePoolPending = 0;
+
+    g_names.context = eglGetCurrentContext();
+    g_names.enabled = enabled;
+    g_names.initialized = true;
+
+    if (enabled) refill();
+
+    velocityLogInfo("Name pool initialized (%s)", enabled ? "enabled" : "disabled");
+}
+
+void namePoolShutdown(void) {
+    if (!g_names.initialized) return;
+
+    if (eglGetCurrentContext() == g_names.context) {
+        namePoolFlush();
+        releaseAvailable();
+    }
+    memset(&g_names, 0, sizeof(NamePoolContext));
+    g_namePoolPending = 0;
+}
+
+void namePoolSetEnabled(bool enabled) {
+    if (!g_names.initialized || g_names.enabled == enabled) return;
+
+    if (!enabled && eglGetCurrentContext() == g_names.context) {
+        namePoolFlush();
+        releaseAvailable();
+    }
+    g_names.enabled = enabled;
+}
+
+void namePoolGen(NameKind kind, GLsizei n, GLuint* names) {
+    if (n <= 0 || !names) return;
+
+    if (!usable()) {
+        driverGen(kind, n, names);
+        return;
+    }
+
+    GLsizei taken = 0;
+    int* available = &g_names.availableCount[kind];
+    while (taken < n && *available > 0) {
+        names[taken++] = g_names.available[kind][--(*available)];
+    }
+    g_names.served += taken;
+
+    // Bulk allocations the pool can't cover take a single driver call
+    if (taken < n) {
+        driverGen(kind, n - taken, names + taken);
+        g_names.generated += n - taken;
+    }
+}
+
+void namePoolDelete(NameKind kind, GLsizei n, const GLuint* names) {
+    if (n <= 0 || !names) return;
+
+    if (!usable() || !unbind(kind, n, names)) {
+        driverDelete(kind, n, names);
+        return;
+    }
+
+    TRACE_SCOPE("deferred_delete");
+
+    GLuint immediate[DELETE_BATCH];
+    GLsizei immediateCount = 0;
+
+    for (GLsizei i = 0; i < n; i++) {
+        GLuint name = names[i];
+        if (name == 0) continue;
+
+        uint64_t key = setKey(kind, name);
+        if (setFind(key)) continue;
+
+        // A full queue hands the rest straight to the driver
+        if (g_names.count == NAME_POOL_MAX_PENDING) {
+            immediate[immediateCount++] = name;
+            g_names.forced++;
+            if (immediateCount == DELETE_BATCH) {
+                driverDelete(kind, immediateCount, immediate);
+                immediateCount = 0;
+            }
+            continue;
+        }
+
+        uint32_t index = (g_names.head + g_names.count) & (NAME_POOL_MAX_PENDING - 1);
+        g_names.queue[index].name = name;
+        g_names.queue[index].kind = (uint8_t)kind;
+        g_names.queue[index].frame = g_names.frame;
+        g_names.count++;
+
+        setInsert(key);
+        g_namePoolPending++;
+        g_names.deferred++;
+        g_names.queuedThisFrame = true;
+    }
+
+    driverDelete(kind, immediateCount, immediate);
+}
+
+bool namePoolIsPending(NameKind kind, GLuint name) {
+    if (g_namePoolPending == 0 || name == 0) return false;
+    return setFind(setKey(kind, name)) != NULL;
+}
+
+void namePoolRevive(NameKind kind, GLuint name) {
+    uint64_t key = setKey(kind, name);
+    if (!setFind(key)) return;
+
+    // Rare: the app binds a name it deleted, which must give a new object
+    setRemove(key);
+    g_namePoolPending--;
+    for (uint32_t i = 0; i < g_names.count; i++) {
+        PendingName* pending = &g_names.queue[(g_names.head + i) & (NAME_POOL_MAX_PENDING - 1)];
+        if (pending->name == name && pending->kind == kind) {
+            pending->name = 0;
+            break;
+        }
+    }
+
+    driverDelete(kind, 1, &name);
+    g_names.deleteCalls++;
+    g_names.forced++;
+}
+
+void namePoolEndFrame(void) {
+    if (!usable()) return;
+
+    fenceFrame();
+    retireSignaled();
+    refill();
+    g_names.frame++;
+}
+
+void namePoolFlush(void) {
+    if (!g_names.initialized) return;
+
+    while (g_names.fenceCount > 0) popFence();
+    retireThrough(g_names.frame, true);
+    g_names.queuedThisFrame = false;
+}
+
+void namePoolGetStats(NamePoolStats* stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(NamePoolStats));
+
+    stats->enabled = g_names.enabled;
+    for (int k = 0; k < NAME_KIND_COUNT; k++) {
+        stats->available += g_names.availableCount[k];
+    }
+    stats->pending = g_namePoolPending;
+    stats->served = g_names.served;
+    stats->generated = g_names.generated;
+    stats->deferred = g_names.deferred;
+    stats->deleted = g_names.deleted;
+    stats->deleteCalls = g_names.deleteCalls;
+    stats->forced = g_names.forced;
+}
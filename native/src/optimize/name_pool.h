@@ -0,0 +1,129 @@
+/**
+ * Name Pool - Pre-generated object names and deferred batched deletion
+ * glGen* for buffers, textures and renderbuffers is served from names
+ * generated ahead in bulk between frames. glDelete* unbinds the objects
+ * the way the driver would, then queues them behind the frame fence; once
+ * the GPU has passed that frame they are deleted in one call per kind, so
+ * freeing objects still in flight never stalls the render thread.
+ */
+
+#ifndef NAME_POOL_H
+#define NAME_POOL_H
+
+#include <GLES3/gl32.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define NAME_POOL_SIZE              128     // Names generated ahead per kind
+#define NAME_POOL_REFILL            32      // Refill once fewer remain
+#define NAME_POOL_MAX_PENDING       4096    // Queued deletions (power of two)
+#define NAME_POOL_MAX_FRAMES        4       // Frames of deletions awaiting their fence
+
+// ============================================================================
+// Types
+// ============================================================================
+
+typedef enum NameKind {
+    NAME_BUFFER = 0,
+    NAME_TEXTURE,
+    NAME_RENDERBUFFER,
+    NAME_KIND_COUNT
+} NameKind;
+
+/**
+ * Name pool statistics
+ */
+typedef struct NamePoolStats {
+    bool enabled;
+    uint32_t available;          // Pre-generated names on hand
+    uint32_t pending;            // Deleted names awaiting their fence
+    uint32_t served;             // Names handed out without a driver call
+    uint32_t generated;          // Names the driver generated on demand
+    uint32_t deferred;           // Deletions queued behind a fence
+    uint32_t deleted;            // Queued names deleted after their fence
+    uint32_t deleteCalls;        // Driver delete calls issued for them
+    uint32_t forced;             // Deleted before their fence (queue full, rebind)
+} NamePoolStats;
+
+// Names awaiting deletion, read on the bind hot path
+extern uint32_t g_namePoolPending;
+
+// ============================================================================
+// Name Pool API
+// ============================================================================
+
+/**
+ * Initialize the pool (requires GL context)
+ */
+void namePoolInit(bool enabled);
+
+/**
+ * Delete pending and pre-generated names
+ */
+void namePoolShutdown(void);
+
+/**
+ * Enable/disable pooling (disabling deletes what is pending)
+ */
+void namePoolSetEnabled(bool enabled);
+
+/**
+ * Generate names, from the pool where possible
+ */
+void namePoolGen(NameKind kind, GLsizei n, GLuint* names);
+
+/**
+ * Delete objects by their real names, deferring the driver call until the
+ * GPU is done with the current frame
+ */
+void namePoolDelete(NameKind kind, GLsizei n, const GLuint* names);
+
+/**
+ * Check if a name is queued for deletion
+ */
+bool namePoolIsPending(NameKind kind, GLuint name);
+
+/**
+ * Slow path: a pending name is bound again, delete the old object now so
+ * the bind creates a new one
+ */
+void namePoolRevive(NameKind kind, GLuint name);
+
+/**
+ * Retire deletions whose fence signaled and top up the pools (call once
+ * per frame)
+ */
+void namePoolEndFrame(void);
+
+/**
+ * Delete everything pending now
+ */
+void namePoolFlush(void);
+
+/**
+ * Get statistics
+ */
+void namePoolGetStats(NamePoolStats* stats);
+
+/**
+ * Call before binding an app name
+ */
+static inline void namePoolBind(NameKind kind, GLuint name) {
+    if (__builtin_expect(g_namePoolPending != 0, 0) && name != 0) {
+        namePoolRevive(kind, name);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NAME_POOL_H
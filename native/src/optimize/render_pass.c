@@ -0,0 +1,202 @@
+/**
+ * Render Pass - Implementation
+ */
+
+#include "render_pass.h"
+#include "resolution_scaler.h"
+#include "fb_invalidate.h"
+#include "../buffer/draw_batcher.h"
+#include "../profile/gpu_timer.h"
+#include "../utils/log.h"
+
+#include <string.h>
+
+// ============================================================================
+// Types
+// ============================================================================
+
+typedef struct RenderPassCounters {
+    uint32_t passesRecorded;
+    uint32_t passesExecuted;
+    uint32_t clearsRecorded;
+    uint32_t clearsIssued;
+} RenderPassCounters;
+
+typedef struct RenderPassContext {
+    bool initialized;
+    bool enabled;
+
+    // App bindings
+    GLuint draw;
+    GLuint read;
+
+    // Driver bindings (scaler target stands in for 0)
+    GLuint driverDraw;
+    GLuint driverRead;
+    bool driverKnown;
+
+    GLbitfield pendingClear;
+
+    RenderPassCounters frame;
+    RenderPassCounters lastFrame;
+} RenderPassContext;
+
+static RenderPassContext g_rp = {0};
+
+// Apps keep resolved entry points across contexts, so this outlives them
+static bool g_rpHeld = false;
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static inline GLuint driverName(GLuint framebuffer) {
+    if (framebuffer != 0) return framebuffer;
+    return resolutionScalerGetTargetFBO();
+}
+
+// ============================================================================
+// Render Pass API
+// ============================================================================
+
+void renderPassInit(bool enabled) {
+    memset(&g_rp, 0, sizeof(RenderPassContext));
+    g_rp.initialized = true;
+    g_rp.enabled = enabled && !g_rpHeld;
+
+    velocityLogInfo("Render pass recorder initialized: %s", g_rp.enabled ? "deferred" : "immediate");
+}
+
+void renderPassShutdown(void) {
+    memset(&g_rp, 0, sizeof(RenderPassContext));
+}
+
+void renderPassSetEnabled(bool enabled) {
+    if (g_rpHeld) enabled = false;
+    if (g_rp.enabled && !enabled) renderPassFlush();
+    g_rp.enabled = enabled;
+}
+
+void renderPassHold(void) {
+    if (g_rpHeld) return;
+
+    velocityLogInfo("Render pass recorder: unwrapped framebuffer calls in use, binding immediately");
+    renderPassSetEnabled(false);
+    g_rpHeld = true;
+}
+
+bool renderPassIsEnabled(void) {
+    return g_rp.initialized && g_rp.enabled;
+}
+
+void renderPassBind(GLenum target, GLuint framebuffer) {
+    if (!g_rp.initialized) {
+        glBindFramebuffer(target, driverName(framebuffer));
+        return;
+    }
+
+    if (target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER) {
+        if (framebuffer != g_rp.draw) g_rp.frame.passesRecorded++;
+        g_rp.draw = framebuffer;
+    }
+    if (target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER) {
+        g_rp.read = framebuffer;
+    }
+
+    if (!g_rp.enabled) renderPassFlush();
+}
+
+void renderPassFlush(void) {
+    if (!g_rp.initialized) return;
+
+    GLuint draw = driverName(g_rp.draw);
+    GLuint read = driverName(g_rp.read);
+    bool drawChanged = !g_rp.driverKnown || draw != g_rp.driverDraw;
+    bool readChanged = !g_rp.driverKnown || read != g_rp.driverRead;
+    if (!drawChanged && !readChanged) return;
+
+    if (drawChanged) {
+        // Queued draws and discards belong to the pass that is ending
+        drawBatcherFlush();
+        fbInvalidateBindDraw(g_rp.draw);
+        gpuTimerBeginPass(g_rp.draw ? "framebuffer" : "default_framebuffer", g_rp.draw);
+        g_rp.frame.passesExecuted++;
+    }
+
+    if (drawChanged && readChanged && draw == read) {
+        glBindFramebuffer(GL_FRAMEBUFFER, draw);
+    } else {
+        if (drawChanged) glBindFramebuffer(GL_DRAW_FRAMEBUFFER, draw);
+        if (readChanged) glBindFramebuffer(GL_READ_FRAMEBUFFER, read);
+    }
+
+    g_rp.driverDraw = draw;
+    g_rp.driverRead = read;
+    g_rp.driverKnown = true;
+}
+
+bool renderPassDeferClear(GLbitfield mask) {
+    if (!g_rp.initialized) return false;
+
+    g_rp.frame.clearsRecorded++;
+    if (!g_rp.enabled) return false;
+
+    g_rp.pendingClear |= mask;
+    return true;
+}
+
+GLbitfield renderPassTakeClear(void) {
+    GLbitfield mask = g_rp.pendingClear;
+    g_rp.pendingClear = 0;
+    return mask;
+}
+
+void renderPassNoteClearIssued(void) {
+    g_rp.frame.clearsIssued++;
+}
+
+void renderPassInvalidate(void) {
+    g_rp.driverKnown = false;
+}
+
+void renderPassMarkBound(void) {
+    g_rp.driverDraw = driverName(g_rp.draw);
+    g_rp.driverRead = driverName(g_rp.read);
+    g_rp.driverKnown = true;
+}
+
+void renderPassForgetFramebuffers(GLsizei n, const GLuint* framebuffers) {
+    if (!g_rp.initialized || !framebuffers) return;
+
+    for (GLsizei i = 0; i < n; i++) {
+        GLuint framebuffer = framebuffers[i];
+        if (framebuffer == 0) continue;
+
+        if (g_rp.draw == framebuffer) g_rp.draw = 0;
+        if (g_rp.read == framebuffer) g_rp.read = 0;
+
+        // The driver reverts its own binding the same way
+        if (g_rp.driverDraw == framebuffer || g_rp.driverRead == framebuffer) {
+            g_rp.driverKnown = false;
+        }
+    }
+}
+
+void renderPassEndFrame(void) {
+    g_rp.lastFrame = g_rp.frame;
+    memset(&g_rp.frame, 0, sizeof(RenderPassCounters));
+
+    // The swap and the scaler bind framebuffers behind the recorder's back
+    g_rp.driverKnown = false;
+}
+
+void renderPassGetStats(RenderPassStats* stats) {
+    if (!stats) return;
+
+    memset(stats, 0, sizeof(RenderPassStats));
+    stats->enabled = g_rp.enabled;
+    stats->passesRecorded = g_rp.lastFrame.passesRecorded;
+    stats->passesExecuted = g_rp.lastFrame.passesExecuted;
+    stats->clearsRecorded = g_rp.lastFrame.clearsRecorded;
+    stats->clearsIssued = g_rp.lastFrame.clearsIssued;
+}
@@ -0,0 +1,120 @@
+/**
+ * Render Pass - Deferred framebuffer binds and clear merging
+ * Framebuffer binds are recorded and only reach the driver at the first
+ * draw, clear or framebuffer operation, so passes that never draw are
+ * dropped and rebinding the target that is still bound merges the passes.
+ * Consecutive clears are combined into one glClear at pass start. On
+ * tilers every extra pass costs a tile load and store.
+ */
+
+#ifndef RENDER_PASS_H
+#define RENDER_PASS_H
+
+#include <GLES3/gl32.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * Pass statistics (last finished frame)
+ */
+typedef struct RenderPassStats {
+    bool enabled;
+    uint32_t passesRecorded;     // Draw framebuffer changes made by the app
+    uint32_t passesExecuted;     // Draw framebuffer changes that reached the driver
+    uint32_t clearsRecorded;
+    uint32_t clearsIssued;
+} RenderPassStats;
+
+// ============================================================================
+// Render Pass API
+// ============================================================================
+
+/**
+ * Initialize the recorder
+ */
+void renderPassInit(bool enabled);
+
+/**
+ * Shutdown the recorder
+ */
+void renderPassShutdown(void);
+
+/**
+ * Enable/disable deferral (binds go straight to the driver when off)
+ */
+void renderPassSetEnabled(bool enabled);
+
+/**
+ * Stop deferring for the rest of the context: the app resolved a call that
+ * reads the bound framebuffer without going through the wrappers
+ */
+void renderPassHold(void);
+
+/**
+ * Check if binds are deferred
+ */
+bool renderPassIsEnabled(void);
+
+/**
+ * Record an app framebuffer bind (0 is the default framebuffer)
+ */
+void renderPassBind(GLenum target, GLuint framebuffer);
+
+/**
+ * Make the driver bindings match the app's
+ */
+void renderPassFlush(void);
+
+/**
+ * Record a clear, true if it was deferred (the driver binding is current)
+ */
+bool renderPassDeferClear(GLbitfield mask);
+
+/**
+ * Take the deferred clear mask, 0 if none
+ */
+GLbitfield renderPassTakeClear(void);
+
+/**
+ * Count a clear that reached the driver
+ */
+void renderPassNoteClearIssued(void);
+
+/**
+ * Forget the driver bindings (before the wrapper binds framebuffers itself)
+ */
+void renderPassInvalidate(void);
+
+/**
+ * The wrapper bound the app's framebuffers itself: take them as current
+ */
+void renderPassMarkBound(void);
+
+/**
+ * Deleted framebuffers revert their bindings to 0
+ */
+void renderPassForgetFramebuffers(GLsizei n, const GLuint* framebuffers);
+
+/**
+ * Publish this frame's counters (call at swap)
+ */
+void renderPassEndFrame(void);
+
+/**
+ * Get statistics
+ */
+void renderPassGetStats(RenderPassStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RENDER_PASS_H
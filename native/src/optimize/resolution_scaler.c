@@ -6,9 +6,14 @@
 #include "../utils/log.h"
 #include "../utils/memory.h"
 #include "../core/gl_wrapper.h"
+#include "../profile/trace.h"
+#include "../profile/gpu_timer.h"
+#include "damage_tracker.h"
+#include "rt_scaler.h"
 
 #include <string.h>
 #include <math.h>
+#include <time.h>
 
 // ============================================================================
 // Shader Sources
@@ -19,9 +24,10 @@ static const char* UPSCALE_VERTEX_SHADER =
     "layout(location = 0) in vec2 aPos;\n"
     "layout(location = 1) in vec2 aTexCoord;\n"
     "out vec2 vTexCoord;\n"
+    "uniform vec2 uUVScale;\n"
     "void main() {\n"
     "    gl_Position = vec4(aPos, 0.0, 1.0);\n"
-    "    vTexCoord = aTexCoord;\n"
+    "    vTexCoord = aTexCoord * uUVScale;\n"
     "}\n";
 
 static const char* UPSCALE_BILINEAR_FRAGMENT_SHADER = 
@@ -30,8 +36,9 @@ static const char* UPSCALE_BILINEAR_FRAGMENT_SHADER =
     "in vec2 vTexCoord;\n"
     "out vec4 fragColor;\n"
     "uniform sampler2D uTexture;\n"
+    "uniform vec2 uUVMax;\n"
     "void main() {\n"
-    "    fragColor = texture(uTexture, vTexCoord);\n"
+    "    fragColor = texture(uTexture, min(vTexCoord, uUVMax));\n"
     "}\n";
 
 static const char* SHARPEN_FRAGMENT_SHADER = 
@@ -60,20 +67,22 @@ static const char* CAS_FRAGMENT_SHADER =
     "out vec4 fragColor;\n"
     "uniform sampler2D uTexture;\n"
     "uniform vec2 uTexelSize;\n"
+    "uniform vec2 uUVMax;\n"
     "uniform float uSharpness;\n"
     "\n"
     "float luma(vec3 c) { return dot(c, vec3(0.299, 0.587, 0.114)); }\n"
     "\n"
+    "// Taps stay inside the rendered subrect of the render target\n"
+    "vec3 tap(vec2 offset) {\n"
+    "    return texture(uTexture, min(vTexCoord + offset * uTexelSize, uUVMax)).rgb;\n"
+    "}\n"
+    "\n"
     "void main() {\n"
-    "    vec3 a = texture(uTexture, vTexCoord + vec2(-uTexelSize.x, -uTexelSize.y)).rgb;\n"
-    "    vec3 b = texture(uTexture, vTexCoord + vec2(0.0, -uTexelSize.y)).rgb;\n"
-    "    vec3 c = texture(uTexture, vTexCoord + vec2(uTexelSize.x, -uTexelSize.y)).rgb;\n"
-    "    vec3 d = texture(uTexture, vTexCoord + vec2(-uTexelSize.x, 0.0)).rgb;\n"
-    "    vec3 e = texture(uTexture, vTexCoord).rgb;\n"
-    "    vec3 f = texture(uTexture, vTexCoord + vec2(uTexelSize.x, 0.0)).rgb;\n"
-    "    vec3 g = texture(uTexture, vTexCoord + vec2(-uTexelSize.x, uTexelSize.y)).rgb;\n"
-    "    vec3 h = texture(uTexture, vTexCoord + vec2(0.0, uTexelSize.y)).rgb;\n"
-    "    vec3 i = texture(uTexture, vTexCoord + vec2(uTexelSize.x, uTexelSize.y)).rgb;\n"
+    "    vec3 b = tap(vec2(0.0, -1.0));\n"
+    "    vec3 d = tap(vec2(-1.0, 0.0));\n"
+    "    vec3 e = tap(vec2(0.0, 0.0));\n"
+    "    vec3 f = tap(vec2(1.0, 0.0));\n"
+    "    vec3 h = tap(vec2(0.0, 1.0));\n"
     "\n"
     "    float mnL = min(min(min(luma(d), luma(e)), min(luma(f), luma(b))), luma(h));\n"
     "    float mxL = max(max(max(luma(d), luma(e)), max(luma(f), luma(b))), luma(h));\n"
@@ -89,6 +98,189 @@ static const char* CAS_FRAGMENT_SHADER =
     "    fragColor = vec4(result, 1.0);\n"
     "}\n";
 
+// FSR1-style edge-adaptive spatial upsampling. 12 texelFetch taps around
+// the output pixel's source position replace textureGather so it runs on
+// GLES 3.0; taps are clamped to the rendered subrect. Pixel positions stay
+// highp, filter math is mediump.
+static const char* EASU_FRAGMENT_SHADER = 
+    "#version 300 es\n"
+    "precision mediump float;\n"
+    "precision highp int;\n"
+    "out vec4 fragColor;\n"
+    "uniform mediump sampler2D uTexture;\n"
+    "layout(std140) uniform FsrConstants {\n"
+    "    highp vec4 uEasuScale;\n"
+    "    highp vec4 uInputMax;\n"
+    "    mediump vec4 uRcas;\n"
+    "};\n"
+    "\n"
+    "ivec2 gBase;\n"
+    "ivec2 gMax;\n"
+    "\n"
+    "vec3 fetch(int x, int y) {\n"
+    "    return texelFetch(uTexture, clamp(gBase + ivec2(x, y), ivec2(0), gMax), 0).rgb;\n"
+    "}\n"
+    "\n"
+    "float luma(vec3 c) { return c.b * 0.5 + (c.r * 0.5 + c.g); }\n"
+    "\n"
+    "// Gradient direction and edge length from one bilinear quadrant\n"
+    "void easuSet(inout vec2 dir, inout float len, float w,\n"
+    "             float lA, float lB, float lC, float lD, float lE) {\n"
+    "    float lenX = max(abs(lD - lC), abs(lC - lB));\n"
+    "    float dirX = lD - lB;\n"
+    "    dir.x += dirX * w;\n"
+    "    lenX = clamp(abs(dirX) / max(lenX, 1.0 / 4096.0), 0.0, 1.0);\n"
+    "    len += lenX * lenX * w;\n"
+    "\n"
+    "    float lenY = max(abs(lE - lC), abs(lC - lA));\n"
+    "    float dirY = lE - lA;\n"
+    "    dir.y += dirY * w;\n"
+    "    lenY = clamp(abs(dirY) / max(lenY, 1.0 / 4096.0), 0.0, 1.0);\n"
+    "    len += lenY * lenY * w;\n"
+    "}\n"
+    "\n"
+    "// Lanczos-2 approximation stretched along the edge\n"
+    "void easuTap(inout vec3 aC, inout float aW, vec2 off, vec2 dir,\n"
+    "             vec2 len2, float lob, float clp, vec3 c) {\n"
+    "    vec2 v = vec2(dot(off, dir), dot(off, vec2(-dir.y, dir.x))) * len2;\n"
+    "    float d2 = min(dot(v, v), clp);\n"
+    "    float wB = 0.4 * d2 - 1.0;\n"
+    "    float wA = lob * d2 - 1.0;\n"
+    "    wB *= wB;\n"
+    "    wA *= wA;\n"
+    "    float w = (1.5625 * wB - 0.5625) * wA;\n"
+    "    aW += w;\n"
+    "    aC += c * w;\n"
+    "}\n"
+    "\n"
+    "void main() {\n"
+    "    highp vec2 pp = floor(gl_FragCoord.xy) * uEasuScale.xy + uEasuScale.zw;\n"
+    "    highp vec2 fp = floor(pp);\n"
+    "    vec2 f = vec2(pp - fp);\n"
+    "    gBase = ivec2(fp);\n"
+    "    gMax = ivec2(uInputMax.xy);\n"
+    "\n"
+    "    //    b c\n"
+    "    //  e f g h\n"
+    "    //  i j k l\n"
+    "    //    n o\n"
+    "    vec3 bC = fetch(0, -1); vec3 cC = fetch(1, -1);\n"
+    "    vec3 eC = fetch(-1, 0); vec3 fC = fetch(0, 0); vec3 gC = fetch(1, 0); vec3 hC = fetch(2, 0);\n"
+    "    vec3 iC = fetch(-1, 1); vec3 jC = fetch(0, 1); vec3 kC = fetch(1, 1); vec3 lC = fetch(2, 1);\n"
+    "    vec3 nC = fetch(0, 2); vec3 oC = fetch(1, 2);\n"
+    "\n"
+    "    float bL = luma(bC); float cL = luma(cC);\n"
+    "    float eL = luma(eC); float fL = luma(fC); float gL = luma(gC); float hL = luma(hC);\n"
+    "    float iL = luma(iC); float jL = luma(jC); float kL = luma(kC); float lL = luma(lC);\n"
+    "    float nL = luma(nC); float oL = luma(oC);\n"
+    "\n"
+    "    vec2 dir = vec2(0.0);\n"
+    "    float len = 0.0;\n"
+    "    easuSet(dir, len, (1.0 - f.x) * (1.0 - f.y), bL, eL, fL, gL, jL);\n"
+    "    easuSet(dir, len, f.x * (1.0 - f.y), cL, fL, gL, hL, kL);\n"
+    "    easuSet(dir, len, (1.0 - f.x) * f.y, fL, iL, jL, kL, nL);\n"
+    "    easuSet(dir, len, f.x * f.y, gL, jL, kL, lL, oL);\n"
+    "\n"
+    "    // Flat areas get an arbitrary direction (1/16384 is mediump's smallest normal)\n"
+    "    float dirR = dot(dir, dir);\n"
+    "    bool zro = dirR < 1.0 / 16384.0;\n"
+    "    dirR = zro ? 1.0 : inversesqrt(dirR);\n"
+    "    dir.x = zro ? 1.0 : dir.x;\n"
+    "    dir *= dirR;\n"
+    "\n"
+    "    len = len * 0.5;\n"
+    "    len *= len;\n"
+    "    float stretch = dot(dir, dir) / max(abs(dir.x), abs(dir.y));\n"
+    "    vec2 len2 = vec2(1.0 + (stretch - 1.0) * len, 1.0 - 0.5 * len);\n"
+    "    float lob = 0.5 - 0.29 * len;\n"
+    "    float clp = 1.0 / lob;\n"
+    "\n"
+    "    vec3 aC = vec3(0.0);\n"
+    "    float aW = 0.0;\n"
+    "    easuTap(aC, aW, vec2( 0.0, -1.0) - f, dir, len2, lob, clp, bC);\n"
+    "    easuTap(aC, aW, vec2( 1.0, -1.0) - f, dir, len2, lob, clp, cC);\n"
+    "    easuTap(aC, aW, vec2(-1.0,  1.0) - f, dir, len2, lob, clp, iC);\n"
+    "    easuTap(aC, aW, vec2( 0.0,  1.0) - f, dir, len2, lob, clp, jC);\n"
+    "    easuTap(aC, aW, vec2( 0.0,  0.0) - f, dir, len2, lob, clp, fC);\n"
+    "    easuTap(aC, aW, vec2(-1.0,  0.0) - f, dir, len2, lob, clp, eC);\n"
+    "    easuTap(aC, aW, vec2( 1.0,  1.0) - f, dir, len2, lob, clp, kC);\n"
+    "    easuTap(aC, aW, vec2( 2.0,  1.0) - f, dir, len2, lob, clp, lC);\n"
+    "    easuTap(aC, aW, vec2( 2.0,  0.0) - f, dir, len2, lob, clp, hC);\n"
+    "    easuTap(aC, aW, vec2( 1.0,  0.0) - f, dir, len2, lob, clp, gC);\n"
+    "    easuTap(aC, aW, vec2( 1.0,  2.0) - f, dir, len2, lob, clp, oC);\n"
+    "    easuTap(aC, aW, vec2( 0.0,  2.0) - f, dir, len2, lob, clp, nC);\n"
+    "\n"
+    "    // Deringing: stay inside the 2x2 neighbourhood\n"
+    "    vec3 mn4 = min(min(fC, gC), min(jC, kC));\n"
+    "    vec3 mx4 = max(max(fC, gC), max(jC, kC));\n"
+    "    fragColor = vec4(min(mx4, max(mn4, aC / aW)), 1.0);\n"
+    "}\n";
+
+// FSR1-style robust contrast-adaptive sharpening at output resolution.
+// The lobe is limited so no channel can clip, and isolated spikes are
+// sharpened less (noise detection).
+static const char* RCAS_FRAGMENT_SHADER = 
+    "#version 300 es\n"
+    "precision mediump float;\n"
+    "precision highp int;\n"
+    "out vec4 fragColor;\n"
+    "uniform mediump sampler2D uTexture;\n"
+    "layout(std140) uniform FsrConstants {\n"
+    "    highp vec4 uEasuScale;\n"
+    "    highp vec4 uInputMax;\n"
+    "    mediump vec4 uRcas;\n"
+    "};\n"
+    "\n"
+    "float luma(vec3 c) { return c.b * 0.5 + (c.r * 0.5 + c.g); }\n"
+    "\n"
+    "void main() {\n"
+    "    ivec2 p = ivec2(gl_FragCoord.xy);\n"
+    "    ivec2 pMax = textureSize(uTexture, 0) - 1;\n"
+    "    vec3 b = texelFetch(uTexture, clamp(p + ivec2(0, -1), ivec2(0), pMax), 0).rgb;\n"
+    "    vec3 d = texelFetch(uTexture, clamp(p + ivec2(-1, 0), ivec2(0), pMax), 0).rgb;\n"
+    "    vec3 e = texelFetch(uTexture, p, 0).rgb;\n"
+    "    vec3 f = texelFetch(uTexture, clamp(p + ivec2(1, 0), ivec2(0), pMax), 0).rgb;\n"
+    "    vec3 h = texelFetch(uTexture, clamp(p + ivec2(0, 1), ivec2(0), pMax), 0).rgb;\n"
+    "\n"
+    "    float bL = luma(b); float dL = luma(d); float eL = luma(e);\n"
+    "    float fL = luma(f); float hL = luma(h);\n"
+    "\n"
+    "    float nz = 0.25 * (bL + dL + fL + hL) - eL;\n"
+    "    float range = max(max(max(bL, dL), max(fL, hL)), eL) -\n"
+    "                  min(min(min(bL, dL), min(fL, hL)), eL);\n"
+    "    nz = clamp(abs(nz) / max(range, 1.0 / 4096.0), 0.0, 1.0);\n"
+    "    nz = 1.0 - 0.5 * nz;\n"
+    "\n"
+    "    vec3 mn4 = min(min(b, d), min(f, h));\n"
+    "    vec3 mx4 = max(max(b, d), max(f, h));\n"
+    "    vec3 hitMin = min(mn4, e) / max(4.0 * mx4, vec3(1.0 / 4096.0));\n"
+    "    vec3 hitMax = (1.0 - max(mx4, e)) / min(4.0 * mn4 - 4.0, vec3(-1.0 / 4096.0));\n"
+    "    vec3 lobeRGB = max(-hitMin, hitMax);\n"
+    "    float lobe = max(-0.1875, min(max(max(lobeRGB.r, lobeRGB.g), lobeRGB.b), 0.0));\n"
+    "    lobe *= uRcas.x * nz;\n"
+    "\n"
+    "    fragColor = vec4((lobe * (b + d + f + h) + e) / (4.0 * lobe + 1.0), 1.0);\n"
+    "}\n";
+
+// Benchmark pattern: hard edges at an angle next to concentric rings over
+// a gradient, a function of normalized position so any resolution renders
+// the same image
+static const char* PATTERN_FRAGMENT_SHADER = 
+    "#version 300 es\n"
+    "precision highp float;\n"
+    "out vec4 fragColor;\n"
+    "uniform vec2 uResolution;\n"
+    "void main() {\n"
+    "    vec2 uv = gl_FragCoord.xy / uResolution;\n"
+    "    vec2 p = (uv - 0.5) * vec2(uResolution.x / uResolution.y, 1.0);\n"
+    "    vec2 r = mat2(0.955, -0.296, 0.296, 0.955) * p;\n"
+    "    float checker = mod(floor(r.x * 12.0) + floor(r.y * 12.0), 2.0);\n"
+    "    float rings = step(0.5, fract(length(p) * 24.0));\n"
+    "    float v = uv.x < 0.5 ? checker : rings;\n"
+    "    vec3 tint = vec3(1.0, 1.0 - 0.3 * uv.y, 0.8 + 0.2 * uv.x);\n"
+    "    fragColor = vec4(mix(vec3(0.1, 0.15, 0.2), vec3(0.9, 0.85, 0.7), v) * tint, 1.0);\n"
+    "}\n";
+
 // ============================================================================
 // Global State
 // ============================================================================
@@ -163,14 +355,35 @@ static GLuint createProgram(const char* vertSrc, const char* fragSrc) {
     return program;
 }
 
+static inline GLenum sceneColorFormat(void) {
+    return g_scaler->config.colorFormat ? g_scaler->config.colorFormat : GL_RGBA8;
+}
+
+static inline GLenum sceneDepthFormat(void) {
+    return g_scaler->config.depthFormat ? g_scaler->config.depthFormat : GL_DEPTH24_STENCIL8;
+}
+
+static inline bool formatHasStencil(GLenum format) {
+    return format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8;
+}
+
+static inline bool formatHasAlpha(GLenum format) {
+    return format != GL_RGB565 && format != GL_RGB8 && format != GL_R11F_G11F_B10F;
+}
+
 static void createFramebuffers(void) {
     if (!g_scaler) return;
     
-    // Delete existing
+    GLenum colorFormat = sceneColorFormat();
+    GLenum depthFormat = sceneDepthFormat();
+    g_scaler->formatsChanged = false;
+    damageTrackerAddFull();
+    
+    // Release existing: a resize back (rotation, format fallback) reuses them
     if (g_scaler->renderFBO) {
         glDeleteFramebuffers(1, &g_scaler->renderFBO);
-        glDeleteTextures(1, &g_scaler->renderColorTex);
-        glDeleteTextures(1, &g_scaler->renderDepthTex);
+        storagePoolRelease(g_scaler->renderColorTex, &g_scaler->renderColorKey);
+        storagePoolRelease(g_scaler->renderDepthRB, &g_scaler->renderDepthKey);
     }
     
     // Create render FBO
@@ -178,9 +391,14 @@ static void createFramebuffers(void) {
     glBindFramebuffer(GL_FRAMEBUFFER, g_scaler->renderFBO);
     
     // Color texture
-    glGenTextures(1, &g_scaler->renderColorTex);
-    glBindTexture(GL_TEXTURE_2D, g_scaler->renderColorTex);
-    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, g_scaler->renderWidth, g_scaler->renderHeight);
+    g_scaler->renderColorKey = storageKeyTexture(GL_TEXTURE_2D, 1, colorFormat,
+                                                 g_scaler->allocWidth, g_scaler->allocHeight, 1);
+    g_scaler->renderColorTex = storagePoolAcquire(&g_scaler->renderColorKey);
+    if (!g_scaler->renderColorTex) {
+        glGenTextures(1, &g_scaler->renderColorTex);
+        glBindTexture(GL_TEXTURE_2D, g_scaler->renderColorTex);
+        glTexStorage2D(GL_TEXTURE_2D, 1, colorFormat, g_scaler->allocWidth, g_scaler->allocHeight);
+    }
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -188,31 +406,46 @@ static void createFramebuffers(void) {
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 
                            g_scaler->renderColorTex, 0);
     
-    // Depth texture
-    glGenTextures(1, &g_scaler->renderDepthTex);
-    glBindTexture(GL_TEXTURE_2D, g_scaler->renderDepthTex);
-    glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH24_STENCIL8, 
-                   g_scaler->renderWidth, g_scaler->renderHeight);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D,
-                           g_scaler->renderDepthTex, 0);
+    // Depth renderbuffer: never sampled and discarded every frame, so
+    // tilers can keep it on chip
+    g_scaler->renderDepthKey = storageKeyRenderbuffer(0, depthFormat,
+                                                      g_scaler->allocWidth, g_scaler->allocHeight);
+    g_scaler->renderDepthRB = storagePoolAcquire(&g_scaler->renderDepthKey);
+    if (!g_scaler->renderDepthRB) {
+        glGenRenderbuffers(1, &g_scaler->renderDepthRB);
+        glBindRenderbuffer(GL_RENDERBUFFER, g_scaler->renderDepthRB);
+        glRenderbufferStorage(GL_RENDERBUFFER, depthFormat, 
+                              g_scaler->allocWidth, g_scaler->allocHeight);
+    }
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, 
+                              formatHasStencil(depthFormat) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT,
+                              GL_RENDERBUFFER, g_scaler->renderDepthRB);
     
     GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
     if (status != GL_FRAMEBUFFER_COMPLETE) {
+        if (g_scaler->config.colorFormat || g_scaler->config.depthFormat) {
+            velocityLogWarn("Render framebuffer incomplete with 0x%x/0x%x, using RGBA8/D24S8",
+                            colorFormat, depthFormat);
+            g_scaler->config.colorFormat = 0;
+            g_scaler->config.depthFormat = 0;
+            createFramebuffers();
+            return;
+        }
         velocityLogError("Render framebuffer incomplete: 0x%x", status);
     }
     
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
     glBindTexture(GL_TEXTURE_2D, 0);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
     
-    velocityLogInfo("Created render FBO: %dx%d (scale: %.2f)", 
-                    g_scaler->renderWidth, g_scaler->renderHeight, g_scaler->currentScale);
+    velocityLogInfo("Created render FBO: %dx%d, color 0x%x, depth 0x%x (max scale: %.2f)", 
+                    g_scaler->allocWidth, g_scaler->allocHeight, colorFormat, depthFormat,
+                    (float)g_scaler->allocWidth / g_scaler->nativeWidth);
 }
 
-static void updateRenderSize(void) {
-    if (!g_scaler) return;
-    
-    int newWidth = (int)(g_scaler->nativeWidth * g_scaler->currentScale);
-    int newHeight = (int)(g_scaler->nativeHeight * g_scaler->currentScale);
+static void computeSize(float scale, int* width, int* height) {
+    int newWidth = (int)(g_scaler->nativeWidth * scale);
+    int newHeight = (int)(g_scaler->nativeHeight * scale);
     
     // Ensure even dimensions
     newWidth = (newWidth + 1) & ~1;
@@ -224,12 +457,269 @@ static void updateRenderSize(void) {
     if (newWidth > g_scaler->nativeWidth * 2) newWidth = g_scaler->nativeWidth * 2;
     if (newHeight > g_scaler->nativeHeight * 2) newHeight = g_scaler->nativeHeight * 2;
     
-    if (newWidth != g_scaler->renderWidth || newHeight != g_scaler->renderHeight) {
-        g_scaler->renderWidth = newWidth;
-        g_scaler->renderHeight = newHeight;
-        createFramebuffers();
-        g_scaler->scaleChanges++;
+    *width = newWidth;
+    *height = newHeight;
+}
+
+static inline float quantizeScale(float scale) {
+    return roundf(scale / SCALER_SCALE_STEP) * SCALER_SCALE_STEP;
+}
+
+/**
+ * (Re)allocate the render target for the largest scale it has to hold.
+ * Only native resizes and explicit scales above the maximum get here;
+ * adaptive scaling just moves the subrect.
+ */
+static void allocateRenderTarget(float maxScale) {
+    computeSize(maxScale, &g_scaler->allocWidth, &g_scaler->allocHeight);
+    createFramebuffers();
+}
+
+static bool updateRenderSize(void) {
+    if (!g_scaler) return false;
+    
+    int newWidth, newHeight;
+    computeSize(g_scaler->currentScale, &newWidth, &newHeight);
+    
+    if (newWidth > g_scaler->allocWidth) newWidth = g_scaler->allocWidth;
+    if (newHeight > g_scaler->allocHeight) newHeight = g_scaler->allocHeight;
+    
+    if (newWidth == g_scaler->renderWidth && newHeight == g_scaler->renderHeight) {
+        return false;
+    }
+    
+    g_scaler->renderWidth = newWidth;
+    g_scaler->renderHeight = newHeight;
+    
+    // Undamaged parts of the target hold the old layout
+    damageTrackerAddFull();
+    return true;
+}
+
+/**
+ * Native-size target for EASU output when RCAS runs as a second pass
+ */
+static bool ensureUpscaleTarget(void) {
+    if (g_scaler->upscaleFBO &&
+        g_scaler->upscaleWidth == g_scaler->nativeWidth &&
+        g_scaler->upscaleHeight == g_scaler->nativeHeight) {
+        return true;
+    }
+    
+    if (g_scaler->upscaleFBO) {
+        glDeleteFramebuffers(1, &g_scaler->upscaleFBO);
+        storagePoolRelease(g_scaler->upscaleColorTex, &g_scaler->upscaleColorKey);
+        g_scaler->upscaleFBO = 0;
+        g_scaler->upscaleColorTex = 0;
+    }
+    
+    // RCAS reads past a repaired region: fill the new target completely
+    glDisable(GL_SCISSOR_TEST);
+    
+    g_scaler->upscaleColorKey = storageKeyTexture(GL_TEXTURE_2D, 1, sceneColorFormat(),
+                                                  g_scaler->nativeWidth, g_scaler->nativeHeight, 1);
+    g_scaler->upscaleColorTex = storagePoolAcquire(&g_scaler->upscaleColorKey);
+    if (!g_scaler->upscaleColorTex) {
+        glGenTextures(1, &g_scaler->upscaleColorTex);
+        glBindTexture(GL_TEXTURE_2D, g_scaler->upscaleColorTex);
+        glTexStorage2D(GL_TEXTURE_2D, 1, sceneColorFormat(), g_scaler->nativeWidth, g_scaler->nativeHeight);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    
+    glGenFramebuffers(1, &g_scaler->upscaleFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, g_scaler->upscaleFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                           g_scaler->upscaleColorTex, 0);
+    
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        velocityLogWarn("EASU framebuffer incomplete: 0x%x, sharpening skipped", status);
+        glDeleteFramebuffers(1, &g_scaler->upscaleFBO);
+        glDeleteTextures(1, &g_scaler->upscaleColorTex);
+        g_scaler->upscaleFBO = 0;
+        g_scaler->upscaleColorTex = 0;
+        return false;
+    }
+    
+    g_scaler->upscaleWidth = g_scaler->nativeWidth;
+    g_scaler->upscaleHeight = g_scaler->nativeHeight;
+    return true;
+}
+
+/**
+ * Refresh the FSR uniform block; only uploads when scale, size or
+ * sharpness changed
+ */
+static void updateFsrConstants(void) {
+    ScalerFsrConstants constants;
+    memset(&constants, 0, sizeof(constants));
+    
+    float scaleX = (float)g_scaler->renderWidth / g_scaler->nativeWidth;
+    float scaleY = (float)g_scaler->renderHeight / g_scaler->nativeHeight;
+    constants.easuScale[0] = scaleX;
+    constants.easuScale[1] = scaleY;
+    constants.easuScale[2] = 0.5f * scaleX - 0.5f;
+    constants.easuScale[3] = 0.5f * scaleY - 0.5f;
+    constants.inputMax[0] = (float)(g_scaler->renderWidth - 1);
+    constants.inputMax[1] = (float)(g_scaler->renderHeight - 1);
+    
+    // sharpenAmount 1 is full RCAS strength, each stop below halves it
+    float amount = g_scaler->config.sharpenAmount;
+    if (amount < 0.0f) amount = 0.0f;
+    if (amount > 1.0f) amount = 1.0f;
+    constants.rcas[0] = exp2f(-SCALER_RCAS_MAX_STOPS * (1.0f - amount));
+    
+    if (memcmp(&constants, &g_scaler->fsrConstants, sizeof(constants)) == 0) return;
+    
+    g_scaler->fsrConstants = constants;
+    glBindBuffer(GL_UNIFORM_BUFFER, g_scaler->fsrUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(constants), &constants);
+}
+
+static bool useFsr(UpscaleMethod method) {
+    // EASU only reconstructs; at or above native size bilinear is enough
+    return method == UPSCALE_FSR && g_scaler->fsrProgram && g_scaler->fsrUBO &&
+           (g_scaler->renderWidth < g_scaler->nativeWidth ||
+            g_scaler->renderHeight < g_scaler->nativeHeight);
+}
+
+/**
+ * repair is the scissored output box of a partial upscale, NULL for a
+ * full one
+ */
+static void drawFsr(GLuint targetFBO, bool timed, const GLint* repair) {
+    bool rcas = g_scaler->config.sharpening && g_scaler->rcasProgram && ensureUpscaleTarget();
+    GLuint binding = g_scaler->fsrBinding;
+    
+    // Keep whatever the app had bound at the block's binding point
+    GLint prevBuffer = 0;
+    GLint64 prevStart = 0, prevSize = 0;
+    glGetIntegeri_v(GL_UNIFORM_BUFFER_BINDING, binding, &prevBuffer);
+    if (prevBuffer) {
+        glGetInteger64i_v(GL_UNIFORM_BUFFER_START, binding, &prevStart);
+        glGetInteger64i_v(GL_UNIFORM_BUFFER_SIZE, binding, &prevSize);
+    }
+    
+    updateFsrConstants();
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, g_scaler->fsrUBO);
+    
+    // EASU, straight to the target unless RCAS follows
+    GLuint easuTarget = rcas ? g_scaler->upscaleFBO : targetFBO;
+    if (timed) gpuTimerBeginPass(rcas ? "scaler_easu" : "scaler_upscale", easuTarget);
+    glBindFramebuffer(GL_FRAMEBUFFER, easuTarget);
+    if (rcas && !repair) {
+        // Fully overwritten: skip loading last frame's tiles
+        const GLenum attachment = GL_COLOR_ATTACHMENT0;
+        glInvalidateFramebuffer(GL_FRAMEBUFFER, 1, &attachment);
+    } else if (rcas) {
+        // RCAS taps one texel around each output pixel: EASU fills that
+        // ring too, and the rest of the target keeps last frame's texels
+        int x0 = repair[0] > 1 ? repair[0] - 1 : 0;
+        int y0 = repair[1] > 1 ? repair[1] - 1 : 0;
+        int x1 = repair[0] + repair[2] + 1;
+        int y1 = repair[1] + repair[3] + 1;
+        if (x1 > g_scaler->nativeWidth) x1 = g_scaler->nativeWidth;
+        if (y1 > g_scaler->nativeHeight) y1 = g_scaler->nativeHeight;
+        glScissor(x0, y0, x1 - x0, y1 - y0);
+    }
+    glViewport(0, 0, g_scaler->nativeWidth, g_scaler->nativeHeight);
+    glBindTexture(GL_TEXTURE_2D, g_scaler->renderColorTex);
+    glUseProgram(g_scaler->fsrProgram);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    
+    if (rcas) {
+        if (timed) gpuTimerBeginPass("scaler_rcas", targetFBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
+        if (repair) glScissor(repair[0], repair[1], repair[2], repair[3]);
+        glBindTexture(GL_TEXTURE_2D, g_scaler->upscaleColorTex);
+        glUseProgram(g_scaler->rcasProgram);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+    }
+    
+    if (prevBuffer && prevSize > 0) {
+        glBindBufferRange(GL_UNIFORM_BUFFER, binding, prevBuffer, (GLintptr)prevStart, (GLsizeiptr)prevSize);
+    } else {
+        glBindBufferBase(GL_UNIFORM_BUFFER, binding, prevBuffer);
+    }
+    
+    // Indexed binds also replace the generic binding
+    GLuint generic = g_wrapperCtx ? g_wrapperCtx->state.buffers.uniformBuffer : 0;
+    glBindBuffer(GL_UNIFORM_BUFFER, generic == 0xFFFFFFFF ? 0 : generic);
+}
+
+static void drawBilinear(GLuint targetFBO, bool timed) {
+    if (timed) gpuTimerBeginPass("scaler_upscale", targetFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
+    glViewport(0, 0, g_scaler->nativeWidth, g_scaler->nativeHeight);
+    
+    // Sample only the rendered subrect, clamped half a texel inside it
+    float uvScaleX = (float)g_scaler->renderWidth / g_scaler->allocWidth;
+    float uvScaleY = (float)g_scaler->renderHeight / g_scaler->allocHeight;
+    float uvMaxX = (g_scaler->renderWidth - 0.5f) / g_scaler->allocWidth;
+    float uvMaxY = (g_scaler->renderHeight - 0.5f) / g_scaler->allocHeight;
+    
+    // Use upscale shader
+    if (g_scaler->config.sharpening && g_scaler->sharpenProgram && !g_scaler->held) {
+        glUseProgram(g_scaler->sharpenProgram);
+        glUniform2f(g_scaler->sharpenUVScaleLoc, uvScaleX, uvScaleY);
+        glUniform2f(g_scaler->sharpenUVMaxLoc, uvMaxX, uvMaxY);
+        glUniform2f(g_scaler->sharpenTexelSizeLoc, 
+                    1.0f / g_scaler->allocWidth, 1.0f / g_scaler->allocHeight);
+        glUniform1f(g_scaler->sharpenAmountLoc, g_scaler->config.sharpenAmount);
+    } else {
+        glUseProgram(g_scaler->upscaleProgram);
+        glUniform2f(g_scaler->upscaleUVScaleLoc, uvScaleX, uvScaleY);
+        glUniform2f(g_scaler->upscaleUVMaxLoc, uvMaxX, uvMaxY);
     }
+    
+    // Bind render texture
+    glBindTexture(GL_TEXTURE_2D, g_scaler->renderColorTex);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+}
+
+/**
+ * The scene's depth/stencil is dead once it is upscaled: skip the writeback
+ */
+static void discardSceneDepth(void) {
+    static const GLenum ATTACHMENTS[] = { GL_DEPTH_ATTACHMENT, GL_STENCIL_ATTACHMENT };
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, g_scaler->renderFBO);
+    glInvalidateFramebuffer(GL_DRAW_FRAMEBUFFER, 2, ATTACHMENTS);
+}
+
+/**
+ * Held at native scale the upscale is a 1:1 copy: skip EASU/RCAS and CAS
+ */
+static inline UpscaleMethod activeMethod(void) {
+    return g_scaler->held ? UPSCALE_BILINEAR : g_scaler->config.upscaleMethod;
+}
+
+/**
+ * Upscale the render subrect to native size into targetFBO, only within
+ * the scissored repair box when one is given
+ */
+static void drawUpscale(GLuint targetFBO, UpscaleMethod method, bool timed, const GLint* repair) {
+    // Disable depth testing for upscale pass
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    
+    glActiveTexture(GL_TEXTURE0);
+    glBindVertexArray(g_quadVAO);
+    
+    if (useFsr(method)) {
+        drawFsr(targetFBO, timed, repair);
+    } else {
+        drawBilinear(targetFBO, timed);
+    }
+    
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+    
+    // Re-enable depth test
+    glEnable(GL_DEPTH_TEST);
 }
 
 // ============================================================================
@@ -266,9 +756,8 @@ bool resolutionScalerInit(int nativeWidth, int nativeHeight, const ScalerConfig*
     
     g_scaler->nativeWidth = nativeWidth;
     g_scaler->nativeHeight = nativeHeight;
-    g_scaler->currentScale = g_scaler->config.maxScale;
-    g_scaler->renderWidth = (int)(nativeWidth * g_scaler->currentScale);
-    g_scaler->renderHeight = (int)(nativeHeight * g_scaler->currentScale);
+    g_scaler->currentScale = quantizeScale(g_scaler->config.maxScale);
+    g_scaler->desiredScale = g_scaler->currentScale;
     g_scaler->targetFrameTime = 1000.0f / g_scaler->config.targetFPS;
     
     // Create fullscreen quad
@@ -297,8 +786,54 @@ bool resolutionScalerInit(int nativeWidth, int nativeHeight, const ScalerConfig*
         return false;
     }
     
-    // Create framebuffers
-    createFramebuffers();
+    // Cache uniform locations
+    glUseProgram(g_scaler->upscaleProgram);
+    glUniform1i(glGetUniformLocation(g_scaler->upscaleProgram, "uTexture"), 0);
+    g_scaler->upscaleUVScaleLoc = glGetUniformLocation(g_scaler->upscaleProgram, "uUVScale");
+    g_scaler->upscaleUVMaxLoc = glGetUniformLocation(g_scaler->upscaleProgram, "uUVMax");
+    
+    if (g_scaler->sharpenProgram) {
+        glUseProgram(g_scaler->sharpenProgram);
+        glUniform1i(glGetUniformLocation(g_scaler->sharpenProgram, "uTexture"), 0);
+        g_scaler->sharpenUVScaleLoc = glGetUniformLocation(g_scaler->sharpenProgram, "uUVScale");
+        g_scaler->sharpenUVMaxLoc = glGetUniformLocation(g_scaler->sharpenProgram, "uUVMax");
+        g_scaler->sharpenTexelSizeLoc = glGetUniformLocation(g_scaler->sharpenProgram, "uTexelSize");
+        g_scaler->sharpenAmountLoc = glGetUniformLocation(g_scaler->sharpenProgram, "uSharpness");
+    }
+    glUseProgram(0);
+    
+    // FSR: EASU + RCAS share one constant block on the last binding point
+    g_scaler->fsrProgram = createProgram(UPSCALE_VERTEX_SHADER, EASU_FRAGMENT_SHADER);
+    g_scaler->rcasProgram = createProgram(UPSCALE_VERTEX_SHADER, RCAS_FRAGMENT_SHADER);
+    
+    if (g_scaler->fsrProgram) {
+        GLint maxBindings = 0;
+        glGetIntegerv(GL_MAX_UNIFORM_BUFFER_BINDINGS, &maxBindings);
+        g_scaler->fsrBinding = maxBindings > 0 ? (GLuint)(maxBindings - 1) : 0;
+        
+        GLuint programs[2] = { g_scaler->fsrProgram, g_scaler->rcasProgram };
+        for (int i = 0; i < 2; i++) {
+            if (!programs[i]) continue;
+            glUseProgram(programs[i]);
+            glUniform1i(glGetUniformLocation(programs[i], "uTexture"), 0);
+            GLuint block = glGetUniformBlockIndex(programs[i], "FsrConstants");
+            if (block != GL_INVALID_INDEX) {
+                glUniformBlockBinding(programs[i], block, g_scaler->fsrBinding);
+            }
+        }
+        glUseProgram(0);
+        
+        glGenBuffers(1, &g_scaler->fsrUBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, g_scaler->fsrUBO);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(ScalerFsrConstants), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    } else {
+        velocityLogWarn("FSR upscaler unavailable, using bilinear");
+    }
+    
+    // Allocate once for the maximum scale, then render into a subrect
+    allocateRenderTarget(g_scaler->config.maxScale);
+    updateRenderSize();
     
     g_scaler->initialized = true;
     
@@ -314,9 +849,16 @@ void resolutionScalerShutdown(void) {
     
     glDeleteFramebuffers(1, &g_scaler->renderFBO);
     glDeleteTextures(1, &g_scaler->renderColorTex);
-    glDeleteTextures(1, &g_scaler->renderDepthTex);
+    glDeleteRenderbuffers(1, &g_scaler->renderDepthRB);
+    glDeleteFramebuffers(1, &g_scaler->upscaleFBO);
+    glDeleteTextures(1, &g_scaler->upscaleColorTex);
+    glDeleteFramebuffers(1, &g_scaler->readFBO);
+    glDeleteRenderbuffers(1, &g_scaler->readRB);
     glDeleteProgram(g_scaler->upscaleProgram);
     glDeleteProgram(g_scaler->sharpenProgram);
+    glDeleteProgram(g_scaler->fsrProgram);
+    glDeleteProgram(g_scaler->rcasProgram);
+    glDeleteBuffers(1, &g_scaler->fsrUBO);
     
     glDeleteVertexArrays(1, &g_quadVAO);
     glDeleteBuffers(1, &g_quadVBO);
@@ -338,7 +880,12 @@ void resolutionScalerBeginFrame(int* outWidth, int* outHeight) {
         return;
     }
     
+    TRACE_SCOPE("scaler_begin");
+    
+    if (g_scaler->formatsChanged) createFramebuffers();
+    
     // Bind render FBO
+    gpuTimerBeginPass("scaler_render", g_scaler->renderFBO);
     glBindFramebuffer(GL_FRAMEBUFFER, g_scaler->renderFBO);
     glViewport(0, 0, g_scaler->renderWidth, g_scaler->renderHeight);
     
@@ -347,80 +894,217 @@ void resolutionScalerBeginFrame(int* outWidth, int* outHeight) {
 }
 
 void resolutionScalerEndFrame(void) {
-    if (!g_scaler || !g_scaler->config.enabled) return;
+    if (!g_scaler) return;
     
-    // Bind default framebuffer
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glViewport(0, 0, g_scaler->nativeWidth, g_scaler->nativeHeight);
+    // Resolved early for native UI: the backbuffer already holds the frame
+    bool resolved = g_scaler->resolved;
+    g_scaler->resolved = false;
+    if (!g_scaler->config.enabled || resolved) return;
     
-    // Disable depth testing for upscale pass
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_BLEND);
+    TRACE_SCOPE("scaler_upscale");
     
-    // Use upscale shader
-    GLuint program = g_scaler->config.sharpening && g_scaler->sharpenProgram ? 
-                     g_scaler->sharpenProgram : g_scaler->upscaleProgram;
+    // The upscale is its own GPU pass (two with RCAS) until swap
+    discardSceneDepth();
     
-    glUseProgram(program);
+    // Only the region the back buffer is missing needs upscaling; widen it
+    // by the filter footprint (EASU reaches two input texels, RCAS one).
+    // Nothing missing (an identical frame) skips the pass
+    GLint repair[4];
+    bool partial = damageTrackerGetRepairBounds(repair);
+    if (partial && (repair[2] <= 0 || repair[3] <= 0)) return;
+    
+    GLint scissorBox[4];
+    GLboolean scissorTest = glIsEnabled(GL_SCISSOR_TEST);
+    glGetIntegerv(GL_SCISSOR_BOX, scissorBox);
     
-    // Set uniforms
-    if (g_scaler->config.sharpening && g_scaler->sharpenProgram) {
-        GLint texelSizeLoc = glGetUniformLocation(program, "uTexelSize");
-        GLint sharpnessLoc = glGetUniformLocation(program, "uSharpness");
+    GLint box[4];
+    if (partial) {
+        int margin = (int)ceilf(2.0f / g_scaler->currentScale) + 2;
+        int x0 = repair[0] - margin > 0 ? repair[0] - margin : 0;
+        int y0 = repair[1] - margin > 0 ? repair[1] - margin : 0;
+        int x1 = repair[0] + repair[2] + margin;
+        int y1 = repair[1] + repair[3] + margin;
+        if (x1 > g_scaler->nativeWidth) x1 = g_scaler->nativeWidth;
+        if (y1 > g_scaler->nativeHeight) y1 = g_scaler->nativeHeight;
+        box[0] = x0;
+        box[1] = y0;
+        box[2] = x1 - x0;
+        box[3] = y1 - y0;
         
-        glUniform2f(texelSizeLoc, 1.0f / g_scaler->nativeWidth, 1.0f / g_scaler->nativeHeight);
-        glUniform1f(sharpnessLoc, g_scaler->config.sharpenAmount);
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(box[0], box[1], box[2], box[3]);
+    } else {
+        glDisable(GL_SCISSOR_TEST);
     }
     
-    // Bind render texture
+    drawUpscale(0, activeMethod(), true, partial ? box : NULL);
+    
+    if (scissorTest) glEnable(GL_SCISSOR_TEST); else glDisable(GL_SCISSOR_TEST);
+    glScissor(scissorBox[0], scissorBox[1], scissorBox[2], scissorBox[3]);
+}
+
+bool resolutionScalerResolve(void) {
+    if (!g_scaler || !g_scaler->initialized || !g_scaler->config.enabled) return false;
+    if (g_scaler->resolved) return false;
+    
+    TRACE_SCOPE("scaler_resolve");
+    
+    // Mid-frame the app's state has to survive the upscale pass
+    GLint program, vertexArray, activeTexture, texture, sampler;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertexArray);
+    glGetIntegerv(GL_ACTIVE_TEXTURE, &activeTexture);
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, g_scaler->renderColorTex);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture);
+    glGetIntegerv(GL_SAMPLER_BINDING, &sampler);
     
-    // Draw fullscreen quad
-    glBindVertexArray(g_quadVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
+    static const GLenum CAPS[] = {
+        GL_DEPTH_TEST, GL_BLEND, GL_SCISSOR_TEST, GL_STENCIL_TEST, GL_CULL_FACE
+    };
+    GLboolean enabled[sizeof(CAPS) / sizeof(CAPS[0])];
+    for (size_t i = 0; i < sizeof(CAPS) / sizeof(CAPS[0]); i++) {
+        enabled[i] = glIsEnabled(CAPS[i]);
+        glDisable(CAPS[i]);
+    }
+    glBindSampler(0, 0);
     
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glUseProgram(0);
+    discardSceneDepth();
+    drawUpscale(0, activeMethod(), true, NULL);
+    g_scaler->resolved = true;
     
-    // Re-enable depth test
-    glEnable(GL_DEPTH_TEST);
+    // The UI draws over the upscale without knowing what changed below it
+    damageTrackerAddFull();
+    
+    for (size_t i = 0; i < sizeof(CAPS) / sizeof(CAPS[0]); i++) {
+        if (enabled[i]) glEnable(CAPS[i]); else glDisable(CAPS[i]);
+    }
+    glBindSampler(0, (GLuint)sampler);
+    glBindTexture(GL_TEXTURE_2D, (GLuint)texture);
+    glActiveTexture((GLenum)activeTexture);
+    glBindVertexArray((GLuint)vertexArray);
+    glUseProgram((GLuint)program);
+    
+    return true;
 }
 
-void resolutionScalerRecordFrameTime(float frameTimeMs) {
-    if (!g_scaler || !g_scaler->config.enabled) return;
+/**
+ * Controller gain multiplier; config.adjustSpeed of 0.1 is nominal
+ */
+static float controllerGain(void) {
+    return g_scaler->config.adjustSpeed > 0.0f ? g_scaler->config.adjustSpeed / 0.1f : 1.0f;
+}
+
+/**
+ * Classify the frame and pick the load signal the controller regulates.
+ * Returns false when the load is not a GPU time, i.e. already includes vsync.
+ */
+static bool measureLoad(const ScalerFrameSample* sample, float* load, bool* gpuBound) {
+    float budget = g_scaler->targetFrameTime;
     
-    // Add to history
-    g_scaler->frameTimeHistory[g_scaler->historyIndex] = frameTimeMs;
-    g_scaler->historyIndex = (g_scaler->historyIndex + 1) % SCALER_HISTORY_SIZE;
+    if (sample->gpuTimeMs > 0.0f) {
+        *load = sample->gpuTimeMs;
+        *gpuBound = sample->gpuTimeMs >= sample->cpuTimeMs;
+        return true;
+    }
     
-    // Calculate average
-    float sum = 0;
-    for (int i = 0; i < SCALER_HISTORY_SIZE; i++) {
-        sum += g_scaler->frameTimeHistory[i];
+    // Without timer queries, time blocked on the frame fence means the
+    // CPU was waiting for the GPU to drain
+    if (sample->gpuWaitMs > SCALER_FENCE_WAIT_MS) {
+        *load = sample->cpuTimeMs + sample->gpuWaitMs;
+        *gpuBound = true;
+        return false;
+    }
+    
+    // Interval only: slow frames with a cheap CPU side point at the GPU
+    *load = sample->intervalMs;
+    *gpuBound = sample->cpuTimeMs < budget * 0.75f;
+    return false;
+}
+
+void resolutionScalerRecordFrame(const ScalerFrameSample* sample) {
+    if (!g_scaler || !g_scaler->config.enabled || g_scaler->held || !sample) return;
+    if (sample->intervalMs <= 0.0f) return;
+    
+    // Smoothed frame interval for reporting
+    if (g_scaler->avgFrameTime <= 0.0f) {
+        g_scaler->avgFrameTime = sample->intervalMs;
+    } else {
+        g_scaler->avgFrameTime += (sample->intervalMs - g_scaler->avgFrameTime) * SCALER_EMA_ALPHA;
     }
-    g_scaler->avgFrameTime = sum / SCALER_HISTORY_SIZE;
     g_scaler->actualFPS = 1000.0f / g_scaler->avgFrameTime;
     
-    // Adaptive scaling
-    float deviation = (g_scaler->avgFrameTime - g_scaler->targetFrameTime) / g_scaler->targetFrameTime;
+    float load;
+    bool gpuBound;
+    bool gpuTimed = measureLoad(sample, &load, &gpuBound);
     
-    if (fabsf(deviation) > SCALER_ADJUST_THRESHOLD) {
-        float adjustment = -deviation * g_scaler->config.adjustSpeed;
-        float newScale = g_scaler->currentScale + adjustment;
-        
-        // Clamp
-        if (newScale < g_scaler->config.minScale) newScale = g_scaler->config.minScale;
-        if (newScale > g_scaler->config.maxScale) newScale = g_scaler->config.maxScale;
-        
-        if (fabsf(newScale - g_scaler->currentScale) > 0.01f) {
-            g_scaler->currentScale = newScale;
-            updateRenderSize();
+    float workload = sample->drawCalls * SCALER_DRAW_COST + (float)sample->triangles;
+    if (g_scaler->gpuLoadEma <= 0.0f) {
+        g_scaler->gpuLoadEma = load;
+        g_scaler->workloadEma = workload;
+        g_scaler->gpuBoundRatio = gpuBound ? 1.0f : 0.0f;
+    } else {
+        g_scaler->gpuLoadEma += (load - g_scaler->gpuLoadEma) * SCALER_EMA_ALPHA;
+        g_scaler->workloadEma += (workload - g_scaler->workloadEma) * SCALER_EMA_ALPHA;
+        g_scaler->gpuBoundRatio += ((gpuBound ? 1.0f : 0.0f) - g_scaler->gpuBoundRatio) * SCALER_EMA_ALPHA;
+    }
+    g_scaler->gpuBound = g_scaler->gpuBoundRatio >= 0.5f;
+    
+    // GPU time lags submission by a few frames; scale the smoothed load by
+    // how much heavier this frame's submission is than the recent average
+    float predicted = g_scaler->gpuLoadEma;
+    if (g_scaler->workloadEma > 0.0f) {
+        float ratio = workload / g_scaler->workloadEma;
+        if (ratio < 0.5f) ratio = 0.5f;
+        if (ratio > 2.0f) ratio = 2.0f;
+        predicted *= ratio;
+    }
+    
+    // A vsync-bound interval never drops below the budget, so only GPU
+    // time gets headroom under it
+    float budget = g_scaler->targetFrameTime;
+    float target = budget * (gpuTimed ? SCALER_GPU_HEADROOM : 1.0f);
+    float error = (predicted - target) / budget;
+    
+    // Hold on target, and never trade resolution for a CPU-bound frame
+    if (fabsf(error) < SCALER_DEADBAND || (error > 0.0f && !g_scaler->gpuBound)) {
+        error = 0.0f;
+    }
+    
+    float gain = controllerGain();
+    float kp = SCALER_KP * gain;
+    float ki = SCALER_KI * gain;
+    
+    float minScale = g_scaler->config.minScale;
+    float maxScale = g_scaler->config.maxScale;
+    
+    // Anti-windup: the running sum never asks for more than the scale range
+    g_scaler->integral += error;
+    float integralMax = (maxScale - minScale) / ki;
+    if (g_scaler->integral < 0.0f) g_scaler->integral = 0.0f;
+    if (g_scaler->integral > integralMax) g_scaler->integral = integralMax;
+    
+    float newScale = maxScale - kp * error - ki * g_scaler->integral;
+    if (newScale < minScale) newScale = minScale;
+    if (newScale > maxScale) newScale = maxScale;
+    g_scaler->desiredScale = newScale;
+    
+    // Switch steps only once the controller is clearly past the midpoint,
+    // so noise around a step boundary does not flip the resolution
+    float threshold = SCALER_SCALE_STEP * (0.5f + SCALER_HYSTERESIS);
+    if (fabsf(g_scaler->desiredScale - g_scaler->currentScale) >= threshold) {
+        g_scaler->currentScale = quantizeScale(g_scaler->desiredScale);
+        if (updateRenderSize()) {
+            g_scaler->scaleChanges++;
         }
     }
 }
 
+void resolutionScalerRecordFrameTime(float frameTimeMs) {
+    ScalerFrameSample sample = {0};
+    sample.intervalMs = frameTimeMs;
+    resolutionScalerRecordFrame(&sample);
+}
+
 // ============================================================================
 // Getters/Setters
 // ============================================================================
@@ -431,8 +1115,25 @@ void resolutionScalerSetScale(float scale) {
     if (scale < SCALER_MIN_SCALE) scale = SCALER_MIN_SCALE;
     if (scale > SCALER_MAX_SCALE) scale = SCALER_MAX_SCALE;
     
+    scale = quantizeScale(scale);
+    
+    // An explicit scale above the allocation is the one case that grows it
+    int width, height;
+    computeSize(scale, &width, &height);
+    if (width > g_scaler->allocWidth || height > g_scaler->allocHeight) {
+        allocateRenderTarget(scale);
+    }
+    
     g_scaler->currentScale = scale;
-    updateRenderSize();
+    g_scaler->desiredScale = scale;
+    
+    // Resume the controller from the explicit scale instead of snapping back
+    float integral = (g_scaler->config.maxScale - scale) / (SCALER_KI * controllerGain());
+    g_scaler->integral = integral > 0.0f ? integral : 0.0f;
+    
+    if (updateRenderSize()) {
+        g_scaler->scaleChanges++;
+    }
 }
 
 float resolutionScalerGetScale(void) {
@@ -449,8 +1150,122 @@ void resolutionScalerGetNativeSize(int* width, int* height) {
     if (height) *height = g_scaler ? g_scaler->nativeHeight : 0;
 }
 
+GLuint resolutionScalerGetTargetFBO(void) {
+    if (!g_scaler || !g_scaler->initialized || !g_scaler->config.enabled) return 0;
+    if (g_scaler->resolved) return 0;
+    return g_scaler->renderFBO;
+}
+
+void resolutionScalerMapRect(GLint rect[4]) {
+    if (!g_scaler || g_scaler->nativeWidth <= 0 || g_scaler->nativeHeight <= 0) return;
+    
+    // Round outwards so adjacent rects still tile the subrect
+    int64_t nw = g_scaler->nativeWidth, nh = g_scaler->nativeHeight;
+    int64_t rw = g_scaler->renderWidth, rh = g_scaler->renderHeight;
+    
+    int64_t x0 = (int64_t)rect[0] * rw / nw;
+    int64_t y0 = (int64_t)rect[1] * rh / nh;
+    int64_t x1 = ((int64_t)(rect[0] + rect[2]) * rw + nw - 1) / nw;
+    int64_t y1 = ((int64_t)(rect[1] + rect[3]) * rh + nh - 1) / nh;
+    
+    rect[0] = (GLint)x0;
+    rect[1] = (GLint)y0;
+    rect[2] = (GLint)(x1 - x0);
+    rect[3] = (GLint)(y1 - y0);
+}
+
+bool resolutionScalerBeginRead(GLuint framebuffer, GLint rect[4]) {
+    if (!g_scaler || rect[2] <= 0 || rect[3] <= 0) return false;
+    
+    bool scaled = framebuffer == 0 ? resolutionScalerGetTargetFBO() != 0 : rtScalerIsScaled(framebuffer);
+    if (!scaled) return false;
+    
+    GLint src[4] = { rect[0], rect[1], rect[2], rect[3] };
+    if (framebuffer == 0) {
+        resolutionScalerMapRect(src);
+    } else {
+        rtScalerMapRect(src);
+    }
+    
+    // At native scale the subrect is pixel for pixel: read it in place
+    if (src[2] == rect[2] && src[3] == rect[3]) {
+        rect[0] = src[0];
+        rect[1] = src[1];
+        return false;
+    }
+    
+    GLint previousDraw = 0;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &g_scaler->readPrevious);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousDraw);
+    
+    if (!g_scaler->readFBO) {
+        glGenFramebuffers(1, &g_scaler->readFBO);
+        glGenRenderbuffers(1, &g_scaler->readRB);
+    }
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, g_scaler->readFBO);
+    if (rect[2] > g_scaler->readWidth || rect[3] > g_scaler->readHeight) {
+        // Grows only; reads use its lower left corner
+        if (rect[2] > g_scaler->readWidth) g_scaler->readWidth = rect[2];
+        if (rect[3] > g_scaler->readHeight) g_scaler->readHeight = rect[3];
+        GLint previousRB = 0;
+        glGetIntegerv(GL_RENDERBUFFER_BINDING, &previousRB);
+        glBindRenderbuffer(GL_RENDERBUFFER, g_scaler->readRB);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, g_scaler->readWidth, g_scaler->readHeight);
+        glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                  GL_RENDERBUFFER, g_scaler->readRB);
+        glBindRenderbuffer(GL_RENDERBUFFER, (GLuint)previousRB);
+    }
+    
+    // Blits are scissored
+    GLboolean scissorTest = glIsEnabled(GL_SCISSOR_TEST);
+    if (scissorTest) glDisable(GL_SCISSOR_TEST);
+    glBlitFramebuffer(src[0], src[1], src[0] + src[2], src[1] + src[3],
+                      0, 0, rect[2], rect[3], GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    if (scissorTest) glEnable(GL_SCISSOR_TEST);
+    
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, (GLuint)previousDraw);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, g_scaler->readFBO);
+    rect[0] = 0;
+    rect[1] = 0;
+    return true;
+}
+
+void resolutionScalerEndRead(void) {
+    if (!g_scaler) return;
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint)g_scaler->readPrevious);
+}
+
 void resolutionScalerSetEnabled(bool enabled) {
-    if (g_scaler) g_scaler->config.enabled = enabled;
+    if (!g_scaler) return;
+    
+    if (!enabled && g_scaler->targetRequired) {
+        if (!g_scaler->held) velocityLogInfo("Window has no depth buffer, holding native scale");
+        g_scaler->held = true;
+        resolutionScalerSetScale(1.0f);
+        return;
+    }
+    
+    g_scaler->held = false;
+    g_scaler->config.enabled = enabled;
+}
+
+void resolutionScalerSetTargetRequired(bool required) {
+    if (g_scaler) g_scaler->targetRequired = required;
+}
+
+void resolutionScalerRequireFormats(bool stencil, bool alpha) {
+    if (!g_scaler) return;
+    
+    if (stencil && !formatHasStencil(sceneDepthFormat())) {
+        velocityLogInfo("App uses stencil, upgrading scene depth to D24S8");
+        g_scaler->config.depthFormat = GL_DEPTH24_STENCIL8;
+        g_scaler->formatsChanged = true;
+    }
+    if (alpha && !formatHasAlpha(sceneColorFormat())) {
+        velocityLogInfo("App blends with destination alpha, upgrading scene color to RGBA8");
+        g_scaler->config.colorFormat = GL_RGBA8;
+        g_scaler->formatsChanged = true;
+    }
 }
 
 bool resolutionScalerIsEnabled(void) {
@@ -460,8 +1275,14 @@ bool resolutionScalerIsEnabled(void) {
 void resolutionScalerResize(int nativeWidth, int nativeHeight) {
     if (!g_scaler) return;
     
+    if (nativeWidth == g_scaler->nativeWidth && nativeHeight == g_scaler->nativeHeight) return;
+    
     g_scaler->nativeWidth = nativeWidth;
     g_scaler->nativeHeight = nativeHeight;
+    
+    float maxScale = g_scaler->config.maxScale > g_scaler->currentScale ?
+                     g_scaler->config.maxScale : g_scaler->currentScale;
+    allocateRenderTarget(maxScale);
     updateRenderSize();
 }
 
@@ -469,6 +1290,12 @@ void resolutionScalerSetConfig(const ScalerConfig* config) {
     if (!g_scaler || !config) return;
     memcpy(&g_scaler->config, config, sizeof(ScalerConfig));
     g_scaler->targetFrameTime = 1000.0f / g_scaler->config.targetFPS;
+    
+    int width, height;
+    computeSize(g_scaler->config.maxScale, &width, &height);
+    if (width > g_scaler->allocWidth || height > g_scaler->allocHeight) {
+        allocateRenderTarget(g_scaler->config.maxScale);
+    }
 }
 
 ScalerConfig resolutionScalerGetConfig(void) {
@@ -485,6 +1312,10 @@ uint32_t resolutionScalerGetScaleChanges(void) {
     return g_scaler ? g_scaler->scaleChanges : 0;
 }
 
+bool resolutionScalerIsGpuBound(void) {
+    return g_scaler && g_scaler->gpuBound;
+}
+
 void resolutionScalerSetUpscaleMethod(UpscaleMethod method) {
     if (g_scaler) g_scaler->config.upscaleMethod = method;
 }
@@ -499,3 +1330,125 @@ void resolutionScalerSetSharpening(bool enabled, float amount) {
         g_scaler->config.sharpenAmount = amount;
     }
 }
+
+// ============================================================================
+// Benchmark
+// ============================================================================
+
+static inline double benchNowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void drawPattern(GLuint program, GLuint fbo, int width, int height) {
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, width, height);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glUseProgram(program);
+    glUniform2f(glGetUniformLocation(program, "uResolution"), (float)width, (float)height);
+    glBindVertexArray(g_quadVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glBindVertexArray(0);
+}
+
+static float computePsnr(const uint8_t* reference, const uint8_t* test, size_t pixels) {
+    double sum = 0.0;
+    for (size_t i = 0; i < pixels; i++) {
+        for (int c = 0; c < 3; c++) {
+            double diff = (double)reference[i * 4 + c] - test[i * 4 + c];
+            sum += diff * diff;
+        }
+    }
+    
+    double mse = sum / (pixels * 3);
+    if (mse <= 0.0) return 99.0f;
+    return (float)(10.0 * log10(255.0 * 255.0 / mse));
+}
+
+bool resolutionScalerBenchmark(UpscaleMethod method, float scale, ScalerBenchmarkResult* result) {
+    if (!result) return false;
+    memset(result, 0, sizeof(ScalerBenchmarkResult));
+    if (!g_scaler || !g_scaler->initialized) return false;
+    
+    int width = g_scaler->nativeWidth;
+    int height = g_scaler->nativeHeight;
+    size_t pixels = (size_t)width * height;
+    
+    uint8_t* reference = (uint8_t*)velocityMalloc(pixels * 4);
+    uint8_t* test = (uint8_t*)velocityMalloc(pixels * 4);
+    GLuint program = createProgram(UPSCALE_VERTEX_SHADER, PATTERN_FRAGMENT_SHADER);
+    if (!reference || !test || !program) {
+        velocityFree(reference);
+        velocityFree(test);
+        glDeleteProgram(program);
+        return false;
+    }
+    
+    GLint prevFBO = 0;
+    GLint prevViewport[4] = {0};
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFBO);
+    glGetIntegerv(GL_VIEWPORT, prevViewport);
+    
+    // Native-size output the upscaler writes instead of the window
+    GLuint outTex, outFBO;
+    glGenTextures(1, &outTex);
+    glBindTexture(GL_TEXTURE_2D, outTex);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+    glGenFramebuffers(1, &outFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, outFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, outTex, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    // Reference at native resolution
+    drawPattern(program, outFBO, width, height);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, reference);
+    
+    // Same pattern into the render subrect at the benchmark scale
+    int savedWidth = g_scaler->renderWidth;
+    int savedHeight = g_scaler->renderHeight;
+    int renderWidth, renderHeight;
+    computeSize(quantizeScale(scale), &renderWidth, &renderHeight);
+    if (renderWidth > g_scaler->allocWidth) renderWidth = g_scaler->allocWidth;
+    if (renderHeight > g_scaler->allocHeight) renderHeight = g_scaler->allocHeight;
+    g_scaler->renderWidth = renderWidth;
+    g_scaler->renderHeight = renderHeight;
+    
+    drawPattern(program, g_scaler->renderFBO, renderWidth, renderHeight);
+    
+    glFinish();
+    double start = benchNowMs();
+    for (int i = 0; i < SCALER_BENCH_ITERATIONS; i++) {
+        drawUpscale(outFBO, method, false, NULL);
+    }
+    glFinish();
+    double elapsed = benchNowMs() - start;
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, outFBO);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, test);
+    
+    result->method = useFsr(method) ? UPSCALE_FSR : UPSCALE_BILINEAR;
+    result->scale = (float)renderWidth / width;
+    result->renderWidth = renderWidth;
+    result->renderHeight = renderHeight;
+    result->psnrDb = computePsnr(reference, test, pixels);
+    result->upscaleMs = (float)(elapsed / SCALER_BENCH_ITERATIONS);
+    
+    g_scaler->renderWidth = savedWidth;
+    g_scaler->renderHeight = savedHeight;
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)prevFBO);
+    glViewport(prevViewport[0], prevViewport[1], prevViewport[2], prevViewport[3]);
+    glDeleteFramebuffers(1, &outFBO);
+    glDeleteTextures(1, &outTex);
+    glDeleteProgram(program);
+    velocityFree(reference);
+    velocityFree(test);
+    
+    velocityLogInfo("Upscale benchmark: %s at %dx%d -> %dx%d, %.2f dB, %.3f ms",
+                    result->method == UPSCALE_FSR ? "FSR" : "bilinear",
+                    renderWidth, renderHeight, width, height,
+                    result->psnrDb, result->upscaleMs);
+    return true;
+}
@@ -9,6 +9,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "../texture/storage_pool.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -20,8 +22,17 @@ extern "C" {
 #define SCALER_MIN_SCALE        0.25f
 #define SCALER_MAX_SCALE        2.0f
 #define SCALER_DEFAULT_SCALE    1.0f
-#define SCALER_HISTORY_SIZE     60      // Frames to average
-#define SCALER_ADJUST_THRESHOLD 0.1f    // 10% deviation to trigger adjustment
+#define SCALER_EMA_ALPHA        0.15f   // Smoothing of load signals
+#define SCALER_KP               0.25f   // Proportional gain (scale per unit load error)
+#define SCALER_KI               0.02f   // Integral gain per frame
+#define SCALER_DEADBAND         0.05f   // Relative load error treated as on target
+#define SCALER_GPU_HEADROOM     0.9f    // Target GPU time as a fraction of the frame budget
+#define SCALER_DRAW_COST        256.0f  // Triangle equivalents per draw for load prediction
+#define SCALER_FENCE_WAIT_MS    0.5f    // CPU fence wait that marks a frame GPU-bound
+#define SCALER_SCALE_STEP       0.05f   // Applied scales are multiples of this
+#define SCALER_HYSTERESIS       0.25f   // Extra step fraction past the midpoint before switching
+#define SCALER_RCAS_MAX_STOPS   2.0f    // RCAS attenuation at sharpenAmount 0
+#define SCALER_BENCH_ITERATIONS 8       // Upscale passes timed per benchmark run
 
 // ============================================================================
 // Types
@@ -34,7 +45,7 @@ typedef enum UpscaleMethod {
     UPSCALE_NEAREST,            // Fastest, pixelated
     UPSCALE_BILINEAR,           // Good balance
     UPSCALE_BICUBIC,            // Smoother
-    UPSCALE_FSR,                // AMD FidelityFX (if available)
+    UPSCALE_FSR,                // FSR1-style EASU, plus RCAS when sharpening
     UPSCALE_CAS                 // Contrast Adaptive Sharpening
 } UpscaleMethod;
 
@@ -50,8 +61,43 @@ typedef struct ScalerConfig {
     UpscaleMethod upscaleMethod;
     bool sharpening;
     float sharpenAmount;        // 0.0-1.0
+    GLenum colorFormat;         // Scene target color (0 = GL_RGBA8)
+    GLenum depthFormat;         // Scene target depth (0 = GL_DEPTH24_STENCIL8)
 } ScalerConfig;
 
+/**
+ * Per-frame inputs to the scale controller
+ */
+typedef struct ScalerFrameSample {
+    float intervalMs;           // Frame-to-frame time
+    float cpuTimeMs;            // CPU time spent building the frame
+    float gpuTimeMs;            // GPU time from timer queries (0 = unavailable)
+    float gpuWaitMs;            // CPU time blocked on frame fences
+    uint32_t drawCalls;
+    uint32_t triangles;
+} ScalerFrameSample;
+
+/**
+ * FSR constants (std140 layout of the FsrConstants uniform block)
+ */
+typedef struct ScalerFsrConstants {
+    float easuScale[4];         // xy = input/output pixel ratio, zw = pixel center offset
+    float inputMax[4];          // xy = last texel of the rendered subrect
+    float rcas[4];              // x = sharpness (1 = max)
+} ScalerFsrConstants;
+
+/**
+ * Upscale benchmark result
+ */
+typedef struct ScalerBenchmarkResult {
+    UpscaleMethod method;       // Method actually run (FSR falls back if unavailable)
+    float scale;
+    int renderWidth;
+    int renderHeight;
+    float psnrDb;               // Against the pattern rendered at native resolution
+    float upscaleMs;            // Mean time of the upscale passes (GPU-synchronized)
+} ScalerBenchmarkResult;
+
 /**
  * Resolution scaler context
  */
@@ -60,33 +106,60 @@ typedef struct ResolutionScalerContext {
     ScalerConfig config;
     
     // Current state
-    float currentScale;
+    float currentScale;         // Applied (quantized) scale
+    float desiredScale;         // Unquantized controller output
     int nativeWidth;
     int nativeHeight;
-    int renderWidth;
+    int renderWidth;            // Subrect of the render target in use
     int renderHeight;
+    int allocWidth;             // Render target size, allocated for the max scale
+    int allocHeight;
+    bool resolved;              // Upscaled early this frame, the rest draws natively
+    bool targetRequired;        // The window has no depth: the scene always renders here
+    bool held;                  // Disabled while required: pinned at native scale
+    bool formatsChanged;        // Target formats upgraded, reallocate at frame start
     
     // Framebuffers
     GLuint renderFBO;
     GLuint renderColorTex;
-    GLuint renderDepthTex;
-    GLuint upscaleFBO;          // For multi-pass upscaling
+    GLuint renderDepthRB;
+    StorageKey renderColorKey;  // Storage of the targets, handed back to the pool on resize
+    StorageKey renderDepthKey;
+    GLuint upscaleFBO;          // For multi-pass upscaling (EASU output, native size)
     GLuint upscaleColorTex;
+    StorageKey upscaleColorKey;
+    int upscaleWidth;
+    int upscaleHeight;
+    GLuint readFBO;             // Window-size staging for reads of scaled targets
+    GLuint readRB;
+    int readWidth;
+    int readHeight;
+    GLint readPrevious;         // Read framebuffer bound around a staged read
     
     // Shaders
     GLuint upscaleProgram;
     GLuint sharpenProgram;
-    GLuint fsrProgram;
+    GLuint fsrProgram;          // EASU
+    GLuint rcasProgram;
+    GLuint fsrUBO;
+    GLuint fsrBinding;          // Uniform block binding, the last one so apps rarely share it
+    ScalerFsrConstants fsrConstants;
     
     // Uniforms
-    GLint upscaleTexSizeLoc;
-    GLint upscaleScaleLoc;
+    GLint upscaleUVScaleLoc;
+    GLint upscaleUVMaxLoc;
+    GLint sharpenUVScaleLoc;
+    GLint sharpenUVMaxLoc;
+    GLint sharpenTexelSizeLoc;
     GLint sharpenAmountLoc;
     
-    // Frame time history for adaptive scaling
-    float frameTimeHistory[SCALER_HISTORY_SIZE];
-    int historyIndex;
-    float avgFrameTime;
+    // Controller state
+    float avgFrameTime;         // EMA of the frame interval
+    float gpuLoadEma;           // EMA of the GPU time estimate
+    float workloadEma;          // EMA of draws/triangles, for load prediction
+    float integral;             // Running sum of the load error
+    float gpuBoundRatio;        // EMA of frames limited by the GPU
+    bool gpuBound;
     
     // Statistics
     float actualFPS;
@@ -137,7 +210,19 @@ void resolutionScalerBeginFrame(int* outWidth, int* outHeight);
 void resolutionScalerEndFrame(void);
 
 /**
- * Record frame time for adaptive scaling
+ * Upscale to the backbuffer mid-frame so the rest of the frame (UI) draws at
+ * native resolution. Restores program, VAO, texture and enable state, but
+ * not framebuffer bindings or viewport/scissor. False if nothing was resolved.
+ */
+bool resolutionScalerResolve(void);
+
+/**
+ * Feed one frame to the adaptive scale controller
+ */
+void resolutionScalerRecordFrame(const ScalerFrameSample* sample);
+
+/**
+ * Record frame time for adaptive scaling (no GPU timing or workload signals)
  */
 void resolutionScalerRecordFrameTime(float frameTimeMs);
 
@@ -161,6 +246,30 @@ void resolutionScalerGetRenderSize(int* width, int* height);
  */
 void resolutionScalerGetNativeSize(int* width, int* height);
 
+/**
+ * Get the FBO that stands in for the default framebuffer, 0 when not scaling
+ * or already resolved this frame
+ */
+GLuint resolutionScalerGetTargetFBO(void);
+
+/**
+ * Map a native-resolution rect (x, y, w, h) into the current render subrect
+ */
+void resolutionScalerMapRect(GLint rect[4]);
+
+/**
+ * Prepare a read (glReadPixels, glCopyTex*) of a window-space rect from a
+ * framebuffer: a scaled one has its subrect upscaled into a staging target
+ * bound for reading, and rect is rewritten to the rect to read there.
+ * Returns true if resolutionScalerEndRead has to restore the binding
+ */
+bool resolutionScalerBeginRead(GLuint framebuffer, GLint rect[4]);
+
+/**
+ * Rebind the read framebuffer replaced by resolutionScalerBeginRead
+ */
+void resolutionScalerEndRead(void);
+
 /**
  * Enable/disable adaptive scaling
  */
@@ -171,6 +280,18 @@ void resolutionScalerSetEnabled(bool enabled);
  */
 bool resolutionScalerIsEnabled(void);
 
+/**
+ * The window surface has no depth buffer: disabling holds the target at
+ * native scale instead of rendering to the window
+ */
+void resolutionScalerSetTargetRequired(bool required);
+
+/**
+ * The app uses stencil or destination alpha: upgrade reduced target
+ * formats from the next frame
+ */
+void resolutionScalerRequireFormats(bool stencil, bool alpha);
+
 // ============================================================================
 // Upscaling Methods
 // ============================================================================
@@ -190,6 +311,12 @@ UpscaleMethod resolutionScalerGetUpscaleMethod(void);
  */
 void resolutionScalerSetSharpening(bool enabled, float amount);
 
+/**
+ * Compare a method against a native-resolution test pattern at the given
+ * scale (stalls the GPU, debug use only)
+ */
+bool resolutionScalerBenchmark(UpscaleMethod method, float scale, ScalerBenchmarkResult* result);
+
 // ============================================================================
 // Statistics
 // ============================================================================
@@ -204,6 +331,11 @@ float resolutionScalerGetActualFPS(void);
  */
 uint32_t resolutionScalerGetScaleChanges(void);
 
+/**
+ * Check if recent frames were limited by the GPU
+ */
+bool resolutionScalerIsGpuBound(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,506 @@
+/**
+ * RT Scaler - Implementation
+ */
+
+#include "rt_scaler.h"
+#include "resolution_scaler.h"
+#include "../core/gl_wrapper.h"
+#include "../profile/trace.h"
+#include "../utils/log.h"
+
+#include <string.h>
+
+// ============================================================================
+// Types
+// ============================================================================
+
+typedef struct ScaledTarget {
+    GLuint name;
+    bool renderbuffer;
+    uint8_t shift;               // Allocated at window size >> shift
+    GLenum internalFormat;
+    GLenum format;               // Textures: glTexImage2D format/type
+    GLenum type;
+    GLsizei levels;
+    GLsizei samples;             // Renderbuffers
+    int width;                   // Current level 0 size
+    int height;
+} ScaledTarget;
+
+typedef struct ScaledFramebuffer {
+    GLuint framebuffer;
+    uint32_t scaledAttachments;  // Bit per attachment point holding a scaled target
+} ScaledFramebuffer;
+
+typedef struct RTScalerContext {
+    bool initialized;
+
+    ScaledTarget targets[RT_SCALER_MAX_TARGETS];
+    int targetCount;
+
+    ScaledFramebuffer framebuffers[RT_SCALER_MAX_FRAMEBUFFERS];
+    int framebufferCount;
+
+    // Size window-size targets currently have
+    int width;
+    int height;
+    bool scaled;                 // Smaller or larger than the window
+    int cooldown;                // Frames until the next resize is allowed
+
+    uint32_t reallocations;
+    uint32_t resizes;
+    uint32_t untracked;
+} RTScalerContext;
+
+static RTScalerContext g_rt = {0};
+
+// Sized formats glTexStorage2D targets are emulated with
+typedef struct StorageFormat {
+    GLenum internalFormat;
+    GLenum format;
+    GLenum type;
+} StorageFormat;
+
+static const StorageFormat STORAGE_FORMATS[] = {
+    { GL_RGBA8,                 GL_RGBA,            GL_UNSIGNED_BYTE },
+    { GL_SRGB8_ALPHA8,          GL_RGBA,            GL_UNSIGNED_BYTE },
+    { GL_RGB8,                  GL_RGB,             GL_UNSIGNED_BYTE },
+    { GL_RG8,                   GL_RG,              GL_UNSIGNED_BYTE },
+    { GL_R8,                    GL_RED,             GL_UNSIGNED_BYTE },
+    { GL_RGB10_A2,              GL_RGBA,            GL_UNSIGNED_INT_2_10_10_10_REV },
+    { GL_RGBA16F,               GL_RGBA,            GL_HALF_FLOAT },
+    { GL_RGB16F,                GL_RGB,             GL_HALF_FLOAT },
+    { GL_RG16F,                 GL_RG,              GL_HALF_FLOAT },
+    { GL_R16F,                  GL_RED,             GL_HALF_FLOAT },
+    { GL_R11F_G11F_B10F,        GL_RGB,             GL_HALF_FLOAT },
+    { GL_RGBA32F,               GL_RGBA,            GL_FLOAT },
+    { GL_RG32F,                 GL_RG,              GL_FLOAT },
+    { GL_R32F,                  GL_RED,             GL_FLOAT },
+    { GL_RGBA8UI,               GL_RGBA_INTEGER,    GL_UNSIGNED_BYTE },
+    { GL_RGBA16UI,              GL_RGBA_INTEGER,    GL_UNSIGNED_SHORT },
+    { GL_R32UI,                 GL_RED_INTEGER,     GL_UNSIGNED_INT },
+    { GL_DEPTH_COMPONENT16,     GL_DEPTH_COMPONENT, GL_UNSIGNED_SHORT },
+    { GL_DEPTH_COMPONENT24,     GL_DEPTH_COMPONENT, GL_UNSIGNED_INT },
+    { GL_DEPTH_COMPONENT32F,    GL_DEPTH_COMPONENT, GL_FLOAT },
+    { GL_DEPTH24_STENCIL8,      GL_DEPTH_STENCIL,   GL_UNSIGNED_INT_24_8 },
+    { GL_DEPTH32F_STENCIL8,     GL_DEPTH_STENCIL,   GL_FLOAT_32_UNSIGNED_INT_24_8_REV },
+};
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static const StorageFormat* findStorageFormat(GLenum internalFormat) {
+    for (size_t i = 0; i < sizeof(STORAGE_FORMATS) / sizeof(STORAGE_FORMATS[0]); i++) {
+        if (STORAGE_FORMATS[i].internalFormat == internalFormat) return &STORAGE_FORMATS[i];
+    }
+    return NULL;
+}
+
+/**
+ * Match a size against the window size and its halves, rounded either way
+ */
+static bool matchWindowSize(GLsizei width, GLsizei height, uint8_t* shift) {
+    int nativeWidth, nativeHeight;
+    resolutionScalerGetNativeSize(&nativeWidth, &nativeHeight);
+    if (nativeWidth <= 0 || nativeHeight <= 0) return false;
+
+    for (int s = 0; s <= RT_SCALER_MAX_SHIFT; s++) {
+        int round = (1 << s) - 1;
+        bool widthMatch = width == (nativeWidth >> s) || width == ((nativeWidth + round) >> s);
+        bool heightMatch = height == (nativeHeight >> s) || height == ((nativeHeight + round) >> s);
+        if (widthMatch && heightMatch) {
+            *shift = (uint8_t)s;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Size window-size targets should have right now: the render size rounded
+ * up to the next step, so small scale changes leave them alone
+ */
+static void currentSize(int* width, int* height) {
+    int nativeWidth, nativeHeight;
+    resolutionScalerGetNativeSize(&nativeWidth, &nativeHeight);
+    if (!resolutionScalerIsEnabled() || nativeWidth <= 0 || nativeHeight <= 0) {
+        *width = nativeWidth;
+        *height = nativeHeight;
+        return;
+    }
+
+    int renderWidth, renderHeight;
+    resolutionScalerGetRenderSize(&renderWidth, &renderHeight);
+
+    int64_t stepsX = ((int64_t)renderWidth * RT_SCALER_SIZE_STEPS + nativeWidth - 1) / nativeWidth;
+    int64_t stepsY = ((int64_t)renderHeight * RT_SCALER_SIZE_STEPS + nativeHeight - 1) / nativeHeight;
+    int64_t steps = stepsX > stepsY ? stepsX : stepsY;
+    if (steps < 1) steps = 1;
+
+    *width = (int)((int64_t)nativeWidth * steps / RT_SCALER_SIZE_STEPS);
+    *height = (int)((int64_t)nativeHeight * steps / RT_SCALER_SIZE_STEPS);
+}
+
+static void updateScaled(void) {
+    int nativeWidth, nativeHeight;
+    resolutionScalerGetNativeSize(&nativeWidth, &nativeHeight);
+    g_rt.scaled = g_rt.width != nativeWidth || g_rt.height != nativeHeight;
+}
+
+static inline int levelSize(int size, int shift) {
+    size >>= shift;
+    return size > 0 ? size : 1;
+}
+
+static ScaledTarget* findTarget(GLuint name, bool renderbuffer) {
+    for (int i = 0; i < g_rt.targetCount; i++) {
+        if (g_rt.targets[i].name == name && g_rt.targets[i].renderbuffer == renderbuffer) {
+            return &g_rt.targets[i];
+        }
+    }
+    return NULL;
+}
+
+static ScaledTarget* addTarget(GLuint name, bool renderbuffer) {
+    ScaledTarget* target = findTarget(name, renderbuffer);
+    if (target) return target;
+
+    if (g_rt.targetCount >= RT_SCALER_MAX_TARGETS) {
+        g_rt.untracked++;
+        return NULL;
+    }
+
+    target = &g_rt.targets[g_rt.targetCount++];
+    memset(target, 0, sizeof(ScaledTarget));
+    target->name = name;
+    target->renderbuffer = renderbuffer;
+    return target;
+}
+
+static void removeTarget(GLuint name, bool renderbuffer) {
+    for (int i = 0; i < g_rt.targetCount; i++) {
+        if (g_rt.targets[i].name == name && g_rt.targets[i].renderbuffer == renderbuffer) {
+            g_rt.targets[i] = g_rt.targets[--g_rt.targetCount];
+            return;
+        }
+    }
+}
+
+static ScaledFramebuffer* findFramebuffer(GLuint framebuffer) {
+    for (int i = 0; i < g_rt.framebufferCount; i++) {
+        if (g_rt.framebuffers[i].framebuffer == framebuffer) return &g_rt.framebuffers[i];
+    }
+    return NULL;
+}
+
+static uint32_t attachmentBits(GLenum attachment) {
+    if (attachment >= GL_COLOR_ATTACHMENT0 && attachment < GL_COLOR_ATTACHMENT0 + 8) {
+        return 1u << (attachment - GL_COLOR_ATTACHMENT0);
+    }
+    switch (attachment) {
+        case GL_DEPTH_ATTACHMENT:           return 1u << 8;
+        case GL_STENCIL_ATTACHMENT:         return 1u << 9;
+        case GL_DEPTH_STENCIL_ATTACHMENT:   return (1u << 8) | (1u << 9);
+    }
+    return 0;
+}
+
+/**
+ * (Re)specify a texture target at its scaled size; the texture is bound
+ */
+static void specifyTexture(const ScaledTarget* target) {
+    for (GLsizei level = 0; level < target->levels; level++) {
+        glTexImage2D(GL_TEXTURE_2D, level, target->internalFormat,
+                     levelSize(target->width, level), levelSize(target->height, level),
+                     0, target->format, target->type, NULL);
+    }
+}
+
+static void specifyRenderbuffer(const ScaledTarget* target) {
+    if (target->samples > 0) {
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, target->samples, target->internalFormat,
+                                         target->width, target->height);
+    } else {
+        glRenderbufferStorage(GL_RENDERBUFFER, target->internalFormat,
+                              target->width, target->height);
+    }
+}
+
+// Tracked binding: texture uploads are too frequent for a glGet each
+static GLuint boundTexture2D(void) {
+    if (g_wrapperCtx) {
+        const GLState* state = &g_wrapperCtx->state;
+        GLint unit = state->activeTextureUnit;
+        if (unit >= 0 && unit < MAX_TEXTURE_UNITS &&
+            state->textureUnits[unit].texture2D != 0xFFFFFFFFu) {
+            return state->textureUnits[unit].texture2D;
+        }
+    }
+
+    // Invalidated state
+    GLint texture = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture);
+    return (GLuint)texture;
+}
+
+static bool unpackBufferBound(void) {
+    GLint unpack = 0;
+    glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpack);
+    return unpack != 0;
+}
+
+// ============================================================================
+// RT Scaler API
+// ============================================================================
+
+void rtScalerInit(void) {
+    memset(&g_rt, 0, sizeof(RTScalerContext));
+    g_rt.initialized = true;
+    currentSize(&g_rt.width, &g_rt.height);
+    updateScaled();
+}
+
+void rtScalerShutdown(void) {
+    memset(&g_rt, 0, sizeof(RTScalerContext));
+}
+
+bool rtScalerTexStorage2D(GLenum target, GLsizei levels, GLenum internalformat,
+                          GLsizei width, GLsizei height) {
+    if (!g_rt.initialized || target != GL_TEXTURE_2D || levels < 1) return false;
+
+    uint8_t shift;
+    if (!matchWindowSize(width, height, &shift)) return false;
+
+    // Immutable storage cannot be resized later: emulate it with mutable levels
+    const StorageFormat* format = findStorageFormat(internalformat);
+    if (!format || unpackBufferBound()) {
+        g_rt.untracked++;
+        return false;
+    }
+
+    GLuint texture = boundTexture2D();
+    if (texture == 0) return false;
+
+    ScaledTarget* scaled = addTarget(texture, false);
+    if (!scaled) return false;
+
+    scaled->shift = shift;
+    scaled->internalFormat = internalformat;
+    scaled->format = format->format;
+    scaled->type = format->type;
+    scaled->levels = levels;
+    scaled->width = levelSize(g_rt.width, shift);
+    scaled->height = levelSize(g_rt.height, shift);
+
+    specifyTexture(scaled);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    return true;
+}
+
+bool rtScalerTexImage2D(GLenum target, GLint level, GLenum internalformat,
+                        GLsizei width, GLsizei height, GLenum format, GLenum type,
+                        const void* pixels) {
+    if (!g_rt.initialized || target != GL_TEXTURE_2D) return false;
+
+    GLuint texture = boundTexture2D();
+    if (texture == 0) return false;
+
+    ScaledTarget* scaled = findTarget(texture, false);
+
+    // Further levels of a scaled target follow its level 0
+    if (scaled && level > 0) {
+        if (pixels || unpackBufferBound()) return false;
+        if (level >= scaled->levels) scaled->levels = level + 1;
+        glTexImage2D(GL_TEXTURE_2D, level, internalformat,
+                     levelSize(scaled->width, level), levelSize(scaled->height, level),
+                     0, format, type, NULL);
+        return true;
+    }
+    if (level != 0) return false;
+
+    // Uploaded data or a different size: not (or no longer) a render target
+    uint8_t shift;
+    if (pixels || !matchWindowSize(width, height, &shift) || unpackBufferBound()) {
+        if (scaled) removeTarget(texture, false);
+        return false;
+    }
+
+    scaled = addTarget(texture, false);
+    if (!scaled) return false;
+
+    scaled->shift = shift;
+    scaled->internalFormat = internalformat;
+    scaled->format = format;
+    scaled->type = type;
+    scaled->levels = 1;
+    scaled->width = levelSize(g_rt.width, shift);
+    scaled->height = levelSize(g_rt.height, shift);
+
+    specifyTexture(scaled);
+    return true;
+}
+
+bool rtScalerRenderbufferStorage(GLsizei samples, GLenum internalformat,
+                                 GLsizei width, GLsizei height) {
+    if (!g_rt.initialized) return false;
+
+    GLint renderbuffer = 0;
+    glGetIntegerv(GL_RENDERBUFFER_BINDING, &renderbuffer);
+    if (renderbuffer == 0) return false;
+
+    uint8_t shift;
+    if (!matchWindowSize(width, height, &shift)) {
+        removeTarget((GLuint)renderbuffer, true);
+        return false;
+    }
+
+    ScaledTarget* scaled = addTarget((GLuint)renderbuffer, true);
+    if (!scaled) return false;
+
+    scaled->shift = shift;
+    scaled->internalFormat = internalformat;
+    scaled->samples = samples;
+    scaled->levels = 1;
+    scaled->width = levelSize(g_rt.width, shift);
+    scaled->height = levelSize(g_rt.height, shift);
+
+    specifyRenderbuffer(scaled);
+    return true;
+}
+
+void rtScalerAttach(GLuint framebuffer, GLenum attachment, GLuint name, bool renderbuffer) {
+    if (!g_rt.initialized || framebuffer == 0) return;
+
+    uint32_t bits = attachmentBits(attachment);
+    if (bits == 0) return;
+
+    bool scaled = name != 0 && findTarget(name, renderbuffer) != NULL;
+    ScaledFramebuffer* entry = findFramebuffer(framebuffer);
+
+    if (scaled) {
+        if (!entry) {
+            if (g_rt.framebufferCount >= RT_SCALER_MAX_FRAMEBUFFERS) {
+                g_rt.untracked++;
+                return;
+            }
+            entry = &g_rt.framebuffers[g_rt.framebufferCount++];
+            entry->framebuffer = framebuffer;
+            entry->scaledAttachments = 0;
+        }
+        entry->scaledAttachments |= bits;
+    } else if (entry) {
+        entry->scaledAttachments &= ~bits;
+        if (entry->scaledAttachments == 0) {
+            *entry = g_rt.framebuffers[--g_rt.framebufferCount];
+        }
+    }
+}
+
+void rtScalerForgetTextures(GLsizei n, const GLuint* textures) {
+    if (!g_rt.initialized || !textures) return;
+    for (GLsizei i = 0; i < n; i++) removeTarget(textures[i], false);
+}
+
+void rtScalerForgetRenderbuffers(GLsizei n, const GLuint* renderbuffers) {
+    if (!g_rt.initialized || !renderbuffers) return;
+    for (GLsizei i = 0; i < n; i++) removeTarget(renderbuffers[i], true);
+}
+
+void rtScalerForgetFramebuffers(GLsizei n, const GLuint* framebuffers) {
+    if (!g_rt.initialized || !framebuffers) return;
+
+    for (GLsizei i = 0; i < n; i++) {
+        ScaledFramebuffer* entry = findFramebuffer(framebuffers[i]);
+        if (entry) *entry = g_rt.framebuffers[--g_rt.framebufferCount];
+    }
+}
+
+bool rtScalerIsScaled(GLuint framebuffer) {
+    if (framebuffer == 0 || g_rt.framebufferCount == 0 || !g_rt.scaled) return false;
+    return findFramebuffer(framebuffer) != NULL;
+}
+
+void rtScalerMapRect(GLint rect[4]) {
+    int nativeWidth, nativeHeight;
+    resolutionScalerGetNativeSize(&nativeWidth, &nativeHeight);
+    if (nativeWidth <= 0 || nativeHeight <= 0) return;
+
+    // Round outwards, as the default framebuffer's rects are
+    int64_t nw = nativeWidth, nh = nativeHeight;
+    int64_t tw = g_rt.width, th = g_rt.height;
+
+    int64_t x0 = (int64_t)rect[0] * tw / nw;
+    int64_t y0 = (int64_t)rect[1] * th / nh;
+    int64_t x1 = ((int64_t)(rect[0] + rect[2]) * tw + nw - 1) / nw;
+    int64_t y1 = ((int64_t)(rect[1] + rect[3]) * th + nh - 1) / nh;
+
+    rect[0] = (GLint)x0;
+    rect[1] = (GLint)y0;
+    rect[2] = (GLint)(x1 - x0);
+    rect[3] = (GLint)(y1 - y0);
+}
+
+void rtScalerSync(void) {
+    if (!g_rt.initialized) return;
+
+    if (g_rt.cooldown > 0) g_rt.cooldown--;
+
+    int width, height;
+    currentSize(&width, &height);
+    if (width == g_rt.width && height == g_rt.height) return;
+
+    // Rects follow the targets' size, so holding the old one stays correct
+    if (g_rt.cooldown > 0 && g_rt.targetCount > 0) return;
+
+    g_rt.width = width;
+    g_rt.height = height;
+    updateScaled();
+    if (g_rt.targetCount == 0) return;
+
+    g_rt.cooldown = RT_SCALER_RESIZE_FRAMES;
+    g_rt.resizes++;
+
+    TRACE_SCOPE("rt_scaler_resize");
+
+    // Between frames, but the app's bindings still have to survive
+    GLint texture = 0, renderbuffer = 0, unpack = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture);
+    glGetIntegerv(GL_RENDERBUFFER_BINDING, &renderbuffer);
+    glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpack);
+    if (unpack) glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    for (int i = 0; i < g_rt.targetCount; i++) {
+        ScaledTarget* target = &g_rt.targets[i];
+        target->width = levelSize(width, target->shift);
+        target->height = levelSize(height, target->shift);
+
+        if (target->renderbuffer) {
+            glBindRenderbuffer(GL_RENDERBUFFER, target->name);
+            specifyRenderbuffer(target);
+        } else {
+            glBindTexture(GL_TEXTURE_2D, target->name);
+            specifyTexture(target);
+        }
+        g_rt.reallocations++;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, (GLuint)texture);
+    glBindRenderbuffer(GL_RENDERBUFFER, (GLuint)renderbuffer);
+    if (unpack) glBindBuffer(GL_PIXEL_UNPACK_BUFFER, (GLuint)unpack);
+
+    velocityLogDebug("Resized %d render targets to %dx%d", g_rt.targetCount, width, height);
+}
+
+void rtScalerGetStats(RTScalerStats* stats) {
+    if (!stats) return;
+
+    memset(stats, 0, sizeof(RTScalerStats));
+    stats->targets = (uint32_t)g_rt.targetCount;
+    stats->framebuffers = (uint32_t)g_rt.framebufferCount;
+    stats->width = g_rt.width;
+    stats->height = g_rt.height;
+    stats->reallocations = g_rt.reallocations;
+    stats->resizes = g_rt.resizes;
+    stats->untracked = g_rt.untracked;
+}
@@ -0,0 +1,128 @@
+/**
+ * RT Scaler - Dynamic resolution for app-created render targets
+ * Textures and renderbuffers allocated at the window size (or a half or
+ * quarter of it) without data are treated as render targets and sized by
+ * the current resolution scale. Framebuffers with such attachments get
+ * their viewport, scissor and blit rects mapped like the default
+ * framebuffer, so G-buffer, bloom and shadow passes of shaderpacks scale
+ * with the rest of the frame.
+ *
+ * Re-specifying every target is a burst of reallocations, so targets don't
+ * follow each scale step: their size is the render size rounded up to a
+ * quarter of the window size, and changes at most once per cooldown. Rects
+ * on their framebuffers are mapped by the targets' own size, which can be
+ * a little larger than the default framebuffer's subrect; passes that
+ * texelFetch a target at gl_FragCoord of the default framebuffer see that
+ * difference.
+ */
+
+#ifndef RT_SCALER_H
+#define RT_SCALER_H
+
+#include <GLES3/gl32.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define RT_SCALER_MAX_TARGETS       128
+#define RT_SCALER_MAX_FRAMEBUFFERS  64
+#define RT_SCALER_MAX_SHIFT         2       // Window size down to 1/4
+#define RT_SCALER_SIZE_STEPS        4       // Target sizes are multiples of 1/4 window size
+#define RT_SCALER_RESIZE_FRAMES     120     // Minimum frames between two resizes
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * RT scaler statistics
+ */
+typedef struct RTScalerStats {
+    uint32_t targets;            // Tracked textures and renderbuffers
+    uint32_t framebuffers;       // Framebuffers with a scaled attachment
+    int width;                   // Current size of window-size targets
+    int height;
+    uint32_t reallocations;      // Targets re-specified for a scale change
+    uint32_t resizes;            // Size changes applied to all targets
+    uint32_t untracked;          // Window-size targets skipped (table full, unknown format)
+} RTScalerStats;
+
+// ============================================================================
+// RT Scaler API
+// ============================================================================
+
+/**
+ * Initialize render target scaling (requires GL context)
+ */
+void rtScalerInit(void);
+
+/**
+ * Shutdown and forget tracked targets
+ */
+void rtScalerShutdown(void);
+
+/**
+ * Allocate the bound 2D texture scaled if it is a window-size render target,
+ * true if handled (emulated with mutable levels so it can be resized)
+ */
+bool rtScalerTexStorage2D(GLenum target, GLsizei levels, GLenum internalformat,
+                          GLsizei width, GLsizei height);
+
+/**
+ * Same for glTexImage2D level 0 without data
+ */
+bool rtScalerTexImage2D(GLenum target, GLint level, GLenum internalformat,
+                        GLsizei width, GLsizei height, GLenum format, GLenum type,
+                        const void* pixels);
+
+/**
+ * Same for the bound renderbuffer
+ */
+bool rtScalerRenderbufferStorage(GLsizei samples, GLenum internalformat,
+                                 GLsizei width, GLsizei height);
+
+/**
+ * Note an attachment change on a framebuffer
+ */
+void rtScalerAttach(GLuint framebuffer, GLenum attachment, GLuint name, bool renderbuffer);
+
+/**
+ * Forget deleted objects
+ */
+void rtScalerForgetTextures(GLsizei n, const GLuint* textures);
+void rtScalerForgetRenderbuffers(GLsizei n, const GLuint* renderbuffers);
+void rtScalerForgetFramebuffers(GLsizei n, const GLuint* framebuffers);
+
+/**
+ * Check if a framebuffer renders into scaled targets
+ */
+bool rtScalerIsScaled(GLuint framebuffer);
+
+/**
+ * Map a window-space rect (x, y, w, h) into scaled targets
+ */
+void rtScalerMapRect(GLint rect[4]);
+
+/**
+ * Resize targets to the step covering the current scale, unless they were
+ * resized recently (call between frames)
+ */
+void rtScalerSync(void);
+
+/**
+ * Get statistics
+ */
+void rtScalerGetStats(RTScalerStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RT_SCALER_H
@@ -0,0 +1,222 @@
+/**
+ * UI Split - Implementation
+ */
+
+#include "ui_split.h"
+#include "../core/gl_wrapper.h"
+#include "../utils/log.h"
+
+#include <string.h>
+#include <math.h>
+
+// ============================================================================
+// Types
+// ============================================================================
+
+#define PROGRAM_EMPTY       0u
+#define PROGRAM_TOMBSTONE   0xFFFFFFFFu
+
+typedef struct UISplitContext {
+    bool initialized;
+    UISplitMode mode;
+
+    // Programs that received a perspective matrix (open addressing)
+    GLuint scenePrograms[UI_SPLIT_PROGRAM_SLOTS];
+
+    // Per frame
+    bool markerPending;
+    bool split;
+    bool splitByMarker;
+    uint32_t draws;              // Draws into the default framebuffer
+    uint32_t sceneDraws;         // ... with depth test on
+
+    // Stats
+    bool splitLastFrame;
+    uint32_t splitDrawIndex;
+    uint32_t framesSplit;
+    uint32_t markerSplits;
+    uint32_t mispredictions;
+    uint32_t backoffFrames;
+} UISplitContext;
+
+static UISplitContext g_split = {0};
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static inline uint32_t programSlot(GLuint program) {
+    return (program * 2654435761u) & (UI_SPLIT_PROGRAM_SLOTS - 1);
+}
+
+static bool isSceneProgram(GLuint program) {
+    uint32_t slot = programSlot(program);
+    for (int i = 0; i < UI_SPLIT_PROGRAM_SLOTS; i++) {
+        GLuint key = g_split.scenePrograms[slot];
+        if (key == program) return true;
+        if (key == PROGRAM_EMPTY) return false;
+        slot = (slot + 1) & (UI_SPLIT_PROGRAM_SLOTS - 1);
+    }
+    return false;
+}
+
+static void markSceneProgram(GLuint program) {
+    if (program == PROGRAM_EMPTY || program == PROGRAM_TOMBSTONE) return;
+    if (isSceneProgram(program)) return;
+
+    // Full table: the program just stays eligible for UI detection
+    uint32_t slot = programSlot(program);
+    for (int i = 0; i < UI_SPLIT_PROGRAM_SLOTS; i++) {
+        GLuint key = g_split.scenePrograms[slot];
+        if (key == PROGRAM_EMPTY || key == PROGRAM_TOMBSTONE) {
+            g_split.scenePrograms[slot] = program;
+            return;
+        }
+        slot = (slot + 1) & (UI_SPLIT_PROGRAM_SLOTS - 1);
+    }
+}
+
+/**
+ * Perspective projections (and any MVP built from one) have a non-trivial
+ * bottom row; orthographic UI transforms keep it at (0, 0, 0, 1)
+ */
+static bool isPerspective(const GLfloat* m, bool transpose) {
+    // Bottom row is m[3], m[7], m[11], m[15] column-major
+    float w0 = transpose ? m[12] : m[3];
+    float w1 = transpose ? m[13] : m[7];
+    float w2 = transpose ? m[14] : m[11];
+    float w3 = m[15];
+
+    return fabsf(w2) > 1e-4f || fabsf(w0) > 1e-4f || fabsf(w1) > 1e-4f ||
+           fabsf(w3 - 1.0f) > 1e-4f;
+}
+
+static inline bool isAlphaBlend(const GLBlendState* blend) {
+    return blend->enabled &&
+           (blend->srcRGB == GL_SRC_ALPHA || blend->srcRGB == GL_ONE) &&
+           blend->dstRGB == GL_ONE_MINUS_SRC_ALPHA;
+}
+
+// ============================================================================
+// UI Split API
+// ============================================================================
+
+void uiSplitInit(UISplitMode mode) {
+    memset(&g_split, 0, sizeof(UISplitContext));
+    g_split.initialized = true;
+    g_split.mode = mode;
+
+    velocityLogInfo("UI split initialized: mode %d", mode);
+}
+
+void uiSplitShutdown(void) {
+    memset(&g_split, 0, sizeof(UISplitContext));
+}
+
+void uiSplitSetMode(UISplitMode mode) {
+    g_split.mode = mode;
+    g_split.backoffFrames = 0;
+}
+
+UISplitMode uiSplitGetMode(void) {
+    return g_split.mode;
+}
+
+void uiSplitMarkUI(void) {
+    if (g_split.mode == UI_SPLIT_OFF) return;
+    g_split.markerPending = true;
+}
+
+void uiSplitNoteMatrix(GLuint program, const GLfloat* values, GLsizei count, bool transpose) {
+    if (!g_split.initialized || g_split.mode != UI_SPLIT_AUTO || !values) return;
+
+    for (GLsizei i = 0; i < count; i++) {
+        if (isPerspective(values + i * 16, transpose)) {
+            markSceneProgram(program);
+            return;
+        }
+    }
+}
+
+void uiSplitForgetProgram(GLuint program) {
+    uint32_t slot = programSlot(program);
+    for (int i = 0; i < UI_SPLIT_PROGRAM_SLOTS; i++) {
+        GLuint key = g_split.scenePrograms[slot];
+        if (key == PROGRAM_EMPTY) return;
+        if (key == program) {
+            g_split.scenePrograms[slot] = PROGRAM_TOMBSTONE;
+            return;
+        }
+        slot = (slot + 1) & (UI_SPLIT_PROGRAM_SLOTS - 1);
+    }
+}
+
+bool uiSplitBeforeDraw(void) {
+    if (!g_split.initialized || g_split.mode == UI_SPLIT_OFF || !g_wrapperCtx) return false;
+
+    const GLState* state = &g_wrapperCtx->state;
+    uint32_t draw = g_split.draws++;
+
+    if (g_split.split) {
+        // The scene carried on after a guessed split: stop guessing for a while
+        if (!g_split.splitByMarker && state->depth.testEnabled) {
+            g_split.mispredictions++;
+            if (g_split.backoffFrames == 0) {
+                velocityLogWarn("UI split guessed too early (draw %u), pausing detection",
+                                g_split.splitDrawIndex);
+            }
+            g_split.backoffFrames = UI_SPLIT_BACKOFF_FRAMES;
+        }
+        return false;
+    }
+
+    bool start = false;
+    if (g_split.markerPending) {
+        g_split.splitByMarker = true;
+        g_split.markerSplits++;
+        start = true;
+    } else if (g_split.mode == UI_SPLIT_AUTO && g_split.backoffFrames == 0) {
+        if (state->depth.testEnabled) {
+            g_split.sceneDraws++;
+        } else {
+            start = g_split.sceneDraws >= UI_SPLIT_MIN_SCENE_DRAWS &&
+                    isAlphaBlend(&state->blend) &&
+                    !isSceneProgram(state->currentProgram);
+        }
+    }
+
+    if (start) {
+        g_split.split = true;
+        g_split.splitDrawIndex = draw;
+        g_split.framesSplit++;
+    }
+    return start;
+}
+
+bool uiSplitIsActive(void) {
+    return g_split.split;
+}
+
+void uiSplitEndFrame(void) {
+    g_split.splitLastFrame = g_split.split;
+    if (g_split.backoffFrames > 0) g_split.backoffFrames--;
+
+    g_split.markerPending = false;
+    g_split.split = false;
+    g_split.splitByMarker = false;
+    g_split.draws = 0;
+    g_split.sceneDraws = 0;
+}
+
+void uiSplitGetStats(UISplitStats* stats) {
+    if (!stats) return;
+
+    memset(stats, 0, sizeof(UISplitStats));
+    stats->mode = g_split.mode;
+    stats->splitLastFrame = g_split.splitLastFrame;
+    stats->splitDrawIndex = g_split.splitDrawIndex;
+    stats->framesSplit = g_split.framesSplit;
+    stats->markerSplits = g_split.markerSplits;
+    stats->mispredictions = g_split.mispredictions;
+    stats->backoffFrames = g_split.backoffFrames;
+}
@@ -0,0 +1,118 @@
+/**
+ * UI Split - Native-resolution UI on top of a scaled 3D frame
+ * Finds the point in a frame where the app stops drawing the 3D scene and
+ * starts drawing UI into the default framebuffer, either from an explicit
+ * marker or from heuristics (depth test off, alpha blending, a program that
+ * never received a perspective matrix). The scaler resolves there and the
+ * UI draws to the backbuffer at native resolution.
+ */
+
+#ifndef UI_SPLIT_H
+#define UI_SPLIT_H
+
+#include <GLES3/gl32.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define UI_SPLIT_PROGRAM_SLOTS      256     // Programs remembered as 3D (power of 2)
+#define UI_SPLIT_MIN_SCENE_DRAWS    4       // Depth-tested draws before UI can start
+#define UI_SPLIT_BACKOFF_FRAMES     600     // Heuristics paused after a wrong split
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * Detection mode (values match VelocityNativeUIMode)
+ */
+typedef enum UISplitMode {
+    UI_SPLIT_OFF = 0,
+    UI_SPLIT_MARKER,            // Only velocityBeginUI() splits the frame
+    UI_SPLIT_AUTO               // Marker or heuristics
+} UISplitMode;
+
+/**
+ * Split statistics
+ */
+typedef struct UISplitStats {
+    UISplitMode mode;
+    bool splitLastFrame;
+    uint32_t splitDrawIndex;     // Default-framebuffer draw that started the UI
+    uint32_t framesSplit;
+    uint32_t markerSplits;
+    uint32_t mispredictions;     // Depth-tested draws seen after a heuristic split
+    uint32_t backoffFrames;      // Frames left before heuristics resume
+} UISplitStats;
+
+// ============================================================================
+// UI Split API
+// ============================================================================
+
+/**
+ * Initialize detection
+ */
+void uiSplitInit(UISplitMode mode);
+
+/**
+ * Shutdown detection
+ */
+void uiSplitShutdown(void);
+
+/**
+ * Set detection mode
+ */
+void uiSplitSetMode(UISplitMode mode);
+
+/**
+ * Get detection mode
+ */
+UISplitMode uiSplitGetMode(void);
+
+/**
+ * Mark the start of UI rendering; takes effect at the next default-framebuffer draw
+ */
+void uiSplitMarkUI(void);
+
+/**
+ * Note a mat4 uniform upload to a program (perspective matrices mark it as 3D)
+ */
+void uiSplitNoteMatrix(GLuint program, const GLfloat* values, GLsizei count, bool transpose);
+
+/**
+ * Forget a deleted program
+ */
+void uiSplitForgetProgram(GLuint program);
+
+/**
+ * Classify a draw into the default framebuffer, true if the UI starts here
+ */
+bool uiSplitBeforeDraw(void);
+
+/**
+ * Check if this frame has already been split
+ */
+bool uiSplitIsActive(void);
+
+/**
+ * Reset per-frame state (call after the frame is presented)
+ */
+void uiSplitEndFrame(void);
+
+/**
+ * Get split statistics
+ */
+void uiSplitGetStats(UISplitStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UI_SPLIT_H
@@ -0,0 +1,337 @@
+/**
+ * Call Profiler - Implementation
+ * Each thread owns a counter block that only it writes. The frame-end merge
+ * reads those blocks with relaxed atomics and folds the deltas into the
+ * shared tables, so the hot path never takes a lock. Wrappers on other
+ * threads may be mid-call at shutdown, so the registry and its blocks live
+ * until process exit and are picked up again by the next init.
+ */
+
+#include "call_profiler.h"
+#include "../utils/log.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+// ============================================================================
+// Types
+// ============================================================================
+
+typedef struct ThreadCounters {
+    // Written by the owning thread only
+    uint64_t calls[PROFILE_CALL_COUNT];
+    uint64_t samples[PROFILE_CALL_COUNT];
+    uint64_t totalNs[PROFILE_CALL_COUNT];
+    uint64_t driverNs[PROFILE_CALL_COUNT];
+    uint32_t tick;
+
+    // Written by the merge only: counter values at the previous merge
+    uint64_t mergedCalls[PROFILE_CALL_COUNT];
+    uint64_t mergedSamples[PROFILE_CALL_COUNT];
+    uint64_t mergedTotalNs[PROFILE_CALL_COUNT];
+    uint64_t mergedDriverNs[PROFILE_CALL_COUNT];
+
+    struct ThreadCounters* next;
+} ThreadCounters;
+
+typedef struct CallProfilerContext {
+    pthread_mutex_t mutex;
+    ThreadCounters* threads;
+    int threadCount;
+
+    // Merged tables
+    uint64_t frameCalls[PROFILE_CALL_COUNT];
+    uint64_t totalCalls[PROFILE_CALL_COUNT];
+    uint64_t samples[PROFILE_CALL_COUNT];
+    uint64_t totalNs[PROFILE_CALL_COUNT];
+    uint64_t driverNs[PROFILE_CALL_COUNT];
+    uint64_t frames;
+} CallProfilerContext;
+
+static CallProfilerContext* g_callProfiler = NULL;
+volatile bool g_callProfilerActive = false;
+
+static _Thread_local ThreadCounters* t_counters = NULL;
+
+static const char* const ENTRY_NAMES[PROFILE_CALL_COUNT] = {
+#define CALL_PROFILER_NAME(name) "gl" #name,
+    CALL_PROFILER_ENTRY_POINTS(CALL_PROFILER_NAME)
+#undef CALL_PROFILER_NAME
+};
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+uint64_t callProfilerNowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline void counterAdd(uint64_t* counter, uint64_t value) {
+    // Single writer: a relaxed store is enough for the merge to see a torn-free value
+    __atomic_store_n(counter, *counter + value, __ATOMIC_RELAXED);
+}
+
+static inline uint64_t counterLoad(const uint64_t* counter) {
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+static ThreadCounters* registerThread(void) {
+    if (!g_callProfiler) return NULL;
+
+    // Never freed, so kept out of the leak tracker
+    ThreadCounters* counters = (ThreadCounters*)calloc(1, sizeof(ThreadCounters));
+    if (!counters) return NULL;
+
+    pthread_mutex_lock(&g_callProfiler->mutex);
+    counters->next = g_callProfiler->threads;
+    g_callProfiler->threads = counters;
+    g_callProfiler->threadCount++;
+    pthread_mutex_unlock(&g_callProfiler->mutex);
+
+    t_counters = counters;
+    return counters;
+}
+
+// ============================================================================
+// Hot Path
+// ============================================================================
+
+void callProfilerScopeEnter(CallProfilerScope* scope) {
+    ThreadCounters* counters = t_counters;
+    if (!counters) {
+        counters = registerThread();
+        if (!counters) return;
+    }
+
+    counterAdd(&counters->calls[scope->entry], 1);
+
+    if ((++counters->tick & CALL_PROFILER_SAMPLE_MASK) == 0) {
+        scope->startNs = callProfilerNowNs();
+    }
+}
+
+void callProfilerScopeCommit(CallProfilerScope* scope) {
+    ThreadCounters* counters = t_counters;
+    if (!counters) return;
+
+    uint64_t elapsed = callProfilerNowNs() - scope->startNs;
+    uint32_t entry = scope->entry;
+
+    counterAdd(&counters->samples[entry], 1);
+    counterAdd(&counters->totalNs[entry], elapsed);
+    counterAdd(&counters->driverNs[entry], scope->driverNs);
+}
+
+// ============================================================================
+// Initialization
+// ============================================================================
+
+bool callProfilerInit(bool enabled) {
+    if (g_callProfiler) {
+        callProfilerSetEnabled(enabled);
+        return true;
+    }
+
+    g_callProfiler = (CallProfilerContext*)calloc(1, sizeof(CallProfilerContext));
+    if (!g_callProfiler) {
+        velocityLogError("Failed to allocate call profiler context");
+        return false;
+    }
+
+    pthread_mutex_init(&g_callProfiler->mutex, NULL);
+    callProfilerSetEnabled(enabled);
+
+    velocityLogInfo("Call profiler initialized (%d entry points, 1/%d sampling, %s)",
+                    PROFILE_CALL_COUNT, CALL_PROFILER_SAMPLE_MASK + 1,
+                    enabled ? "on" : "off");
+    return true;
+}
+
+void callProfilerShutdown(void) {
+    if (!g_callProfiler) return;
+
+    // Calls still in flight land in blocks that stay valid. Folding them in
+    // before the reset lets the next init start from zero.
+    g_callProfilerActive = false;
+    callProfilerEndFrame();
+    callProfilerReset();
+}
+
+void callProfilerSetEnabled(bool enabled) {
+#ifdef VELOCITY_PROFILING
+    g_callProfilerActive = enabled && g_callProfiler != NULL;
+#else
+    (void)enabled;
+    g_callProfilerActive = false;
+#endif
+}
+
+bool callProfilerIsEnabled(void) {
+    return g_callProfilerActive;
+}
+
+// ============================================================================
+// Frame Merge
+// ============================================================================
+
+void callProfilerEndFrame(void) {
+    if (!g_callProfiler) return;
+
+    pthread_mutex_lock(&g_callProfiler->mutex);
+
+    memset(g_callProfiler->frameCalls, 0, sizeof(g_callProfiler->frameCalls));
+
+    for (ThreadCounters* c = g_callProfiler->threads; c; c = c->next) {
+        for (int i = 0; i < PROFILE_CALL_COUNT; i++) {
+            uint64_t calls = counterLoad(&c->calls[i]);
+            uint64_t samples = counterLoad(&c->samples[i]);
+            uint64_t totalNs = counterLoad(&c->totalNs[i]);
+            uint64_t driverNs = counterLoad(&c->driverNs[i]);
+
+            uint64_t deltaCalls = calls - c->mergedCalls[i];
+            g_callProfiler->frameCalls[i] += deltaCalls;
+            g_callProfiler->totalCalls[i] += deltaCalls;
+            g_callProfiler->samples[i] += samples - c->mergedSamples[i];
+            g_callProfiler->totalNs[i] += totalNs - c->mergedTotalNs[i];
+            g_callProfiler->driverNs[i] += driverNs - c->mergedDriverNs[i];
+
+            c->mergedCalls[i] = calls;
+            c->mergedSamples[i] = samples;
+            c->mergedTotalNs[i] = totalNs;
+            c->mergedDriverNs[i] = driverNs;
+        }
+    }
+
+    g_callProfiler->frames++;
+
+    pthread_mutex_unlock(&g_callProfiler->mutex);
+}
+
+// ============================================================================
+// Statistics
+// ============================================================================
+
+static int compareEntryStats(const void* a, const void* b) {
+    const CallProfilerEntryStats* ea = (const CallProfilerEntryStats*)a;
+    const CallProfilerEntryStats* eb = (const CallProfilerEntryStats*)b;
+
+    if (ea->frameCpuMs != eb->frameCpuMs) {
+        return ea->frameCpuMs < eb->frameCpuMs ? 1 : -1;
+    }
+    if (ea->totalCalls != eb->totalCalls) {
+        return ea->totalCalls < eb->totalCalls ? 1 : -1;
+    }
+    return strcmp(ea->name, eb->name);
+}
+
+int callProfilerGetStats(CallProfilerEntryStats* out, int maxEntries) {
+    if (!g_callProfiler || !out || maxEntries <= 0) return 0;
+
+    CallProfilerEntryStats all[PROFILE_CALL_COUNT];
+    int count = 0;
+
+    pthread_mutex_lock(&g_callProfiler->mutex);
+
+    for (int i = 0; i < PROFILE_CALL_COUNT; i++) {
+        if (g_callProfiler->totalCalls[i] == 0) continue;
+
+        CallProfilerEntryStats* e = &all[count++];
+        uint64_t samples = g_callProfiler->samples[i];
+        double avgTotal = samples ? (double)g_callProfiler->totalNs[i] / samples : 0.0;
+        double avgDriver = samples ? (double)g_callProfiler->driverNs[i] / samples : 0.0;
+
+        e->name = ENTRY_NAMES[i];
+        e->frameCalls = g_callProfiler->frameCalls[i];
+        e->totalCalls = g_callProfiler->totalCalls[i];
+        e->sampledCalls = samples;
+        e->avgDriverNs = avgDriver;
+        e->avgWrapperNs = avgTotal > avgDriver ? avgTotal - avgDriver : 0.0;
+        e->frameCpuMs = e->frameCalls * avgTotal / 1000000.0;
+    }
+
+    pthread_mutex_unlock(&g_callProfiler->mutex);
+
+    qsort(all, count, sizeof(CallProfilerEntryStats), compareEntryStats);
+
+    if (count > maxEntries) count = maxEntries;
+    memcpy(out, all, count * sizeof(CallProfilerEntryStats));
+    return count;
+}
+
+bool callProfilerDump(const char* path) {
+    if (!g_callProfiler) return false;
+
+    CallProfilerEntryStats stats[PROFILE_CALL_COUNT];
+    int count = callProfilerGetStats(stats, PROFILE_CALL_COUNT);
+
+    double frameTotalMs = 0.0;
+    for (int i = 0; i < count; i++) {
+        frameTotalMs += stats[i].frameCpuMs;
+    }
+
+    pthread_mutex_lock(&g_callProfiler->mutex);
+    uint64_t frames = g_callProfiler->frames;
+    int threadCount = g_callProfiler->threadCount;
+    pthread_mutex_unlock(&g_callProfiler->mutex);
+
+    FILE* file = NULL;
+    if (path) {
+        file = fopen(path, "w");
+        if (!file) {
+            velocityLogError("Failed to open call profile dump: %s", path);
+            return false;
+        }
+    }
+
+    static const char* HEADER =
+        "%-28s %10s %12s %10s %12s %12s %10s %6s";
+    static const char* ROW =
+        "%-28s %10llu %12llu %10llu %12.0f %12.0f %10.3f %5.1f%%";
+
+    char line[256];
+    snprintf(line, sizeof(line), HEADER, "entry point", "calls/frm", "calls",
+             "sampled", "wrapper ns", "driver ns", "ms/frame", "share");
+    if (file) fprintf(file, "%s\n", line); else velocityLogInfo("%s", line);
+
+    for (int i = 0; i < count; i++) {
+        const CallProfilerEntryStats* e = &stats[i];
+        double share = frameTotalMs > 0.0 ? e->frameCpuMs * 100.0 / frameTotalMs : 0.0;
+
+        snprintf(line, sizeof(line), ROW, e->name,
+                 (unsigned long long)e->frameCalls,
+                 (unsigned long long)e->totalCalls,
+                 (unsigned long long)e->sampledCalls,
+                 e->avgWrapperNs, e->avgDriverNs, e->frameCpuMs, share);
+        if (file) fprintf(file, "%s\n", line); else velocityLogInfo("%s", line);
+    }
+
+    snprintf(line, sizeof(line), "frames merged: %llu, threads: %d, est. %.3f ms/frame in GL calls",
+             (unsigned long long)frames, threadCount, frameTotalMs);
+    if (file) fprintf(file, "%s\n", line); else velocityLogInfo("%s", line);
+
+    if (file) {
+        fclose(file);
+        velocityLogInfo("Call profile written to %s", path);
+    }
+
+    return true;
+}
+
+void callProfilerReset(void) {
+    if (!g_callProfiler) return;
+
+    pthread_mutex_lock(&g_callProfiler->mutex);
+    memset(g_callProfiler->frameCalls, 0, sizeof(g_callProfiler->frameCalls));
+    memset(g_callProfiler->totalCalls, 0, sizeof(g_callProfiler->totalCalls));
+    memset(g_callProfiler->samples, 0, sizeof(g_callProfiler->samples));
+    memset(g_callProfiler->totalNs, 0, sizeof(g_callProfiler->totalNs));
+    memset(g_callProfiler->driverNs, 0, sizeof(g_callProfiler->driverNs));
+    g_callProfiler->frames = 0;
+    pthread_mutex_unlock(&g_callProfiler->mutex);
+}
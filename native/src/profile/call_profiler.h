@@ -0,0 +1,367 @@
+/**
+ * Call Profiler - Per-entry-point call counters and sampled timing
+ * Counts every vgl* call in thread-local tables and times a sample of them,
+ * splitting wrapper time from the time spent inside the driver call
+ */
+
+#ifndef CALL_PROFILER_H
+#define CALL_PROFILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Profiled Entry Points
+// ============================================================================
+
+#define CALL_PROFILER_ENTRY_POINTS(X) \
+    X(DrawArrays) \
+    X(DrawElements) \
+    X(DrawArraysInstanced) \
+    X(DrawElementsInstanced) \
+    X(MultiDrawArrays) \
+    X(MultiDrawElements) \
+    X(DrawRangeElements) \
+    X(DrawElementsBaseVertex) \
+    X(DrawRangeElementsBaseVertex) \
+    X(DrawElementsInstancedBaseVertex) \
+    X(DrawArraysIndirect) \
+    X(DrawElementsIndirect) \
+    X(CreateShader) \
+    X(ShaderSource) \
+    X(CompileShader) \
+    X(DeleteShader) \
+    X(CreateProgram) \
+    X(AttachShader) \
+    X(DetachShader) \
+    X(LinkProgram) \
+    X(UseProgram) \
+    X(DeleteProgram) \
+    X(GetProgramBinary) \
+    X(ProgramBinary) \
+    X(Uniform1i) \
+    X(Uniform1f) \
+    X(Uniform2f) \
+    X(Uniform3f) \
+    X(Uniform4f) \
+    X(UniformMatrix4fv) \
+    X(Uniform2i) \
+    X(Uniform3i) \
+    X(Uniform4i) \
+    X(Uniform1iv) \
+    X(Uniform2iv) \
+    X(Uniform3iv) \
+    X(Uniform4iv) \
+    X(Uniform1fv) \
+    X(Uniform2fv) \
+    X(Uniform3fv) \
+    X(Uniform4fv) \
+    X(UniformMatrix2fv) \
+    X(UniformMatrix3fv) \
+    X(UniformMatrix2x3fv) \
+    X(UniformMatrix3x2fv) \
+    X(UniformMatrix2x4fv) \
+    X(UniformMatrix4x2fv) \
+    X(UniformMatrix3x4fv) \
+    X(UniformMatrix4x3fv) \
+    X(Uniform1ui) \
+    X(Uniform2ui) \
+    X(Uniform3ui) \
+    X(Uniform4ui) \
+    X(Uniform1uiv) \
+    X(Uniform2uiv) \
+    X(Uniform3uiv) \
+    X(Uniform4uiv) \
+    X(ProgramUniform1i) \
+    X(ProgramUniform1f) \
+    X(ProgramUniform4fv) \
+    X(ProgramUniformMatrix4fv) \
+    X(BindProgramPipeline) \
+    X(UseProgramStages) \
+    X(UniformBlockBinding) \
+    X(GenTextures) \
+    X(BindTexture) \
+    X(TexImage2D) \
+    X(TexSubImage2D) \
+    X(TexImage3D) \
+    X(TexStorage2D) \
+    X(DeleteTextures) \
+    X(IsTexture) \
+    X(GenerateMipmap) \
+    X(ActiveTexture) \
+    X(TexParameteri) \
+    X(TexParameterf) \
+    X(TexParameteriv) \
+    X(TexParameterfv) \
+    X(TexStorage3D) \
+    X(TexSubImage3D) \
+    X(CompressedTexImage2D) \
+    X(CompressedTexImage3D) \
+    X(CompressedTexSubImage2D) \
+    X(CompressedTexSubImage3D) \
+    X(BindSampler) \
+    X(SamplerParameteri) \
+    X(SamplerParameterf) \
+    X(SamplerParameteriv) \
+    X(SamplerParameterfv) \
+    X(GenBuffers) \
+    X(DeleteBuffers) \
+    X(IsBuffer) \
+    X(BindBuffer) \
+    X(BufferData) \
+    X(BufferSubData) \
+    X(MapBufferRange) \
+    X(UnmapBuffer) \
+    X(CopyBufferSubData) \
+    X(BindBufferBase) \
+    X(BindBufferRange) \
+    X(BindVertexArray) \
+    X(GenVertexArrays) \
+    X(DeleteVertexArrays) \
+    X(EnableVertexAttribArray) \
+    X(DisableVertexAttribArray) \
+    X(VertexAttribPointer) \
+    X(VertexAttribDivisor) \
+    X(VertexAttrib1f) \
+    X(VertexAttrib2f) \
+    X(VertexAttrib3f) \
+    X(VertexAttrib4f) \
+    X(VertexAttrib1fv) \
+    X(VertexAttrib2fv) \
+    X(VertexAttrib3fv) \
+    X(VertexAttrib4fv) \
+    X(VertexAttribIPointer) \
+    X(GetVertexAttribiv) \
+    X(GetVertexAttribPointerv) \
+    X(VertexAttribI4i) \
+    X(VertexAttribI4ui) \
+    X(VertexAttribFormat) \
+    X(VertexAttribIFormat) \
+    X(VertexAttribBinding) \
+    X(BindVertexBuffer) \
+    X(VertexBindingDivisor) \
+    X(BindFramebuffer) \
+    X(FramebufferTexture2D) \
+    X(FramebufferRenderbuffer) \
+    X(FramebufferTextureLayer) \
+    X(FramebufferTexture) \
+    X(FramebufferParameteri) \
+    X(GetFramebufferAttachmentParameteriv) \
+    X(GenFramebuffers) \
+    X(DeleteFramebuffers) \
+    X(RenderbufferStorage) \
+    X(RenderbufferStorageMultisample) \
+    X(GenRenderbuffers) \
+    X(DeleteRenderbuffers) \
+    X(BindRenderbuffer) \
+    X(CheckFramebufferStatus) \
+    X(DrawBuffers) \
+    X(ReadBuffer) \
+    X(BlitFramebuffer) \
+    X(ReadPixels) \
+    X(ReadnPixels) \
+    X(CopyTexImage2D) \
+    X(CopyTexSubImage2D) \
+    X(CopyTexSubImage3D) \
+    X(InvalidateFramebuffer) \
+    X(InvalidateSubFramebuffer) \
+    X(Enable) \
+    X(Disable) \
+    X(IsEnabled) \
+    X(BlendFuncSeparate) \
+    X(BlendEquationSeparate) \
+    X(DepthFunc) \
+    X(DepthMask) \
+    X(DepthRangef) \
+    X(CullFace) \
+    X(FrontFace) \
+    X(PolygonOffset) \
+    X(LineWidth) \
+    X(Viewport) \
+    X(Scissor) \
+    X(ColorMask) \
+    X(StencilFunc) \
+    X(StencilOp) \
+    X(StencilMask) \
+    X(Clear) \
+    X(ClearColor) \
+    X(ClearDepthf) \
+    X(ClearStencil) \
+    X(ClearBufferfv) \
+    X(ClearBufferiv) \
+    X(ClearBufferuiv) \
+    X(ClearBufferfi) \
+    X(GetIntegerv) \
+    X(GetFloatv) \
+    X(GetBooleanv) \
+    X(GetString) \
+    X(GetStringi) \
+    X(GetError) \
+    X(FenceSync) \
+    X(DeleteSync) \
+    X(ClientWaitSync) \
+    X(WaitSync) \
+    X(Finish) \
+    X(Flush) \
+    X(BeginQuery) \
+    X(EndQuery) \
+    X(BeginTransformFeedback) \
+    X(EndTransformFeedback) \
+    X(PauseTransformFeedback) \
+    X(ResumeTransformFeedback) \
+    X(DispatchCompute) \
+    X(MemoryBarrier) \
+    X(BindImageTexture) \
+    X(CopyImageSubData)
+
+typedef enum CallProfilerEntry {
+#define CALL_PROFILER_ENUM(name) PROFILE_CALL_##name,
+    CALL_PROFILER_ENTRY_POINTS(CALL_PROFILER_ENUM)
+#undef CALL_PROFILER_ENUM
+    PROFILE_CALL_COUNT
+} CallProfilerEntry;
+
+// One call out of every (mask + 1) on a thread is timed
+#define CALL_PROFILER_SAMPLE_MASK 63
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * Per-call scope, lives on the stack of the profiled wrapper
+ */
+typedef struct CallProfilerScope {
+    uint32_t entry;
+    uint64_t startNs;        // 0 when the call is not sampled
+    uint64_t driverNs;       // Time spent inside driver calls
+} CallProfilerScope;
+
+/**
+ * Merged statistics for one entry point
+ */
+typedef struct CallProfilerEntryStats {
+    const char* name;
+    uint64_t frameCalls;     // Calls during the last merged frame
+    uint64_t totalCalls;     // Calls since the last reset
+    uint64_t sampledCalls;   // Timed calls since the last reset
+    double avgWrapperNs;     // Mean time spent in the wrapper itself
+    double avgDriverNs;      // Mean time spent in the driver
+    double frameCpuMs;       // Estimated CPU time during the last frame
+} CallProfilerEntryStats;
+
+// Hot-path switch, read without locking
+extern volatile bool g_callProfilerActive;
+
+// ============================================================================
+// Profiler API
+// ============================================================================
+
+/**
+ * Initialize the call profiler
+ */
+bool callProfilerInit(bool enabled);
+
+/**
+ * Stop profiling and clear merged statistics. Thread counter blocks are
+ * kept until process exit, since other threads may still be writing them.
+ */
+void callProfilerShutdown(void);
+
+/**
+ * Enable or disable call counting and sampling
+ */
+void callProfilerSetEnabled(bool enabled);
+
+/**
+ * Check if profiling is active
+ */
+bool callProfilerIsEnabled(void);
+
+/**
+ * Merge thread-local counters into the frame table (call once per frame)
+ */
+void callProfilerEndFrame(void);
+
+/**
+ * Get merged statistics sorted by estimated CPU time, returns entry count
+ */
+int callProfilerGetStats(CallProfilerEntryStats* out, int maxEntries);
+
+/**
+ * Write the sorted table to a file, or to the log when path is NULL
+ */
+bool callProfilerDump(const char* path);
+
+/**
+ * Reset accumulated statistics
+ */
+void callProfilerReset(void);
+
+/**
+ * Monotonic clock in nanoseconds
+ */
+uint64_t callProfilerNowNs(void);
+
+/**
+ * Slow path: count the call and decide whether to time it
+ */
+void callProfilerScopeEnter(CallProfilerScope* scope);
+
+/**
+ * Slow path: record timing for a sampled call
+ */
+void callProfilerScopeCommit(CallProfilerScope* scope);
+
+static inline CallProfilerScope callProfilerScopeBegin(CallProfilerEntry entry) {
+    CallProfilerScope scope = {(uint32_t)entry, 0, 0};
+    if (__builtin_expect(g_callProfilerActive, 0)) {
+        callProfilerScopeEnter(&scope);
+    }
+    return scope;
+}
+
+static inline void callProfilerScopeEnd(CallProfilerScope* scope) {
+    if (__builtin_expect(scope->startNs != 0, 0)) {
+        callProfilerScopeCommit(scope);
+    }
+}
+
+// ============================================================================
+// Instrumentation Macros
+// ============================================================================
+
+#ifdef VELOCITY_PROFILING
+
+// Count this wrapper call; timing is committed when the scope exits
+#define PROFILE_CALL(name) \
+    CallProfilerScope _profScope __attribute__((cleanup(callProfilerScopeEnd))) = \
+        callProfilerScopeBegin(PROFILE_CALL_##name)
+
+// Wrap the driver call so sampled calls can split wrapper and driver time
+#define PROFILE_DRIVER(stmt) do { \
+        if (_profScope.startNs) { \
+            uint64_t _profDriverStart = callProfilerNowNs(); \
+            stmt; \
+            _profScope.driverNs += callProfilerNowNs() - _profDriverStart; \
+        } else { \
+            stmt; \
+        } \
+    } while (0)
+
+#else
+
+#define PROFILE_CALL(name) ((void)0)
+#define PROFILE_DRIVER(stmt) do { stmt; } while (0)
+
+#endif // VELOCITY_PROFILING
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CALL_PROFILER_H
@@ -0,0 +1,510 @@
+/**
+ * Flight Recorder - Implementation
+ * Events land in a shared lock-free ring (slot claimed with fetch_add, made
+ * visible with a release store of its sequence). Per-type counters are
+ * folded into the frame ring at frame end. Dumps are copied on the render
+ * thread and written by a single background worker.
+ */
+
+#include "flight_recorder.h"
+#include "../utils/log.h"
+#include "../utils/memory.h"
+#include "../utils/thread_pool.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+// ============================================================================
+// Types
+// ============================================================================
+
+typedef struct FlightRecorderContext {
+    char* dumpDir;
+    float thresholdMs;
+
+    // Frame window
+    FlightFrame* frames;
+    int frameCapacity;
+    uint32_t framesClosed;
+    uint32_t currentFrame;              // Read by recording threads
+    size_t lastMemoryUsage;
+
+    // Event ring
+    FlightEvent events[FLIGHT_EVENT_CAPACITY];
+    uint32_t eventHead;
+
+    // Accumulators for the open frame
+    uint32_t counts[FLIGHT_EVENT_COUNT];
+    uint64_t timeNs[FLIGHT_EVENT_COUNT];
+
+    // Dumps
+    ThreadPool* writer;
+    uint64_t lastDumpNs;
+    uint32_t dumpIndex;
+    uint32_t dumpCount;
+    int dumpPending;
+} FlightRecorderContext;
+
+typedef struct FlightSnapshot {
+    FlightFileHeader header;
+    FlightFrame* frames;
+    FlightEvent* events;
+    char path[512];
+} FlightSnapshot;
+
+static FlightRecorderContext* g_flightRecorder = NULL;
+volatile bool g_flightActive = false;
+
+static const char* const EVENT_NAMES[FLIGHT_EVENT_COUNT] = {
+    "shader_compile",
+    "shader_link",
+    "texture_upload",
+    "fence_wait",
+    "alloc_spike",
+    "batch_overflow",
+    "stream_overflow",
+    "state_change"
+};
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+uint64_t flightRecorderNowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+const char* flightRecorderEventName(FlightEventType type) {
+    if ((unsigned)type >= FLIGHT_EVENT_COUNT) return "unknown";
+    return EVENT_NAMES[type];
+}
+
+static void pushEvent(FlightRecorderContext* ctx, FlightEventType type, uint64_t startNs,
+                      uint64_t durationNs, uint64_t value, uint32_t frame) {
+    uint32_t index = __atomic_fetch_add(&ctx->eventHead, 1, __ATOMIC_RELAXED);
+    FlightEvent* ev = &ctx->events[index & (FLIGHT_EVENT_CAPACITY - 1)];
+
+    // Sequence 0 marks the slot as being written
+    __atomic_store_n(&ev->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    uint64_t durationUs = durationNs / 1000;
+    ev->startNs = startNs;
+    ev->value = value;
+    ev->durationUs = durationUs > UINT32_MAX ? UINT32_MAX : (uint32_t)durationUs;
+    ev->frame = frame;
+    ev->type = (uint32_t)type;
+
+    __atomic_store_n(&ev->seq, index + 1, __ATOMIC_RELEASE);
+}
+
+static void appendf(char* out, size_t outSize, size_t* len, const char* fmt, ...) {
+    if (*len >= outSize) return;
+
+    va_list args;
+    va_start(args, fmt);
+    int written = vsnprintf(out + *len, outSize - *len, fmt, args);
+    va_end(args);
+
+    if (written > 0) {
+        *len += (size_t)written;
+        if (*len >= outSize) *len = outSize - 1;
+    }
+}
+
+// ============================================================================
+// Summary
+// ============================================================================
+
+static bool isTimedType(int type) {
+    return type == FLIGHT_EVENT_SHADER_COMPILE || type == FLIGHT_EVENT_SHADER_LINK ||
+           type == FLIGHT_EVENT_TEXTURE_UPLOAD || type == FLIGHT_EVENT_FENCE_WAIT;
+}
+
+static void summarizeWindow(const FlightFileHeader* header, const FlightFrame* frames,
+                            const FlightEvent* events, char* out, size_t outSize) {
+    size_t len = 0;
+    out[0] = '\0';
+
+    // The hitch frame is the newest one in the window
+    const FlightFrame* hitch = NULL;
+    for (uint32_t i = 0; i < header->frameCount; i++) {
+        if (frames[i].frame == header->hitchFrame) {
+            hitch = &frames[i];
+        }
+    }
+    if (!hitch) {
+        appendf(out, outSize, &len, "Hitch frame %u missing from window\n", header->hitchFrame);
+        return;
+    }
+
+    // Baseline over the other frames
+    double avgFrameMs = 0.0;
+    double avgDraws = 0.0;
+    double avgTimeUs[FLIGHT_EVENT_COUNT] = {0};
+    double avgCounts[FLIGHT_EVENT_COUNT] = {0};
+    uint32_t baseFrames = 0;
+
+    for (uint32_t i = 0; i < header->frameCount; i++) {
+        if (&frames[i] == hitch) continue;
+        avgFrameMs += frames[i].frameTimeMs;
+        avgDraws += frames[i].drawCalls;
+        for (int t = 0; t < FLIGHT_EVENT_COUNT; t++) {
+            avgTimeUs[t] += frames[i].timeUs[t];
+            avgCounts[t] += frames[i].counts[t];
+        }
+        baseFrames++;
+    }
+    if (baseFrames > 0) {
+        avgFrameMs /= baseFrames;
+        avgDraws /= baseFrames;
+        for (int t = 0; t < FLIGHT_EVENT_COUNT; t++) {
+            avgTimeUs[t] /= baseFrames;
+            avgCounts[t] /= baseFrames;
+        }
+    }
+
+    appendf(out, outSize, &len, "Hitch at frame %u: %.1f ms (threshold %.1f ms, window avg %.1f ms over %u frames)\n",
+            hitch->frame, hitch->frameTimeMs, header->thresholdMs, avgFrameMs, baseFrames);
+
+    // Timed categories explain the overshoot directly
+    double overshootMs = hitch->frameTimeMs - avgFrameMs;
+    int bestTimed = -1;
+    double bestExcessMs = 0.0;
+    for (int t = 0; t < FLIGHT_EVENT_COUNT; t++) {
+        if (!isTimedType(t)) continue;
+        double excessMs = (hitch->timeUs[t] - avgTimeUs[t]) / 1000.0;
+        if (excessMs > bestExcessMs) {
+            bestExcessMs = excessMs;
+            bestTimed = t;
+        }
+    }
+
+    bool stateBurst = hitch->counts[FLIGHT_EVENT_STATE_CHANGE] > 2.0 * avgCounts[FLIGHT_EVENT_STATE_CHANGE] + 100.0;
+    bool drawSpike = hitch->drawCalls > 2.0 * avgDraws + 50.0;
+
+    if (bestTimed >= 0 && bestExcessMs >= overshootMs * 0.25) {
+        appendf(out, outSize, &len, "Likely cause: %s (%u events, %.1f ms in frame)\n",
+                EVENT_NAMES[bestTimed], hitch->counts[bestTimed], hitch->timeUs[bestTimed] / 1000.0);
+    } else if (hitch->memoryDelta >= FLIGHT_ALLOC_SPIKE_BYTES) {
+        appendf(out, outSize, &len, "Likely cause: alloc_spike (+%.1f MB in frame)\n",
+                hitch->memoryDelta / (1024.0 * 1024.0));
+    } else if (hitch->counts[FLIGHT_EVENT_BATCH_OVERFLOW] || hitch->counts[FLIGHT_EVENT_STREAM_OVERFLOW]) {
+        appendf(out, outSize, &len, "Likely cause: %s\n",
+                hitch->counts[FLIGHT_EVENT_BATCH_OVERFLOW] ? "batch_overflow" : "stream_overflow");
+    } else if (stateBurst) {
+        appendf(out, outSize, &len, "Likely cause: state change burst (%u, avg %.0f)\n",
+                hitch->counts[FLIGHT_EVENT_STATE_CHANGE], avgCounts[FLIGHT_EVENT_STATE_CHANGE]);
+    } else if (drawSpike) {
+        appendf(out, outSize, &len, "Likely cause: draw call spike (%u, avg %.0f)\n",
+                hitch->drawCalls, avgDraws);
+    } else {
+        appendf(out, outSize, &len, "Likely cause: unknown (no recorded event explains the frame; GPU or scheduling)\n");
+    }
+
+    // Per-category breakdown for the hitch frame
+    for (int t = 0; t < FLIGHT_EVENT_COUNT; t++) {
+        if (hitch->counts[t] == 0) continue;
+        if (isTimedType(t)) {
+            appendf(out, outSize, &len, "  %s: %u events, %.2f ms (avg %.2f ms)\n",
+                    EVENT_NAMES[t], hitch->counts[t], hitch->timeUs[t] / 1000.0, avgTimeUs[t] / 1000.0);
+        } else {
+            appendf(out, outSize, &len, "  %s: %u (avg %.1f)\n",
+                    EVENT_NAMES[t], hitch->counts[t], avgCounts[t]);
+        }
+    }
+    appendf(out, outSize, &len, "  draw calls: %u (avg %.0f)\n", hitch->drawCalls, avgDraws);
+    appendf(out, outSize, &len, "  memory: %+.2f MB\n", hitch->memoryDelta / (1024.0 * 1024.0));
+
+    // Slowest individual events in the hitch frame
+    const FlightEvent* slowest[5] = {NULL};
+    for (uint32_t i = 0; i < header->eventCount; i++) {
+        const FlightEvent* ev = &events[i];
+        if (ev->frame != hitch->frame || ev->durationUs == 0) continue;
+        for (int s = 0; s < 5; s++) {
+            if (!slowest[s] || ev->durationUs > slowest[s]->durationUs) {
+                memmove(&slowest[s + 1], &slowest[s], (4 - s) * sizeof(slowest[0]));
+                slowest[s] = ev;
+                break;
+            }
+        }
+    }
+    if (slowest[0]) {
+        appendf(out, outSize, &len, "Slowest events:\n");
+        for (int s = 0; s < 5 && slowest[s]; s++) {
+            appendf(out, outSize, &len, "  %s %.2f ms (value %llu)\n",
+                    flightRecorderEventName((FlightEventType)slowest[s]->type),
+                    slowest[s]->durationUs / 1000.0, (unsigned long long)slowest[s]->value);
+        }
+    }
+}
+
+// ============================================================================
+// Dump Writer
+// ============================================================================
+
+static void writeSnapshotTask(void* arg) {
+    FlightSnapshot* snap = (FlightSnapshot*)arg;
+
+    FILE* file = fopen(snap->path, "wb");
+    if (file) {
+        bool ok = fwrite(&snap->header, sizeof(FlightFileHeader), 1, file) == 1;
+        ok = ok && fwrite(snap->frames, sizeof(FlightFrame), snap->header.frameCount, file) == snap->header.frameCount;
+        ok = ok && fwrite(snap->events, sizeof(FlightEvent), snap->header.eventCount, file) == snap->header.eventCount;
+        fclose(file);
+
+        if (ok) {
+            char summary[2048];
+            summarizeWindow(&snap->header, snap->frames, snap->events, summary, sizeof(summary));
+            velocityLogWarn("Hitch recorded to %s\n%s", snap->path, summary);
+        } else {
+            velocityLogError("Failed to write hitch dump: %s", snap->path);
+        }
+    } else {
+        velocityLogError("Failed to open hitch dump: %s", snap->path);
+    }
+
+    if (g_flightRecorder) {
+        __atomic_fetch_add(&g_flightRecorder->dumpCount, 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&g_flightRecorder->dumpPending, 0, __ATOMIC_RELEASE);
+    }
+    velocityFree(snap);
+}
+
+static void snapshotWindow(FlightRecorderContext* ctx, const FlightFrame* hitch) {
+    uint32_t frameCount = ctx->framesClosed < (uint32_t)ctx->frameCapacity ?
+                          ctx->framesClosed : (uint32_t)ctx->frameCapacity;
+
+    size_t size = sizeof(FlightSnapshot) +
+                  frameCount * sizeof(FlightFrame) +
+                  FLIGHT_EVENT_CAPACITY * sizeof(FlightEvent);
+    FlightSnapshot* snap = (FlightSnapshot*)velocityMalloc(size);
+    if (!snap) {
+        __atomic_store_n(&ctx->dumpPending, 0, __ATOMIC_RELEASE);
+        return;
+    }
+    snap->frames = (FlightFrame*)(snap + 1);
+    snap->events = (FlightEvent*)(snap->frames + frameCount);
+
+    // Frames oldest first
+    uint32_t firstFrame = ctx->framesClosed - frameCount;
+    for (uint32_t i = 0; i < frameCount; i++) {
+        snap->frames[i] = ctx->frames[(firstFrame + i) % ctx->frameCapacity];
+    }
+    uint32_t oldestFrame = snap->frames[0].frame;
+
+    // Events still in the ring and inside the window
+    uint32_t head = __atomic_load_n(&ctx->eventHead, __ATOMIC_ACQUIRE);
+    uint32_t available = head < FLIGHT_EVENT_CAPACITY ? head : FLIGHT_EVENT_CAPACITY;
+    uint32_t eventCount = 0;
+
+    for (uint32_t index = head - available; index != head; index++) {
+        const FlightEvent* slot = &ctx->events[index & (FLIGHT_EVENT_CAPACITY - 1)];
+        uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        if (seq != index + 1) continue;
+
+        FlightEvent copy = *slot;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq) continue;
+
+        if (copy.frame < oldestFrame || copy.frame > hitch->frame) continue;
+        snap->events[eventCount++] = copy;
+    }
+
+    snap->header.magic = FLIGHT_FILE_MAGIC;
+    snap->header.version = FLIGHT_FILE_VERSION;
+    snap->header.eventTypes = FLIGHT_EVENT_COUNT;
+    snap->header.frameCount = frameCount;
+    snap->header.eventCount = eventCount;
+    snap->header.hitchFrame = hitch->frame;
+    snap->header.thresholdMs = ctx->thresholdMs;
+    snap->header.hitchFrameMs = hitch->frameTimeMs;
+    snap->header.reserved = 0;
+
+    snprintf(snap->path, sizeof(snap->path), "%s/hitch_%02u.vfr",
+             ctx->dumpDir, ctx->dumpIndex % FLIGHT_MAX_DUMP_FILES);
+    ctx->dumpIndex++;
+
+    threadPoolSubmit(ctx->writer, writeSnapshotTask, snap);
+}
+
+// ============================================================================
+// Flight Recorder API
+// ============================================================================
+
+bool flightRecorderInit(const char* dumpDir, float thresholdMs, int frames) {
+    if (g_flightRecorder) {
+        velocityLogWarn("Flight recorder already initialized");
+        return true;
+    }
+
+    if (frames <= 1) frames = FLIGHT_DEFAULT_FRAMES;
+    if (frames > FLIGHT_MAX_FRAMES) frames = FLIGHT_MAX_FRAMES;
+
+    g_flightRecorder = (FlightRecorderContext*)velocityCalloc(1, sizeof(FlightRecorderContext));
+    if (!g_flightRecorder) {
+        velocityLogError("Failed to allocate flight recorder");
+        return false;
+    }
+
+    g_flightRecorder->frames = (FlightFrame*)velocityCalloc(frames, sizeof(FlightFrame));
+    g_flightRecorder->writer = threadPoolCreate(1);
+    if (!g_flightRecorder->frames || !g_flightRecorder->writer) {
+        velocityLogError("Failed to allocate flight recorder buffers");
+        flightRecorderShutdown();
+        return false;
+    }
+
+    g_flightRecorder->frameCapacity = frames;
+    g_flightRecorder->dumpDir = velocityStrdup(dumpDir ? dumpDir : ".");
+    g_flightRecorder->lastMemoryUsage = 0;
+
+    flightRecorderSetThreshold(thresholdMs);
+
+    velocityLogInfo("Flight recorder initialized: %d frames, threshold %.1f ms, dir %s",
+                    frames, thresholdMs, g_flightRecorder->dumpDir);
+    return true;
+}
+
+void flightRecorderShutdown(void) {
+    if (!g_flightRecorder) return;
+
+    g_flightActive = false;
+
+    // Drains the queue, so pending dumps still reach the disk
+    threadPoolDestroy(g_flightRecorder->writer);
+
+    velocityFree(g_flightRecorder->frames);
+    velocityFree(g_flightRecorder->dumpDir);
+    velocityFree(g_flightRecorder);
+    g_flightRecorder = NULL;
+}
+
+void flightRecorderSetThreshold(float thresholdMs) {
+    if (!g_flightRecorder) return;
+
+    g_flightRecorder->thresholdMs = thresholdMs > 0.0f ? thresholdMs : 0.0f;
+    g_flightActive = g_flightRecorder->thresholdMs > 0.0f;
+}
+
+float flightRecorderGetThreshold(void) {
+    return g_flightRecorder ? g_flightRecorder->thresholdMs : 0.0f;
+}
+
+void flightRecorderRecord(FlightEventType type, uint64_t startNs, uint64_t durationNs, uint64_t value) {
+    FlightRecorderContext* ctx = g_flightRecorder;
+    if (!ctx || (unsigned)type >= FLIGHT_EVENT_COUNT) return;
+
+    __atomic_fetch_add(&ctx->counts[type], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&ctx->timeNs[type], durationNs, __ATOMIC_RELAXED);
+
+    if (type != FLIGHT_EVENT_STATE_CHANGE) {
+        uint32_t frame = __atomic_load_n(&ctx->currentFrame, __ATOMIC_RELAXED);
+        pushEvent(ctx, type, startNs, durationNs, value, frame);
+    }
+}
+
+void flightRecorderCount(FlightEventType type) {
+    FlightRecorderContext* ctx = g_flightRecorder;
+    if (!ctx || (unsigned)type >= FLIGHT_EVENT_COUNT) return;
+
+    __atomic_fetch_add(&ctx->counts[type], 1, __ATOMIC_RELAXED);
+}
+
+void flightRecorderEndFrame(float frameTimeMs, uint32_t drawCalls, size_t memoryUsage) {
+    FlightRecorderContext* ctx = g_flightRecorder;
+    if (!ctx || !g_flightActive) return;
+
+    FlightFrame* frame = &ctx->frames[ctx->framesClosed % ctx->frameCapacity];
+    memset(frame, 0, sizeof(FlightFrame));
+
+    frame->frame = ctx->currentFrame;
+    frame->frameTimeMs = frameTimeMs;
+    frame->drawCalls = drawCalls;
+
+    for (int t = 0; t < FLIGHT_EVENT_COUNT; t++) {
+        frame->counts[t] = __atomic_exchange_n(&ctx->counts[t], 0, __ATOMIC_RELAXED);
+        uint64_t timeUs = __atomic_exchange_n(&ctx->timeNs[t], 0, __ATOMIC_RELAXED) / 1000;
+        frame->timeUs[t] = timeUs > UINT32_MAX ? UINT32_MAX : (uint32_t)timeUs;
+    }
+
+    // The first frame only establishes the memory baseline
+    if (ctx->framesClosed > 0) {
+        frame->memoryDelta = (int64_t)memoryUsage - (int64_t)ctx->lastMemoryUsage;
+    }
+    ctx->lastMemoryUsage = memoryUsage;
+
+    if (frame->memoryDelta >= FLIGHT_ALLOC_SPIKE_BYTES) {
+        frame->counts[FLIGHT_EVENT_ALLOC_SPIKE]++;
+        pushEvent(ctx, FLIGHT_EVENT_ALLOC_SPIKE, flightRecorderNowNs(), 0,
+                  (uint64_t)frame->memoryDelta, frame->frame);
+    }
+
+    ctx->framesClosed++;
+
+    // Snapshot before the next frame starts overwriting the window
+    if (frameTimeMs >= ctx->thresholdMs && ctx->framesClosed > 1) {
+        uint64_t now = flightRecorderNowNs();
+        bool cooledDown = ctx->lastDumpNs == 0 ||
+                          now - ctx->lastDumpNs >= FLIGHT_DUMP_COOLDOWN_MS * 1000000ULL;
+        int expected = 0;
+
+        if (cooledDown && __atomic_compare_exchange_n(&ctx->dumpPending, &expected, 1, false,
+                                                      __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            ctx->lastDumpNs = now;
+            snapshotWindow(ctx, frame);
+        }
+    }
+
+    __atomic_store_n(&ctx->currentFrame, ctx->currentFrame + 1, __ATOMIC_RELAXED);
+}
+
+uint32_t flightRecorderGetDumpCount(void) {
+    if (!g_flightRecorder) return 0;
+    return __atomic_load_n(&g_flightRecorder->dumpCount, __ATOMIC_RELAXED);
+}
+
+bool flightRecorderSummarize(const char* path, char* out, size_t outSize) {
+    if (!path || !out || outSize == 0) return false;
+    out[0] = '\0';
+
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        velocityLogError("Failed to open hitch dump: %s", path);
+        return false;
+    }
+
+    FlightFileHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        header.magic != FLIGHT_FILE_MAGIC ||
+        header.version != FLIGHT_FILE_VERSION ||
+        header.eventTypes != FLIGHT_EVENT_COUNT ||
+        header.frameCount == 0 || header.frameCount > FLIGHT_MAX_FRAMES ||
+        header.eventCount > FLIGHT_EVENT_CAPACITY) {
+        velocityLogError("Invalid hitch dump: %s", path);
+        fclose(file);
+        return false;
+    }
+
+    FlightFrame* frames = (FlightFrame*)velocityMalloc(header.frameCount * sizeof(FlightFrame));
+    FlightEvent* events = (FlightEvent*)velocityMalloc((header.eventCount + 1) * sizeof(FlightEvent));
+    bool ok = frames && events &&
+              fread(frames, sizeof(FlightFrame), header.frameCount, file) == header.frameCount &&
+              fread(events, sizeof(FlightEvent), header.eventCount, file) == header.eventCount;
+    fclose(file);
+
+    if (ok) {
+        summarizeWindow(&header, frames, events, out, outSize);
+    } else {
+        velocityLogError("Truncated hitch dump: %s", path);
+    }
+
+    velocityFree(frames);
+    velocityFree(events);
+    return ok;
+}
@@ -0,0 +1,208 @@
+/**
+ * Flight Recorder - Rolling per-frame event history for hitch analysis
+ * Keeps the last frames' compiles, uploads, fence waits, allocation spikes,
+ * overflows and state-change counts in memory. A frame over the hitch
+ * threshold snapshots the window and writes it to disk on a worker thread.
+ */
+
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define FLIGHT_DEFAULT_FRAMES       120     // Frames kept in the window
+#define FLIGHT_MAX_FRAMES           1024
+#define FLIGHT_EVENT_CAPACITY       4096    // Detailed events kept (power of two)
+#define FLIGHT_ALLOC_SPIKE_BYTES    (4 * 1024 * 1024)  // Per-frame growth flagged as a spike
+#define FLIGHT_DUMP_COOLDOWN_MS     2000    // Minimum gap between two dumps
+#define FLIGHT_MAX_DUMP_FILES       16      // Dump files are reused round-robin
+
+#define FLIGHT_FILE_MAGIC           0x52464C56  // "VLFR"
+#define FLIGHT_FILE_VERSION         1
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * Event categories
+ */
+typedef enum FlightEventType {
+    FLIGHT_EVENT_SHADER_COMPILE = 0,
+    FLIGHT_EVENT_SHADER_LINK,
+    FLIGHT_EVENT_TEXTURE_UPLOAD,        // value = texels
+    FLIGHT_EVENT_FENCE_WAIT,
+    FLIGHT_EVENT_ALLOC_SPIKE,           // value = bytes grown this frame
+    FLIGHT_EVENT_BATCH_OVERFLOW,        // value = queued commands
+    FLIGHT_EVENT_STREAM_OVERFLOW,       // value = requested bytes
+    FLIGHT_EVENT_STATE_CHANGE,          // Counted only, never stored as events
+    FLIGHT_EVENT_COUNT
+} FlightEventType;
+
+/**
+ * One recorded event (file layout, 32 bytes)
+ */
+typedef struct FlightEvent {
+    uint64_t startNs;        // CLOCK_MONOTONIC
+    uint64_t value;          // Type specific payload
+    uint32_t durationUs;
+    uint32_t frame;
+    uint32_t type;           // FlightEventType
+    uint32_t seq;            // Ring slot sequence, used to reject torn reads
+} FlightEvent;
+
+/**
+ * Per-frame summary (file layout)
+ */
+typedef struct FlightFrame {
+    uint32_t frame;
+    float frameTimeMs;
+    uint32_t drawCalls;
+    uint32_t counts[FLIGHT_EVENT_COUNT];
+    uint32_t timeUs[FLIGHT_EVENT_COUNT];
+    int64_t memoryDelta;     // Heap + GPU memory growth during the frame
+} FlightFrame;
+
+/**
+ * Dump file header, followed by frameCount FlightFrame and eventCount FlightEvent
+ */
+typedef struct FlightFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t eventTypes;     // FLIGHT_EVENT_COUNT at write time
+    uint32_t frameCount;
+    uint32_t eventCount;
+    uint32_t hitchFrame;
+    float thresholdMs;
+    float hitchFrameMs;
+    uint32_t reserved;
+} FlightFileHeader;
+
+// Hot-path switch, read without locking
+extern volatile bool g_flightActive;
+
+// ============================================================================
+// Flight Recorder API
+// ============================================================================
+
+/**
+ * Initialize recorder; dumps go to dumpDir, thresholdMs <= 0 disables it
+ */
+bool flightRecorderInit(const char* dumpDir, float thresholdMs, int frames);
+
+/**
+ * Shutdown recorder (waits for pending dumps)
+ */
+void flightRecorderShutdown(void);
+
+/**
+ * Change hitch threshold (<= 0 disables recording)
+ */
+void flightRecorderSetThreshold(float thresholdMs);
+
+/**
+ * Get hitch threshold
+ */
+float flightRecorderGetThreshold(void);
+
+/**
+ * Record an event on the calling thread
+ */
+void flightRecorderRecord(FlightEventType type, uint64_t startNs, uint64_t durationNs, uint64_t value);
+
+/**
+ * Count an event without storing it
+ */
+void flightRecorderCount(FlightEventType type);
+
+/**
+ * Close the current frame; snapshots the window if frameTimeMs is a hitch
+ */
+void flightRecorderEndFrame(float frameTimeMs, uint32_t drawCalls, size_t memoryUsage);
+
+/**
+ * Get number of dumps written since init
+ */
+uint32_t flightRecorderGetDumpCount(void);
+
+/**
+ * Summarize a dump file into out (likely cause first), returns false on bad file
+ */
+bool flightRecorderSummarize(const char* path, char* out, size_t outSize);
+
+/**
+ * Get event type name
+ */
+const char* flightRecorderEventName(FlightEventType type);
+
+/**
+ * Monotonic clock in nanoseconds
+ */
+uint64_t flightRecorderNowNs(void);
+
+/**
+ * Open scope for a timed event
+ */
+typedef struct FlightScope {
+    FlightEventType type;
+    uint64_t value;
+    uint64_t startNs;        // 0 when recording was off at scope entry
+} FlightScope;
+
+static inline FlightScope flightScopeBegin(FlightEventType type, uint64_t value) {
+    FlightScope scope = {type, value, 0};
+    if (__builtin_expect(g_flightActive, 0)) {
+        scope.startNs = flightRecorderNowNs();
+    }
+    return scope;
+}
+
+static inline void flightScopeEnd(FlightScope* scope) {
+    if (__builtin_expect(scope->startNs != 0, 0)) {
+        flightRecorderRecord(scope->type, scope->startNs,
+                             flightRecorderNowNs() - scope->startNs, scope->value);
+    }
+}
+
+// ============================================================================
+// Instrumentation Macros
+// ============================================================================
+
+#define FLIGHT_CONCAT_(a, b) a##b
+#define FLIGHT_CONCAT(a, b) FLIGHT_CONCAT_(a, b)
+
+// Timed event that ends when the enclosing block exits. Always compiled in:
+// the recorder is meant for release builds and costs one branch when off.
+#define FLIGHT_SCOPE(type, value) \
+    FlightScope FLIGHT_CONCAT(_flightScope, __LINE__) \
+        __attribute__((cleanup(flightScopeEnd))) = flightScopeBegin(type, value)
+
+// Instant event
+#define FLIGHT_EVENT(type, value) \
+    do { \
+        if (__builtin_expect(g_flightActive, 0)) { \
+            flightRecorderRecord(type, flightRecorderNowNs(), 0, value); \
+        } \
+    } while (0)
+
+// Counter only
+#define FLIGHT_COUNT(type) \
+    do { \
+        if (__builtin_expect(g_flightActive, 0)) flightRecorderCount(type); \
+    } while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FLIGHT_RECORDER_H
@@ -0,0 +1,218 @@
+/**
+ * Frame Stats - Implementation
+ * Samples are kept in microseconds. Values below 2^SUB_BITS get one bucket
+ * each; every octave above is split into 2^(SUB_BITS-1) linear buckets.
+ * The ring of raw samples lets the oldest frame leave the histogram when a
+ * new one enters, so the window never needs rebuilding.
+ */
+
+#include "frame_stats.h"
+#include "../utils/log.h"
+#include "../utils/memory.h"
+
+#include <string.h>
+
+// ============================================================================
+// Types
+// ============================================================================
+
+#define SUB_COUNT       (1u << FRAME_STATS_SUB_BITS)
+#define HALF_SUB_COUNT  (SUB_COUNT >> 1)
+#define MAX_VALUE_US    ((1u << FRAME_STATS_MAX_OCTAVE) - 1)
+
+typedef struct FrameStatsContext {
+    // Raw window, oldest sample at head once full
+    uint32_t samplesUs[FRAME_STATS_WINDOW];
+    uint8_t stutter[FRAME_STATS_WINDOW];
+    uint32_t head;
+    uint32_t count;
+    uint64_t sumUs;
+
+    uint32_t buckets[FRAME_STATS_BUCKETS];
+
+    uint32_t windowStutters;
+    uint32_t totalStutters;
+
+    FrameStatsSummary summary;
+} FrameStatsContext;
+
+static FrameStatsContext* g_frameStats = NULL;
+
+// ============================================================================
+// Buckets
+// ============================================================================
+
+static inline uint32_t bucketIndex(uint32_t us) {
+    if (us > MAX_VALUE_US) us = MAX_VALUE_US;
+    if (us < SUB_COUNT) return us;
+
+    uint32_t msb = 31 - (uint32_t)__builtin_clz(us);
+    uint32_t shift = msb - (FRAME_STATS_SUB_BITS - 1);
+    uint32_t sub = us >> shift;     // In [HALF_SUB_COUNT, SUB_COUNT)
+
+    return SUB_COUNT + (shift - 1) * HALF_SUB_COUNT + (sub - HALF_SUB_COUNT);
+}
+
+static inline float bucketMidpointMs(uint32_t index) {
+    if (index < SUB_COUNT) return index / 1000.0f;
+
+    uint32_t offset = index - SUB_COUNT;
+    uint32_t shift = offset / HALF_SUB_COUNT + 1;
+    uint32_t sub = offset % HALF_SUB_COUNT + HALF_SUB_COUNT;
+
+    uint32_t low = sub << shift;
+    uint32_t width = 1u << shift;
+    return (low + width * 0.5f) / 1000.0f;
+}
+
+static float percentileMs(const FrameStatsContext* ctx, float percentile) {
+    if (ctx->count == 0) return 0.0f;
+
+    // Rank of the sample at this percentile (1-based, nearest-rank)
+    uint64_t rank = (uint64_t)(percentile / 100.0f * ctx->count + 0.999f);
+    if (rank < 1) rank = 1;
+    if (rank > ctx->count) rank = ctx->count;
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < FRAME_STATS_BUCKETS; i++) {
+        seen += ctx->buckets[i];
+        if (seen >= rank) return bucketMidpointMs(i);
+    }
+    return bucketMidpointMs(FRAME_STATS_BUCKETS - 1);
+}
+
+static void refreshSummary(FrameStatsContext* ctx) {
+    FrameStatsSummary* s = &ctx->summary;
+    memset(s, 0, sizeof(FrameStatsSummary));
+
+    s->sampleCount = ctx->count;
+    s->windowStutters = ctx->windowStutters;
+    s->totalStutters = ctx->totalStutters;
+    if (ctx->count == 0) return;
+
+    s->meanMs = (float)(ctx->sumUs / (double)ctx->count / 1000.0);
+
+    // One forward pass for all fixed percentiles
+    const float targets[4] = {50.0f, 90.0f, 99.0f, 99.9f};
+    float* outputs[4] = {&s->p50Ms, &s->p90Ms, &s->p99Ms, &s->p999Ms};
+    uint64_t ranks[4];
+    for (int t = 0; t < 4; t++) {
+        ranks[t] = (uint64_t)(targets[t] / 100.0f * ctx->count + 0.999f);
+        if (ranks[t] < 1) ranks[t] = 1;
+        if (ranks[t] > ctx->count) ranks[t] = ctx->count;
+    }
+
+    uint64_t seen = 0;
+    int next = 0;
+    for (uint32_t i = 0; i < FRAME_STATS_BUCKETS && next < 4; i++) {
+        if (ctx->buckets[i] == 0) continue;
+        seen += ctx->buckets[i];
+        while (next < 4 && seen >= ranks[next]) {
+            *outputs[next++] = bucketMidpointMs(i);
+        }
+    }
+
+    // Slowest 1% (at least one frame), walking down from the top bucket
+    uint32_t lowCount = (ctx->count + 99) / 100;
+    uint32_t remaining = lowCount;
+    double lowSumMs = 0.0;
+    for (int i = FRAME_STATS_BUCKETS - 1; i >= 0 && remaining > 0; i--) {
+        uint32_t n = ctx->buckets[i];
+        if (n == 0) continue;
+        if (s->maxMs == 0.0f) s->maxMs = bucketMidpointMs(i);
+        if (n > remaining) n = remaining;
+        lowSumMs += (double)n * bucketMidpointMs(i);
+        remaining -= n;
+    }
+
+    double lowMeanMs = lowSumMs / lowCount;
+    s->onePercentLowFPS = lowMeanMs > 0.0 ? (float)(1000.0 / lowMeanMs) : 0.0f;
+}
+
+// ============================================================================
+// Frame Stats API
+// ============================================================================
+
+bool frameStatsInit(void) {
+    if (g_frameStats) {
+        velocityLogWarn("Frame stats already initialized");
+        return true;
+    }
+
+    g_frameStats = (FrameStatsContext*)velocityCalloc(1, sizeof(FrameStatsContext));
+    if (!g_frameStats) {
+        velocityLogError("Failed to allocate frame stats");
+        return false;
+    }
+
+    velocityLogInfo("Frame stats initialized: %d frame window, %d buckets",
+                    FRAME_STATS_WINDOW, FRAME_STATS_BUCKETS);
+    return true;
+}
+
+void frameStatsShutdown(void) {
+    if (!g_frameStats) return;
+
+    velocityFree(g_frameStats);
+    g_frameStats = NULL;
+}
+
+void frameStatsRecord(float frameTimeMs) {
+    FrameStatsContext* ctx = g_frameStats;
+    if (!ctx || frameTimeMs <= 0.0f) return;
+
+    float us = frameTimeMs * 1000.0f + 0.5f;
+    uint32_t sampleUs = us >= (float)MAX_VALUE_US ? MAX_VALUE_US : (uint32_t)us;
+
+    // Judge against the median before this frame joins the window
+    bool isStutter = ctx->count >= FRAME_STATS_MIN_SAMPLES &&
+                     frameTimeMs > ctx->summary.p50Ms * FRAME_STATS_STUTTER_FACTOR;
+
+    // Evict the oldest sample once the window is full
+    if (ctx->count == FRAME_STATS_WINDOW) {
+        uint32_t old = ctx->samplesUs[ctx->head];
+        ctx->buckets[bucketIndex(old)]--;
+        ctx->sumUs -= old;
+        ctx->windowStutters -= ctx->stutter[ctx->head];
+    } else {
+        ctx->count++;
+    }
+
+    ctx->samplesUs[ctx->head] = sampleUs;
+    ctx->stutter[ctx->head] = isStutter ? 1 : 0;
+    ctx->head = (ctx->head + 1) % FRAME_STATS_WINDOW;
+
+    ctx->buckets[bucketIndex(sampleUs)]++;
+    ctx->sumUs += sampleUs;
+
+    if (isStutter) {
+        ctx->windowStutters++;
+        ctx->totalStutters++;
+    }
+
+    refreshSummary(ctx);
+}
+
+void frameStatsGetSummary(FrameStatsSummary* out) {
+    if (!out) return;
+
+    if (g_frameStats) {
+        *out = g_frameStats->summary;
+    } else {
+        memset(out, 0, sizeof(FrameStatsSummary));
+    }
+}
+
+float frameStatsGetPercentile(float percentile) {
+    if (!g_frameStats) return 0.0f;
+    if (percentile < 0.0f) percentile = 0.0f;
+    if (percentile > 100.0f) percentile = 100.0f;
+
+    return percentileMs(g_frameStats, percentile);
+}
+
+void frameStatsReset(void) {
+    if (!g_frameStats) return;
+
+    memset(g_frameStats, 0, sizeof(FrameStatsContext));
+}
@@ -0,0 +1,88 @@
+/**
+ * Frame Stats - Windowed frame-time histogram
+ * Log-linear (HDR style) buckets over the last FRAME_STATS_WINDOW frames,
+ * giving percentiles, 1% lows and stutter counts without sorting.
+ */
+
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define FRAME_STATS_WINDOW          1200    // Frames in the window (~20 s at 60 FPS)
+#define FRAME_STATS_SUB_BITS        5       // 32 sub-buckets per octave, <= 3.2% error
+#define FRAME_STATS_MAX_OCTAVE      26      // Values clamp at 2^26 us (~67 s)
+#define FRAME_STATS_BUCKETS         ((1 << FRAME_STATS_SUB_BITS) + \
+                                     (FRAME_STATS_MAX_OCTAVE - FRAME_STATS_SUB_BITS) * \
+                                     (1 << (FRAME_STATS_SUB_BITS - 1)))
+#define FRAME_STATS_STUTTER_FACTOR  2.0f    // Stutter = frame over 2x the window median
+#define FRAME_STATS_MIN_SAMPLES     30      // Median must be this stable before stutters count
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * Distribution of the current window
+ */
+typedef struct FrameStatsSummary {
+    uint32_t sampleCount;
+    float meanMs;
+    float p50Ms;
+    float p90Ms;
+    float p99Ms;
+    float p999Ms;
+    float maxMs;
+    float onePercentLowFPS;      // FPS over the slowest 1% of frames
+    uint32_t windowStutters;     // Stutters still inside the window
+    uint32_t totalStutters;      // Stutters since reset
+} FrameStatsSummary;
+
+// ============================================================================
+// Frame Stats API
+// ============================================================================
+
+/**
+ * Initialize frame statistics
+ */
+bool frameStatsInit(void);
+
+/**
+ * Shutdown frame statistics
+ */
+void frameStatsShutdown(void);
+
+/**
+ * Record one frame-to-frame interval (render thread only)
+ */
+void frameStatsRecord(float frameTimeMs);
+
+/**
+ * Get the window distribution, refreshed on every record
+ */
+void frameStatsGetSummary(FrameStatsSummary* out);
+
+/**
+ * Get an arbitrary percentile (0-100) of the window in ms
+ */
+float frameStatsGetPercentile(float percentile);
+
+/**
+ * Clear window and stutter counters
+ */
+void frameStatsReset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FRAME_STATS_H
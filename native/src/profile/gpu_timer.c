@@ -0,0 +1,467 @@
+/**
+ * GPU Timer - Implementation
+ * With timestamp counters every span is a pair of GL_TIMESTAMP_EXT
+ * queries, so passes and scopes may overlap freely. Without them only
+ * passes are timed, as back-to-back GL_TIME_ELAPSED_EXT queries.
+ */
+
+#include "gpu_timer.h"
+#include "trace.h"
+#include "../utils/log.h"
+#include "../utils/memory.h"
+
+#include <EGL/egl.h>
+#include <GLES3/gl32.h>
+#include <GLES2/gl2ext.h>
+
+#include <string.h>
+
+// ============================================================================
+// Forward declarations
+// ============================================================================
+
+bool glExtensionSupported(const char* extension);
+
+// ============================================================================
+// Types
+// ============================================================================
+
+typedef enum GpuFrameState {
+    GPU_FRAME_FREE = 0,
+    GPU_FRAME_RECORDING,
+    GPU_FRAME_SUBMITTED
+} GpuFrameState;
+
+typedef struct GpuSpan {
+    const char* name;
+    uint32_t framebuffer;
+    uint64_t cpuSubmitNs;
+    bool pass;
+    bool closed;
+} GpuSpan;
+
+typedef struct GpuFrame {
+    GLuint queries[GPU_TIMER_MAX_SPANS * 2];     // Span i uses 2i (and 2i+1)
+    GpuSpan spans[GPU_TIMER_MAX_SPANS];
+    int spanCount;
+    GLuint lastQuery;            // Last query issued, resolves after all others
+    bool incomplete;             // A pass could not be recorded
+    GpuFrameState state;
+} GpuFrame;
+
+typedef struct GpuTimerContext {
+    bool available;
+    bool timestamps;
+    int64_t clockOffsetNs;       // CPU monotonic minus GPU timestamp
+    int resyncCountdown;
+
+    GpuFrame frames[GPU_TIMER_FRAMES];
+    int head;                    // Next frame to record
+    int tail;                    // Oldest frame in flight
+    int count;
+    GpuFrame* current;
+
+    // Open spans of the current frame, -1 when not recorded
+    int pass;
+    int stack[GPU_TIMER_MAX_DEPTH];
+    int depth;
+
+    // Pass carried over into the next frame
+    const char* passName;
+    uint32_t passFramebuffer;
+
+    // Results
+    GpuPassStats passes[GPU_TIMER_MAX_PASSES];
+    int passCount;
+    float frameTimeMs;
+    float avgFrameTimeMs;
+    uint64_t lastGpuEndNs;
+    uint32_t resolvedFrames;
+    uint32_t droppedFrames;
+    uint32_t disjointFrames;
+    uint32_t droppedScopes;
+} GpuTimerContext;
+
+static GpuTimerContext* g_gpuTimer = NULL;
+
+// EXT_disjoint_timer_query entry points
+static PFNGLGENQUERIESEXTPROC pglGenQueriesEXT = NULL;
+static PFNGLDELETEQUERIESEXTPROC pglDeleteQueriesEXT = NULL;
+static PFNGLBEGINQUERYEXTPROC pglBeginQueryEXT = NULL;
+static PFNGLENDQUERYEXTPROC pglEndQueryEXT = NULL;
+static PFNGLQUERYCOUNTEREXTPROC pglQueryCounterEXT = NULL;
+static PFNGLGETQUERYIVEXTPROC pglGetQueryivEXT = NULL;
+static PFNGLGETQUERYOBJECTUIVEXTPROC pglGetQueryObjectuivEXT = NULL;
+static PFNGLGETQUERYOBJECTUI64VEXTPROC pglGetQueryObjectui64vEXT = NULL;
+static PFNGLGETINTEGER64VEXTPROC pglGetInteger64vEXT = NULL;
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static bool probeExtension(void) {
+    if (!glExtensionSupported("GL_EXT_disjoint_timer_query")) {
+        velocityLogInfo("GPU timer: GL_EXT_disjoint_timer_query unavailable");
+        return false;
+    }
+
+    pglGenQueriesEXT = (PFNGLGENQUERIESEXTPROC)eglGetProcAddress("glGenQueriesEXT");
+    pglDeleteQueriesEXT = (PFNGLDELETEQUERIESEXTPROC)eglGetProcAddress("glDeleteQueriesEXT");
+    pglBeginQueryEXT = (PFNGLBEGINQUERYEXTPROC)eglGetProcAddress("glBeginQueryEXT");
+    pglEndQueryEXT = (PFNGLENDQUERYEXTPROC)eglGetProcAddress("glEndQueryEXT");
+    pglQueryCounterEXT = (PFNGLQUERYCOUNTEREXTPROC)eglGetProcAddress("glQueryCounterEXT");
+    pglGetQueryivEXT = (PFNGLGETQUERYIVEXTPROC)eglGetProcAddress("glGetQueryivEXT");
+    pglGetQueryObjectuivEXT = (PFNGLGETQUERYOBJECTUIVEXTPROC)eglGetProcAddress("glGetQueryObjectuivEXT");
+    pglGetQueryObjectui64vEXT = (PFNGLGETQUERYOBJECTUI64VEXTPROC)eglGetProcAddress("glGetQueryObjectui64vEXT");
+    pglGetInteger64vEXT = (PFNGLGETINTEGER64VEXTPROC)eglGetProcAddress("glGetInteger64vEXT");
+
+    if (!pglGenQueriesEXT || !pglDeleteQueriesEXT || !pglBeginQueryEXT || !pglEndQueryEXT ||
+        !pglGetQueryObjectuivEXT || !pglGetQueryObjectui64vEXT) {
+        velocityLogWarn("GPU timer: timer query entry points missing");
+        return false;
+    }
+
+    // Some drivers expose the extension with a 0-bit timestamp counter
+    GLint counterBits = 0;
+    if (pglQueryCounterEXT && pglGetQueryivEXT && pglGetInteger64vEXT) {
+        pglGetQueryivEXT(GL_TIMESTAMP_EXT, GL_QUERY_COUNTER_BITS_EXT, &counterBits);
+    }
+    g_gpuTimer->timestamps = counterBits > 0;
+
+    return true;
+}
+
+static void resyncClock(void) {
+    if (!g_gpuTimer->timestamps) return;
+
+    GLint64 gpuNow = 0;
+    pglGetInteger64vEXT(GL_TIMESTAMP_EXT, &gpuNow);
+    g_gpuTimer->clockOffsetNs = (int64_t)traceNowNs() - (int64_t)gpuNow;
+    g_gpuTimer->resyncCountdown = GPU_TIMER_RESYNC_FRAMES;
+}
+
+static int openSpan(GpuFrame* frame, const char* name, uint32_t framebuffer, bool pass) {
+    int index = frame->spanCount++;
+    GpuSpan* span = &frame->spans[index];
+    span->name = name;
+    span->framebuffer = framebuffer;
+    span->cpuSubmitNs = traceNowNs();
+    span->pass = pass;
+    span->closed = false;
+
+    GLuint query = frame->queries[index * 2];
+    if (g_gpuTimer->timestamps) {
+        pglQueryCounterEXT(query, GL_TIMESTAMP_EXT);
+    } else {
+        pglBeginQueryEXT(GL_TIME_ELAPSED_EXT, query);
+    }
+    frame->lastQuery = query;
+
+    return index;
+}
+
+static void closeSpan(GpuFrame* frame, int index) {
+    if (index < 0) return;
+
+    if (g_gpuTimer->timestamps) {
+        GLuint query = frame->queries[index * 2 + 1];
+        pglQueryCounterEXT(query, GL_TIMESTAMP_EXT);
+        frame->lastQuery = query;
+    } else {
+        pglEndQueryEXT(GL_TIME_ELAPSED_EXT);
+    }
+    frame->spans[index].closed = true;
+}
+
+static void addPass(const char* name, uint32_t framebuffer, float ms) {
+    for (int i = 0; i < g_gpuTimer->passCount; i++) {
+        GpuPassStats* pass = &g_gpuTimer->passes[i];
+        if (pass->framebuffer == framebuffer && pass->name == name) {
+            pass->gpuTimeMs += ms;
+            return;
+        }
+    }
+
+    if (g_gpuTimer->passCount < GPU_TIMER_MAX_PASSES) {
+        GpuPassStats* pass = &g_gpuTimer->passes[g_gpuTimer->passCount++];
+        pass->name = name;
+        pass->framebuffer = framebuffer;
+        pass->gpuTimeMs = ms;
+    }
+}
+
+static void readFrame(GpuFrame* frame) {
+    float frameMs = 0.0f;
+    g_gpuTimer->passCount = 0;
+
+    for (int i = 0; i < frame->spanCount; i++) {
+        GpuSpan* span = &frame->spans[i];
+        if (!span->closed) continue;
+
+        uint64_t startNs, durationNs;
+
+        if (g_gpuTimer->timestamps) {
+            GLuint64 t0 = 0, t1 = 0;
+            pglGetQueryObjectui64vEXT(frame->queries[i * 2], GL_QUERY_RESULT_EXT, &t0);
+            pglGetQueryObjectui64vEXT(frame->queries[i * 2 + 1], GL_QUERY_RESULT_EXT, &t1);
+            startNs = (uint64_t)((int64_t)t0 + g_gpuTimer->clockOffsetNs);
+            durationNs = t1 > t0 ? t1 - t0 : 0;
+        } else {
+            // Elapsed time only: place the span no earlier than its
+            // submission and after the previous GPU span
+            GLuint64 elapsed = 0;
+            pglGetQueryObjectui64vEXT(frame->queries[i * 2], GL_QUERY_RESULT_EXT, &elapsed);
+            startNs = span->cpuSubmitNs > g_gpuTimer->lastGpuEndNs ?
+                      span->cpuSubmitNs : g_gpuTimer->lastGpuEndNs;
+            durationNs = elapsed;
+        }
+
+        if (span->pass) {
+            float ms = durationNs / 1000000.0f;
+            frameMs += ms;
+            addPass(span->name, span->framebuffer, ms);
+            g_gpuTimer->lastGpuEndNs = startNs + durationNs;
+        }
+
+        if (g_traceActive) {
+            traceRecordGpu(span->name, startNs, durationNs);
+        }
+    }
+
+    if (!frame->incomplete) {
+        g_gpuTimer->frameTimeMs = frameMs;
+        g_gpuTimer->avgFrameTimeMs = g_gpuTimer->resolvedFrames == 0 ? frameMs :
+            g_gpuTimer->avgFrameTimeMs + (frameMs - g_gpuTimer->avgFrameTimeMs) * 0.1f;
+        g_gpuTimer->resolvedFrames++;
+    }
+}
+
+static void releaseOldest(void) {
+    g_gpuTimer->frames[g_gpuTimer->tail].state = GPU_FRAME_FREE;
+    g_gpuTimer->tail = (g_gpuTimer->tail + 1) % GPU_TIMER_FRAMES;
+    g_gpuTimer->count--;
+}
+
+static void resolveFrames(void) {
+    // A disjoint event invalidates every result that is currently in flight
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+
+    while (g_gpuTimer->count > 0) {
+        GpuFrame* frame = &g_gpuTimer->frames[g_gpuTimer->tail];
+        if (frame->state != GPU_FRAME_SUBMITTED) break;
+
+        if (disjoint) {
+            g_gpuTimer->disjointFrames++;
+            releaseOldest();
+            continue;
+        }
+
+        // Queries complete in submission order: the last one covers the frame
+        GLuint available = 0;
+        pglGetQueryObjectuivEXT(frame->lastQuery, GL_QUERY_RESULT_AVAILABLE_EXT, &available);
+        if (!available) break;
+
+        readFrame(frame);
+        releaseOldest();
+    }
+
+    if (disjoint) {
+        resyncClock();
+    }
+}
+
+// ============================================================================
+// Initialization
+// ============================================================================
+
+bool gpuTimerInit(void) {
+    if (g_gpuTimer) return g_gpuTimer->available;
+
+    g_gpuTimer = (GpuTimerContext*)velocityCalloc(1, sizeof(GpuTimerContext));
+    if (!g_gpuTimer) {
+        velocityLogError("Failed to allocate GPU timer context");
+        return false;
+    }
+
+    g_gpuTimer->pass = -1;
+    for (int i = 0; i < GPU_TIMER_MAX_DEPTH; i++) {
+        g_gpuTimer->stack[i] = -1;
+    }
+    g_gpuTimer->passName = "framebuffer";
+
+    if (!probeExtension()) {
+        return false;
+    }
+
+    for (int i = 0; i < GPU_TIMER_FRAMES; i++) {
+        pglGenQueriesEXT(GPU_TIMER_MAX_SPANS * 2, g_gpuTimer->frames[i].queries);
+    }
+
+    resyncClock();
+    g_gpuTimer->available = true;
+
+    velocityLogInfo("GPU timer initialized (%s, %d frames in flight)",
+                    g_gpuTimer->timestamps ? "timestamps" : "elapsed-time queries",
+                    GPU_TIMER_FRAMES);
+    return true;
+}
+
+void gpuTimerShutdown(void) {
+    if (!g_gpuTimer) return;
+
+    if (g_gpuTimer->available) {
+        // An elapsed query must not stay active when its name is deleted
+        if (g_gpuTimer->current && !g_gpuTimer->timestamps && g_gpuTimer->pass >= 0) {
+            pglEndQueryEXT(GL_TIME_ELAPSED_EXT);
+        }
+        for (int i = 0; i < GPU_TIMER_FRAMES; i++) {
+            pglDeleteQueriesEXT(GPU_TIMER_MAX_SPANS * 2, g_gpuTimer->frames[i].queries);
+        }
+    }
+
+    velocityFree(g_gpuTimer);
+    g_gpuTimer = NULL;
+}
+
+bool gpuTimerIsAvailable(void) {
+    return g_gpuTimer && g_gpuTimer->available;
+}
+
+// ============================================================================
+// Frame Boundary
+// ============================================================================
+
+void gpuTimerBeginFrame(void) {
+    if (!g_gpuTimer || !g_gpuTimer->available || g_gpuTimer->current) return;
+
+    // Never wait for results: skip timing while every slot is in flight
+    if (g_gpuTimer->count == GPU_TIMER_FRAMES) {
+        g_gpuTimer->droppedFrames++;
+        return;
+    }
+
+    GpuFrame* frame = &g_gpuTimer->frames[g_gpuTimer->head];
+    g_gpuTimer->head = (g_gpuTimer->head + 1) % GPU_TIMER_FRAMES;
+    g_gpuTimer->count++;
+
+    frame->spanCount = 0;
+    frame->incomplete = false;
+    frame->state = GPU_FRAME_RECORDING;
+    g_gpuTimer->current = frame;
+
+    // Rendering continues into whatever was bound at the end of last frame
+    g_gpuTimer->pass = openSpan(frame, g_gpuTimer->passName, g_gpuTimer->passFramebuffer, true);
+}
+
+void gpuTimerEndFrame(void) {
+    if (!g_gpuTimer || !g_gpuTimer->available) return;
+
+    GpuFrame* frame = g_gpuTimer->current;
+    if (frame) {
+        // Scopes left open across the frame boundary are not reported
+        for (int i = 0; i < g_gpuTimer->depth && i < GPU_TIMER_MAX_DEPTH; i++) {
+            g_gpuTimer->stack[i] = -1;
+        }
+
+        closeSpan(frame, g_gpuTimer->pass);
+        g_gpuTimer->pass = -1;
+
+        frame->state = GPU_FRAME_SUBMITTED;
+        g_gpuTimer->current = NULL;
+    }
+
+    resolveFrames();
+
+    if (--g_gpuTimer->resyncCountdown <= 0) {
+        resyncClock();
+    }
+}
+
+// ============================================================================
+// Passes and Scopes
+// ============================================================================
+
+void gpuTimerBeginPass(const char* name, uint32_t framebuffer) {
+    if (!g_gpuTimer) return;
+
+    g_gpuTimer->passName = name;
+    g_gpuTimer->passFramebuffer = framebuffer;
+
+    GpuFrame* frame = g_gpuTimer->current;
+    if (!frame) return;
+
+    closeSpan(frame, g_gpuTimer->pass);
+    g_gpuTimer->pass = -1;
+
+    if (frame->spanCount < GPU_TIMER_MAX_SPANS) {
+        g_gpuTimer->pass = openSpan(frame, name, framebuffer, true);
+    } else {
+        frame->incomplete = true;
+    }
+}
+
+void gpuTimerBeginScope(const char* name) {
+    if (!g_gpuTimer) return;
+
+    if (g_gpuTimer->depth >= GPU_TIMER_MAX_DEPTH) {
+        g_gpuTimer->depth++;
+        return;
+    }
+
+    GpuFrame* frame = g_gpuTimer->current;
+    int index = -1;
+
+    if (g_traceActive && frame && g_gpuTimer->timestamps) {
+        if (frame->spanCount < GPU_TIMER_MAX_SPANS - GPU_TIMER_PASS_RESERVE) {
+            index = openSpan(frame, name, 0, false);
+        } else {
+            g_gpuTimer->droppedScopes++;
+        }
+    }
+
+    g_gpuTimer->stack[g_gpuTimer->depth++] = index;
+}
+
+void gpuTimerEndScope(void) {
+    if (!g_gpuTimer || g_gpuTimer->depth == 0) return;
+
+    g_gpuTimer->depth--;
+    if (g_gpuTimer->depth >= GPU_TIMER_MAX_DEPTH) return;
+
+    int index = g_gpuTimer->stack[g_gpuTimer->depth];
+    g_gpuTimer->stack[g_gpuTimer->depth] = -1;
+
+    if (g_gpuTimer->current) {
+        closeSpan(g_gpuTimer->current, index);
+    }
+}
+
+// ============================================================================
+// Statistics
+// ============================================================================
+
+void gpuTimerGetStats(GpuTimerStats* stats) {
+    if (!stats) return;
+
+    memset(stats, 0, sizeof(GpuTimerStats));
+    if (!g_gpuTimer) return;
+
+    stats->available = g_gpuTimer->available;
+    stats->timestamps = g_gpuTimer->timestamps;
+    stats->frameTimeMs = g_gpuTimer->frameTimeMs;
+    stats->avgFrameTimeMs = g_gpuTimer->avgFrameTimeMs;
+    stats->latencyFrames = (uint32_t)g_gpuTimer->count;
+    stats->resolvedFrames = g_gpuTimer->resolvedFrames;
+    stats->droppedFrames = g_gpuTimer->droppedFrames;
+    stats->disjointFrames = g_gpuTimer->disjointFrames;
+    stats->droppedScopes = g_gpuTimer->droppedScopes;
+}
+
+int gpuTimerGetPasses(GpuPassStats* passes, int maxEntries) {
+    if (!g_gpuTimer || !passes || maxEntries <= 0) return 0;
+
+    int count = g_gpuTimer->passCount < maxEntries ? g_gpuTimer->passCount : maxEntries;
+    memcpy(passes, g_gpuTimer->passes, count * sizeof(GpuPassStats));
+    return count;
+}
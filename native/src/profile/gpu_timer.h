@@ -0,0 +1,116 @@
+/**
+ * GPU Timer - Frame and pass GPU time from timer queries
+ * A ring of GL_EXT_disjoint_timer_query frames read back without blocking
+ * a few frames later. Frames are split into passes at framebuffer binds;
+ * nested scopes (batcher flushes, upscale) are timed while tracing when
+ * timestamp queries are available. Resolved spans also feed the trace.
+ */
+
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define GPU_TIMER_FRAMES            4       // Frames in flight before readback
+#define GPU_TIMER_MAX_SPANS         64      // Passes + scopes per frame
+#define GPU_TIMER_PASS_RESERVE      16      // Spans scopes may not take from passes
+#define GPU_TIMER_MAX_DEPTH         8
+#define GPU_TIMER_MAX_PASSES        16      // Distinct passes reported per frame
+#define GPU_TIMER_RESYNC_FRAMES     120
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * GPU time of one pass in the last resolved frame
+ */
+typedef struct GpuPassStats {
+    const char* name;
+    uint32_t framebuffer;        // Draw framebuffer the pass rendered into
+    float gpuTimeMs;             // Summed over binds of the same framebuffer
+} GpuPassStats;
+
+/**
+ * Timer statistics
+ */
+typedef struct GpuTimerStats {
+    bool available;              // GL_EXT_disjoint_timer_query in use
+    bool timestamps;             // Timestamp counters (nested scopes) available
+    float frameTimeMs;           // GPU time of the last resolved frame
+    float avgFrameTimeMs;        // EMA of frameTimeMs
+    uint32_t latencyFrames;      // Frames between submission and readback
+    uint32_t resolvedFrames;
+    uint32_t droppedFrames;      // Not timed because every slot was in flight
+    uint32_t disjointFrames;     // Discarded after a disjoint event
+    uint32_t droppedScopes;
+} GpuTimerStats;
+
+// ============================================================================
+// GPU Timer API
+// ============================================================================
+
+/**
+ * Initialize timer (requires GL context)
+ */
+bool gpuTimerInit(void);
+
+/**
+ * Shutdown timer and delete queries
+ */
+void gpuTimerShutdown(void);
+
+/**
+ * Check if GPU timing is available
+ */
+bool gpuTimerIsAvailable(void);
+
+/**
+ * Start timing a frame (call after swap)
+ */
+void gpuTimerBeginFrame(void);
+
+/**
+ * Close the frame and resolve finished frames (call before swap)
+ */
+void gpuTimerEndFrame(void);
+
+/**
+ * Start a new pass, closing the current one
+ */
+void gpuTimerBeginPass(const char* name, uint32_t framebuffer);
+
+/**
+ * Begin a nested scope (recorded while tracing, timestamps only)
+ */
+void gpuTimerBeginScope(const char* name);
+
+/**
+ * End the innermost scope
+ */
+void gpuTimerEndScope(void);
+
+/**
+ * Get timer statistics
+ */
+void gpuTimerGetStats(GpuTimerStats* stats);
+
+/**
+ * Get pass breakdown of the last resolved frame, returns entries written
+ */
+int gpuTimerGetPasses(GpuPassStats* passes, int maxEntries);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GPU_TIMER_H
@@ -0,0 +1,158 @@
+/**
+ * Metrics Export - Implementation
+ */
+
+#include "metrics_export.h"
+#include "../utils/log.h"
+#include "../utils/seqlock.h"
+
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC         0x0001U
+#endif
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING   0x0002U
+#endif
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS         1033
+#define F_SEAL_SHRINK       0x0002
+#define F_SEAL_GROW         0x0004
+#endif
+
+// Readers hard-code these offsets
+_Static_assert(offsetof(VelocityMetricsBlock, sequence) == 12, "metrics sequence offset");
+_Static_assert(offsetof(VelocityMetricsBlock, metrics) == 16, "metrics payload offset");
+_Static_assert(offsetof(VelocityMetricsBlock, metrics.fps) == 64, "metrics fps offset");
+_Static_assert(offsetof(VelocityMetricsBlock, metrics.resolutionScale) == 132, "metrics scale offset");
+_Static_assert(sizeof(VelocityMetricsBlock) == 152, "metrics block size");
+_Static_assert(sizeof(VelocityMetrics) % sizeof(uint32_t) == 0, "metrics copied as words");
+
+// ============================================================================
+// Types
+// ============================================================================
+
+typedef struct MetricsExportContext {
+    VelocityMetricsBlock* block;
+    size_t size;
+    int fd;
+    bool active;
+} MetricsExportContext;
+
+// The mapping outlives shutdown: overlays may still hold a ByteBuffer or
+// pointer to it, so it is only marked inactive and reused on re-init
+static MetricsExportContext g_metrics = { NULL, 0, -1, false };
+
+static inline SeqLock* blockLock(VelocityMetricsBlock* block) {
+    // The public layout exposes the sequence as a plain word
+    return (SeqLock*)&block->sequence;
+}
+
+// ============================================================================
+// Metrics Export API
+// ============================================================================
+
+static void resetBlock(void) {
+    memset(g_metrics.block, 0, sizeof(VelocityMetricsBlock));
+    g_metrics.block->version = VELOCITY_METRICS_VERSION;
+    g_metrics.block->size = sizeof(VelocityMetricsBlock);
+    __atomic_store_n(&g_metrics.block->magic, VELOCITY_METRICS_MAGIC, __ATOMIC_RELEASE);
+}
+
+bool metricsExportInit(void) {
+    if (g_metrics.active) {
+        velocityLogWarn("Metrics export already initialized");
+        return true;
+    }
+
+    if (g_metrics.block) {
+        resetBlock();
+        g_metrics.active = true;
+        return true;
+    }
+
+    long pageSize = sysconf(_SC_PAGESIZE);
+    size_t size = pageSize > 0 ? (size_t)pageSize : 4096;
+    int fd = -1;
+    void* mapping = MAP_FAILED;
+
+    // memfd_create has no libc wrapper before API 30, go through syscall
+#ifdef __NR_memfd_create
+    fd = (int)syscall(__NR_memfd_create, "velocitygl-metrics", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#endif
+
+    if (fd >= 0) {
+        if (ftruncate(fd, (off_t)size) == 0) {
+            fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW);
+            mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    // Old kernels: in-process readers still work, local tools do not
+    if (mapping == MAP_FAILED) {
+        mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED) {
+            velocityLogError("Failed to map metrics block");
+            return false;
+        }
+    }
+
+    g_metrics.block = (VelocityMetricsBlock*)mapping;
+    g_metrics.size = size;
+    g_metrics.fd = fd;
+
+    resetBlock();
+    g_metrics.active = true;
+
+    velocityLogInfo("Metrics export initialized (%s, fd %d)", fd >= 0 ? "memfd" : "anonymous", fd);
+    return true;
+}
+
+void metricsExportShutdown(void) {
+    if (!g_metrics.active) return;
+
+    // Readers check the magic before trusting the payload
+    __atomic_store_n(&g_metrics.block->magic, 0, __ATOMIC_RELEASE);
+    g_metrics.active = false;
+}
+
+void metricsExportPublish(const VelocityMetrics* metrics) {
+    if (!g_metrics.active || !metrics) return;
+
+    seqlockPublish(blockLock(g_metrics.block), &g_metrics.block->metrics,
+                   metrics, sizeof(VelocityMetrics));
+}
+
+bool metricsExportRead(VelocityMetrics* out) {
+    if (!out) return false;
+
+    if (!g_metrics.active) {
+        memset(out, 0, sizeof(VelocityMetrics));
+        return false;
+    }
+
+    seqlockRead(blockLock(g_metrics.block), out, &g_metrics.block->metrics,
+                sizeof(VelocityMetrics));
+    return true;
+}
+
+const VelocityMetricsBlock* metricsExportGetBlock(void) {
+    return g_metrics.active ? g_metrics.block : NULL;
+}
+
+int metricsExportGetFd(void) {
+    return g_metrics.active ? g_metrics.fd : -1;
+}
+
+size_t metricsExportGetSize(void) {
+    return g_metrics.size;
+}
@@ -0,0 +1,58 @@
+/**
+ * Metrics Export - Shared-memory metrics block
+ * A memfd-backed page holding VelocityMetricsBlock, published once per
+ * frame under a seqlock so overlays and local tools can poll it without
+ * JNI calls or locks.
+ */
+
+#ifndef METRICS_EXPORT_H
+#define METRICS_EXPORT_H
+
+#include "velocity_gl.h"
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Create and map the metrics block
+ */
+bool metricsExportInit(void);
+
+/**
+ * Mark the block inactive (the mapping stays valid for existing readers)
+ */
+void metricsExportShutdown(void);
+
+/**
+ * Publish metrics (render thread only)
+ */
+void metricsExportPublish(const VelocityMetrics* metrics);
+
+/**
+ * Read a consistent copy (any thread)
+ */
+bool metricsExportRead(VelocityMetrics* out);
+
+/**
+ * Get the mapped block, NULL if not initialized
+ */
+const VelocityMetricsBlock* metricsExportGetBlock(void);
+
+/**
+ * Get the memfd, -1 when backed by anonymous memory
+ */
+int metricsExportGetFd(void);
+
+/**
+ * Get the mapping size in bytes
+ */
+size_t metricsExportGetSize(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // METRICS_EXPORT_H
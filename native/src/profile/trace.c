@@ -0,0 +1,344 @@
+/**
+ * Trace - Implementation
+ * Every thread writes its own ring; the exporter copies rings without
+ * stopping writers and discards slots that were overwritten mid-copy.
+ */
+
+#include "trace.h"
+#include "../utils/log.h"
+#include "../utils/memory.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+// ============================================================================
+// Types
+// ============================================================================
+
+#define TRACE_THREAD_MASK (TRACE_THREAD_CAPACITY - 1)
+
+typedef struct TraceThreadBuffer {
+    TraceEvent events[TRACE_THREAD_CAPACITY];
+    uint64_t head;               // Events written so far (owner stores with release)
+    int tid;
+    struct TraceThreadBuffer* next;
+} TraceThreadBuffer;
+
+// GPU spans resolved by the GPU timer, written on the render thread
+typedef struct TraceGpuState {
+    TraceEvent events[TRACE_GPU_CAPACITY];
+    uint64_t head;
+} TraceGpuState;
+
+typedef struct TraceContext {
+    pthread_mutex_t mutex;
+    TraceThreadBuffer* threads;
+
+    uint64_t sessionStartNs;
+    uint32_t windowMs;
+
+    // Frame capture
+    char* capturePath;
+    int captureFramesLeft;
+    bool captureOwnsSession;
+
+    TraceGpuState gpu;
+} TraceContext;
+
+static TraceContext* g_trace = NULL;
+volatile bool g_traceActive = false;
+
+static volatile uint32_t g_traceGeneration = 1;
+static _Thread_local TraceThreadBuffer* t_traceBuffer = NULL;
+static _Thread_local uint32_t t_traceGeneration = 0;
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+uint64_t traceNowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static TraceThreadBuffer* registerThread(void) {
+    if (!g_trace) return NULL;
+
+    TraceThreadBuffer* buffer = (TraceThreadBuffer*)velocityCalloc(1, sizeof(TraceThreadBuffer));
+    if (!buffer) return NULL;
+
+    buffer->tid = (int)syscall(SYS_gettid);
+
+    pthread_mutex_lock(&g_trace->mutex);
+    buffer->next = g_trace->threads;
+    g_trace->threads = buffer;
+    pthread_mutex_unlock(&g_trace->mutex);
+
+    t_traceBuffer = buffer;
+    t_traceGeneration = g_traceGeneration;
+    return buffer;
+}
+
+// ============================================================================
+// Initialization
+// ============================================================================
+
+bool traceInit(void) {
+    if (g_trace) return true;
+
+    g_trace = (TraceContext*)velocityCalloc(1, sizeof(TraceContext));
+    if (!g_trace) {
+        velocityLogError("Failed to allocate trace context");
+        return false;
+    }
+
+    pthread_mutex_init(&g_trace->mutex, NULL);
+
+    velocityLogInfo("Trace initialized (%d events per thread)", TRACE_THREAD_CAPACITY);
+    return true;
+}
+
+void traceShutdown(void) {
+    if (!g_trace) return;
+
+    g_traceActive = false;
+    __atomic_add_fetch(&g_traceGeneration, 1, __ATOMIC_SEQ_CST);
+
+    TraceThreadBuffer* buffer = g_trace->threads;
+    while (buffer) {
+        TraceThreadBuffer* next = buffer->next;
+        velocityFree(buffer);
+        buffer = next;
+    }
+
+    if (g_trace->capturePath) {
+        velocityFree(g_trace->capturePath);
+    }
+
+    pthread_mutex_destroy(&g_trace->mutex);
+    velocityFree(g_trace);
+    g_trace = NULL;
+}
+
+// ============================================================================
+// Recording Control
+// ============================================================================
+
+void traceStart(uint32_t windowMs) {
+#ifdef VELOCITY_PROFILING
+    if (!g_trace) return;
+
+    g_trace->windowMs = windowMs;
+    if (!g_traceActive) {
+        g_trace->sessionStartNs = traceNowNs();
+        g_traceActive = true;
+        velocityLogInfo("Trace recording started (window: %u ms)", windowMs);
+    }
+#else
+    (void)windowMs;
+    velocityLogWarn("Trace unavailable: built without VELOCITY_PROFILING");
+#endif
+}
+
+void traceStop(void) {
+    if (!g_trace || !g_traceActive) return;
+
+    g_traceActive = false;
+    velocityLogInfo("Trace recording stopped");
+}
+
+bool traceIsActive(void) {
+    return g_traceActive;
+}
+
+void traceCaptureFrames(const char* path, int frames) {
+    if (!g_trace || !path || frames <= 0) return;
+
+    pthread_mutex_lock(&g_trace->mutex);
+    if (g_trace->capturePath) {
+        velocityFree(g_trace->capturePath);
+    }
+    g_trace->capturePath = velocityStrdup(path);
+    g_trace->captureFramesLeft = frames;
+    g_trace->captureOwnsSession = !g_traceActive;
+    pthread_mutex_unlock(&g_trace->mutex);
+
+    if (!g_traceActive) {
+        traceStart(0);
+    }
+}
+
+// ============================================================================
+// CPU Events
+// ============================================================================
+
+void traceRecord(const char* name, uint64_t startNs, uint64_t durationNs) {
+    TraceThreadBuffer* buffer = t_traceBuffer;
+    if (!buffer || t_traceGeneration != g_traceGeneration) {
+        buffer = registerThread();
+        if (!buffer) return;
+    }
+
+    uint64_t head = buffer->head;
+    TraceEvent* event = &buffer->events[head & TRACE_THREAD_MASK];
+    event->name = name;
+    event->startNs = startNs;
+    event->durationNs = durationNs;
+
+    __atomic_store_n(&buffer->head, head + 1, __ATOMIC_RELEASE);
+}
+
+// ============================================================================
+// GPU Spans
+// ============================================================================
+
+void traceRecordGpu(const char* name, uint64_t startNs, uint64_t durationNs) {
+    if (!g_trace) return;
+
+    TraceGpuState* gpu = &g_trace->gpu;
+    TraceEvent* event = &gpu->events[gpu->head % TRACE_GPU_CAPACITY];
+    event->name = name;
+    event->startNs = startNs;
+    event->durationNs = durationNs;
+    __atomic_store_n(&gpu->head, gpu->head + 1, __ATOMIC_RELEASE);
+}
+
+// ============================================================================
+// Frame Boundary
+// ============================================================================
+
+void traceEndFrame(void) {
+    if (!g_trace) return;
+
+    if (g_trace->captureFramesLeft > 0 && --g_trace->captureFramesLeft == 0) {
+        char* path = g_trace->capturePath;
+        g_trace->capturePath = NULL;
+
+        if (g_trace->captureOwnsSession) {
+            traceStop();
+        }
+
+        if (path) {
+            traceDump(path);
+            velocityFree(path);
+        }
+    }
+}
+
+// ============================================================================
+// Export
+// ============================================================================
+
+typedef struct TraceWriter {
+    FILE* file;
+    bool first;
+    uint64_t minStartNs;
+} TraceWriter;
+
+static void writeEvent(TraceWriter* w, const TraceEvent* e, int tid) {
+    if (!e->name || e->startNs < w->minStartNs) return;
+
+    fprintf(w->file, "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+            "\"ts\":%.3f,\"dur\":%.3f}",
+            w->first ? "" : ",", e->name, tid == 0 ? "gpu" : "cpu", tid,
+            e->startNs / 1000.0, e->durationNs / 1000.0);
+    w->first = false;
+}
+
+static void writeThreadName(TraceWriter* w, int tid, const char* name) {
+    fprintf(w->file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+            "\"args\":{\"name\":\"%s\"}}",
+            w->first ? "" : ",", tid, name);
+    w->first = false;
+}
+
+// Copy the live part of a ring, dropping slots the writer reused meanwhile
+static int snapshotRing(const TraceEvent* ring, uint64_t capacity, const uint64_t* headPtr,
+                        TraceEvent* out) {
+    uint64_t head = __atomic_load_n(headPtr, __ATOMIC_ACQUIRE);
+    uint64_t count = head < capacity ? head : capacity;
+    uint64_t first = head - count;
+
+    for (uint64_t i = 0; i < count; i++) {
+        out[i] = ring[(first + i) % capacity];
+    }
+
+    uint64_t headAfter = __atomic_load_n(headPtr, __ATOMIC_ACQUIRE);
+    uint64_t overwritten = headAfter > capacity ? headAfter - capacity : 0;
+    uint64_t skip = overwritten > first ? overwritten - first : 0;
+    if (skip > count) skip = count;
+
+    if (skip > 0) {
+        memmove(out, out + skip, (count - skip) * sizeof(TraceEvent));
+    }
+    return (int)(count - skip);
+}
+
+bool traceDump(const char* path) {
+    if (!g_trace || !path) return false;
+
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        velocityLogError("Failed to open trace file: %s", path);
+        return false;
+    }
+
+    TraceEvent* scratch = (TraceEvent*)velocityMalloc(sizeof(TraceEvent) * TRACE_THREAD_CAPACITY);
+    if (!scratch) {
+        fclose(file);
+        return false;
+    }
+
+    TraceWriter writer = {file, true, g_trace->sessionStartNs};
+    if (g_trace->windowMs > 0) {
+        uint64_t windowStart = traceNowNs() - (uint64_t)g_trace->windowMs * 1000000ULL;
+        if (windowStart > writer.minStartNs) writer.minStartNs = windowStart;
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    fprintf(file, "\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"VelocityGL\"}}");
+    writer.first = false;
+
+    int eventCount = 0;
+
+    pthread_mutex_lock(&g_trace->mutex);
+    for (TraceThreadBuffer* buffer = g_trace->threads; buffer; buffer = buffer->next) {
+        char threadName[32];
+        snprintf(threadName, sizeof(threadName), "thread %d", buffer->tid);
+        writeThreadName(&writer, buffer->tid, threadName);
+
+        int count = snapshotRing(buffer->events, TRACE_THREAD_CAPACITY, &buffer->head, scratch);
+        for (int i = 0; i < count; i++) {
+            writeEvent(&writer, &scratch[i], buffer->tid);
+        }
+        eventCount += count;
+    }
+    pthread_mutex_unlock(&g_trace->mutex);
+
+    GpuTimerStats gpuStats;
+    gpuTimerGetStats(&gpuStats);
+    
+    TraceGpuState* gpu = &g_trace->gpu;
+    if (gpuStats.available) {
+        writeThreadName(&writer, 0, "GPU");
+
+        int count = snapshotRing(gpu->events, TRACE_GPU_CAPACITY, &gpu->head, scratch);
+        for (int i = 0; i < count; i++) {
+            writeEvent(&writer, &scratch[i], 0);
+        }
+        eventCount += count;
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    velocityFree(scratch);
+
+    velocityLogInfo("Trace written to %s (%d events, %u GPU spans dropped)",
+                    path, eventCount, gpuStats.droppedScopes);
+    return true;
+}
@@ -0,0 +1,157 @@
+/**
+ * Trace - Scoped CPU/GPU timeline events
+ * Scopes are recorded into per-thread lock-free rings and exported as
+ * Chrome Trace Event JSON (loadable in chrome://tracing and Perfetto UI)
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "gpu_timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define TRACE_THREAD_CAPACITY   16384   // Events kept per thread (power of two)
+#define TRACE_GPU_CAPACITY      4096    // GPU spans kept
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * One complete event ("ph":"X")
+ */
+typedef struct TraceEvent {
+    const char* name;        // Static string
+    uint64_t startNs;        // CLOCK_MONOTONIC
+    uint64_t durationNs;
+} TraceEvent;
+
+/**
+ * Open CPU scope, lives on the stack of the instrumented function
+ */
+typedef struct TraceScope {
+    const char* name;        // NULL when tracing was off at scope entry
+    uint64_t startNs;
+} TraceScope;
+
+// Hot-path switch, read without locking
+extern volatile bool g_traceActive;
+
+// ============================================================================
+// Trace API
+// ============================================================================
+
+/**
+ * Initialize tracing (buffers are allocated lazily per thread)
+ */
+bool traceInit(void);
+
+/**
+ * Shutdown tracing and release all buffers
+ */
+void traceShutdown(void);
+
+/**
+ * Start recording; windowMs > 0 keeps only the last windowMs on export
+ */
+void traceStart(uint32_t windowMs);
+
+/**
+ * Stop recording (recorded events stay available for export)
+ */
+void traceStop(void);
+
+/**
+ * Check if recording
+ */
+bool traceIsActive(void);
+
+/**
+ * Record N frames and write them to path at the end of the last frame
+ */
+void traceCaptureFrames(const char* path, int frames);
+
+/**
+ * Write recorded events as Chrome Trace Event JSON
+ */
+bool traceDump(const char* path);
+
+/**
+ * Frame boundary: finishes pending captures
+ */
+void traceEndFrame(void);
+
+/**
+ * Record a finished event on the calling thread
+ */
+void traceRecord(const char* name, uint64_t startNs, uint64_t durationNs);
+
+/**
+ * Record a resolved GPU span (called by the GPU timer)
+ */
+void traceRecordGpu(const char* name, uint64_t startNs, uint64_t durationNs);
+
+/**
+ * Monotonic clock in nanoseconds
+ */
+uint64_t traceNowNs(void);
+
+static inline TraceScope traceScopeBegin(const char* name) {
+    TraceScope scope = {NULL, 0};
+    if (__builtin_expect(g_traceActive, 0)) {
+        scope.name = name;
+        scope.startNs = traceNowNs();
+    }
+    return scope;
+}
+
+static inline void traceScopeEnd(TraceScope* scope) {
+    if (__builtin_expect(scope->name != NULL, 0)) {
+        traceRecord(scope->name, scope->startNs, traceNowNs() - scope->startNs);
+    }
+}
+
+// ============================================================================
+// Instrumentation Macros
+// ============================================================================
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#ifdef VELOCITY_PROFILING
+
+// CPU scope that ends when the enclosing block exits
+#define TRACE_SCOPE(name) \
+    TraceScope TRACE_CONCAT(_traceScope, __LINE__) \
+        __attribute__((cleanup(traceScopeEnd))) = traceScopeBegin(name)
+
+// GPU span around GL work issued between begin and end, timed by the GPU
+// timer. Both calls are made even when tracing is off so begin/end pairs
+// always stay balanced; they are issued a handful of times per frame.
+#define TRACE_GPU_BEGIN(name) gpuTimerBeginScope(name)
+#define TRACE_GPU_END() gpuTimerEndScope()
+
+#else
+
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_GPU_BEGIN(name) ((void)0)
+#define TRACE_GPU_END() ((void)0)
+
+#endif // VELOCITY_PROFILING
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TRACE_H
@@ -7,6 +7,7 @@
 #include "../utils/memory.h"
 #include "../utils/hash.h"
 #include "../core/gl_wrapper.h"
+#include "../profile/trace.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -396,6 +397,8 @@ bool shaderCacheLoadFromDisk(void) {
         return false;
     }
     
+    TRACE_SCOPE("shader_cache_load");
+    
     char filename[512];
     snprintf(filename, sizeof(filename), "%s/shader_cache.bin", g_shaderCache->cachePath);
     
@@ -465,6 +468,8 @@ bool shaderCacheSaveToDisk(void) {
         return false;
     }
     
+    TRACE_SCOPE("shader_cache_save");
+    
     char filename[512];
     snprintf(filename, sizeof(filename), "%s/shader_cache.bin", g_shaderCache->cachePath);
     
@@ -0,0 +1,693 @@
+/**
+ * Storage Pool - Implementation
+ * A pooled object is one the app deleted: what glDeleteTextures would do
+ * to the context (unbinding it from texture units, detaching it from the
+ * bound framebuffers) is done by hand, and if tracked state can't tell
+ * where it is bound the object is deleted after all.
+ */
+
+#include "storage_pool.h"
+#include "../core/gl_wrapper.h"
+#include "../utils/log.h"
+#include "../utils/memory.h"
+
+#include <string.h>
+
+bool glExtensionSupported(const char* extension);
+
+#ifndef GL_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_TEXTURE_MAX_ANISOTROPY_EXT 0x84FE
+#endif
+
+// ============================================================================
+// Types
+// ============================================================================
+
+#define UNKNOWN_BINDING 0xFFFFFFFFu
+
+typedef struct StorageSlot {
+    GLuint name;                 // 0: empty
+    GLuint object;               // Alias tables: object backing the name
+    StorageKey key;              // Record tables: storage the object holds
+} StorageSlot;
+
+// Open addressing with linear probing, at most 3/4 full
+typedef struct StorageTable {
+    StorageSlot* slots;
+    uint32_t mask;
+    uint32_t count;
+} StorageTable;
+
+typedef struct PooledStorage {
+    GLuint name;
+    StorageKey key;
+    size_t bytes;
+    uint32_t frame;              // Frame it was released in
+} PooledStorage;
+
+typedef struct TextureParameters {
+    GLint ints[14];
+    GLfloat lod[2];
+    GLfloat borderColor[4];
+    GLfloat anisotropy;
+} TextureParameters;
+
+typedef struct StoragePoolContext {
+    bool initialized;
+    bool enabled;
+    size_t budget;
+
+    StorageTable textureRecords;
+    StorageTable renderbufferRecords;
+    StorageTable textureAliases;
+    StorageTable renderbufferAliases;
+
+    // Released objects, oldest first
+    PooledStorage entries[STORAGE_POOL_MAX_ENTRIES];
+    int entryCount;
+    size_t pooledBytes;
+
+    uint32_t frame;
+    int esVersion;               // 30, 31, 32
+    bool anisotropy;
+
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t freed;
+} StoragePoolContext;
+
+static StoragePoolContext g_pool = {0};
+
+static const GLenum INT_PARAMETERS[] = {
+    GL_TEXTURE_MIN_FILTER, GL_TEXTURE_MAG_FILTER,
+    GL_TEXTURE_WRAP_S, GL_TEXTURE_WRAP_T, GL_TEXTURE_WRAP_R,
+    GL_TEXTURE_BASE_LEVEL, GL_TEXTURE_MAX_LEVEL,
+    GL_TEXTURE_COMPARE_MODE, GL_TEXTURE_COMPARE_FUNC,
+    GL_TEXTURE_SWIZZLE_R, GL_TEXTURE_SWIZZLE_G, GL_TEXTURE_SWIZZLE_B, GL_TEXTURE_SWIZZLE_A,
+    GL_DEPTH_STENCIL_TEXTURE_MODE,   // ES 3.1
+};
+
+#define INT_PARAMETER_COUNT (int)(sizeof(INT_PARAMETERS) / sizeof(INT_PARAMETERS[0]))
+
+static const TextureParameters DEFAULT_PARAMETERS = {
+    .ints = {
+        GL_NEAREST_MIPMAP_LINEAR, GL_LINEAR,
+        GL_REPEAT, GL_REPEAT, GL_REPEAT,
+        0, 1000,
+        GL_NONE, GL_LEQUAL,
+        GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA,
+        GL_DEPTH_COMPONENT,
+    },
+    .lod = { -1000.0f, 1000.0f },
+    .borderColor = { 0.0f, 0.0f, 0.0f, 0.0f },
+    .anisotropy = 1.0f,
+};
+
+// ============================================================================
+// Tables
+// ============================================================================
+
+static inline uint32_t slotIndex(const StorageTable* table, GLuint name) {
+    return (name * 2654435761u) & table->mask;
+}
+
+static bool tableCreate(StorageTable* table, uint32_t capacity) {
+    table->slots = (StorageSlot*)velocityCalloc(capacity, sizeof(StorageSlot));
+    table->mask = capacity - 1;
+    table->count = 0;
+    return table->slots != NULL;
+}
+
+static void tableDestroy(StorageTable* table) {
+    velocityFree(table->slots);
+    memset(table, 0, sizeof(StorageTable));
+}
+
+static StorageSlot* tableFind(const StorageTable* table, GLuint name) {
+    if (table->count == 0 || name == 0) return NULL;
+
+    for (uint32_t i = slotIndex(table, name); ; i = (i + 1) & table->mask) {
+        StorageSlot* slot = &table->slots[i];
+        if (slot->name == name) return slot;
+        if (slot->name == 0) return NULL;
+    }
+}
+
+static StorageSlot* tableInsert(StorageTable* table, GLuint name) {
+    if (!table->slots || name == 0) return NULL;
+
+    uint32_t i = slotIndex(table, name);
+    for (; table->slots[i].name != 0; i = (i + 1) & table->mask) {
+        if (table->slots[i].name == name) return &table->slots[i];
+    }
+
+    if ((table->count + 1) * 4 > (table->mask + 1) * 3) return NULL;
+
+    StorageSlot* slot = &table->slots[i];
+    memset(slot, 0, sizeof(StorageSlot));
+    slot->name = name;
+    table->count++;
+    return slot;
+}
+
+static void tableRemove(StorageTable* table, GLuint name) {
+    StorageSlot* slot = tableFind(table, name);
+    if (!slot) return;
+
+    // Backward shift: pull later slots of the probe run into the hole
+    uint32_t hole = (uint32_t)(slot - table->slots);
+    for (uint32_t i = (hole + 1) & table->mask; table->slots[i].name != 0; i = (i + 1) & table->mask) {
+        uint32_t home = slotIndex(table, table->slots[i].name);
+        bool stays = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+        if (stays) continue;
+
+        table->slots[hole] = table->slots[i];
+        hole = i;
+    }
+    table->slots[hole].name = 0;
+    table->count--;
+}
+
+static GLuint tableReverse(const StorageTable* table, GLuint object) {
+    if (table->count == 0 || object == 0) return object;
+
+    for (uint32_t i = 0; i <= table->mask; i++) {
+        if (table->slots[i].name != 0 && table->slots[i].object == object) {
+            return table->slots[i].name;
+        }
+    }
+    return object;
+}
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static int formatBytes(GLenum internalFormat) {
+    switch (internalFormat) {
+        case GL_R8: case GL_R8UI: case GL_R8I: case GL_STENCIL_INDEX8:
+            return 1;
+        case GL_RG8: case GL_R16F: case GL_R16UI: case GL_R16I: case GL_RGB565:
+        case GL_RGBA4: case GL_RGB5_A1: case GL_DEPTH_COMPONENT16:
+            return 2;
+        case GL_RGB8: case GL_SRGB8: case GL_DEPTH_COMPONENT24:
+            return 3;
+        case GL_RGB16F:
+            return 6;
+        case GL_RGBA16F: case GL_RGBA16UI: case GL_RGBA16I: case GL_RG32F:
+        case GL_DEPTH32F_STENCIL8:
+            return 8;
+        case GL_RGB32F:
+            return 12;
+        case GL_RGBA32F: case GL_RGBA32UI: case GL_RGBA32I:
+            return 16;
+        default:
+            return 4;
+    }
+}
+
+static size_t storageBytes(const StorageKey* key) {
+    size_t texels = (size_t)key->width * key->height;
+    if (key->depth > 1) texels *= key->depth;
+    if (key->target == GL_TEXTURE_CUBE_MAP) texels *= 6;
+    if (key->samples > 1) texels *= key->samples;
+
+    size_t bytes = texels * formatBytes(key->internalFormat);
+    if (key->levels > 1) bytes += bytes / 3;
+    return bytes;
+}
+
+static bool poolableTarget(GLenum target) {
+    return target == GL_TEXTURE_2D || target == GL_TEXTURE_3D ||
+           target == GL_TEXTURE_CUBE_MAP || target == GL_TEXTURE_2D_ARRAY;
+}
+
+static GLuint* trackedBinding(GLTextureUnitState* unit, GLenum target) {
+    switch (target) {
+        case GL_TEXTURE_2D:         return &unit->texture2D;
+        case GL_TEXTURE_3D:         return &unit->texture3D;
+        case GL_TEXTURE_CUBE_MAP:   return &unit->textureCube;
+        case GL_TEXTURE_2D_ARRAY:   return &unit->texture2DArray;
+    }
+    return NULL;
+}
+
+static GLTextureUnitState* activeUnit(void) {
+    if (!g_wrapperCtx) return NULL;
+
+    GLint unit = g_wrapperCtx->state.activeTextureUnit;
+    if (unit < 0 || unit >= MAX_TEXTURE_UNITS) return NULL;
+    return &g_wrapperCtx->state.textureUnits[unit];
+}
+
+static GLuint boundTexture(GLenum target) {
+    GLTextureUnitState* unit = activeUnit();
+    GLuint* tracked = unit ? trackedBinding(unit, target) : NULL;
+    if (tracked && *tracked != UNKNOWN_BINDING) return *tracked;
+
+    // Invalidated state
+    GLenum query = 0;
+    switch (target) {
+        case GL_TEXTURE_2D:         query = GL_TEXTURE_BINDING_2D; break;
+        case GL_TEXTURE_3D:         query = GL_TEXTURE_BINDING_3D; break;
+        case GL_TEXTURE_CUBE_MAP:   query = GL_TEXTURE_BINDING_CUBE_MAP; break;
+        case GL_TEXTURE_2D_ARRAY:   query = GL_TEXTURE_BINDING_2D_ARRAY; break;
+        default:                    return 0;
+    }
+    GLint texture = 0;
+    glGetIntegerv(query, &texture);
+    return (GLuint)texture;
+}
+
+static void bindTexture(GLenum target, GLuint texture) {
+    glBindTexture(target, texture);
+
+    GLTextureUnitState* unit = activeUnit();
+    GLuint* tracked = unit ? trackedBinding(unit, target) : NULL;
+    if (tracked) *tracked = texture;
+}
+
+static GLuint boundRenderbuffer(void) {
+    GLint renderbuffer = 0;
+    glGetIntegerv(GL_RENDERBUFFER_BINDING, &renderbuffer);
+    return (GLuint)renderbuffer;
+}
+
+static bool unpackBufferBound(void) {
+    GLint unpack = 0;
+    glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpack);
+    return unpack != 0;
+}
+
+static int intParameterCount(void) {
+    // GL_DEPTH_STENCIL_TEXTURE_MODE is ES 3.1
+    return g_pool.esVersion >= 31 ? INT_PARAMETER_COUNT : INT_PARAMETER_COUNT - 1;
+}
+
+static void readParameters(GLenum target, TextureParameters* params) {
+    *params = DEFAULT_PARAMETERS;
+
+    for (int i = 0; i < intParameterCount(); i++) {
+        glGetTexParameteriv(target, INT_PARAMETERS[i], &params->ints[i]);
+    }
+    glGetTexParameterfv(target, GL_TEXTURE_MIN_LOD, &params->lod[0]);
+    glGetTexParameterfv(target, GL_TEXTURE_MAX_LOD, &params->lod[1]);
+    if (g_pool.esVersion >= 32) {
+        glGetTexParameterfv(target, GL_TEXTURE_BORDER_COLOR, params->borderColor);
+    }
+    if (g_pool.anisotropy) {
+        glGetTexParameterfv(target, GL_TEXTURE_MAX_ANISOTROPY_EXT, &params->anisotropy);
+    }
+}
+
+static void writeParameters(GLenum target, const TextureParameters* params) {
+    for (int i = 0; i < intParameterCount(); i++) {
+        glTexParameteri(target, INT_PARAMETERS[i], params->ints[i]);
+    }
+    glTexParameterf(target, GL_TEXTURE_MIN_LOD, params->lod[0]);
+    glTexParameterf(target, GL_TEXTURE_MAX_LOD, params->lod[1]);
+    if (g_pool.esVersion >= 32) {
+        glTexParameterfv(target, GL_TEXTURE_BORDER_COLOR, params->borderColor);
+    }
+    if (g_pool.anisotropy) {
+        glTexParameterf(target, GL_TEXTURE_MAX_ANISOTROPY_EXT, params->anisotropy);
+    }
+}
+
+static void deleteObject(GLuint name, GLenum target) {
+    if (target == GL_RENDERBUFFER) {
+        glDeleteRenderbuffers(1, &name);
+    } else {
+        glDeleteTextures(1, &name);
+    }
+}
+
+// ============================================================================
+// Pooled Storage
+// ============================================================================
+
+static void freeEntry(int index) {
+    PooledStorage* entry = &g_pool.entries[index];
+    deleteObject(entry->name, entry->key.target);
+    g_pool.pooledBytes -= entry->bytes;
+    g_pool.freed++;
+
+    g_pool.entryCount--;
+    memmove(entry, entry + 1, (g_pool.entryCount - index) * sizeof(PooledStorage));
+}
+
+static void addEntry(GLuint name, const StorageKey* key, size_t bytes) {
+    while (g_pool.entryCount > 0 &&
+           (g_pool.entryCount >= STORAGE_POOL_MAX_ENTRIES || g_pool.pooledBytes + bytes > g_pool.budget)) {
+        freeEntry(0);
+    }
+
+    PooledStorage* entry = &g_pool.entries[g_pool.entryCount++];
+    entry->name = name;
+    entry->key = *key;
+    entry->bytes = bytes;
+    entry->frame = g_pool.frame;
+    g_pool.pooledBytes += bytes;
+}
+
+static int findEntry(const StorageKey* key) {
+    // Most recently released first
+    for (int i = g_pool.entryCount - 1; i >= 0; i--) {
+        if (memcmp(&g_pool.entries[i].key, key, sizeof(StorageKey)) == 0) return i;
+    }
+    return -1;
+}
+
+static GLuint takeEntry(int index) {
+    GLuint name = g_pool.entries[index].name;
+    g_pool.pooledBytes -= g_pool.entries[index].bytes;
+
+    g_pool.entryCount--;
+    memmove(&g_pool.entries[index], &g_pool.entries[index + 1],
+            (g_pool.entryCount - index) * sizeof(PooledStorage));
+    return name;
+}
+
+static bool fitsPool(const StorageKey* key) {
+    return g_pool.enabled && storageBytes(key) <= g_pool.budget;
+}
+
+/**
+ * Back a fresh app name with released storage of the same shape
+ */
+static bool recycle(const StorageKey* key, GLuint name) {
+    bool renderbuffer = key->target == GL_RENDERBUFFER;
+    StorageTable* aliases = renderbuffer ? &g_pool.renderbufferAliases : &g_pool.textureAliases;
+    StorageTable* records = renderbuffer ? &g_pool.renderbufferRecords : &g_pool.textureRecords;
+
+    int index = findEntry(key);
+    if (index < 0) return false;
+
+    StorageSlot* alias = tableInsert(aliases, name);
+    if (!alias) return false;
+    StorageSlot* record = tableInsert(records, g_pool.entries[index].name);
+    if (!record) {
+        tableRemove(aliases, name);
+        return false;
+    }
+
+    GLuint object = takeEntry(index);
+    alias->object = object;
+    record->key = *key;
+
+    if (renderbuffer) {
+        glBindRenderbuffer(GL_RENDERBUFFER, object);
+    } else {
+        // Parameters set before the storage belong to the app's texture
+        TextureParameters params;
+        readParameters(key->target, &params);
+        bindTexture(key->target, object);
+        writeParameters(key->target, &params);
+    }
+
+    g_pool.hits++;
+    return true;
+}
+
+static void recordStorage(StorageTable* records, GLuint name, const StorageKey* key) {
+    StorageSlot* record = tableInsert(records, name);
+    if (record) record->key = *key;
+}
+
+/**
+ * Pool a deleted app object's storage, false if it has to be deleted
+ */
+static bool release(GLuint object, bool renderbuffer) {
+    StorageTable* records = renderbuffer ? &g_pool.renderbufferRecords : &g_pool.textureRecords;
+    StorageSlot* record = tableFind(records, object);
+    if (!record) return false;
+
+    StorageKey key = record->key;
+    tableRemove(records, object);
+    if (!fitsPool(&key)) return false;
+
+    if (renderbuffer) {
+        if (boundRenderbuffer() == object) glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    } else if (!glStateUnbindTextures(1, &object)) {
+        return false;
+    }
+    glStateDetachObjects(1, &object, renderbuffer);
+
+    addEntry(object, &key, storageBytes(&key));
+    return true;
+}
+
+static GLsizei deleteNames(GLsizei n, GLuint* names, bool renderbuffer) {
+    StorageTable* aliases = renderbuffer ? &g_pool.renderbufferAliases : &g_pool.textureAliases;
+    GLsizei remaining = 0;
+
+    for (GLsizei i = 0; i < n; i++) {
+        GLuint name = names[i];
+        if (name == 0) continue;
+
+        // The app's own object behind an alias was never given storage
+        GLuint object = name;
+        StorageSlot* alias = tableFind(aliases, name);
+        if (alias) {
+            object = alias->object;
+            tableRemove(aliases, name);
+            deleteObject(name, renderbuffer ? GL_RENDERBUFFER : GL_TEXTURE_2D);
+        }
+
+        if (release(object, renderbuffer)) continue;
+        names[remaining++] = object;
+    }
+    return remaining;
+}
+
+// ============================================================================
+// Storage Pool API
+// ============================================================================
+
+void storagePoolInit(bool enabled, size_t budgetBytes) {
+    if (g_pool.initialized) storagePoolShutdown();
+
+    memset(&g_pool, 0, sizeof(StoragePoolContext));
+
+    if (!tableCreate(&g_pool.textureRecords, STORAGE_POOL_MAX_RECORDS) ||
+        !tableCreate(&g_pool.renderbufferRecords, STORAGE_POOL_MAX_RECORDS) ||
+        !tableCreate(&g_pool.textureAliases, STORAGE_POOL_MAX_ALIASES) ||
+        !tableCreate(&g_pool.renderbufferAliases, STORAGE_POOL_MAX_ALIASES)) {
+        velocityLogError("Failed to allocate storage pool tables");
+        tableDestroy(&g_pool.textureRecords);
+        tableDestroy(&g_pool.renderbufferRecords);
+        tableDestroy(&g_pool.textureAliases);
+        tableDestroy(&g_pool.renderbufferAliases);
+        return;
+    }
+
+    GLint major = 3, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    g_pool.esVersion = major * 10 + minor;
+
+    g_pool.anisotropy = glExtensionSupported("GL_EXT_texture_filter_anisotropic");
+
+    g_pool.budget = budgetBytes;
+    g_pool.enabled = enabled;
+    g_pool.initialized = true;
+
+    velocityLogInfo("Storage pool initialized (%s, %zu MB budget)",
+                    enabled ? "enabled" : "disabled", budgetBytes / (1024 * 1024));
+}
+
+void storagePoolShutdown(void) {
+    if (!g_pool.initialized) return;
+
+    storagePoolTrim(0);
+    tableDestroy(&g_pool.textureRecords);
+    tableDestroy(&g_pool.renderbufferRecords);
+    tableDestroy(&g_pool.textureAliases);
+    tableDestroy(&g_pool.renderbufferAliases);
+    memset(&g_pool, 0, sizeof(StoragePoolContext));
+}
+
+void storagePoolSetEnabled(bool enabled) {
+    if (!g_pool.initialized) return;
+
+    // Storage keeps being recorded so nothing is stale when re-enabled
+    g_pool.enabled = enabled;
+    if (!enabled) storagePoolTrim(0);
+}
+
+GLuint storagePoolTexture(GLuint texture) {
+    StorageSlot* alias = tableFind(&g_pool.textureAliases, texture);
+    return alias ? alias->object : texture;
+}
+
+GLuint storagePoolRenderbuffer(GLuint renderbuffer) {
+    StorageSlot* alias = tableFind(&g_pool.renderbufferAliases, renderbuffer);
+    return alias ? alias->object : renderbuffer;
+}
+
+GLuint storagePoolAppTexture(GLuint texture) {
+    return tableReverse(&g_pool.textureAliases, texture);
+}
+
+GLuint storagePoolAppRenderbuffer(GLuint renderbuffer) {
+    return tableReverse(&g_pool.renderbufferAliases, renderbuffer);
+}
+
+bool storagePoolTexStorage(GLenum target, GLsizei levels, GLenum internalformat,
+                           GLsizei width, GLsizei height, GLsizei depth) {
+    if (!g_pool.initialized || !poolableTarget(target) || levels < 1) return false;
+
+    GLuint texture = boundTexture(target);
+    if (texture == 0) return false;
+
+    // Immutable already: the driver reports the error
+    StorageSlot* record = tableFind(&g_pool.textureRecords, texture);
+    if (record && record->key.levels > 0) return false;
+
+    StorageKey key = storageKeyTexture(target, levels, internalformat, width, height, depth);
+    if (!record && fitsPool(&key) && recycle(&key, texture)) return true;
+
+    if (target == GL_TEXTURE_3D || target == GL_TEXTURE_2D_ARRAY) {
+        glTexStorage3D(target, levels, internalformat, width, height, depth);
+    } else {
+        glTexStorage2D(target, levels, internalformat, width, height);
+    }
+    recordStorage(&g_pool.textureRecords, texture, &key);
+    g_pool.misses++;
+    return true;
+}
+
+bool storagePoolTexImage2D(GLenum target, GLint level, GLenum internalformat,
+                           GLsizei width, GLsizei height, GLenum format, GLenum type,
+                           const void* pixels) {
+    if (!g_pool.initialized || target != GL_TEXTURE_2D) return false;
+
+    GLuint texture = boundTexture(GL_TEXTURE_2D);
+    if (texture == 0) return false;
+
+    StorageSlot* record = tableFind(&g_pool.textureRecords, texture);
+    if (record && record->key.levels > 0) return false;
+
+    // Uploaded data or further levels: no longer plain render target storage
+    if (level != 0 || pixels || unpackBufferBound()) {
+        if (record) tableRemove(&g_pool.textureRecords, texture);
+        return false;
+    }
+
+    StorageKey key = storageKeyTexture(GL_TEXTURE_2D, 0, internalformat, width, height, 1);
+    key.format = format;
+    key.type = type;
+    if (!record && fitsPool(&key) && recycle(&key, texture)) return true;
+
+    glTexImage2D(GL_TEXTURE_2D, 0, internalformat, width, height, 0, format, type, NULL);
+    recordStorage(&g_pool.textureRecords, texture, &key);
+    g_pool.misses++;
+    return true;
+}
+
+bool storagePoolRenderbufferStorage(GLsizei samples, GLenum internalformat,
+                                    GLsizei width, GLsizei height) {
+    if (!g_pool.initialized) return false;
+
+    GLuint renderbuffer = boundRenderbuffer();
+    if (renderbuffer == 0) return false;
+
+    StorageSlot* record = tableFind(&g_pool.renderbufferRecords, renderbuffer);
+    StorageKey key = storageKeyRenderbuffer(samples, internalformat, width, height);
+    if (!record && fitsPool(&key) && recycle(&key, renderbuffer)) return true;
+
+    if (samples > 0) {
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, internalformat, width, height);
+    } else {
+        glRenderbufferStorage(GL_RENDERBUFFER, internalformat, width, height);
+    }
+    recordStorage(&g_pool.renderbufferRecords, renderbuffer, &key);
+    g_pool.misses++;
+    return true;
+}
+
+void storagePoolDropBound(GLenum target) {
+    if (!g_pool.initialized) return;
+
+    if (target == GL_RENDERBUFFER) {
+        if (g_pool.renderbufferRecords.count == 0) return;
+        tableRemove(&g_pool.renderbufferRecords, boundRenderbuffer());
+    } else if (poolableTarget(target)) {
+        if (g_pool.textureRecords.count == 0) return;
+        tableRemove(&g_pool.textureRecords, boundTexture(target));
+    }
+}
+
+GLsizei storagePoolDeleteTextures(GLsizei n, GLuint* textures) {
+    if (!g_pool.initialized || !textures) return n;
+    return deleteNames(n, textures, false);
+}
+
+GLsizei storagePoolDeleteRenderbuffers(GLsizei n, GLuint* renderbuffers) {
+    if (!g_pool.initialized || !renderbuffers) return n;
+    return deleteNames(n, renderbuffers, true);
+}
+
+GLuint storagePoolAcquire(const StorageKey* key) {
+    if (!g_pool.initialized || !key || !g_pool.enabled) return 0;
+
+    int index = findEntry(key);
+    if (index < 0) {
+        g_pool.misses++;
+        return 0;
+    }
+
+    GLuint object = takeEntry(index);
+    if (key->target == GL_RENDERBUFFER) {
+        glBindRenderbuffer(GL_RENDERBUFFER, object);
+    } else {
+        glBindTexture(key->target, object);
+        writeParameters(key->target, &DEFAULT_PARAMETERS);
+    }
+
+    g_pool.hits++;
+    return object;
+}
+
+void storagePoolRelease(GLuint name, const StorageKey* key) {
+    if (name == 0 || !key) return;
+
+    if (!g_pool.initialized || !fitsPool(key)) {
+        deleteObject(name, key->target);
+        return;
+    }
+    addEntry(name, key, storageBytes(key));
+}
+
+void storagePoolEndFrame(void) {
+    if (!g_pool.initialized) return;
+
+    g_pool.frame++;
+    while (g_pool.entryCount > 0 &&
+           g_pool.frame - g_pool.entries[0].frame > STORAGE_POOL_FRAMES) {
+        freeEntry(0);
+    }
+}
+
+void storagePoolTrim(size_t targetBytes) {
+    while (g_pool.entryCount > 0 && g_pool.pooledBytes > targetBytes) {
+        freeEntry(0);
+    }
+    if (targetBytes == 0) {
+        while (g_pool.entryCount > 0) freeEntry(0);
+    }
+}
+
+void storagePoolGetStats(StoragePoolStats* stats) {
+    if (!stats) return;
+
+    memset(stats, 0, sizeof(StoragePoolStats));
+    stats->enabled = g_pool.enabled;
+    stats->records = g_pool.textureRecords.count + g_pool.renderbufferRecords.count;
+    stats->aliases = g_pool.textureAliases.count + g_pool.renderbufferAliases.count;
+    stats->pooled = (uint32_t)g_pool.entryCount;
+    stats->pooledBytes = g_pool.pooledBytes;
+    stats->hits = g_pool.hits;
+    stats->misses = g_pool.misses;
+    stats->freed = g_pool.freed;
+}
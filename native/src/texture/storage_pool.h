@@ -0,0 +1,181 @@
+/**
+ * Storage Pool - Recycling of texture and renderbuffer storage
+ * Storage allocated without data (immutable textures, level 0 of mutable
+ * 2D textures specified with NULL, renderbuffers) is recorded with its
+ * target, format, size, levels and samples. When such an object is
+ * deleted it is kept for a few frames instead, and a later allocation of
+ * the same shape on a fresh name is served from it: the app's name becomes
+ * an alias of the pooled object and wrapped entry points taking texture or
+ * renderbuffer names translate it. Released storage is capped by a byte
+ * budget and freed when unused. Window-size targets the RT scaler resizes
+ * are never pooled.
+ */
+
+#ifndef STORAGE_POOL_H
+#define STORAGE_POOL_H
+
+#include <GLES3/gl32.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define STORAGE_POOL_FRAMES         4       // Frames released storage is kept
+#define STORAGE_POOL_MAX_ENTRIES    64      // Released objects held at once
+#define STORAGE_POOL_MAX_RECORDS    4096    // Tracked objects per kind (power of two)
+#define STORAGE_POOL_MAX_ALIASES    512     // App names served from the pool (power of two)
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * Shape of an allocation; storage is only handed back on an exact match
+ */
+typedef struct StorageKey {
+    GLenum target;               // Texture target, or GL_RENDERBUFFER
+    GLenum internalFormat;
+    GLenum format;               // Mutable textures: glTexImage2D format/type
+    GLenum type;
+    GLsizei width;
+    GLsizei height;
+    GLsizei depth;
+    GLsizei levels;              // 0: mutable texture with level 0 only
+    GLsizei samples;             // Renderbuffers
+} StorageKey;
+
+/**
+ * Pool statistics
+ */
+typedef struct StoragePoolStats {
+    bool enabled;
+    uint32_t records;            // Objects whose storage is known
+    uint32_t aliases;            // App names backed by recycled objects
+    uint32_t pooled;             // Released objects held
+    size_t pooledBytes;
+    uint32_t hits;               // Allocations served from the pool
+    uint32_t misses;             // Allocations the driver made
+    uint32_t freed;              // Released objects deleted (aged out, over budget)
+} StoragePoolStats;
+
+// ============================================================================
+// Storage Pool API
+// ============================================================================
+
+/**
+ * Initialize the pool (requires GL context)
+ */
+void storagePoolInit(bool enabled, size_t budgetBytes);
+
+/**
+ * Delete pooled objects and forget aliases
+ */
+void storagePoolShutdown(void);
+
+/**
+ * Enable/disable recycling (disabling frees what is pooled)
+ */
+void storagePoolSetEnabled(bool enabled);
+
+/**
+ * Translate an app name to the object backing it
+ */
+GLuint storagePoolTexture(GLuint texture);
+GLuint storagePoolRenderbuffer(GLuint renderbuffer);
+
+/**
+ * Translate an object back to the app name it serves
+ */
+GLuint storagePoolAppTexture(GLuint texture);
+GLuint storagePoolAppRenderbuffer(GLuint renderbuffer);
+
+/**
+ * Allocate immutable storage for the bound texture, from the pool if
+ * possible; true if handled
+ */
+bool storagePoolTexStorage(GLenum target, GLsizei levels, GLenum internalformat,
+                           GLsizei width, GLsizei height, GLsizei depth);
+
+/**
+ * Same for glTexImage2D level 0 without data
+ */
+bool storagePoolTexImage2D(GLenum target, GLint level, GLenum internalformat,
+                           GLsizei width, GLsizei height, GLenum format, GLenum type,
+                           const void* pixels);
+
+/**
+ * Same for the bound renderbuffer
+ */
+bool storagePoolRenderbufferStorage(GLsizei samples, GLenum internalformat,
+                                    GLsizei width, GLsizei height);
+
+/**
+ * The bound object's storage changed in a way the pool can't recycle
+ * (GL_RENDERBUFFER for the bound renderbuffer)
+ */
+void storagePoolDropBound(GLenum target);
+
+/**
+ * Delete app objects, pooling recyclable storage; names are translated
+ * in place and the ones left for the driver returned in the array
+ */
+GLsizei storagePoolDeleteTextures(GLsizei n, GLuint* textures);
+GLsizei storagePoolDeleteRenderbuffers(GLsizei n, GLuint* renderbuffers);
+
+/**
+ * Take a released object of this shape, bound to its target with default
+ * parameters; 0 if none (for the wrapper's own targets)
+ */
+GLuint storagePoolAcquire(const StorageKey* key);
+
+/**
+ * Hand an unbound object of the wrapper's own back, deleting it if the
+ * pool can't hold it
+ */
+void storagePoolRelease(GLuint name, const StorageKey* key);
+
+/**
+ * Age out released storage (call once per frame)
+ */
+void storagePoolEndFrame(void);
+
+/**
+ * Free released storage down to a byte count
+ */
+void storagePoolTrim(size_t targetBytes);
+
+/**
+ * Get statistics
+ */
+void storagePoolGetStats(StoragePoolStats* stats);
+
+/**
+ * Key for texture storage
+ */
+static inline StorageKey storageKeyTexture(GLenum target, GLsizei levels, GLenum internalFormat,
+                                           GLsizei width, GLsizei height, GLsizei depth) {
+    StorageKey key = { target, internalFormat, 0, 0, width, height, depth, levels, 0 };
+    return key;
+}
+
+/**
+ * Key for renderbuffer storage
+ */
+static inline StorageKey storageKeyRenderbuffer(GLsizei samples, GLenum internalFormat,
+                                                GLsizei width, GLsizei height) {
+    StorageKey key = { GL_RENDERBUFFER, internalFormat, 0, 0, width, height, 1, 1, samples };
+    return key;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STORAGE_POOL_H
@@ -6,6 +6,8 @@
 #include "../utils/log.h"
 #include "../utils/memory.h"
 #include "../core/gl_wrapper.h"
+#include "../profile/trace.h"
+#include "../profile/flight_recorder.h"
 
 #include <string.h>
 #include <math.h>
@@ -383,6 +385,9 @@ void textureUpload(Texture* texture, int level, int x, int y,
                    int width, int height, const void* data) {
     if (!texture || texture->id == 0 || !data) return;
     
+    TRACE_SCOPE("texture_upload");
+    FLIGHT_SCOPE(FLIGHT_EVENT_TEXTURE_UPLOAD, (uint64_t)width * height);
+    
     GLenum format = textureGetGLFormat(texture->format);
     GLenum type = textureGetGLType(texture->format);
     
@@ -401,6 +406,9 @@ void textureUploadSub(Texture* texture, int level,
                       const void* data) {
     if (!texture || texture->id == 0 || !data) return;
     
+    TRACE_SCOPE("texture_upload");
+    FLIGHT_SCOPE(FLIGHT_EVENT_TEXTURE_UPLOAD, (uint64_t)width * height * depth);
+    
     GLenum format = textureGetGLFormat(texture->format);
     GLenum type = textureGetGLType(texture->format);
     
@@ -140,6 +140,21 @@ bool velocityConfigLoad(const char* path, VelocityConfig* config) {
             
             if (strcmp(key, "targetFPS") == 0) config->targetFPS = (int)token.numberValue;
             else if (strcmp(key, "quality") == 0) config->quality = (int)token.numberValue;
+            else if (strcmp(key, "enableFramePacing") == 0) config->enableFramePacing = token.boolValue;
+            else if (strcmp(key, "enableLatencyMode") == 0) config->enableLatencyMode = token.boolValue;
+            else if (strcmp(key, "maxFramesInFlight") == 0) config->maxFramesInFlight = (int)token.numberValue;
+            else if (strcmp(key, "nativeUI") == 0) config->nativeUI = (int)token.numberValue;
+            else if (strcmp(key, "enableAutoInvalidate") == 0) config->enableAutoInvalidate = token.boolValue;
+            else if (strcmp(key, "enableRenderPassMerging") == 0) config->enableRenderPassMerging = token.boolValue;
+            else if (strcmp(key, "enablePartialPresent") == 0) config->enablePartialPresent = token.boolValue;
+            else if (strcmp(key, "idlePolicy") == 0) config->idlePolicy = (int)token.numberValue;
+            else if (strcmp(key, "idleFPS") == 0) config->idleFPS = (int)token.numberValue;
+            else if (strcmp(key, "enableStoragePooling") == 0) config->enableStoragePooling = token.boolValue;
+            else if (strcmp(key, "enableNamePooling") == 0) config->enableNamePooling = token.boolValue;
+            else if (strcmp(key, "enableAsyncReadback") == 0) config->enableAsyncReadback = token.boolValue;
+            else if (strcmp(key, "enableVaoCache") == 0) config->enableVaoCache = token.boolValue;
+            else if (strcmp(key, "enableVertexPacking") == 0) config->enableVertexPacking = token.boolValue;
+            else if (strcmp(key, "hitchThresholdMs") == 0) config->hitchThresholdMs = (float)token.numberValue;
             
             velocityFree(key);
             if (token.type == JSON_STRING) velocityFree(token.stringValue);
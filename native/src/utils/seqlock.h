@@ -0,0 +1,92 @@
+/**
+ * SeqLock - Single-writer sequence lock
+ * The writer never blocks; readers retry until they copy a snapshot that no
+ * write overlapped. Payload words are copied with relaxed atomics so the
+ * racing copy is well defined.
+ */
+
+#ifndef VELOCITY_SEQLOCK_H
+#define VELOCITY_SEQLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct SeqLock {
+    uint32_t sequence;       // Odd while a write is in progress
+} SeqLock;
+
+/**
+ * Copy a payload word by word (size must be a multiple of 4, both 4-aligned)
+ */
+static inline void seqlockCopy(void* dst, const void* src, size_t size) {
+    uint32_t* d = (uint32_t*)dst;
+    const uint32_t* s = (const uint32_t*)src;
+    for (size_t i = 0; i < size / sizeof(uint32_t); i++) {
+        __atomic_store_n(&d[i], __atomic_load_n(&s[i], __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Begin a write (writer thread only)
+ */
+static inline void seqlockWriteBegin(SeqLock* lock) {
+    __atomic_store_n(&lock->sequence, lock->sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/**
+ * End a write
+ */
+static inline void seqlockWriteEnd(SeqLock* lock) {
+    __atomic_store_n(&lock->sequence, lock->sequence + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Begin a read, spins while a write is in progress
+ */
+static inline uint32_t seqlockReadBegin(const SeqLock* lock) {
+    uint32_t seq;
+    while ((seq = __atomic_load_n(&lock->sequence, __ATOMIC_ACQUIRE)) & 1) {
+        // Writes are a few hundred bytes, just spin
+    }
+    return seq;
+}
+
+/**
+ * Check if the read must be retried
+ */
+static inline bool seqlockReadRetry(const SeqLock* lock, uint32_t seq) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&lock->sequence, __ATOMIC_RELAXED) != seq;
+}
+
+/**
+ * Publish payload under the lock (writer thread only)
+ */
+static inline void seqlockPublish(SeqLock* lock, void* dst, const void* src, size_t size) {
+    seqlockWriteBegin(lock);
+    seqlockCopy(dst, src, size);
+    seqlockWriteEnd(lock);
+}
+
+/**
+ * Read a consistent copy of a published payload
+ */
+static inline void seqlockRead(const SeqLock* lock, void* dst, const void* src, size_t size) {
+    uint32_t seq;
+    do {
+        seq = seqlockReadBegin(lock);
+        seqlockCopy(dst, src, size);
+    } while (seqlockReadRetry(lock, seq));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VELOCITY_SEQLOCK_H
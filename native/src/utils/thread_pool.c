@@ -2,6 +2,7 @@
  * Thread Pool - Stub implementation
  */
 
+#include "thread_pool.h"
 #include "log.h"
 #include "memory.h"
 
@@ -13,8 +14,6 @@
 // Types
 // ============================================================================
 
-typedef void (*TaskFunc)(void* arg);
-
 typedef struct Task {
     TaskFunc func;
     void* arg;
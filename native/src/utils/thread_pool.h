@@ -0,0 +1,43 @@
+/**
+ * Thread Pool - Fixed worker pool for background tasks
+ */
+
+#ifndef VELOCITY_THREAD_POOL_H
+#define VELOCITY_THREAD_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Types
+// ============================================================================
+
+typedef void (*TaskFunc)(void* arg);
+
+typedef struct ThreadPool ThreadPool;
+
+// ============================================================================
+// Thread Pool API
+// ============================================================================
+
+/**
+ * Create pool with numThreads workers (<= 0 uses 4)
+ */
+ThreadPool* threadPoolCreate(int numThreads);
+
+/**
+ * Drain queued tasks and join all workers
+ */
+void threadPoolDestroy(ThreadPool* pool);
+
+/**
+ * Queue a task, runs on the first free worker
+ */
+void threadPoolSubmit(ThreadPool* pool, TaskFunc func, void* arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VELOCITY_THREAD_POOL_H
@@ -7,17 +7,39 @@
 #include "core/gl_wrapper.h"
 #include "shader/shader_cache.h"
 #include "texture/texture_manager.h"
+#include "texture/storage_pool.h"
 #include "buffer/buffer_pool.h"
 #include "buffer/draw_batcher.h"
+#include "buffer/readback.h"
+#include "buffer/vao_cache.h"
+#include "buffer/vertex_packer.h"
 #include "optimize/resolution_scaler.h"
+#include "optimize/frame_pacing.h"
+#include "optimize/frame_throttle.h"
+#include "optimize/fence_timeline.h"
+#include "optimize/name_pool.h"
+#include "optimize/ui_split.h"
+#include "optimize/rt_scaler.h"
+#include "optimize/fb_invalidate.h"
+#include "optimize/render_pass.h"
+#include "optimize/damage_tracker.h"
+#include "optimize/frame_idle.h"
 #include "gpu/gpu_detect.h"
 #include "gl/gl_functions.h"
+#include "profile/call_profiler.h"
+#include "profile/trace.h"
+#include "profile/gpu_timer.h"
+#include "profile/flight_recorder.h"
+#include "profile/frame_stats.h"
+#include "profile/metrics_export.h"
 #include "utils/log.h"
 #include "utils/memory.h"
 #include "utils/config.h"
 
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <time.h>
 #include <pthread.h>
 #include <android/native_window.h>
 #include <android/native_window_jni.h>
@@ -48,6 +70,14 @@ VelocityConfig velocityGetDefaultConfig(void) {
         .minResolutionScale = 0.5f,
         .maxResolutionScale = 1.0f,
         .targetFPS = 60,
+        .nativeUI = VELOCITY_NATIVE_UI_MARKER,
+        
+        // Frame pacing
+        .enableFramePacing = true,
+        .enableLatencyMode = false,
+        .maxFramesInFlight = THROTTLE_DEFAULT_FRAMES,
+        .idlePolicy = VELOCITY_IDLE_REPRESENT,
+        .idleFPS = 10,
         
         // Draw call optimization
         .enableDrawBatching = true,
@@ -59,11 +89,21 @@ VelocityConfig velocityGetDefaultConfig(void) {
         .enableAsyncTextureLoad = true,
         .texturePoolSize = 128,  // MB
         .maxTextureSize = 4096,
+        .enableStoragePooling = true,
         
         // Buffer optimization
         .enableBufferPooling = true,
         .bufferPoolSize = 32,    // MB
         .enablePersistentMapping = true,
+        .enableNamePooling = true,
+        .enableAsyncReadback = false,
+        .enableVaoCache = true,
+        .enableVertexPacking = false,
+        
+        // Render passes
+        .enableAutoInvalidate = true,
+        .enableRenderPassMerging = true,
+        .enablePartialPresent = true,
         
         // GPU specific
         .enableGPUSpecificTweaks = true,
@@ -71,7 +111,8 @@ VelocityConfig velocityGetDefaultConfig(void) {
         
         // Debug
         .enableDebugOutput = false,
-        .enableProfiling = true,
+        .enableProfiling = false,
+        .hitchThresholdMs = 100.0f,
         .logPath = NULL
     };
     
@@ -109,6 +150,22 @@ VELOCITY_API bool velocityInit(const VelocityConfig* config) {
         return false;
     }
     
+    // Frame time histogram and shared metrics block
+    frameStatsInit();
+    metricsExportInit();
+    
+    // Frame pacer (refresh rate defaults to 60 Hz until the app reports it)
+    framePacingInit(cfg.targetFPS, cfg.enableFramePacing);
+    
+    // Call profiler (counters stay idle unless profiling is enabled)
+    callProfilerInit(cfg.enableProfiling);
+    
+    // Timeline tracing (recording starts on request)
+    traceInit();
+    
+    // Hitch flight recorder (dumps next to the shader cache)
+    flightRecorderInit(cfg.shaderCachePath, cfg.hitchThresholdMs, FLIGHT_DEFAULT_FRAMES);
+    
     // Initialize GL function table
     if (!glFunctionsInit()) {
         velocityLogError("Failed to initialize GL functions");
@@ -129,11 +186,31 @@ VELOCITY_API void velocityShutdown(void) {
     velocityLogInfo("Shutting down VelocityGL...");
     
     // Shutdown subsystems in reverse order
+    uiSplitShutdown();
+    rtScalerShutdown();
+    fbInvalidateShutdown();
+    renderPassShutdown();
+    damageTrackerShutdown();
+    frameIdleShutdown();
+    frameThrottleShutdown();
+    gpuTimerShutdown();
     resolutionScalerShutdown();
+    vertexPackerShutdown();
+    vaoCacheShutdown();
     drawBatcherShutdown();
     bufferManagerShutdown();
+    storagePoolShutdown();
+    namePoolShutdown();
+    readbackShutdown();
     textureManagerShutdown();
+    fenceTimelineShutdown();
     glFunctionsShutdown();
+    flightRecorderShutdown();
+    traceShutdown();
+    callProfilerShutdown();
+    metricsExportShutdown();
+    frameStatsShutdown();
+    framePacingShutdown();
     glWrapperShutdown();
     
     // Check for memory leaks
@@ -161,13 +238,40 @@ VELOCITY_API bool velocityUpdateConfig(const VelocityConfig* config) {
     
     // Update resolution scaler
     if (resolutionScalerIsEnabled() != config->enableDynamicResolution) {
+        glFunctionsFlushPasses();
         resolutionScalerSetEnabled(config->enableDynamicResolution);
     }
+    if (g_wrapperCtx->config.nativeUI == VELOCITY_NATIVE_UI_AUTO && g_wrapperCtx->contextCurrent &&
+        !g_wrapperCtx->windowDepth) {
+        g_wrapperCtx->config.nativeUI = VELOCITY_NATIVE_UI_MARKER;
+    }
+    uiSplitSetMode((UISplitMode)g_wrapperCtx->config.nativeUI);
+    fbInvalidateSetEnabled(config->enableAutoInvalidate);
+    glFunctionsFlushPasses();
+    renderPassSetEnabled(config->enableRenderPassMerging);
+    damageTrackerSetEnabled(config->enablePartialPresent);
+    frameIdleSetPolicy((FrameIdlePolicy)config->idlePolicy, config->idleFPS);
+    storagePoolSetEnabled(config->enableStoragePooling);
+    namePoolSetEnabled(config->enableNamePooling);
+    readbackSetAsyncMode(config->enableAsyncReadback);
+    
+    vaoCacheSetEnabled(config->enableVaoCache);
+    vertexPackerSetEnabled(config->enableVertexPacking);
     
     // Update draw batcher
     drawBatcherSetEnabled(config->enableDrawBatching);
     drawBatcherSetInstancing(config->enableInstancing);
     
+    // Update frame pacer
+    framePacingSetTargetFPS(config->targetFPS);
+    framePacingSetEnabled(config->enableFramePacing);
+    frameThrottleSetMaxFrames(config->maxFramesInFlight);
+    frameThrottleSetEnabled(config->enableLatencyMode);
+    
+    // Update call profiler
+    callProfilerSetEnabled(config->enableProfiling);
+    flightRecorderSetThreshold(config->hitchThresholdMs);
+    
     return true;
 }
 
@@ -182,6 +286,29 @@ VELOCITY_API VelocityConfig velocityGetConfig(void) {
 // Context Management
 // ============================================================================
 
+/**
+ * Scene target formats by quality tier. Low tiers halve color and depth
+ * bandwidth; the scaler upgrades again if the app turns out to use
+ * stencil or destination alpha.
+ */
+static void chooseSceneFormats(VelocityQualityPreset quality, GLenum* color, GLenum* depth) {
+    switch (quality) {
+        case VELOCITY_QUALITY_ULTRA_LOW:
+        case VELOCITY_QUALITY_LOW:
+            *color = GL_RGB565;
+            *depth = GL_DEPTH_COMPONENT16;
+            break;
+        case VELOCITY_QUALITY_MEDIUM:
+            *color = GL_RGB10_A2;       // Same size as RGBA8, less banding after upscale
+            *depth = GL_DEPTH24_STENCIL8;
+            break;
+        default:
+            *color = GL_RGBA8;
+            *depth = GL_DEPTH24_STENCIL8;
+            break;
+    }
+}
+
 VELOCITY_API bool velocityCreateContext(void* nativeWindow, void* eglDisplay) {
     if (!g_wrapperCtx) {
         velocityLogError("VelocityGL not initialized");
@@ -198,12 +325,27 @@ VELOCITY_API bool velocityCreateContext(void* nativeWindow, void* eglDisplay) {
     
     // Initialize subsystems that need GL context
     
+    // Sync points shared by the throttle, stream buffer and deferred work
+    fenceTimelineInit();
+    
     // Texture manager
     if (!textureManagerInit(g_wrapperCtx->config.texturePoolSize, 
                             g_wrapperCtx->config.maxTextureSize)) {
         velocityLogWarn("Texture manager initialization failed");
     }
     
+    // Released render targets may hold up to half the texture budget
+    storagePoolInit(g_wrapperCtx->config.enableStoragePooling,
+                    (size_t)g_wrapperCtx->config.texturePoolSize * 1024 * 1024 / 2);
+    
+    // Object names and deferred deletion
+    namePoolInit(g_wrapperCtx->config.enableNamePooling);
+    
+    // Pixel readback
+    if (!readbackInit(g_wrapperCtx->config.enableAsyncReadback)) {
+        velocityLogWarn("Readback initialization failed");
+    }
+    
     // Buffer manager
     if (!bufferManagerInit(g_wrapperCtx->config.bufferPoolSize * 1024 * 1024)) {
         velocityLogWarn("Buffer manager initialization failed");
@@ -214,6 +356,14 @@ VELOCITY_API bool velocityCreateContext(void* nativeWindow, void* eglDisplay) {
         velocityLogWarn("Draw batcher initialization failed");
     }
     
+    // Vertex arrays keyed by attribute setup
+    vaoCacheInit(g_wrapperCtx->config.enableVaoCache);
+    
+    // Compact copies of static vertex data
+    if (!vertexPackerInit(g_wrapperCtx->config.enableVertexPacking)) {
+        velocityLogWarn("Vertex packer initialization failed");
+    }
+    
     // Resolution scaler
     if (g_wrapperCtx->config.enableDynamicResolution) {
         ScalerConfig scalerCfg = {
@@ -222,10 +372,11 @@ VELOCITY_API bool velocityCreateContext(void* nativeWindow, void* eglDisplay) {
             .maxScale = g_wrapperCtx->config.maxResolutionScale,
             .targetFPS = g_wrapperCtx->config.targetFPS,
             .adjustSpeed = 0.1f,
-            .upscaleMethod = UPSCALE_BILINEAR,
+            .upscaleMethod = UPSCALE_FSR,
             .sharpening = true,
             .sharpenAmount = 0.3f
         };
+        chooseSceneFormats(g_wrapperCtx->config.quality, &scalerCfg.colorFormat, &scalerCfg.depthFormat);
         
         if (!resolutionScalerInit(g_wrapperCtx->windowWidth, 
                                    g_wrapperCtx->windowHeight, 
@@ -234,6 +385,31 @@ VELOCITY_API bool velocityCreateContext(void* nativeWindow, void* eglDisplay) {
         }
     }
     
+    // The window was chosen color-only for the scaler; without it the scene
+    // draws straight into the window and needs depth there
+    if (!g_wrapperCtx->windowDepth && !resolutionScalerIsEnabled() &&
+        !glWrapperRequireWindowDepth()) {
+        velocityLogError("Window surface has no depth buffer and no scaler target to render into");
+        return false;
+    }
+    if (g_wrapperCtx->config.enableDynamicResolution) {
+        resolutionScalerSetTargetRequired(!g_wrapperCtx->windowDepth);
+    }
+    rtScalerInit();
+    uiSplitInit((UISplitMode)g_wrapperCtx->config.nativeUI);
+    fbInvalidateInit(g_wrapperCtx->config.enableAutoInvalidate);
+    renderPassInit(g_wrapperCtx->config.enableRenderPassMerging);
+    damageTrackerInit(g_wrapperCtx->config.enablePartialPresent);
+    frameIdleInit((FrameIdlePolicy)g_wrapperCtx->config.idlePolicy, g_wrapperCtx->config.idleFPS);
+    
+    // Frame fences for latency mode and latency estimates
+    frameThrottleInit(g_wrapperCtx->config.maxFramesInFlight,
+                      g_wrapperCtx->config.enableLatencyMode);
+    
+    // GPU frame timing (first frame starts now)
+    gpuTimerInit();
+    gpuTimerBeginFrame();
+    
     velocityLogInfo("Rendering context created successfully");
     velocityLogInfo("  Window: %dx%d", g_wrapperCtx->windowWidth, g_wrapperCtx->windowHeight);
     
@@ -245,10 +421,24 @@ VELOCITY_API void velocityDestroyContext(void) {
     
     velocityLogInfo("Destroying rendering context...");
     
+    uiSplitShutdown();
+    rtScalerShutdown();
+    fbInvalidateShutdown();
+    renderPassShutdown();
+    damageTrackerShutdown();
+    frameIdleShutdown();
+    frameThrottleShutdown();
+    gpuTimerShutdown();
     resolutionScalerShutdown();
+    vertexPackerShutdown();
+    vaoCacheShutdown();
     drawBatcherShutdown();
     bufferManagerShutdown();
+    storagePoolShutdown();
+    namePoolShutdown();
+    readbackShutdown();
     textureManagerShutdown();
+    fenceTimelineShutdown();
     
     glWrapperDestroyContext();
 }
@@ -256,11 +446,48 @@ VELOCITY_API void velocityDestroyContext(void) {
 VELOCITY_API void velocitySwapBuffers(void) {
     if (!g_wrapperCtx) return;
     
-    // End resolution scaler pass
+    // Deferred clears and queued draws belong to the scene the scaler is
+    // about to upscale
+    glFunctionsFlushPasses();
+    drawBatcherFlush();
+    
+    // An identical frame drops its damage before it is closed
+    bool present = frameIdleEndFrame();
+    
+    // Close the frame's damage before the upscale, which only repairs it
+    damageTrackerEndFrame(g_wrapperCtx->eglDisplay, g_wrapperCtx->eglSurface);
+    
+    // End resolution scaler pass (skipped if the UI split already resolved)
     resolutionScalerEndFrame();
+    uiSplitEndFrame();
     
-    // Swap buffers
-    glWrapperSwapBuffers();
+    // App render targets follow scale changes between frames
+    rtScalerSync();
+    
+    // Backbuffer depth/stencil never survives the swap
+    fbInvalidateBeforeSwap();
+    
+    // Close GPU timing for this frame
+    gpuTimerEndFrame();
+    
+    // Swap buffers, holding the CPU in latency mode
+    frameThrottleBeforeSwap();
+    if (present) {
+        glWrapperSwapBuffers();
+    } else {
+        damageTrackerSkipPresent();
+        frameIdleWait();
+    }
+    frameThrottleAfterSwap();
+    
+    renderPassEndFrame();
+    vaoCacheEndFrame();
+    vertexPackerEndFrame();
+    storagePoolEndFrame();
+    namePoolEndFrame();
+    readbackEndFrame();
+    fenceTimelineEndFrame();
+    gpuTimerBeginFrame();
 }
 
 VELOCITY_API bool velocityMakeCurrent(void) {
@@ -278,7 +505,8 @@ VELOCITY_API void velocityBeginFrame(void) {
     bufferStreamBeginFrame();
     drawBatcherBeginFrame();
     
-    // Begin resolution scaler
+    // Begin resolution scaler (binds its target itself)
+    glFunctionsFlushPasses();
     int renderWidth, renderHeight;
     resolutionScalerBeginFrame(&renderWidth, &renderHeight);
     
@@ -288,6 +516,114 @@ VELOCITY_API void velocityBeginFrame(void) {
     g_wrapperCtx->stats.currentResolutionScale = resolutionScalerGetScale();
 }
 
+static void publishMetrics(void) {
+    static uint64_t frameIndex = 0;
+    
+    VelocityStats stats = velocityGetStats();
+    VelocityMetrics metrics = {0};
+    
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    
+    metrics.frameIndex = ++frameIndex;
+    metrics.timestampNs = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    metrics.textureMemory = stats.textureMemory;
+    metrics.bufferMemory = stats.bufferMemory;
+    metrics.heapMemory = velocityMemoryGetUsage();
+    metrics.shaderCacheSize = stats.shaderCacheSize;
+    
+    metrics.fps = stats.currentFPS;
+    metrics.avgFps = stats.avgFPS;
+    metrics.frameTimeMs = stats.frameTimeMs;
+    metrics.cpuTimeMs = stats.cpuTimeMs;
+    metrics.gpuTimeMs = stats.gpuTimeMs;
+    metrics.frameTimeP50Ms = stats.frameTimeP50Ms;
+    metrics.frameTimeP90Ms = stats.frameTimeP90Ms;
+    metrics.frameTimeP99Ms = stats.frameTimeP99Ms;
+    metrics.frameTimeP999Ms = stats.frameTimeP999Ms;
+    metrics.onePercentLowFps = stats.onePercentLowFPS;
+    metrics.stutterCount = stats.stutterCount;
+    
+    uint32_t batches;
+    drawBatcherGetStats(NULL, NULL, NULL, &batches);
+    metrics.drawCalls = stats.drawCalls;
+    metrics.drawCallsSaved = stats.drawCallsSaved;
+    metrics.triangles = stats.triangles;
+    metrics.batchesCreated = batches;
+    
+    metrics.shaderCacheHits = stats.shaderCacheHits;
+    metrics.shaderCacheMisses = stats.shaderCacheMisses;
+    
+    metrics.resolutionScale = stats.currentResolutionScale;
+    metrics.renderWidth = stats.renderWidth;
+    metrics.renderHeight = stats.renderHeight;
+    metrics.windowWidth = g_wrapperCtx->windowWidth;
+    metrics.windowHeight = g_wrapperCtx->windowHeight;
+    
+    metricsExportPublish(&metrics);
+}
+
+/**
+ * Subsystem counters live on the render thread; copy them in before the
+ * frame's stats are published
+ */
+static void collectSubsystemStats(VelocityStats* stats) {
+    // Add shader cache stats
+    shaderCacheGetStats(&stats->shaderCacheHits, 
+                        &stats->shaderCacheMisses, 
+                        &stats->shaderCacheSize);
+    
+    // Add texture memory
+    stats->textureMemory = textureManagerGetMemoryUsage();
+    
+    // Add buffer memory
+    size_t bufAlloc, bufUsed;
+    uint32_t allocCount;
+    bufferManagerGetStats(&bufAlloc, &bufUsed, &allocCount);
+    stats->bufferMemory = bufUsed;
+    
+    // Render passes before and after merging
+    RenderPassStats passes;
+    renderPassGetStats(&passes);
+    stats->renderPasses = passes.passesRecorded;
+    stats->renderPassesExecuted = passes.passesExecuted;
+    
+    DamageTrackerStats damage;
+    damageTrackerGetStats(&damage);
+    stats->presentedArea = damage.lastDamagedArea;
+    
+    FrameIdleStats idle;
+    frameIdleGetStats(&idle);
+    stats->identicalFrames = idle.identicalFrames;
+    
+    StoragePoolStats pool;
+    storagePoolGetStats(&pool);
+    stats->storageRecycled = pool.hits;
+    stats->storagePooled = pool.pooledBytes;
+    
+    NamePoolStats names;
+    namePoolGetStats(&names);
+    stats->deferredDeletes = names.pending;
+    
+    ReadbackStats readback;
+    readbackGetStats(&readback);
+    stats->readbackStallMs = readback.syncMs;
+    
+    FenceTimelineStats timeline;
+    fenceTimelineGetStats(&timeline);
+    stats->syncStallMs = timeline.frameStallMs;
+    
+    VaoCacheStats vaos;
+    vaoCacheGetStats(&vaos);
+    stats->attribCallsSaved = vaos.callsAbsorbed > vaos.callsIssued ?
+                              vaos.callsAbsorbed - vaos.callsIssued : 0;
+    stats->attribsStripped = vaos.attribsStripped;
+    
+    VertexPackerStats packer;
+    vertexPackerGetStats(&packer);
+    stats->vertexBytesSaved = packer.originalBytes - packer.packedBytes;
+}
+
 VELOCITY_API void velocityEndFrame(void) {
     if (!g_wrapperCtx) return;
     
@@ -300,8 +636,44 @@ VELOCITY_API void velocityEndFrame(void) {
     // Record frame timing
     glWrapperEndFrame();
     
-    // Update resolution scaler with frame time
-    resolutionScalerRecordFrameTime(g_wrapperCtx->stats.frameTimeMs);
+    // Merge per-thread call counters
+    callProfilerEndFrame();
+    
+    // Resolve GPU spans and finish frame captures
+    traceEndFrame();
+    
+    // Close the flight recorder frame (snapshots on hitch)
+    if (g_flightActive) {
+        flightRecorderEndFrame(g_wrapperCtx->stats.frameTimeMs,
+                               g_wrapperCtx->stats.drawCalls,
+                               velocityGetMemoryUsage());
+    }
+    
+    FramePacingStats pacing;
+    framePacingGetStats(&pacing);
+    g_wrapperCtx->stats.pacedFPS = pacing.pacedFPS;
+    
+    FrameThrottleStats throttle;
+    frameThrottleGetStats(&throttle);
+    g_wrapperCtx->stats.latencyMs = throttle.latencyMs;
+    
+    // The scaler only lowers resolution while the GPU is the limiter; fence
+    // wait stands in for GPU time when timer queries are unavailable
+    VelocityStats* frame = &g_wrapperCtx->stats;
+    ScalerFrameSample sample = {0};
+    sample.intervalMs = frame->currentFPS > 0.0f ? 1000.0f / frame->currentFPS : frame->frameTimeMs;
+    sample.cpuTimeMs = frame->cpuTimeMs;
+    sample.gpuTimeMs = frame->gpuTimeMs;
+    sample.gpuWaitMs = throttle.waitMs;
+    sample.drawCalls = frame->drawCalls;
+    sample.triangles = frame->triangles;
+    resolutionScalerRecordFrame(&sample);
+    
+    collectSubsystemStats(frame);
+    
+    // Make this frame's stats visible to other threads
+    glWrapperPublishStats();
+    publishMetrics();
 }
 
 // ============================================================================
@@ -311,23 +683,9 @@ VELOCITY_API void velocityEndFrame(void) {
 VELOCITY_API VelocityStats velocityGetStats(void) {
     VelocityStats stats = {0};
     
-    if (g_wrapperCtx) {
-        memcpy(&stats, &g_wrapperCtx->stats, sizeof(VelocityStats));
-        
-        // Add shader cache stats
-        shaderCacheGetStats(&stats.shaderCacheHits, 
-                            &stats.shaderCacheMisses, 
-                            &stats.shaderCacheSize);
-        
-        // Add texture memory
-        stats.textureMemory = textureManagerGetMemoryUsage();
-        
-        // Add buffer memory
-        size_t bufAlloc, bufUsed;
-        uint32_t allocCount;
-        bufferManagerGetStats(&bufAlloc, &bufUsed, &allocCount);
-        stats.bufferMemory = bufUsed;
-    }
+    // Consistent snapshot of the last finished frame, subsystem counters
+    // included; nothing here touches render-thread state
+    glWrapperReadStats(&stats);
     
     return stats;
 }
@@ -336,7 +694,114 @@ VELOCITY_API void velocityResetStats(void) {
     if (g_wrapperCtx) {
         memset(&g_wrapperCtx->stats, 0, sizeof(VelocityStats));
     }
+    frameStatsReset();
     drawBatcherResetStats();
+    callProfilerReset();
+}
+
+VELOCITY_API void velocitySetCallProfiling(bool enabled) {
+    if (g_wrapperCtx) {
+        g_wrapperCtx->config.enableProfiling = enabled;
+    }
+    callProfilerSetEnabled(enabled);
+}
+
+VELOCITY_API int velocityGetCallStats(VelocityCallStats* stats, int maxEntries) {
+    if (!stats || maxEntries <= 0) return 0;
+    
+    CallProfilerEntryStats entries[PROFILE_CALL_COUNT];
+    int count = callProfilerGetStats(entries, PROFILE_CALL_COUNT);
+    if (count > maxEntries) count = maxEntries;
+    
+    for (int i = 0; i < count; i++) {
+        stats[i].name = entries[i].name;
+        stats[i].callsPerFrame = entries[i].frameCalls;
+        stats[i].totalCalls = entries[i].totalCalls;
+        stats[i].sampledCalls = entries[i].sampledCalls;
+        stats[i].wrapperTimeNs = (float)entries[i].avgWrapperNs;
+        stats[i].driverTimeNs = (float)entries[i].avgDriverNs;
+        stats[i].frameTimeMs = (float)entries[i].frameCpuMs;
+    }
+    
+    return count;
+}
+
+VELOCITY_API bool velocityDumpCallStats(const char* path) {
+    return callProfilerDump(path);
+}
+
+VELOCITY_API int velocityGetGpuPassStats(VelocityGpuPassStats* stats, int maxEntries) {
+    if (!stats || maxEntries <= 0) return 0;
+    
+    GpuPassStats passes[GPU_TIMER_MAX_PASSES];
+    int count = gpuTimerGetPasses(passes, GPU_TIMER_MAX_PASSES);
+    if (count > maxEntries) count = maxEntries;
+    
+    for (int i = 0; i < count; i++) {
+        stats[i].name = passes[i].name;
+        stats[i].framebuffer = passes[i].framebuffer;
+        stats[i].gpuTimeMs = passes[i].gpuTimeMs;
+    }
+    
+    return count;
+}
+
+VELOCITY_API int velocityGetSyncStallStats(VelocitySyncStallStats* stats, int maxEntries) {
+    if (!stats || maxEntries <= 0) return 0;
+    
+    FenceTimelineStats timeline;
+    fenceTimelineGetStats(&timeline);
+    int count = FENCE_WAIT_CAUSE_COUNT < maxEntries ? FENCE_WAIT_CAUSE_COUNT : maxEntries;
+    
+    for (int i = 0; i < count; i++) {
+        stats[i].name = timeline.causes[i].name;
+        stats[i].waitsPerFrame = timeline.causes[i].frameWaits;
+        stats[i].frameMs = timeline.causes[i].frameMs;
+        stats[i].totalWaits = timeline.causes[i].totalWaits;
+        stats[i].totalMs = timeline.causes[i].totalMs;
+        stats[i].maxMs = timeline.causes[i].maxMs;
+    }
+    
+    return count;
+}
+
+VELOCITY_API void velocityTraceStart(uint32_t windowMs) {
+    traceStart(windowMs);
+}
+
+VELOCITY_API void velocityTraceStop(void) {
+    traceStop();
+}
+
+VELOCITY_API bool velocityTraceDump(const char* path) {
+    return traceDump(path);
+}
+
+VELOCITY_API void velocityTraceCaptureFrames(const char* path, int frames) {
+    traceCaptureFrames(path, frames);
+}
+
+VELOCITY_API void velocitySetHitchThreshold(float thresholdMs) {
+    if (g_wrapperCtx) {
+        g_wrapperCtx->config.hitchThresholdMs = thresholdMs;
+    }
+    flightRecorderSetThreshold(thresholdMs);
+}
+
+VELOCITY_API bool velocitySummarizeHitch(const char* path, char* out, size_t outSize) {
+    return flightRecorderSummarize(path, out, outSize);
+}
+
+VELOCITY_API const VelocityMetricsBlock* velocityGetMetricsBlock(void) {
+    return metricsExportGetBlock();
+}
+
+VELOCITY_API int velocityGetMetricsFd(void) {
+    return metricsExportGetFd();
+}
+
+VELOCITY_API bool velocityReadMetrics(VelocityMetrics* out) {
+    return metricsExportRead(out);
 }
 
 VELOCITY_API VelocityGPUCaps velocityGetGPUCaps(void) {
@@ -379,6 +844,7 @@ VELOCITY_API void velocityFlushShaderCache(void) {
 // ============================================================================
 
 VELOCITY_API void velocitySetResolutionScale(float scale) {
+    glFunctionsFlushPasses();
     resolutionScalerSetScale(scale);
 }
 
@@ -387,9 +853,110 @@ VELOCITY_API float velocityGetResolutionScale(void) {
 }
 
 VELOCITY_API void velocitySetDynamicResolution(bool enabled) {
+    glFunctionsFlushPasses();
     resolutionScalerSetEnabled(enabled);
 }
 
+VELOCITY_API bool velocityBenchmarkUpscaler(float scale, VelocityUpscaleBenchmark* result) {
+    if (!result) return false;
+    memset(result, 0, sizeof(VelocityUpscaleBenchmark));
+    
+    ScalerBenchmarkResult fsr, bilinear;
+    glFunctionsFlushPasses();
+    if (!resolutionScalerBenchmark(UPSCALE_FSR, scale, &fsr) ||
+        !resolutionScalerBenchmark(UPSCALE_BILINEAR, scale, &bilinear)) {
+        return false;
+    }
+    
+    result->scale = fsr.scale;
+    result->fsrPsnrDb = fsr.psnrDb;
+    result->fsrMs = fsr.upscaleMs;
+    result->bilinearPsnrDb = bilinear.psnrDb;
+    result->bilinearMs = bilinear.upscaleMs;
+    return fsr.method == UPSCALE_FSR;
+}
+
+VELOCITY_API void velocityBeginUI(void) {
+    uiSplitMarkUI();
+}
+
+VELOCITY_API void velocitySetNativeUI(VelocityNativeUIMode mode) {
+    // Heuristic splits need a window depth buffer to fall back on
+    if (mode == VELOCITY_NATIVE_UI_AUTO && g_wrapperCtx && g_wrapperCtx->contextCurrent &&
+        !g_wrapperCtx->windowDepth) {
+        velocityLogWarn("Window surface has no depth buffer, native UI stays marker-driven");
+        mode = VELOCITY_NATIVE_UI_MARKER;
+    }
+    
+    uiSplitSetMode((UISplitMode)mode);
+    
+    if (g_wrapperCtx) {
+        g_wrapperCtx->config.nativeUI = mode;
+    }
+}
+
+// ============================================================================
+// Frame Pacing
+// ============================================================================
+
+VELOCITY_API void velocitySetFramePacing(bool enabled) {
+    framePacingSetEnabled(enabled);
+    
+    if (g_wrapperCtx) {
+        g_wrapperCtx->config.enableFramePacing = enabled;
+    }
+}
+
+VELOCITY_API void velocitySetDisplayRefreshRate(float hz) {
+    framePacingSetRefreshRate(hz);
+}
+
+VELOCITY_API void velocitySetIdlePolicy(VelocityIdlePolicy policy, int idleFPS) {
+    frameIdleSetPolicy((FrameIdlePolicy)policy, idleFPS);
+    
+    if (g_wrapperCtx) {
+        g_wrapperCtx->config.idlePolicy = policy;
+        g_wrapperCtx->config.idleFPS = idleFPS;
+    }
+}
+
+VELOCITY_API void velocitySetLatencyMode(bool enabled, int maxFramesInFlight) {
+    frameThrottleSetMaxFrames(maxFramesInFlight);
+    frameThrottleSetEnabled(enabled);
+    
+    if (g_wrapperCtx) {
+        g_wrapperCtx->config.enableLatencyMode = enabled;
+        g_wrapperCtx->config.maxFramesInFlight = maxFramesInFlight;
+    }
+}
+
+// ============================================================================
+// Pixel Readback
+// ============================================================================
+
+VELOCITY_API uint32_t velocityReadPixelsAsync(int x, int y, int width, int height,
+                                              uint32_t format, uint32_t type,
+                                              VelocityReadbackCallback callback, void* userData) {
+    if (!g_wrapperCtx) return 0;
+    
+    // Deferred clears and passes must land before the read
+    glFunctionsFlushPasses();
+    fbInvalidateRead(g_wrapperCtx->state.framebuffer.readFramebuffer, GL_COLOR_BUFFER_BIT);
+    return readbackRequest(x, y, width, height, format, type, callback, userData);
+}
+
+VELOCITY_API int velocityPollReadback(uint32_t handle, void* pixels, size_t size) {
+    return readbackPoll(handle, pixels, size);
+}
+
+VELOCITY_API void velocitySetAsyncReadback(bool enabled) {
+    readbackSetAsyncMode(enabled);
+    
+    if (g_wrapperCtx) {
+        g_wrapperCtx->config.enableAsyncReadback = enabled;
+    }
+}
+
 // ============================================================================
 // Memory Management
 // ============================================================================
@@ -404,14 +971,20 @@ VELOCITY_API void velocityTrimMemory(int level) {
         case 1:
             bufferManagerTrim();
             textureManagerTrim(textureManagerGetMemoryUsage() / 2);
+            storagePoolTrim(0);
+            namePoolFlush();
             break;
         case 2:
             bufferManagerTrim();
             textureManagerTrim(textureManagerGetMemoryUsage() / 4);
+            storagePoolTrim(0);
+            namePoolFlush();
             shaderCacheClear();
             break;
         default:
             bufferManagerTrim();
+            storagePoolTrim(0);
+            namePoolFlush();
             textureCacheClear();
             shaderCacheClear();
             velocityMemoryTrim();
@@ -507,6 +1080,34 @@ Java_com_velocitygl_VelocityGL_nativeGetProcAddress(JNIEnv* env, jclass clazz, j
     return (jlong)proc;
 }
 
+JNIEXPORT jstring JNICALL
+Java_com_velocitygl_VelocityGL_nativeGetStats(JNIEnv* env, jclass clazz) {
+    VelocityStats stats = velocityGetStats();
+    
+    char json[1024];
+    snprintf(json, sizeof(json),
+             "{\"fps\":%.3f,\"avgFps\":%.3f,\"frameTimeMs\":%.3f,\"gpuTimeMs\":%.3f,"
+             "\"frameTimeP50Ms\":%.3f,\"frameTimeP90Ms\":%.3f,"
+             "\"frameTimeP99Ms\":%.3f,\"frameTimeP999Ms\":%.3f,"
+             "\"onePercentLowFps\":%.3f,\"stutterCount\":%u,\"pacedFps\":%.3f,"
+             "\"latencyMs\":%.3f,"
+             "\"drawCalls\":%u,\"triangles\":%u,"
+             "\"textureMemoryMB\":%.3f,\"bufferMemoryMB\":%.3f,"
+             "\"shaderCacheHits\":%u,\"shaderCacheMisses\":%u,"
+             "\"resolutionScale\":%.3f,\"renderWidth\":%d,\"renderHeight\":%d}",
+             stats.currentFPS, stats.avgFPS, stats.frameTimeMs, stats.gpuTimeMs,
+             stats.frameTimeP50Ms, stats.frameTimeP90Ms,
+             stats.frameTimeP99Ms, stats.frameTimeP999Ms,
+             stats.onePercentLowFPS, stats.stutterCount, stats.pacedFPS,
+             stats.latencyMs,
+             stats.drawCalls, stats.triangles,
+             stats.textureMemory / (1024.0 * 1024.0), stats.bufferMemory / (1024.0 * 1024.0),
+             stats.shaderCacheHits, stats.shaderCacheMisses,
+             stats.currentResolutionScale, stats.renderWidth, stats.renderHeight);
+    
+    return (*env)->NewStringUTF(env, json);
+}
+
 JNIEXPORT jfloat JNICALL
 Java_com_velocitygl_VelocityGL_nativeGetFPS(JNIEnv* env, jclass clazz) {
     VelocityStats stats = velocityGetStats();
@@ -517,3 +1118,113 @@ JNIEXPORT void JNICALL
 Java_com_velocitygl_VelocityGL_nativeSetResolutionScale(JNIEnv* env, jclass clazz, jfloat scale) {
     velocitySetResolutionScale(scale);
 }
+
+JNIEXPORT void JNICALL
+Java_com_velocitygl_VelocityGL_nativeSetCallProfiling(JNIEnv* env, jclass clazz, jboolean enabled) {
+    velocitySetCallProfiling(enabled == JNI_TRUE);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_velocitygl_VelocityGL_nativeDumpCallStats(JNIEnv* env, jclass clazz, jstring path) {
+    const char* dumpPath = NULL;
+    if (path) {
+        dumpPath = (*env)->GetStringUTFChars(env, path, NULL);
+    }
+    
+    jboolean result = velocityDumpCallStats(dumpPath) ? JNI_TRUE : JNI_FALSE;
+    
+    if (dumpPath) {
+        (*env)->ReleaseStringUTFChars(env, path, dumpPath);
+    }
+    
+    return result;
+}
+
+JNIEXPORT void JNICALL
+Java_com_velocitygl_VelocityGL_nativeTraceStart(JNIEnv* env, jclass clazz, jint windowMs) {
+    velocityTraceStart(windowMs > 0 ? (uint32_t)windowMs : 0);
+}
+
+JNIEXPORT void JNICALL
+Java_com_velocitygl_VelocityGL_nativeTraceStop(JNIEnv* env, jclass clazz) {
+    velocityTraceStop();
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_velocitygl_VelocityGL_nativeTraceDump(JNIEnv* env, jclass clazz, jstring path) {
+    if (!path) return JNI_FALSE;
+    const char* dumpPath = (*env)->GetStringUTFChars(env, path, NULL);
+    if (!dumpPath) return JNI_FALSE;
+    jboolean result = velocityTraceDump(dumpPath) ? JNI_TRUE : JNI_FALSE;
+    (*env)->ReleaseStringUTFChars(env, path, dumpPath);
+    return result;
+}
+
+JNIEXPORT void JNICALL
+Java_com_velocitygl_VelocityGL_nativeTraceCaptureFrames(JNIEnv* env, jclass clazz, 
+                                                         jstring path, jint frames) {
+    if (!path) return;
+    const char* capturePath = (*env)->GetStringUTFChars(env, path, NULL);
+    if (!capturePath) return;
+    velocityTraceCaptureFrames(capturePath, frames);
+    (*env)->ReleaseStringUTFChars(env, path, capturePath);
+}
+
+JNIEXPORT void JNICALL
+Java_com_velocitygl_VelocityGL_nativeSetHitchThreshold(JNIEnv* env, jclass clazz, jfloat thresholdMs) {
+    velocitySetHitchThreshold(thresholdMs);
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_velocitygl_VelocityGL_nativeSummarizeHitch(JNIEnv* env, jclass clazz, jstring path) {
+    if (!path) return NULL;
+    const char* dumpPath = (*env)->GetStringUTFChars(env, path, NULL);
+    if (!dumpPath) return NULL;
+    
+    char summary[2048];
+    bool ok = velocitySummarizeHitch(dumpPath, summary, sizeof(summary));
+    
+    (*env)->ReleaseStringUTFChars(env, path, dumpPath);
+    
+    return ok ? (*env)->NewStringUTF(env, summary) : NULL;
+}
+
+JNIEXPORT jobject JNICALL
+Java_com_velocitygl_VelocityGL_nativeGetMetricsBuffer(JNIEnv* env, jclass clazz) {
+    const VelocityMetricsBlock* block = velocityGetMetricsBlock();
+    if (!block) return NULL;
+    
+    // Wraps the shared page; Kotlin reads it without further JNI calls
+    return (*env)->NewDirectByteBuffer(env, (void*)block, (jlong)sizeof(VelocityMetricsBlock));
+}
+
+JNIEXPORT jint JNICALL
+Java_com_velocitygl_VelocityGL_nativeGetMetricsFd(JNIEnv* env, jclass clazz) {
+    return velocityGetMetricsFd();
+}
+
+JNIEXPORT void JNICALL
+Java_com_velocitygl_VelocityGL_nativeSetFramePacing(JNIEnv* env, jclass clazz, jboolean enabled) {
+    velocitySetFramePacing(enabled == JNI_TRUE);
+}
+
+JNIEXPORT void JNICALL
+Java_com_velocitygl_VelocityGL_nativeSetDisplayRefreshRate(JNIEnv* env, jclass clazz, jfloat hz) {
+    velocitySetDisplayRefreshRate(hz);
+}
+
+JNIEXPORT void JNICALL
+Java_com_velocitygl_VelocityGL_nativeSetLatencyMode(JNIEnv* env, jclass clazz, 
+                                                    jboolean enabled, jint maxFramesInFlight) {
+    velocitySetLatencyMode(enabled == JNI_TRUE, maxFramesInFlight);
+}
+
+JNIEXPORT void JNICALL
+Java_com_velocitygl_VelocityGL_nativeBeginUI(JNIEnv* env, jclass clazz) {
+    velocityBeginUI();
+}
+
+JNIEXPORT void JNICALL
+Java_com_velocitygl_VelocityGL_nativeSetNativeUI(JNIEnv* env, jclass clazz, jint mode) {
+    velocitySetNativeUI((VelocityNativeUIMode)mode);
+}